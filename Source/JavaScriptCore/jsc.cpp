@@ -61,6 +61,7 @@
 #include <string.h>
 #include <thread>
 #include <wtf/CurrentTime.h>
+#include <wtf/LockProfiler.h>
 #include <wtf/MainThread.h>
 #include <wtf/StringPrintStream.h>
 #include <wtf/text/StringBuilder.h>
@@ -510,6 +511,8 @@ static EncodedJSValue JSC_HOST_CALL functionFullGC(ExecState*);
 static EncodedJSValue JSC_HOST_CALL functionEdenGC(ExecState*);
 static EncodedJSValue JSC_HOST_CALL functionForceGCSlowPaths(ExecState*);
 static EncodedJSValue JSC_HOST_CALL functionHeapSize(ExecState*);
+static EncodedJSValue JSC_HOST_CALL functionDumpLockContention(ExecState*);
+static EncodedJSValue JSC_HOST_CALL functionResetLockContention(ExecState*);
 static EncodedJSValue JSC_HOST_CALL functionAddressOf(ExecState*);
 #ifndef NDEBUG
 static EncodedJSValue JSC_HOST_CALL functionDumpCallFrame(ExecState*);
@@ -673,6 +676,8 @@ protected:
         addFunction(vm, "edenGC", functionEdenGC, 0);
         addFunction(vm, "forceGCSlowPaths", functionForceGCSlowPaths, 0);
         addFunction(vm, "gcHeapSize", functionHeapSize, 0);
+        addFunction(vm, "dumpLockContention", functionDumpLockContention, 0);
+        addFunction(vm, "resetLockContention", functionResetLockContention, 0);
         addFunction(vm, "addressOf", functionAddressOf, 1);
 #ifndef NDEBUG
         addFunction(vm, "dumpCallFrame", functionDumpCallFrame, 0);
@@ -1207,6 +1212,19 @@ EncodedJSValue JSC_HOST_CALL functionHeapSize(ExecState* exec)
     return JSValue::encode(jsNumber(exec->heap()->size()));
 }
 
+// Only records anything when run with --profileLockContention=true.
+EncodedJSValue JSC_HOST_CALL functionDumpLockContention(ExecState*)
+{
+    LockProfiler::dump();
+    return JSValue::encode(jsUndefined());
+}
+
+EncodedJSValue JSC_HOST_CALL functionResetLockContention(ExecState*)
+{
+    LockProfiler::reset();
+    return JSValue::encode(jsUndefined());
+}
+
 // This function is not generally very helpful in 64-bit code as the tag and payload
 // share a register. But in 32-bit JITed code the tag may not be checked if an
 // optimization removes type checking requirements, such as in ===.
@@ -2030,6 +2048,9 @@ int jscmain(int argc, char** argv)
         std::sort(compileTimeKeys.begin(), compileTimeKeys.end());
         for (CString key : compileTimeKeys)
             printf("%40s: %.3lf ms\n", key.data(), compileTimeStats.get(key));
+
+        if (Options::profileLockContention())
+            LockProfiler::dump();
     }
     
     return result;
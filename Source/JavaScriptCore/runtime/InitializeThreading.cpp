@@ -41,6 +41,7 @@
 #include "StructureIDTable.h"
 #include "WriteBarrier.h"
 #include <mutex>
+#include <wtf/LockProfiler.h>
 #include <wtf/dtoa.h>
 #include <wtf/Threading.h>
 #include <wtf/dtoa/cached-powers.h>
@@ -59,6 +60,8 @@ void initializeThreading()
         Options::initialize();
         if (Options::recordGCPauseTimes())
             HeapStatistics::initialize();
+        if (Options::profileLockContention())
+            LockProfiler::setEnabled(true, Options::lockContentionSamplingPeriod());
 #if ENABLE(WRITE_BARRIER_PROFILING)
         WriteBarrierCounters::initialize();
 #endif
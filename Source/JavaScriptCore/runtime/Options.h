@@ -319,6 +319,8 @@ typedef const char* optionString;
     v(unsigned, forceRAMSize, 0, nullptr) \
     v(bool, recordGCPauseTimes, false, nullptr) \
     v(bool, logHeapStatisticsAtExit, false, nullptr) \
+    v(bool, profileLockContention, false, "records where threads block on a WTF::Lock; jsc dumps the profile at exit") \
+    v(unsigned, lockContentionSamplingPeriod, 1, "records one in N contended WTF::Lock acquisitions") \
     v(bool, useTypeProfiler, false, nullptr) \
     v(bool, useControlFlowProfiler, false, nullptr) \
     \
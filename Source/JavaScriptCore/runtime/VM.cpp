@@ -153,7 +153,11 @@ VM::VM(VMType vmType, HeapType heapType)
     , clientData(0)
     , topVMEntryFrame(nullptr)
     , topCallFrame(CallFrame::noCaller())
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+    , m_atomicStringTable(wtfThreadData().atomicStringTable())
+#else
     , m_atomicStringTable(vmType == Default ? wtfThreadData().atomicStringTable() : new AtomicStringTable)
+#endif
     , propertyNames(nullptr)
     , emptyList(new MarkedArgumentBuffer)
     , stringCache(*this)
@@ -350,8 +354,10 @@ VM::~VM()
     delete emptyList;
 
     delete propertyNames;
+#if !USE(SHARED_ATOMIC_STRING_TABLE)
     if (vmType != Default)
         delete m_atomicStringTable;
+#endif
 
     delete clientData;
     delete m_regExpCache;
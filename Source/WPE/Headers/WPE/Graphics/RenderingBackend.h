@@ -52,6 +52,9 @@ public:
         virtual EGLNativeWindowType nativeWindow() = 0;
         virtual void resize(uint32_t, uint32_t) = 0;
 
+        virtual void beginFrame();
+        // Time the web process spent painting the contents of the frame about to be locked, in microseconds.
+        virtual void reportPaintTime(uint32_t);
         virtual BufferExport lockFrontBuffer() = 0;
         virtual void releaseBuffer(uint32_t) = 0;
     };
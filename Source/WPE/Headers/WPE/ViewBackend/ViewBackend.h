@@ -28,7 +28,10 @@
 #define WPE_ViewBackend_ViewBackend_h
 
 #include <WPE/WPE.h>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <tuple>
 
 namespace WPE {
 
@@ -47,10 +50,16 @@ public:
 
 class ViewBackend {
 public:
+    // x, y, width and height, in buffer coordinates.
+    using DamageRect = std::tuple<int32_t, int32_t, uint32_t, uint32_t>;
+
     static WPE_EXPORT std::unique_ptr<ViewBackend> create();
 
     virtual void setClient(Client*);
     virtual uint32_t constructRenderingTarget(uint32_t, uint32_t) = 0;
+    // Parts of the next committed buffer that differ from the previously committed one. Backends
+    // that don't override this present the whole buffer.
+    virtual void setDamage(const DamageRect*, size_t);
     virtual void commitBuffer(int, const uint8_t*, size_t) = 0;
     virtual void destroyBuffer(uint32_t) = 0;
 
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef WPE_Graphics_BufferDataHeadless_h
+#define WPE_Graphics_BufferDataHeadless_h
+
+#if WPE_BACKEND(HEADLESS)
+
+#include <stdint.h>
+
+namespace WPE {
+
+namespace Graphics {
+
+struct BufferDataHeadless {
+    uint32_t width;
+    uint32_t height;
+    uint32_t frameNumber;
+    // Time spent by the compositor on this frame, from the start of the frame
+    // until rendering was finished, in microseconds.
+    uint32_t renderTime;
+    // Time spent by the web process main thread flushing and painting the layers
+    // shown in this frame, in microseconds.
+    uint32_t paintTime;
+    uint32_t magic;
+
+    static const uint32_t magicValue;
+};
+
+} // Graphics
+
+} // WPE
+
+#endif // WPE_BACKEND(HEADLESS)
+
+#endif // WPE_Graphics_BufferDataHeadless_h
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "Config.h"
+#include "RenderingBackendHeadless.h"
+
+#if WPE_BACKEND(HEADLESS)
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace WPE {
+
+namespace Graphics {
+
+RenderingBackendHeadless::RenderingBackendHeadless()
+{
+    // Mesa selects the platform used by eglGetDisplay(EGL_DEFAULT_DISPLAY) from EGL_PLATFORM.
+    // The surfaceless platform doesn't need any display server nor GPU, and combined with
+    // LIBGL_ALWAYS_SOFTWARE=1 it renders through llvmpipe. An explicit setting is respected.
+    setenv("EGL_PLATFORM", "surfaceless", 0);
+}
+
+RenderingBackendHeadless::~RenderingBackendHeadless() = default;
+
+EGLNativeDisplayType RenderingBackendHeadless::nativeDisplay()
+{
+    return EGL_DEFAULT_DISPLAY;
+}
+
+std::unique_ptr<RenderingBackend::Surface> RenderingBackendHeadless::createSurface(uint32_t width, uint32_t height, uint32_t targetHandle, RenderingBackend::Surface::Client& client)
+{
+    return std::unique_ptr<RenderingBackendHeadless::Surface>(new RenderingBackendHeadless::Surface(*this, width, height, targetHandle, client));
+}
+
+std::unique_ptr<RenderingBackend::OffscreenSurface> RenderingBackendHeadless::createOffscreenSurface()
+{
+    return std::unique_ptr<RenderingBackendHeadless::OffscreenSurface>(new RenderingBackendHeadless::OffscreenSurface(*this));
+}
+
+RenderingBackendHeadless::Surface::Surface(const RenderingBackendHeadless&, uint32_t width, uint32_t height, uint32_t, RenderingBackendHeadless::Surface::Client&)
+{
+    m_bufferData.width = width;
+    m_bufferData.height = height;
+    m_bufferData.frameNumber = 0;
+    m_bufferData.renderTime = 0;
+    m_bufferData.paintTime = 0;
+    m_bufferData.magic = BufferDataHeadless::magicValue;
+
+    if (const char* dumpDirectory = std::getenv("WPE_HEADLESS_DUMP_DIRECTORY"))
+        m_dumpDirectory = dumpDirectory;
+}
+
+RenderingBackendHeadless::Surface::~Surface() = default;
+
+EGLNativeWindowType RenderingBackendHeadless::Surface::nativeWindow()
+{
+    // Without a native window the GL context is created on a pbuffer of the surface size.
+    return 0;
+}
+
+void RenderingBackendHeadless::Surface::resize(uint32_t, uint32_t)
+{
+    // Pbuffers can't be resized, frames keep being produced at the initial size.
+}
+
+void RenderingBackendHeadless::Surface::beginFrame()
+{
+    m_frameStartTime = std::chrono::steady_clock::now();
+    // Frames are not always preceded by a paint, e.g. when only the scroll position changed.
+    m_bufferData.paintTime = 0;
+}
+
+void RenderingBackendHeadless::Surface::reportPaintTime(uint32_t paintTime)
+{
+    m_bufferData.paintTime = paintTime;
+}
+
+RenderingBackend::BufferExport RenderingBackendHeadless::Surface::lockFrontBuffer()
+{
+    // Rendering is asynchronous, wait for it so the reported time covers the whole frame.
+    glFinish();
+    auto renderTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_frameStartTime);
+    m_bufferData.renderTime = renderTime.count();
+
+    if (!m_dumpDirectory.empty())
+        dumpFrame();
+
+    ++m_bufferData.frameNumber;
+    return std::make_tuple(-1, reinterpret_cast<uint8_t*>(&m_bufferData), sizeof(BufferDataHeadless));
+}
+
+void RenderingBackendHeadless::Surface::releaseBuffer(uint32_t)
+{
+}
+
+void RenderingBackendHeadless::Surface::dumpFrame()
+{
+    uint32_t width = m_bufferData.width;
+    uint32_t height = m_bufferData.height;
+    if (!width || !height)
+        return;
+
+    m_pixels.resize(width * height * 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, m_pixels.data());
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/frame-%05u.ppm", m_dumpDirectory.c_str(), m_bufferData.frameNumber);
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "RenderingBackendHeadless: could not open %s for writing\n", path);
+        return;
+    }
+
+    // GL rows go bottom to top, PPM ones top to bottom.
+    fprintf(file, "P6\n%u %u\n255\n", width, height);
+    std::vector<uint8_t> row(width * 3);
+    for (uint32_t y = height; y > 0; --y) {
+        const uint8_t* source = m_pixels.data() + (y - 1) * width * 4;
+        for (uint32_t x = 0; x < width; ++x)
+            std::memcpy(&row[x * 3], &source[x * 4], 3);
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    fclose(file);
+}
+
+RenderingBackendHeadless::OffscreenSurface::OffscreenSurface(const RenderingBackendHeadless&)
+{
+}
+
+RenderingBackendHeadless::OffscreenSurface::~OffscreenSurface() = default;
+
+EGLNativeWindowType RenderingBackendHeadless::OffscreenSurface::nativeWindow()
+{
+    // This will in turn create a pbuffer-based GL context.
+    return 0;
+}
+
+} // namespace Graphics
+
+} // namespace WPE
+
+#endif // WPE_BACKEND(HEADLESS)
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef WPE_Graphics_RenderingBackendHeadless_h
+#define WPE_Graphics_RenderingBackendHeadless_h
+
+#if WPE_BACKEND(HEADLESS)
+
+#include "BufferDataHeadless.h"
+#include <WPE/Graphics/RenderingBackend.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace WPE {
+
+namespace Graphics {
+
+// Renders without any display hardware or windowing system: surfaces are backed
+// by pbuffers on a surfaceless EGL display, which together with Mesa's software
+// rasterizer allows running the whole graphics pipeline on CI machines.
+class RenderingBackendHeadless final : public RenderingBackend {
+public:
+    class Surface final : public RenderingBackend::Surface {
+    public:
+        Surface(const RenderingBackendHeadless&, uint32_t, uint32_t, uint32_t, Client&);
+        WPE_EXPORT virtual ~Surface();
+
+        EGLNativeWindowType nativeWindow() override;
+        void resize(uint32_t, uint32_t) override;
+
+        void beginFrame() override;
+        void reportPaintTime(uint32_t) override;
+        BufferExport lockFrontBuffer() override;
+        void releaseBuffer(uint32_t) override;
+
+    private:
+        void dumpFrame();
+
+        BufferDataHeadless m_bufferData;
+        std::chrono::steady_clock::time_point m_frameStartTime;
+
+        std::string m_dumpDirectory;
+        std::vector<uint8_t> m_pixels;
+    };
+
+    class OffscreenSurface final : public RenderingBackend::OffscreenSurface {
+    public:
+        OffscreenSurface(const RenderingBackendHeadless&);
+        virtual ~OffscreenSurface();
+
+        EGLNativeWindowType nativeWindow() override;
+    };
+
+    RenderingBackendHeadless();
+    virtual ~RenderingBackendHeadless();
+
+    EGLNativeDisplayType nativeDisplay() override;
+    std::unique_ptr<RenderingBackend::Surface> createSurface(uint32_t, uint32_t, uint32_t, RenderingBackend::Surface::Client&) override;
+    std::unique_ptr<RenderingBackend::OffscreenSurface> createOffscreenSurface() override;
+};
+
+} // namespace Graphics
+
+} // namespace WPE
+
+#endif // WPE_BACKEND(HEADLESS)
+
+#endif // WPE_Graphics_RenderingBackendHeadless_h
@@ -29,8 +29,11 @@
 #include "RenderingBackendBCMNexus.h"
 #include "RenderingBackendBCMRPi.h"
 #include "RenderingBackendGBM.h"
+#include "RenderingBackendHeadless.h"
 #include "RenderingBackendIntelCE.h"
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 namespace WPE {
 
@@ -38,6 +41,12 @@ namespace Graphics {
 
 std::unique_ptr<RenderingBackend> RenderingBackend::create()
 {
+#if WPE_BACKEND(HEADLESS)
+    auto* backendEnv = std::getenv("WPE_BACKEND");
+    if (backendEnv && !std::strcmp(backendEnv, "headless"))
+        return std::unique_ptr<RenderingBackendHeadless>(new RenderingBackendHeadless);
+#endif
+
 #if WPE_BACKEND(DRM) || WPE_BACKEND(WAYLAND)
     return std::unique_ptr<RenderingBackendGBM>(new RenderingBackendGBM);
 #endif
@@ -54,6 +63,10 @@ std::unique_ptr<RenderingBackend> RenderingBackend::create()
     return std::unique_ptr<RenderingBackendIntelCE>(new RenderingBackendIntelCE);
 #endif
 
+#if WPE_BACKEND(HEADLESS)
+    return std::unique_ptr<RenderingBackendHeadless>(new RenderingBackendHeadless);
+#endif
+
     fprintf(stderr, "RenderingBackend: no usable backend found, will crash.\n");
     return nullptr;
 }
@@ -62,6 +75,14 @@ RenderingBackend::~RenderingBackend() = default;
 
 RenderingBackend::Surface::~Surface() = default;
 
+void RenderingBackend::Surface::beginFrame()
+{
+}
+
+void RenderingBackend::Surface::reportPaintTime(uint32_t)
+{
+}
+
 RenderingBackend::OffscreenSurface::~OffscreenSurface() = default;
 
 } // namespace Graphics
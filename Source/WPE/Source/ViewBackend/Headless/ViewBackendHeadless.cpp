@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "Config.h"
+#include "ViewBackendHeadless.h"
+
+#if WPE_BACKEND(HEADLESS)
+
+#include "BufferDataHeadless.h"
+#include <WPE/Input/Handling.h>
+#include <algorithm>
+#include <cstdlib>
+
+namespace WPE {
+
+namespace ViewBackend {
+
+ViewBackendHeadless::ViewBackendHeadless()
+    : m_client(nullptr)
+    , m_width(1280)
+    , m_height(720)
+    , m_frameLog(nullptr)
+    , m_damagedArea(-1)
+{
+    if (const char* size = std::getenv("WPE_HEADLESS_SIZE")) {
+        uint32_t width, height;
+        if (std::sscanf(size, "%ux%u", &width, &height) == 2 && width && height) {
+            m_width = width;
+            m_height = height;
+        } else
+            fprintf(stderr, "ViewBackendHeadless: ignoring invalid WPE_HEADLESS_SIZE, expected WIDTHxHEIGHT\n");
+    }
+
+    if (const char* frameLogPath = std::getenv("WPE_HEADLESS_FRAME_LOG")) {
+        m_frameLog = fopen(frameLogPath, "a");
+        if (!m_frameLog)
+            fprintf(stderr, "ViewBackendHeadless: could not open the frame log %s\n", frameLogPath);
+    }
+}
+
+ViewBackendHeadless::~ViewBackendHeadless()
+{
+    Input::Server::singleton().setTarget(nullptr);
+    if (m_frameLog)
+        fclose(m_frameLog);
+}
+
+void ViewBackendHeadless::setClient(Client* client)
+{
+    m_client = client;
+    if (m_client)
+        m_client->setSize(m_width, m_height);
+}
+
+uint32_t ViewBackendHeadless::constructRenderingTarget(uint32_t, uint32_t)
+{
+    return 0;
+}
+
+void ViewBackendHeadless::setDamage(const DamageRect* rects, size_t count)
+{
+    m_damagedArea = count ? 0 : -1;
+    for (size_t i = 0; i < count; ++i)
+        m_damagedArea += static_cast<int64_t>(std::get<2>(rects[i])) * std::get<3>(rects[i]);
+}
+
+void ViewBackendHeadless::commitBuffer(int fd, const uint8_t* data, size_t size)
+{
+    if (!data || size != sizeof(Graphics::BufferDataHeadless) || fd != -1) {
+        fprintf(stderr, "ViewBackendHeadless: failed to validate the committed buffer\n");
+        return;
+    }
+
+    auto& bufferData = *reinterpret_cast<const Graphics::BufferDataHeadless*>(data);
+    if (bufferData.magic != Graphics::BufferDataHeadless::magicValue) {
+        fprintf(stderr, "ViewBackendHeadless: failed to validate the committed buffer\n");
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (m_frameLog) {
+        // One line per frame: frame number, time since the previous frame, compositor render
+        // time and web process paint time, all in microseconds, then the percentage of the
+        // buffer that was damaged. The first frame has no interval.
+        uint64_t interval = 0;
+        if (bufferData.frameNumber)
+            interval = std::chrono::duration_cast<std::chrono::microseconds>(now - m_lastCommitTime).count();
+        uint64_t bufferArea = static_cast<uint64_t>(bufferData.width) * bufferData.height;
+        unsigned damagedPercentage = 100;
+        if (m_damagedArea >= 0 && bufferArea)
+            damagedPercentage = std::min<uint64_t>(100, (m_damagedArea * 100 + bufferArea - 1) / bufferArea);
+        fprintf(m_frameLog, "%u %llu %u %u %u\n", bufferData.frameNumber, static_cast<unsigned long long>(interval), bufferData.renderTime, bufferData.paintTime, damagedPercentage);
+        fflush(m_frameLog);
+    }
+    m_lastCommitTime = now;
+    m_damagedArea = -1;
+
+    if (m_client)
+        m_client->frameComplete();
+}
+
+void ViewBackendHeadless::destroyBuffer(uint32_t)
+{
+}
+
+void ViewBackendHeadless::setInputClient(Input::Client* client)
+{
+    Input::Server::singleton().setTarget(client);
+}
+
+} // namespace ViewBackend
+
+} // namespace WPE
+
+#endif // WPE_BACKEND(HEADLESS)
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef WPE_ViewBackend_ViewBackendHeadless_h
+#define WPE_ViewBackend_ViewBackendHeadless_h
+
+#if WPE_BACKEND(HEADLESS)
+
+#include <WPE/ViewBackend/ViewBackend.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace WPE {
+
+namespace ViewBackend {
+
+// Presents nothing: committed frames are acknowledged right away, and their timings and damaged
+// area are appended to the file named by WPE_HEADLESS_FRAME_LOG when set. There are no input devices
+// either, events served through Input::Server, e.g. by test runners, go to the input client.
+class ViewBackendHeadless final : public ViewBackend {
+public:
+    ViewBackendHeadless();
+    virtual ~ViewBackendHeadless();
+
+    void setClient(Client*) override;
+    uint32_t constructRenderingTarget(uint32_t, uint32_t) override;
+    void setDamage(const DamageRect*, size_t) override;
+    void commitBuffer(int, const uint8_t*, size_t) override;
+    void destroyBuffer(uint32_t) override;
+
+    void setInputClient(Input::Client*) override;
+
+private:
+    Client* m_client;
+
+    uint32_t m_width;
+    uint32_t m_height;
+
+    FILE* m_frameLog;
+    // Damaged pixels of the next committed buffer, or -1 for the whole buffer.
+    int64_t m_damagedArea;
+    std::chrono::steady_clock::time_point m_lastCommitTime;
+};
+
+} // namespace ViewBackend
+
+} // namespace WPE
+
+#endif // WPE_BACKEND(HEADLESS)
+
+#endif // WPE_ViewBackend_ViewBackendHeadless_h
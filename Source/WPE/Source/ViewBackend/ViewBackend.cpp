@@ -30,6 +30,7 @@
 #include "ViewBackendBCMNexus.h"
 #include "ViewBackendBCMRPi.h"
 #include "ViewBackendDRM.h"
+#include "ViewBackendHeadless.h"
 #include "ViewBackendWayland.h"
 #include "ViewBackendIntelCE.h"
 #include <cstring>
@@ -44,6 +45,11 @@ std::unique_ptr<ViewBackend> ViewBackend::create()
 {
     auto* backendEnv = std::getenv("WPE_BACKEND");
 
+#if WPE_BACKEND(HEADLESS)
+    if (backendEnv && !std::strcmp(backendEnv, "headless"))
+        return std::unique_ptr<ViewBackendHeadless>(new ViewBackendHeadless);
+#endif
+
 #if WPE_BACKEND(WAYLAND)
     if (std::getenv("WAYLAND_DISPLAY") || (backendEnv && !std::strcmp(backendEnv, "wayland")))
         return std::unique_ptr<ViewBackendWayland>(new ViewBackendWayland);
@@ -69,6 +75,11 @@ std::unique_ptr<ViewBackend> ViewBackend::create()
         return std::unique_ptr<ViewBackendIntelCE>(new ViewBackendIntelCE);
 #endif
 
+#if WPE_BACKEND(HEADLESS)
+    if (!backendEnv)
+        return std::unique_ptr<ViewBackendHeadless>(new ViewBackendHeadless);
+#endif
+
     fprintf(stderr, "ViewBackend: no usable backend found, will crash.\n");
     return nullptr;
 }
@@ -77,6 +88,10 @@ void ViewBackend::setClient(Client*)
 {
 }
 
+void ViewBackend::setDamage(const DamageRect*, size_t)
+{
+}
+
 void ViewBackend::setInputClient(Input::Client*)
 {
 }
@@ -149,6 +149,11 @@ uint32_t ViewBackendWayland::constructRenderingTarget(uint32_t, uint32_t)
     return 0;
 }
 
+void ViewBackendWayland::setDamage(const DamageRect* rects, size_t count)
+{
+    m_damage.assign(rects, rects + count);
+}
+
 void ViewBackendWayland::commitBuffer(int fd, const uint8_t* data, size_t size)
 {
     if (!data || size != sizeof(Graphics::BufferDataGBM)) {
@@ -189,7 +194,11 @@ void ViewBackendWayland::commitBuffer(int fd, const uint8_t* data, size_t size)
     wl_callback_add_listener(m_callbackData.frameCallback, &g_callbackListener, &m_callbackData);
 
     wl_surface_attach(m_surface, buffer, 0, 0);
-    wl_surface_damage(m_surface, 0, 0, INT32_MAX, INT32_MAX);
+    if (m_damage.empty())
+        wl_surface_damage(m_surface, 0, 0, INT32_MAX, INT32_MAX);
+    for (auto& rect : m_damage)
+        wl_surface_damage(m_surface, std::get<0>(rect), std::get<1>(rect), std::get<2>(rect), std::get<3>(rect));
+    m_damage.clear();
     wl_surface_commit(m_surface);
     wl_display_flush(m_display.display());
 }
@@ -31,6 +31,7 @@
 
 #include <WPE/ViewBackend/ViewBackend.h>
 #include <unordered_map>
+#include <vector>
 
 struct ivi_surface;
 struct wl_buffer;
@@ -56,6 +57,7 @@ public:
 
     void setClient(Client* client) override;
     uint32_t constructRenderingTarget(uint32_t, uint32_t) override;
+    void setDamage(const DamageRect*, size_t) override;
     void commitBuffer(int, const uint8_t* data, size_t size) override;
     void destroyBuffer(uint32_t handle) override;
 
@@ -87,6 +89,9 @@ private:
     BufferListenerData m_bufferData;
     CallbackListenerData m_callbackData;
     ResizingData m_resizingData;
+
+    // Damage of the next committed buffer. Empty means the whole buffer.
+    std::vector<DamageRect> m_damage;
 };
 
 } // namespace ViewBackend
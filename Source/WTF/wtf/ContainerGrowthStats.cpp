@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "ContainerGrowthStats.h"
+
+#if DUMP_CONTAINER_GROWTH_STATS
+
+#include "DataLog.h"
+#include "HashFunctions.h"
+#include "Lock.h"
+#include "Vector.h"
+#include <mutex>
+#include <string.h>
+
+#if OS(DARWIN) || (OS(LINUX) && defined(__GLIBC__) && !defined(__UCLIBC__))
+#include <cxxabi.h>
+#include <dlfcn.h>
+#define USE_DLADDR 1
+#endif
+
+namespace WTF {
+
+// Sizes are bucketed by powers of two: bucket 0 holds size 0, bucket 1 size 1, and bucket k > 1
+// sizes in (2^(k-2), 2^(k-1)]. The last bucket also collects everything larger.
+static const unsigned numberOfSizeBuckets = 24;
+
+static unsigned sizeBucket(unsigned size)
+{
+    if (size <= 1)
+        return size;
+    unsigned bucket = 2;
+    for (unsigned bound = 2; bound < size && bucket < numberOfSizeBuckets - 1; bound <<= 1)
+        ++bucket;
+    return bucket;
+}
+
+static unsigned sizeBucketUpperBound(unsigned bucket)
+{
+    return bucket ? 1u << (bucket - 1) : 0;
+}
+
+struct CallSiteStats {
+    const void* callSite;
+    ContainerGrowthStats::ContainerType type;
+    unsigned inlineCapacity;
+    unsigned elementSize;
+    unsigned maxPeakSize;
+    uint64_t instances;
+    uint64_t allocations;
+    unsigned peakSizeHistogram[numberOfSizeBuckets];
+    unsigned finalSizeHistogram[numberOfSizeBuckets];
+    uint64_t allocationsByPeakSize[numberOfSizeBuckets];
+};
+
+// Recording must not allocate: the containers it would use are themselves instrumented.
+// Call sites therefore live in a fixed-size open addressed table.
+static const unsigned callSiteTableSize = 4096;
+static CallSiteStats callSiteTable[callSiteTableSize];
+static unsigned numberOfCallSites;
+static uint64_t numberOfDroppedRecords;
+static StaticLock callSiteTableLock;
+
+const void* ContainerGrowthStats::callSite()
+{
+    return __builtin_return_address(0);
+}
+
+void ContainerGrowthStats::record(ContainerType type, const void* callSite, size_t inlineCapacity, size_t elementSize, size_t finalSize, unsigned peakSize, unsigned allocationCount)
+{
+    std::lock_guard<StaticLock> lock(callSiteTableLock);
+
+    unsigned hash = PtrHash<const void*>::hash(callSite) + static_cast<unsigned>(type);
+    CallSiteStats* stats = nullptr;
+    for (unsigned probe = 0; probe < callSiteTableSize; ++probe) {
+        CallSiteStats& entry = callSiteTable[(hash + probe) & (callSiteTableSize - 1)];
+        if (!entry.instances) {
+            if (numberOfCallSites >= callSiteTableSize * 3 / 4)
+                break;
+            ++numberOfCallSites;
+            entry.callSite = callSite;
+            entry.type = type;
+            entry.inlineCapacity = inlineCapacity;
+            entry.elementSize = elementSize;
+            stats = &entry;
+            break;
+        }
+        if (entry.callSite == callSite && entry.type == type) {
+            stats = &entry;
+            break;
+        }
+    }
+
+    if (!stats) {
+        ++numberOfDroppedRecords;
+        return;
+    }
+
+    unsigned peakBucket = sizeBucket(peakSize);
+    stats->instances++;
+    stats->allocations += allocationCount;
+    stats->maxPeakSize = std::max(stats->maxPeakSize, peakSize);
+    stats->peakSizeHistogram[peakBucket]++;
+    stats->finalSizeHistogram[sizeBucket(finalSize)]++;
+    stats->allocationsByPeakSize[peakBucket] += allocationCount;
+}
+
+void ContainerGrowthStats::reset()
+{
+    std::lock_guard<StaticLock> lock(callSiteTableLock);
+    memset(callSiteTable, 0, sizeof(callSiteTable));
+    numberOfCallSites = 0;
+    numberOfDroppedRecords = 0;
+}
+
+static void dumpCallSite(const void* callSite)
+{
+#if USE(DLADDR)
+    Dl_info info;
+    if (dladdr(callSite, &info) && info.dli_sname) {
+        char* demangled = abi::__cxa_demangle(info.dli_sname, 0, 0, 0);
+        dataLogF("%p %s+%#lx", callSite, demangled ? demangled : info.dli_sname, static_cast<unsigned long>(static_cast<const char*>(callSite) - static_cast<const char*>(info.dli_saddr)));
+        free(demangled);
+        return;
+    }
+#endif
+    dataLogF("%p", callSite);
+}
+
+static void dumpHistogram(const char* label, const unsigned* histogram)
+{
+    dataLogF("      %s:", label);
+    for (unsigned bucket = 0; bucket < numberOfSizeBuckets; ++bucket) {
+        if (histogram[bucket])
+            dataLogF(" <=%u:%u", sizeBucketUpperBound(bucket), histogram[bucket]);
+    }
+    dataLogF("\n");
+}
+
+// Suggests the smallest power of two capacity that covers the peak size of most instances, along
+// with the number of allocations that capacity would have removed.
+static void dumpAdvice(const CallSiteStats& stats)
+{
+    static const unsigned coveragePercent = 90;
+    static const unsigned maxInlineCapacityInBytes = 1024;
+
+    uint64_t coveredInstances = 0;
+    uint64_t avoidedAllocations = 0;
+    unsigned bucket = 0;
+    for (; bucket < numberOfSizeBuckets - 1; ++bucket) {
+        coveredInstances += stats.peakSizeHistogram[bucket];
+        avoidedAllocations += stats.allocationsByPeakSize[bucket];
+        if (coveredInstances * 100 >= stats.instances * coveragePercent)
+            break;
+    }
+    unsigned capacity = std::max(sizeBucketUpperBound(bucket), 1u);
+
+    if (stats.type == ContainerGrowthStats::ContainerType::Vector) {
+        if (capacity > stats.inlineCapacity && capacity * stats.elementSize <= maxInlineCapacityInBytes) {
+            dataLogF("      advice: inline capacity %u avoids %llu of %llu allocations\n", capacity,
+                static_cast<unsigned long long>(avoidedAllocations), static_cast<unsigned long long>(stats.allocations));
+            return;
+        }
+        if (stats.allocations > stats.instances) {
+            dataLogF("      advice: reserveInitialCapacity() avoids up to %llu reallocations\n",
+                static_cast<unsigned long long>(stats.allocations - stats.instances));
+        }
+        return;
+    }
+
+    if (stats.allocations > stats.instances) {
+        dataLogF("      advice: a minimum table size for %u keys avoids up to %llu rehashes\n", capacity,
+            static_cast<unsigned long long>(stats.allocations - stats.instances));
+    }
+}
+
+void ContainerGrowthStats::dumpStats()
+{
+    static const unsigned maxCallSitesToDump = 100;
+
+    // Copy the table out first: the Vector below reports to the table when it is destroyed.
+    Vector<CallSiteStats> callSites;
+    uint64_t droppedRecords;
+    {
+        std::lock_guard<StaticLock> lock(callSiteTableLock);
+        callSites.reserveInitialCapacity(numberOfCallSites);
+        for (auto& entry : callSiteTable) {
+            if (entry.instances)
+                callSites.uncheckedAppend(entry);
+        }
+        droppedRecords = numberOfDroppedRecords;
+    }
+
+    std::sort(callSites.begin(), callSites.end(), [] (const CallSiteStats& a, const CallSiteStats& b) {
+        return a.allocations > b.allocations;
+    });
+
+    uint64_t totalAllocations = 0;
+    for (auto& stats : callSites)
+        totalAllocations += stats.allocations;
+
+    dataLogF("\nWTF container growth statistics\n\n");
+    dataLogF("%u call sites, %llu allocations, %llu records dropped\n\n", static_cast<unsigned>(callSites.size()),
+        static_cast<unsigned long long>(totalAllocations), static_cast<unsigned long long>(droppedRecords));
+
+    for (unsigned i = 0; i < std::min(callSites.size(), static_cast<size_t>(maxCallSitesToDump)); ++i) {
+        const CallSiteStats& stats = callSites[i];
+        dataLogF("%3u. %s<%u bytes, inline %u> ", i + 1, stats.type == ContainerType::Vector ? "Vector" : "HashTable", stats.elementSize, stats.inlineCapacity);
+        dumpCallSite(stats.callSite);
+        dataLogF("\n      %llu allocations by %llu instances, %.2f per instance, largest size %u\n",
+            static_cast<unsigned long long>(stats.allocations), static_cast<unsigned long long>(stats.instances),
+            static_cast<double>(stats.allocations) / stats.instances, stats.maxPeakSize);
+        dumpHistogram("peak size", stats.peakSizeHistogram);
+        dumpHistogram("final size", stats.finalSizeHistogram);
+        dumpAdvice(stats);
+    }
+}
+
+} // namespace WTF
+
+#undef USE_DLADDR
+
+#endif // DUMP_CONTAINER_GROWTH_STATS
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ContainerGrowthStats_h
+#define ContainerGrowthStats_h
+
+// Set DUMP_CONTAINER_GROWTH_STATS to 1 to record, for every call site that makes a Vector or
+// HashTable allocate, how large those containers got and how many buffer allocations they made.
+// ContainerGrowthStats::dumpStats() then reports the sites where an inline capacity or an up-front
+// reservation would remove allocations. This makes every Vector and HashTable a few words larger.
+#ifndef DUMP_CONTAINER_GROWTH_STATS
+#define DUMP_CONTAINER_GROWTH_STATS 0
+#endif
+
+#if DUMP_CONTAINER_GROWTH_STATS
+
+#include <algorithm>
+#include <utility>
+#include <wtf/Compiler.h>
+#include <wtf/ExportMacros.h>
+
+namespace WTF {
+
+class ContainerGrowthStats {
+public:
+    enum class ContainerType : uint8_t {
+        Vector,
+        HashTable
+    };
+
+    // Embedded in each container. A container reports to its call site when it is destroyed, and
+    // only if it allocated a buffer at least once.
+    class Tracker {
+    public:
+        ALWAYS_INLINE void noteCallSite(const void* callSite)
+        {
+            if (!m_callSite)
+                m_callSite = callSite;
+        }
+
+        ALWAYS_INLINE void noteSize(size_t size)
+        {
+            m_peakSize = std::max(m_peakSize, static_cast<unsigned>(size));
+        }
+
+        ALWAYS_INLINE void didAllocate(const void* callSite)
+        {
+            noteCallSite(callSite);
+            ++m_allocationCount;
+        }
+
+        ALWAYS_INLINE void willDestroy(ContainerType type, size_t inlineCapacity, size_t elementSize, size_t finalSize)
+        {
+            noteSize(finalSize);
+            if (m_allocationCount)
+                ContainerGrowthStats::record(type, m_callSite, inlineCapacity, elementSize, finalSize, m_peakSize, m_allocationCount);
+            *this = Tracker();
+        }
+
+        void swap(Tracker& other) { std::swap(*this, other); }
+
+    private:
+        const void* m_callSite { nullptr };
+        unsigned m_peakSize { 0 };
+        unsigned m_allocationCount { 0 };
+    };
+
+    // Returns an address inside the function that called it. Containers call this from inlined code,
+    // so the address points into the function that uses the container. Growth that goes through an
+    // out-of-line container function is attributed to that function instead.
+    WTF_EXPORT_PRIVATE static NEVER_INLINE const void* callSite();
+
+    WTF_EXPORT_PRIVATE static void record(ContainerType, const void* callSite, size_t inlineCapacity, size_t elementSize, size_t finalSize, unsigned peakSize, unsigned allocationCount);
+    WTF_EXPORT_PRIVATE static void dumpStats();
+    WTF_EXPORT_PRIVATE static void reset();
+};
+
+} // namespace WTF
+
+using WTF::ContainerGrowthStats;
+
+#endif // DUMP_CONTAINER_GROWTH_STATS
+
+#endif // ContainerGrowthStats_h
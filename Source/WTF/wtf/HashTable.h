@@ -28,6 +28,7 @@
 #include <type_traits>
 #include <utility>
 #include <wtf/Assertions.h>
+#include <wtf/ContainerGrowthStats.h>
 #include <wtf/FastMalloc.h>
 #include <wtf/HashTraits.h>
 #include <wtf/Lock.h>
@@ -354,6 +355,9 @@ namespace WTF {
         ~HashTable() 
         {
             invalidateIterators(); 
+#if DUMP_CONTAINER_GROWTH_STATS
+            m_growthStats.willDestroy(ContainerGrowthStats::ContainerType::HashTable, 0, sizeof(ValueType), m_keyCount);
+#endif
             if (m_table)
                 deallocateTable(m_table, m_tableSize);
 #if CHECK_HASHTABLE_USE_AFTER_DESTRUCTION
@@ -497,6 +501,10 @@ namespace WTF {
     public:
         mutable std::unique_ptr<Stats> m_stats;
 #endif
+
+#if DUMP_CONTAINER_GROWTH_STATS
+        ContainerGrowthStats::Tracker m_growthStats;
+#endif
     };
 
     // Set all the bits to one after the most significant bit: 00110101010 -> 00111111111.
@@ -854,8 +862,13 @@ namespace WTF {
 
         invalidateIterators();
 
-        if (!m_table)
+        if (!m_table) {
+#if DUMP_CONTAINER_GROWTH_STATS
+            // add() is always inlined, so this attributes the table to the code adding to it.
+            m_growthStats.noteCallSite(ContainerGrowthStats::callSite());
+#endif
             expand(nullptr);
+        }
 
         internalCheckTableConsistency();
 
@@ -1175,6 +1188,10 @@ namespace WTF {
         m_tableSize = newTableSize;
         m_tableSizeMask = newTableSize - 1;
         m_table = allocateTable(newTableSize);
+#if DUMP_CONTAINER_GROWTH_STATS
+        m_growthStats.didAllocate(ContainerGrowthStats::callSite());
+        m_growthStats.noteSize(m_keyCount);
+#endif
 
         Value* newEntry = nullptr;
         for (unsigned i = 0; i != oldTableSize; ++i) {
@@ -1205,6 +1222,9 @@ namespace WTF {
         if (!m_table)
             return;
 
+#if DUMP_CONTAINER_GROWTH_STATS
+        m_growthStats.noteSize(m_keyCount);
+#endif
         deallocateTable(m_table, m_tableSize);
         m_table = 0;
         m_tableSize = 0;
@@ -1246,6 +1266,10 @@ namespace WTF {
         m_tableSizeMask = m_tableSize - 1;
         m_keyCount = otherKeyCount;
         m_table = allocateTable(m_tableSize);
+#if DUMP_CONTAINER_GROWTH_STATS
+        m_growthStats.didAllocate(ContainerGrowthStats::callSite());
+        m_growthStats.noteSize(m_keyCount);
+#endif
 
         for (const auto& otherValue : other)
             addUniqueForInitialization<IdentityTranslatorType>(Extractor::extract(otherValue), otherValue);
@@ -1266,6 +1290,10 @@ namespace WTF {
 #if DUMP_HASHTABLE_STATS_PER_TABLE
         m_stats.swap(other.m_stats);
 #endif
+
+#if DUMP_CONTAINER_GROWTH_STATS
+        m_growthStats.swap(other.m_growthStats);
+#endif
     }
 
     template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits>
@@ -1301,6 +1329,10 @@ namespace WTF {
         m_stats = WTF::move(other.m_stats);
         other.m_stats = nullptr;
 #endif
+
+#if DUMP_CONTAINER_GROWTH_STATS
+        m_growthStats.swap(other.m_growthStats);
+#endif
     }
 
     template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits>
@@ -26,7 +26,9 @@
 #include "config.h"
 #include "Lock.h"
 
+#include "CurrentTime.h"
 #include "DataLog.h"
+#include "LockProfiler.h"
 #include "ParkingLot.h"
 #include "StringPrintStream.h"
 #include "ThreadingPrimitives.h"
@@ -39,6 +41,7 @@ static const bool verbose = false;
 void LockBase::lockSlow()
 {
     unsigned spinCount = 0;
+    double parkStartTime = 0;
 
     // This magic number turns out to be optimal based on past JikesRVM experiments.
     const unsigned spinLimit = 40;
@@ -50,8 +53,12 @@ void LockBase::lockSlow()
 
         // We allow ourselves to barge in.
         if (!(currentByteValue & isHeldBit)
-            && m_byte.compareExchangeWeak(currentByteValue, currentByteValue | isHeldBit))
+            && m_byte.compareExchangeWeak(currentByteValue, currentByteValue | isHeldBit)) {
+            // lockSlow() is never inlined into lock(), so our return address is in the code that locked.
+            if (UNLIKELY(parkStartTime))
+                LockProfiler::didAcquireAfterParking(this, __builtin_return_address(0), monotonicallyIncreasingTime() - parkStartTime);
             return;
+        }
 
         // If there is nobody parked and we haven't spun too much, we can just try to spin around.
         if (!(currentByteValue & hasParkedBit) && spinCount < spinLimit) {
@@ -66,6 +73,9 @@ void LockBase::lockSlow()
             && !m_byte.compareExchangeWeak(currentByteValue, currentByteValue | hasParkedBit))
             continue;
 
+        if (UNLIKELY(!parkStartTime && LockProfiler::isEnabled()))
+            parkStartTime = monotonicallyIncreasingTime();
+
         // We now expect the value to be isHeld|hasParked. So long as that's the case, we can park.
         ParkingLot::compareAndPark(&m_byte, isHeldBit | hasParkedBit);
 
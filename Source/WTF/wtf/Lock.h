@@ -99,7 +99,7 @@ protected:
     static const uint8_t isHeldBit = 1;
     static const uint8_t hasParkedBit = 2;
 
-    WTF_EXPORT_PRIVATE void lockSlow();
+    WTF_EXPORT_PRIVATE NEVER_INLINE void lockSlow();
     WTF_EXPORT_PRIVATE void unlockSlow();
 
     // Method used for testing only.
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "LockProfiler.h"
+
+#include "DataLog.h"
+#include "HashMap.h"
+#include "NeverDestroyed.h"
+#include "WordLock.h"
+#include <algorithm>
+
+#if OS(DARWIN) || (OS(LINUX) && defined(__GLIBC__) && !defined(__UCLIBC__))
+#include <cxxabi.h>
+#include <dlfcn.h>
+#define USE_DLADDR 1
+#endif
+
+namespace WTF {
+
+std::atomic<bool> LockProfiler::s_isEnabled;
+
+static std::atomic<unsigned> samplingPeriod { 1 };
+static std::atomic<unsigned> numberOfContendedAcquisitions;
+
+// This uses a WordLock because a contended WTF::Lock would report back here.
+struct ProfileData {
+    WordLock lock;
+    HashMap<const void*, LockProfiler::SiteStatistics> sites;
+    uint64_t numberOfSamples { 0 };
+};
+
+static ProfileData& profileData()
+{
+    static NeverDestroyed<ProfileData> data;
+    return data;
+}
+
+void LockProfiler::setEnabled(bool enabled, unsigned period)
+{
+    samplingPeriod.store(std::max(period, 1u), std::memory_order_relaxed);
+    s_isEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void LockProfiler::didAcquireAfterParking(const void* lock, const void* callSite, double waitTime)
+{
+    if (numberOfContendedAcquisitions++ % samplingPeriod.load(std::memory_order_relaxed))
+        return;
+
+    ProfileData& data = profileData();
+    WordLockHolder locker(data.lock);
+    data.numberOfSamples++;
+
+    auto result = data.sites.add(callSite, SiteStatistics());
+    SiteStatistics& site = result.iterator->value;
+    if (result.isNewEntry) {
+        site.callSite = callSite;
+        site.numberOfLocks = 0;
+        site.contendedAcquisitions = 0;
+        site.totalWaitTime = 0;
+        site.maxWaitTime = 0;
+    }
+
+    site.contendedAcquisitions++;
+    site.totalWaitTime += waitTime;
+    site.maxWaitTime = std::max(site.maxWaitTime, waitTime);
+
+    if (site.numberOfLocks < SiteStatistics::maxTrackedLocks && std::find(site.locks, site.locks + site.numberOfLocks, lock) == site.locks + site.numberOfLocks)
+        site.locks[site.numberOfLocks++] = lock;
+}
+
+Vector<LockProfiler::SiteStatistics> LockProfiler::statistics()
+{
+    Vector<SiteStatistics> result;
+    {
+        ProfileData& data = profileData();
+        WordLockHolder locker(data.lock);
+        copyValuesToVector(data.sites, result);
+    }
+
+    std::sort(result.begin(), result.end(), [] (const SiteStatistics& a, const SiteStatistics& b) {
+        return a.totalWaitTime > b.totalWaitTime;
+    });
+    return result;
+}
+
+static void printCallSite(PrintStream& out, const void* callSite)
+{
+#if USE(DLADDR)
+    Dl_info info;
+    if (dladdr(callSite, &info) && info.dli_sname) {
+        char* demangled = abi::__cxa_demangle(info.dli_sname, 0, 0, 0);
+        out.printf("%p %s+%#lx", callSite, demangled ? demangled : info.dli_sname, static_cast<unsigned long>(static_cast<const char*>(callSite) - static_cast<const char*>(info.dli_saddr)));
+        free(demangled);
+        return;
+    }
+#endif
+    out.printf("%p", callSite);
+}
+
+void LockProfiler::dump(PrintStream& out)
+{
+    static const unsigned maxSitesToDump = 50;
+
+    Vector<SiteStatistics> sites = statistics();
+    uint64_t numberOfSamples;
+    {
+        ProfileData& data = profileData();
+        WordLockHolder locker(data.lock);
+        numberOfSamples = data.numberOfSamples;
+    }
+
+    double totalWaitTime = 0;
+    for (auto& site : sites)
+        totalWaitTime += site.totalWaitTime;
+
+    out.printf("\nWTF::Lock contention profile\n\n");
+    out.printf("%llu sampled contended acquisitions (1 in %u), %.3f ms blocked, %u call sites\n\n",
+        static_cast<unsigned long long>(numberOfSamples), samplingPeriod.load(), totalWaitTime * 1000, static_cast<unsigned>(sites.size()));
+    out.printf("%10s %8s %10s %10s  %s\n", "total ms", "count", "mean us", "max us", "call site / locks");
+
+    for (unsigned i = 0; i < std::min(sites.size(), static_cast<size_t>(maxSitesToDump)); ++i) {
+        const SiteStatistics& site = sites[i];
+        out.printf("%10.3f %8llu %10.1f %10.1f  ", site.totalWaitTime * 1000, static_cast<unsigned long long>(site.contendedAcquisitions),
+            site.totalWaitTime * 1000000 / site.contendedAcquisitions, site.maxWaitTime * 1000000);
+        printCallSite(out, site.callSite);
+        out.printf("\n%44s", "");
+        for (unsigned j = 0; j < site.numberOfLocks; ++j)
+            out.printf(" %p", site.locks[j]);
+        if (site.numberOfLocks == SiteStatistics::maxTrackedLocks)
+            out.printf(" ...");
+        out.printf("\n");
+    }
+}
+
+void LockProfiler::dump()
+{
+    dump(WTF::dataFile());
+}
+
+void LockProfiler::reset()
+{
+    ProfileData& data = profileData();
+    WordLockHolder locker(data.lock);
+    data.sites.clear();
+    data.numberOfSamples = 0;
+}
+
+} // namespace WTF
+
+#undef USE_DLADDR
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LockProfiler_h
+#define LockProfiler_h
+
+#include <atomic>
+#include <wtf/Vector.h>
+
+namespace WTF {
+
+class PrintStream;
+
+// Records where threads block on a WTF::Lock. When enabled, every Nth acquisition that had to park
+// reports the lock, the code that called lock() and how long the thread was blocked. Reports are
+// aggregated per call site. Acquisitions that succeed without parking cost nothing extra, and the
+// parking path only pays for a relaxed load while the profiler is disabled.
+class LockProfiler {
+public:
+    struct SiteStatistics {
+        const void* callSite;
+        // The first few distinct locks acquired at this site.
+        static const unsigned maxTrackedLocks = 4;
+        const void* locks[maxTrackedLocks];
+        unsigned numberOfLocks;
+        uint64_t contendedAcquisitions;
+        double totalWaitTime;
+        double maxWaitTime;
+    };
+
+    static bool isEnabled() { return s_isEnabled.load(std::memory_order_relaxed); }
+
+    // A sampling period of N records one in N contended acquisitions.
+    WTF_EXPORT_PRIVATE static void setEnabled(bool, unsigned samplingPeriod = 1);
+
+    WTF_EXPORT_PRIVATE static void didAcquireAfterParking(const void* lock, const void* callSite, double waitTime);
+
+    // Sorted by total wait time, longest first.
+    WTF_EXPORT_PRIVATE static Vector<SiteStatistics> statistics();
+    WTF_EXPORT_PRIVATE static void dump(PrintStream&);
+    WTF_EXPORT_PRIVATE static void dump();
+    WTF_EXPORT_PRIVATE static void reset();
+
+private:
+    WTF_EXPORT_PRIVATE static std::atomic<bool> s_isEnabled;
+};
+
+} // namespace WTF
+
+using WTF::LockProfiler;
+
+#endif // LockProfiler_h
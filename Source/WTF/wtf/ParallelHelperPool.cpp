@@ -28,6 +28,7 @@
 
 #include "DataLog.h"
 #include "StringPrintStream.h"
+#include "TaskScheduler.h"
 
 namespace WTF {
 
@@ -35,7 +36,6 @@ ParallelHelperClient::ParallelHelperClient(RefPtr<ParallelHelperPool> pool)
     : m_pool(pool)
 {
     LockHolder locker(m_pool->m_lock);
-    RELEASE_ASSERT(!m_pool->m_isDying);
     m_pool->m_clients.append(this);
 }
 
@@ -128,16 +128,9 @@ ParallelHelperPool::ParallelHelperPool()
 
 ParallelHelperPool::~ParallelHelperPool()
 {
+    // Helper tasks keep the pool alive until they return.
     RELEASE_ASSERT(m_clients.isEmpty());
-    
-    {
-        LockHolder locker(m_lock);
-        m_isDying = true;
-        m_workAvailableCondition.notifyAll();
-    }
-
-    for (ThreadIdentifier threadIdentifier : m_threads)
-        waitForThreadCompletion(threadIdentifier);
+    RELEASE_ASSERT(!m_numHelpers);
 }
 
 void ParallelHelperPool::ensureThreads(unsigned numThreads)
@@ -167,18 +160,19 @@ void ParallelHelperPool::doSomeHelping()
 
 void ParallelHelperPool::didMakeWorkAvailable(const LockHolder&)
 {
-    while (m_numThreads > m_threads.size()) {
-        ThreadIdentifier threadIdentifier = createThread(
-            "WTF Parallel Helper Thread",
-            [this] () {
-                helperThreadBody();
-            });
-        m_threads.append(threadIdentifier);
+    // Helpers that are still around will pick up the new work. Only top up to m_numThreads; if the
+    // scheduler is busy the helpers just start later, and clients never wait for helpers that have
+    // not claimed their task yet.
+    while (m_numHelpers < m_numThreads) {
+        m_numHelpers++;
+        RefPtr<ParallelHelperPool> protectedThis(this);
+        TaskScheduler::singleton().dispatch([protectedThis] {
+            protectedThis->helperTaskBody();
+        });
     }
-    m_workAvailableCondition.notifyAll();
 }
 
-void ParallelHelperPool::helperThreadBody()
+void ParallelHelperPool::helperTaskBody()
 {
     for (;;) {
         ParallelHelperClient* client;
@@ -186,9 +180,10 @@ void ParallelHelperPool::helperThreadBody()
 
         {
             LockHolder locker(m_lock);
-            client = waitForClientWithTask(locker);
+            client = getClientWithTask(locker);
             if (!client) {
-                RELEASE_ASSERT(m_isDying);
+                // Return the worker to the scheduler. The next setTask() dispatches a new helper.
+                m_numHelpers--;
                 return;
             }
 
@@ -222,20 +217,5 @@ ParallelHelperClient* ParallelHelperPool::getClientWithTask(const LockHolder&)
     return nullptr;
 }
 
-ParallelHelperClient* ParallelHelperPool::waitForClientWithTask(const LockHolder& locker)
-{
-    for (;;) {
-        // It might be quittin' time.
-        if (m_isDying)
-            return nullptr;
-
-        if (ParallelHelperClient* result = getClientWithTask(locker))
-            return result;
-
-        // Wait until work becomes available.
-        m_workAvailableCondition.wait(m_lock);
-    }
-}
-
 } // namespace WTF
 
@@ -31,14 +31,14 @@
 #include <wtf/RefPtr.h>
 #include <wtf/SharedTask.h>
 #include <wtf/ThreadSafeRefCounted.h>
-#include <wtf/Threading.h>
 #include <wtf/Vector.h>
 #include <wtf/WeakRandom.h>
 
 namespace WTF {
 
-// A ParallelHelperPool is a shared pool of threads that can be asked to help with some finite-time
-// parallel activity. It's designed to work well when there are multiple concurrent tasks that may
+// A ParallelHelperPool is a shared pool of helpers that can be asked to help with some finite-time
+// parallel activity. Helpers run as tasks on the process-wide TaskScheduler, so the pool does not
+// own any threads of its own. It's designed to work well when there are multiple concurrent tasks that may
 // all want parallel help. In that case, we don't want each task to start its own thread pool. It's
 // also designed to work well for tasks that do their own load balancing and do not wish to
 // participate in microtask-style load balancing.
@@ -188,22 +188,19 @@ private:
     friend class ParallelHelperClient;
 
     void didMakeWorkAvailable(const LockHolder&);
-    void helperThreadBody();
+    void helperTaskBody();
 
     bool hasClientWithTask(const LockHolder&);
     ParallelHelperClient* getClientWithTask(const LockHolder&);
-    ParallelHelperClient* waitForClientWithTask(const LockHolder&);
     
     Lock m_lock;
-    Condition m_workAvailableCondition;
     Condition m_workCompleteCondition;
 
     WeakRandom m_random;
     
     Vector<ParallelHelperClient*> m_clients;
-    Vector<ThreadIdentifier> m_threads;
-    unsigned m_numThreads { 0 }; // This can be larger than m_threads.size() because we start threads only once there is work.
-    bool m_isDying { false };
+    unsigned m_numThreads { 0 };
+    unsigned m_numHelpers { 0 }; // Helper tasks dispatched to the TaskScheduler that have not returned yet.
 };
 
 } // namespace WTF
@@ -4,9 +4,18 @@ list(APPEND WTF_SOURCES
     glib/GLibUtilities.cpp
     glib/MainThreadGLib.cpp
     glib/RunLoopGLib.cpp
-    glib/WorkQueueGLib.cpp
 )
 
+if (USE_EPOLL_WORK_QUEUE)
+    list(APPEND WTF_SOURCES
+        linux/WorkQueueLinux.cpp
+    )
+else ()
+    list(APPEND WTF_SOURCES
+        glib/WorkQueueGLib.cpp
+    )
+endif ()
+
 list(APPEND WTF_LIBRARIES
     ${GLIB_GIO_LIBRARIES}
     ${GLIB_GOBJECT_LIBRARIES}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "TaskScheduler.h"
+
+#include <wtf/NeverDestroyed.h>
+#include <wtf/NumberOfCores.h>
+
+namespace WTF {
+
+TaskScheduler& TaskScheduler::singleton()
+{
+    static NeverDestroyed<TaskScheduler> scheduler;
+    return scheduler;
+}
+
+TaskScheduler::TaskScheduler()
+{
+    // The thread waiting on a TaskGroup helps running tasks, so one worker less than the number of
+    // cores keeps every core busy without oversubscribing them.
+    unsigned numberOfWorkers = std::max(1, numberOfProcessorCores() - 1);
+    for (unsigned i = 0; i < numberOfWorkers; ++i)
+        m_workers.append(std::make_unique<Worker>());
+
+    for (unsigned i = 0; i < numberOfWorkers; ++i) {
+        // Hold the worker lock so that currentWorkerIndex() cannot race with the thread identifier being set.
+        LockHolder locker(m_workers[i]->lock);
+        m_workers[i]->thread = createThread("WTF Task Scheduler Worker", [this, i] {
+            workerThreadBody(i);
+        });
+        detachThread(m_workers[i]->thread);
+    }
+}
+
+void TaskScheduler::dispatch(std::function<void ()> function, Priority priority)
+{
+    enqueue({ WTF::move(function), nullptr }, priority);
+}
+
+void TaskScheduler::enqueue(Task&& task, Priority priority)
+{
+    // Tasks spawned from a worker go to its own deque so they stay hot in its cache; the others are
+    // spread round-robin and balanced by stealing.
+    int workerIndex = currentWorkerIndex();
+    if (workerIndex < 0)
+        workerIndex = m_nextWorker++ % m_workers.size();
+
+    Worker& worker = *m_workers[workerIndex];
+    {
+        LockHolder locker(worker.lock);
+        worker.queues[static_cast<unsigned>(priority)].append(WTF::move(task));
+        m_numberOfQueuedTasks++;
+    }
+
+    if (m_numberOfIdleWorkers.load()) {
+        LockHolder locker(m_idleLock);
+        m_workAvailableCondition.notifyOne();
+    }
+}
+
+int TaskScheduler::currentWorkerIndex() const
+{
+    ThreadIdentifier thread = currentThread();
+    for (unsigned i = 0; i < m_workers.size(); ++i) {
+        if (m_workers[i]->thread == thread)
+            return i;
+    }
+    return -1;
+}
+
+bool TaskScheduler::popTask(Worker& worker, unsigned priority, Task& task)
+{
+    LockHolder locker(worker.lock);
+    Deque<Task>& queue = worker.queues[priority];
+    if (queue.isEmpty())
+        return false;
+    task = queue.takeLast();
+    m_numberOfQueuedTasks--;
+    return true;
+}
+
+bool TaskScheduler::stealTask(Worker& worker, unsigned priority, Task& task)
+{
+    LockHolder locker(worker.lock);
+    Deque<Task>& queue = worker.queues[priority];
+    if (queue.isEmpty())
+        return false;
+    task = queue.takeFirst();
+    m_numberOfQueuedTasks--;
+    return true;
+}
+
+bool TaskScheduler::takeTask(Task& task)
+{
+    if (!m_numberOfQueuedTasks.load())
+        return false;
+
+    int workerIndex = currentWorkerIndex();
+    unsigned startIndex = workerIndex < 0 ? m_nextWorker.load() : workerIndex + 1;
+    for (unsigned priority = numberOfPriorities; priority--;) {
+        if (workerIndex >= 0 && popTask(*m_workers[workerIndex], priority, task))
+            return true;
+
+        for (unsigned i = 0; i < m_workers.size(); ++i) {
+            unsigned victimIndex = (startIndex + i) % m_workers.size();
+            if (static_cast<int>(victimIndex) == workerIndex)
+                continue;
+            if (stealTask(*m_workers[victimIndex], priority, task))
+                return true;
+        }
+    }
+    return false;
+}
+
+bool TaskScheduler::takeTaskForGroup(TaskGroup& group, Task& task)
+{
+    if (!m_numberOfQueuedTasks.load())
+        return false;
+
+    // A group only ever enqueues at its own priority. Tasks are taken from the front, like when
+    // stealing, so that the workers keep the most recently spawned ones.
+    unsigned priority = static_cast<unsigned>(group.m_priority);
+    for (auto& worker : m_workers) {
+        LockHolder locker(worker->lock);
+        Deque<Task>& queue = worker->queues[priority];
+        auto it = queue.findIf([&group] (const Task& queuedTask) {
+            return queuedTask.group == &group;
+        });
+        if (it == queue.end())
+            continue;
+        task = WTF::move(*it);
+        queue.remove(it);
+        m_numberOfQueuedTasks--;
+        return true;
+    }
+    return false;
+}
+
+void TaskScheduler::runTask(Task& task)
+{
+    task.function();
+    if (task.group)
+        task.group->didFinishTask();
+}
+
+bool TaskScheduler::runPendingTask()
+{
+    Task task;
+    if (!takeTask(task))
+        return false;
+    runTask(task);
+    return true;
+}
+
+void TaskScheduler::workerThreadBody(unsigned index)
+{
+    {
+        // Wait for the constructor to publish our thread identifier.
+        LockHolder locker(m_workers[index]->lock);
+    }
+
+    for (;;) {
+        if (runPendingTask())
+            continue;
+
+        LockHolder locker(m_idleLock);
+        m_numberOfIdleWorkers++;
+        while (!m_numberOfQueuedTasks.load())
+            m_workAvailableCondition.wait(m_idleLock);
+        m_numberOfIdleWorkers--;
+    }
+}
+
+void TaskGroup::dispatch(std::function<void ()> function)
+{
+    m_numberOfPendingTasks++;
+    m_scheduler.enqueue({ WTF::move(function), this }, m_priority);
+}
+
+void TaskGroup::didFinishTask()
+{
+    // The count is decremented under the lock so that wait() cannot return, and the group cannot be
+    // destroyed, while this thread is still about to touch it.
+    LockHolder locker(m_lock);
+    if (!--m_numberOfPendingTasks)
+        m_completionCondition.notifyAll();
+}
+
+void TaskGroup::wait()
+{
+    while (m_numberOfPendingTasks.load()) {
+        TaskScheduler::Task task;
+        if (m_scheduler.takeTaskForGroup(*this, task)) {
+            m_scheduler.runTask(task);
+            continue;
+        }
+
+        // Everything left is running on other threads, so it is fine to just block until the last
+        // one finishes.
+        LockHolder locker(m_lock);
+        while (m_numberOfPendingTasks.load())
+            m_completionCondition.wait(m_lock);
+    }
+
+    // The last didFinishTask() may still hold the lock; wait for it to be done with this group.
+    LockHolder locker(m_lock);
+}
+
+} // namespace WTF
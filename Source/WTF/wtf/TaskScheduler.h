@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TaskScheduler_h
+#define TaskScheduler_h
+
+#include <atomic>
+#include <functional>
+#include <wtf/Condition.h>
+#include <wtf/Deque.h>
+#include <wtf/FastMalloc.h>
+#include <wtf/Forward.h>
+#include <wtf/Lock.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+// A process-wide pool of worker threads, one per core (minus the thread that dispatches the work,
+// which is expected to help while it waits). Each worker owns a deque per priority: it runs its own
+// tasks newest-first and, when it runs out, steals the oldest tasks of other workers. Subsystems that
+// want parallelism (ParallelJobs, ParallelHelperPool, ...) share these threads instead of spinning up
+// their own.
+//
+// Usage:
+//
+//     TaskGroup group;
+//     group.dispatch([&] { ... });
+//     group.dispatch([&] { ... });
+//     group.wait(); // Runs the group's pending tasks on this thread until the group is done.
+//
+//     parallelFor(0, rows, [&] (size_t row) { ... });
+
+namespace WTF {
+
+class TaskGroup;
+
+class TaskScheduler {
+    WTF_MAKE_NONCOPYABLE(TaskScheduler);
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    enum class Priority {
+        Low,
+        Normal,
+        High
+    };
+    static const unsigned numberOfPriorities = 3;
+
+    WTF_EXPORT_PRIVATE static TaskScheduler& singleton();
+
+    unsigned numberOfWorkers() const { return m_workers.size(); }
+
+    // Fire-and-forget variant. Use a TaskGroup to wait for completion.
+    WTF_EXPORT_PRIVATE void dispatch(std::function<void ()>, Priority = Priority::Normal);
+
+    // Runs at most one pending task on the calling thread. Returns false if there was nothing to run.
+    WTF_EXPORT_PRIVATE bool runPendingTask();
+
+private:
+    friend class TaskGroup;
+    friend class NeverDestroyed<TaskScheduler>;
+
+    struct Task {
+        std::function<void ()> function;
+        TaskGroup* group;
+    };
+
+    struct Worker {
+        WTF_MAKE_FAST_ALLOCATED;
+    public:
+        Lock lock;
+        Deque<Task> queues[numberOfPriorities];
+        ThreadIdentifier thread { 0 };
+    };
+
+    TaskScheduler();
+
+    void enqueue(Task&&, Priority);
+    bool takeTask(Task&);
+    bool popTask(Worker&, unsigned priority, Task&);
+    bool stealTask(Worker&, unsigned priority, Task&);
+    bool takeTaskForGroup(TaskGroup&, Task&);
+    void runTask(Task&);
+    int currentWorkerIndex() const;
+    void workerThreadBody(unsigned index);
+
+    Vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<unsigned> m_nextWorker { 0 };
+    std::atomic<unsigned> m_numberOfQueuedTasks { 0 };
+
+    Lock m_idleLock;
+    Condition m_workAvailableCondition;
+    std::atomic<unsigned> m_numberOfIdleWorkers { 0 };
+};
+
+class TaskGroup {
+    WTF_MAKE_NONCOPYABLE(TaskGroup);
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    explicit TaskGroup(TaskScheduler::Priority priority = TaskScheduler::Priority::Normal)
+        : m_scheduler(TaskScheduler::singleton())
+        , m_priority(priority)
+    {
+    }
+
+    ~TaskGroup()
+    {
+        wait();
+    }
+
+    WTF_EXPORT_PRIVATE void dispatch(std::function<void ()>);
+
+    // Blocks until every task dispatched to this group has finished, running the group's pending tasks
+    // in the meantime. Tasks of other groups are left to the workers, so that a short wait on the main
+    // thread does not end up running a long, unrelated task. May be called from within a task.
+    WTF_EXPORT_PRIVATE void wait();
+
+private:
+    friend class TaskScheduler;
+
+    void didFinishTask();
+
+    TaskScheduler& m_scheduler;
+    TaskScheduler::Priority m_priority;
+    std::atomic<unsigned> m_numberOfPendingTasks { 0 };
+    Lock m_lock;
+    Condition m_completionCondition;
+};
+
+// Calls functor(index) for every index in [begin, end), split into chunks of at least grainSize
+// indices that are distributed among the scheduler's workers and the calling thread.
+template<typename Functor>
+void parallelFor(size_t begin, size_t end, const Functor& functor, size_t grainSize = 1, TaskScheduler::Priority priority = TaskScheduler::Priority::Normal)
+{
+    if (begin >= end)
+        return;
+
+    size_t count = end - begin;
+    // A few chunks per thread leave room for stealing when the cost per index is uneven.
+    size_t maxNumberOfChunks = (TaskScheduler::singleton().numberOfWorkers() + 1) * 4;
+    size_t numberOfChunks = std::max<size_t>(1, std::min(maxNumberOfChunks, count / std::max<size_t>(grainSize, 1)));
+    if (numberOfChunks == 1) {
+        for (size_t index = begin; index < end; ++index)
+            functor(index);
+        return;
+    }
+
+    TaskGroup group(priority);
+    size_t chunkSize = count / numberOfChunks;
+    size_t remainder = count % numberOfChunks;
+    size_t chunkBegin = begin;
+    for (size_t chunk = 0; chunk < numberOfChunks; ++chunk) {
+        size_t chunkEnd = chunkBegin + chunkSize + (chunk < remainder ? 1 : 0);
+        group.dispatch([&functor, chunkBegin, chunkEnd] {
+            for (size_t index = chunkBegin; index < chunkEnd; ++index)
+                functor(index);
+        });
+        chunkBegin = chunkEnd;
+    }
+    group.wait();
+}
+
+} // namespace WTF
+
+using WTF::TaskGroup;
+using WTF::TaskScheduler;
+using WTF::parallelFor;
+
+#endif // TaskScheduler_h
@@ -27,6 +27,7 @@
 #include <type_traits>
 #include <utility>
 #include <wtf/CheckedArithmetic.h>
+#include <wtf/ContainerGrowthStats.h>
 #include <wtf/FastMalloc.h>
 #include <wtf/MallocPtr.h>
 #include <wtf/Noncopyable.h>
@@ -604,6 +605,9 @@ public:
     explicit Vector(size_t size)
         : Base(size, size)
     {
+#if DUMP_CONTAINER_GROWTH_STATS
+        didAllocateBuffer(capacity());
+#endif
         asanSetInitialBufferSizeTo(size);
 
         if (begin())
@@ -613,6 +617,9 @@ public:
     Vector(size_t size, const T& val)
         : Base(size, size)
     {
+#if DUMP_CONTAINER_GROWTH_STATS
+        didAllocateBuffer(capacity());
+#endif
         asanSetInitialBufferSizeTo(size);
 
         if (begin())
@@ -631,6 +638,9 @@ public:
 
     ~Vector()
     {
+#if DUMP_CONTAINER_GROWTH_STATS
+        m_growthStats.willDestroy(ContainerGrowthStats::ContainerType::Vector, inlineCapacity, sizeof(T), m_size);
+#endif
         if (m_size)
             shrink(0);
 
@@ -771,6 +781,9 @@ public:
 
         Base::swap(other, m_size, other.m_size);
         std::swap(m_size, other.m_size);
+#if DUMP_CONTAINER_GROWTH_STATS
+        m_growthStats.swap(other.m_growthStats);
+#endif
 
         asanSetInitialBufferSizeTo(m_size);
         other.asanSetInitialBufferSizeTo(other.m_size);
@@ -806,12 +819,25 @@ private:
 #if ASAN_ENABLED
     using Base::endOfBuffer;
 #endif
+
+#if DUMP_CONTAINER_GROWTH_STATS
+    ALWAYS_INLINE void didAllocateBuffer(size_t newCapacity)
+    {
+        if (newCapacity > inlineCapacity)
+            m_growthStats.didAllocate(ContainerGrowthStats::callSite());
+    }
+
+    ContainerGrowthStats::Tracker m_growthStats;
+#endif
 };
 
 template<typename T, size_t inlineCapacity, typename OverflowHandler, size_t minCapacity>
 Vector<T, inlineCapacity, OverflowHandler, minCapacity>::Vector(const Vector& other)
     : Base(other.capacity(), other.size())
 {
+#if DUMP_CONTAINER_GROWTH_STATS
+    didAllocateBuffer(capacity());
+#endif
     asanSetInitialBufferSizeTo(other.size());
 
     if (begin())
@@ -823,6 +849,9 @@ template<size_t otherCapacity, typename otherOverflowBehaviour, size_t otherMini
 Vector<T, inlineCapacity, OverflowHandler, minCapacity>::Vector(const Vector<T, otherCapacity, otherOverflowBehaviour, otherMinimumCapacity>& other)
     : Base(other.capacity(), other.size())
 {
+#if DUMP_CONTAINER_GROWTH_STATS
+    didAllocateBuffer(capacity());
+#endif
     asanSetInitialBufferSizeTo(other.size());
 
     if (begin())
@@ -952,6 +981,9 @@ void Vector<T, inlineCapacity, OverflowHandler, minCapacity>::appendRange(Iterat
 template<typename T, size_t inlineCapacity, typename OverflowHandler, size_t minCapacity>
 void Vector<T, inlineCapacity, OverflowHandler, minCapacity>::expandCapacity(size_t newMinCapacity)
 {
+#if DUMP_CONTAINER_GROWTH_STATS
+    m_growthStats.noteSize(newMinCapacity);
+#endif
     reserveCapacity(std::max(newMinCapacity, std::max(static_cast<size_t>(minCapacity), capacity() + capacity() / 4 + 1)));
 }
 
@@ -970,6 +1002,9 @@ T* Vector<T, inlineCapacity, OverflowHandler, minCapacity>::expandCapacity(size_
 template<typename T, size_t inlineCapacity, typename OverflowHandler, size_t minCapacity>
 bool Vector<T, inlineCapacity, OverflowHandler, minCapacity>::tryExpandCapacity(size_t newMinCapacity)
 {
+#if DUMP_CONTAINER_GROWTH_STATS
+    m_growthStats.noteSize(newMinCapacity);
+#endif
     return tryReserveCapacity(std::max(newMinCapacity, std::max(static_cast<size_t>(minCapacity), capacity() + capacity() / 4 + 1)));
 }
 
@@ -1022,6 +1057,9 @@ template<typename T, size_t inlineCapacity, typename OverflowHandler, size_t min
 void Vector<T, inlineCapacity, OverflowHandler, minCapacity>::shrink(size_t size)
 {
     ASSERT(size <= m_size);
+#if DUMP_CONTAINER_GROWTH_STATS
+    m_growthStats.noteSize(m_size);
+#endif
     TypeOperations::destruct(begin() + size, end());
     asanBufferSizeWillChangeTo(size);
     m_size = size;
@@ -1093,6 +1131,9 @@ void Vector<T, inlineCapacity, OverflowHandler, minCapacity>::reserveCapacity(si
 
     Base::allocateBuffer(newCapacity);
     ASSERT(begin());
+#if DUMP_CONTAINER_GROWTH_STATS
+    didAllocateBuffer(newCapacity);
+#endif
 
     asanSetInitialBufferSizeTo(size());
 
@@ -1115,6 +1156,9 @@ bool Vector<T, inlineCapacity, OverflowHandler, minCapacity>::tryReserveCapacity
         return false;
     }
     ASSERT(begin());
+#if DUMP_CONTAINER_GROWTH_STATS
+    didAllocateBuffer(newCapacity);
+#endif
 
     asanSetInitialBufferSizeTo(size());
 
@@ -1128,13 +1172,20 @@ inline void Vector<T, inlineCapacity, OverflowHandler, minCapacity>::reserveInit
 {
     ASSERT(!m_size);
     ASSERT(capacity() == inlineCapacity);
-    if (initialCapacity > inlineCapacity)
+    if (initialCapacity > inlineCapacity) {
         Base::allocateBuffer(initialCapacity);
+#if DUMP_CONTAINER_GROWTH_STATS
+        didAllocateBuffer(initialCapacity);
+#endif
+    }
 }
 
 template<typename T, size_t inlineCapacity, typename OverflowHandler, size_t minCapacity>
 void Vector<T, inlineCapacity, OverflowHandler, minCapacity>::shrinkCapacity(size_t newCapacity)
 {
+#if DUMP_CONTAINER_GROWTH_STATS
+    m_growthStats.noteSize(size());
+#endif
     if (newCapacity >= capacity())
         return;
 
@@ -1147,12 +1198,18 @@ void Vector<T, inlineCapacity, OverflowHandler, minCapacity>::shrinkCapacity(siz
     if (newCapacity > 0) {
         if (Base::shouldReallocateBuffer(newCapacity)) {
             Base::reallocateBuffer(newCapacity);
+#if DUMP_CONTAINER_GROWTH_STATS
+            didAllocateBuffer(newCapacity);
+#endif
             asanSetInitialBufferSizeTo(size());
             return;
         }
 
         T* oldEnd = end();
         Base::allocateBuffer(newCapacity);
+#if DUMP_CONTAINER_GROWTH_STATS
+        didAllocateBuffer(newCapacity);
+#endif
         if (begin() != oldBuffer)
             TypeOperations::move(oldBuffer, oldEnd, begin());
     }
@@ -1211,6 +1268,10 @@ ALWAYS_INLINE void Vector<T, inlineCapacity, OverflowHandler, minCapacity>::appe
         return;
     }
 
+#if DUMP_CONTAINER_GROWTH_STATS
+    // append() is always inlined, so this attributes the growth to the code doing the append.
+    m_growthStats.noteCallSite(ContainerGrowthStats::callSite());
+#endif
     appendSlowCase(std::forward<U>(value));
 }
 
@@ -26,14 +26,8 @@
 #include "config.h"
 #include "WorkQueue.h"
 
-#include <mutex>
-#include <wtf/MessageQueue.h>
-#include <wtf/NeverDestroyed.h>
-#include <wtf/NumberOfCores.h>
 #include <wtf/Ref.h>
-#include <wtf/Threading.h>
-#include <wtf/text/WTFString.h>
-#include <wtf/threads/BinarySemaphore.h>
+#include <wtf/TaskScheduler.h>
 
 namespace WTF {
 
@@ -63,93 +57,10 @@ void WorkQueue::concurrentApply(size_t iterations, const std::function<void (siz
         return;
     }
 
-    class ThreadPool {
-    public:
-        ThreadPool()
-        {
-            // We don't need a thread for the current core.
-            unsigned threadCount = numberOfProcessorCores() - 1;
-
-            m_workers.reserveInitialCapacity(threadCount);
-            for (unsigned i = 0; i < threadCount; ++i) {
-                m_workers.append(createThread(String::format("ThreadPool Worker %u", i).utf8().data(), [this] {
-                    threadBody();
-                }));
-            }
-        }
-
-        size_t workerCount() const { return m_workers.size(); }
-
-        void dispatch(const std::function<void ()>* function)
-        {
-            LockHolder holder(m_lock);
-
-            m_queue.append(function);
-            m_condition.notifyOne();
-        }
-
-    private:
-        NO_RETURN void threadBody()
-        {
-            while (true) {
-                const std::function<void ()>* function;
-
-                {
-                    LockHolder holder(m_lock);
-
-                    m_condition.wait(m_lock, [this] {
-                        return !m_queue.isEmpty();
-                    });
-
-                    function = m_queue.takeFirst();
-                }
-
-                (*function)();
-            }
-        }
-
-        Lock m_lock;
-        Condition m_condition;
-        Deque<const std::function<void ()>*> m_queue;
-
-        Vector<ThreadIdentifier> m_workers;
-    };
-
-    static LazyNeverDestroyed<ThreadPool> threadPool;
-    static std::once_flag onceFlag;
-    std::call_once(onceFlag, [] {
-        threadPool.construct();
+    // The shared TaskScheduler balances the iterations across its workers and this thread.
+    parallelFor(0, iterations, [&function](size_t index) {
+        function(index);
     });
-
-    // Cap the worker count to the number of iterations (excluding this thread)
-    const size_t workerCount = std::min(iterations - 1, threadPool->workerCount());
-
-    std::atomic<size_t> currentIndex(0);
-    std::atomic<size_t> activeThreads(workerCount + 1);
-
-    Condition condition;
-    Lock lock;
-
-    std::function<void ()> applier = [&] {
-        size_t index;
-
-        // Call the function for as long as there are iterations left.
-        while ((index = currentIndex++) < iterations)
-            function(index);
-
-        // If there are no active threads left, signal the caller.
-        if (!--activeThreads) {
-            LockHolder holder(lock);
-            condition.notifyOne();
-        }
-    };
-
-    for (size_t i = 0; i < workerCount; ++i)
-        threadPool->dispatch(&applier);
-    applier();
-
-    LockHolder holder(lock);
-    condition.wait(lock, [&] { return !activeThreads; });
 }
 #endif
 
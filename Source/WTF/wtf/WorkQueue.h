@@ -38,7 +38,10 @@
 #include <dispatch/dispatch.h>
 #endif
 
-#if PLATFORM(GTK) || PLATFORM(WPE)
+#if USE(EPOLL_WORK_QUEUE)
+#include <wtf/Deque.h>
+#include <wtf/Lock.h>
+#elif PLATFORM(GTK) || PLATFORM(WPE)
 #include <glib.h>
 #include <wtf/glib/GRefPtr.h>
 #include <wtf/glib/GSourceWrap.h>
@@ -52,6 +55,10 @@
 
 namespace WTF {
 
+#if USE(EPOLL_WORK_QUEUE)
+class WorkQueuePool;
+#endif
+
 class WorkQueue final : public FunctionDispatcher {
 public:
     enum class Type {
@@ -76,7 +83,7 @@ public:
 
 #if OS(DARWIN)
     dispatch_queue_t dispatchQueue() const { return m_dispatchQueue; }
-#elif PLATFORM(GTK) || PLATFORM(WPE)
+#elif PLATFORM(GTK) || PLATFORM(WPE) || USE(EPOLL_WORK_QUEUE)
     void registerSocketEventHandler(int, std::function<void ()>, std::function<void ()>);
     void unregisterSocketEventHandler(int);
 #elif PLATFORM(EFL)
@@ -103,9 +110,19 @@ private:
     static DWORD WINAPI unregisterWaitAndDestroyItemCallback(void* context);
 #endif
 
+#if USE(EPOLL_WORK_QUEUE)
+    friend class WorkQueuePool;
+    void performWork();
+#endif
+
 #if OS(DARWIN)
     static void executeFunction(void*);
     dispatch_queue_t m_dispatchQueue;
+#elif USE(EPOLL_WORK_QUEUE)
+    Type m_type;
+    Lock m_functionsLock;
+    Deque<std::function<void ()>> m_functions;
+    bool m_isScheduled { false };
 #elif PLATFORM(GTK) || PLATFORM(WPE)
     GMutex m_threadMutex;
     GMutex m_threadInitializationMutex;
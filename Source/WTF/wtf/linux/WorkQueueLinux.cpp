@@ -0,0 +1,456 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "WorkQueue.h"
+
+#if USE(EPOLL_WORK_QUEUE)
+
+#include <atomic>
+#include <errno.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <wtf/Condition.h>
+#include <wtf/HashMap.h>
+#include <wtf/NeverDestroyed.h>
+#include <wtf/NumberOfCores.h>
+#include <wtf/ThreadSafeRefCounted.h>
+
+namespace WTF {
+
+// All WorkQueues in the process share a pool of threads. A serial queue is scheduled on the pool as
+// a single job that drains its functions in order, so at most one pool thread works on it at any
+// time; functions of concurrent queues are scheduled as individual jobs. Timers and socket handlers
+// are file descriptors watched by a single epoll thread, which turns readiness into functions
+// dispatched to the owning queue.
+//
+// The pool normally keeps at most max(4, 2 * cores) threads. A function may block until a function
+// on another queue has run, though, and with a hard limit enough of those would leave no thread for
+// the function they wait for. So when jobs are queued, no thread is idle and no job has started or
+// finished for a starvation interval, the poll thread adds one more worker. Workers above the
+// normal limit exit as soon as they find the job list empty.
+class WorkQueuePool {
+    WTF_MAKE_NONCOPYABLE(WorkQueuePool);
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    class EventSource : public ThreadSafeRefCounted<EventSource> {
+    public:
+        virtual ~EventSource() { }
+        virtual void dispatchEvent(uint32_t events) = 0;
+    };
+
+    static WorkQueuePool& singleton();
+
+    void schedule(Ref<WorkQueue>&&, std::function<void ()>&&);
+
+    bool addEventSource(int fileDescriptor, uint32_t events, Ref<EventSource>&&);
+    void rearmEventSource(int fileDescriptor, uint32_t events);
+    void removeEventSource(int fileDescriptor);
+
+private:
+    friend class NeverDestroyed<WorkQueuePool>;
+
+    struct Job {
+        RefPtr<WorkQueue> queue;
+        std::function<void ()> function;
+    };
+
+    WorkQueuePool();
+
+    void createWorkerThread();
+    void workerThreadBody();
+    NO_RETURN void pollThreadBody();
+
+    void armStarvationTimer();
+    void checkForStarvation();
+
+    Lock m_lock;
+    Condition m_jobAvailableCondition;
+    Deque<Job> m_jobs;
+    unsigned m_maxNumberOfThreads;
+    unsigned m_numberOfThreads { 0 };
+    unsigned m_numberOfIdleThreads { 0 };
+
+    // Incremented whenever a job starts or finishes.
+    std::atomic<uint64_t> m_progress { 0 };
+    uint64_t m_progressWhenStarvationTimerArmed { 0 };
+    bool m_starvationTimerIsArmed { false };
+
+    int m_epollDescriptor;
+    int m_starvationTimerDescriptor;
+    Lock m_eventSourcesLock;
+    HashMap<int, RefPtr<EventSource>> m_eventSources;
+};
+
+WorkQueuePool& WorkQueuePool::singleton()
+{
+    static NeverDestroyed<WorkQueuePool> pool;
+    return pool;
+}
+
+WorkQueuePool::WorkQueuePool()
+    // Functions dispatched to work queues may block on I/O, so allow more threads than cores.
+    : m_maxNumberOfThreads(std::max(4, 2 * numberOfProcessorCores()))
+    , m_epollDescriptor(epoll_create1(EPOLL_CLOEXEC))
+    , m_starvationTimerDescriptor(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC))
+{
+    RELEASE_ASSERT(m_epollDescriptor != -1);
+    RELEASE_ASSERT(m_starvationTimerDescriptor != -1);
+
+    // Not an EventSource: this descriptor is handled by the poll thread itself and never disarmed.
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = m_starvationTimerDescriptor;
+    RELEASE_ASSERT(!epoll_ctl(m_epollDescriptor, EPOLL_CTL_ADD, m_starvationTimerDescriptor, &event));
+
+    detachThread(createThread("WorkQueue Poller", [this] {
+        pollThreadBody();
+    }));
+}
+
+void WorkQueuePool::schedule(Ref<WorkQueue>&& queue, std::function<void ()>&& function)
+{
+    LockHolder locker(m_lock);
+    m_jobs.append({ WTF::move(queue), WTF::move(function) });
+
+    // Idle threads only stop counting as idle once they woke up, so compare against all queued jobs.
+    if (m_numberOfIdleThreads) {
+        m_jobAvailableCondition.notifyOne();
+        if (m_numberOfIdleThreads >= m_jobs.size())
+            return;
+    }
+
+    // Threads are created lazily, so a process with a few mostly idle queues only pays for a few threads.
+    if (m_numberOfThreads < m_maxNumberOfThreads) {
+        createWorkerThread();
+        return;
+    }
+
+    armStarvationTimer();
+}
+
+void WorkQueuePool::createWorkerThread()
+{
+    ASSERT(m_lock.isLocked());
+    m_numberOfThreads++;
+    detachThread(createThread("WorkQueue Worker", [this] {
+        workerThreadBody();
+    }));
+}
+
+void WorkQueuePool::workerThreadBody()
+{
+    for (;;) {
+        Job job;
+        {
+            LockHolder locker(m_lock);
+            while (m_jobs.isEmpty()) {
+                if (m_numberOfThreads > m_maxNumberOfThreads) {
+                    m_numberOfThreads--;
+                    return;
+                }
+                m_numberOfIdleThreads++;
+                m_jobAvailableCondition.wait(m_lock);
+                m_numberOfIdleThreads--;
+            }
+            job = m_jobs.takeFirst();
+        }
+
+        m_progress++;
+        if (job.function)
+            job.function();
+        else
+            job.queue->performWork();
+        m_progress++;
+    }
+}
+
+void WorkQueuePool::armStarvationTimer()
+{
+    ASSERT(m_lock.isLocked());
+    if (m_starvationTimerIsArmed)
+        return;
+
+    static const long starvationIntervalInNanoseconds = 50 * 1000 * 1000;
+    struct itimerspec time;
+    memset(&time, 0, sizeof(time));
+    time.it_value.tv_nsec = starvationIntervalInNanoseconds;
+    timerfd_settime(m_starvationTimerDescriptor, 0, &time, nullptr);
+
+    m_starvationTimerIsArmed = true;
+    m_progressWhenStarvationTimerArmed = m_progress.load();
+}
+
+void WorkQueuePool::checkForStarvation()
+{
+    uint64_t expirations;
+    if (read(m_starvationTimerDescriptor, &expirations, sizeof(expirations)) != sizeof(expirations))
+        return;
+
+    LockHolder locker(m_lock);
+    m_starvationTimerIsArmed = false;
+    if (m_jobs.size() <= m_numberOfIdleThreads)
+        return;
+
+    if (m_progress.load() == m_progressWhenStarvationTimerArmed)
+        createWorkerThread();
+    armStarvationTimer();
+}
+
+bool WorkQueuePool::addEventSource(int fileDescriptor, uint32_t events, Ref<EventSource>&& source)
+{
+    LockHolder locker(m_eventSourcesLock);
+    m_eventSources.set(fileDescriptor, WTF::move(source));
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events | EPOLLONESHOT;
+    event.data.fd = fileDescriptor;
+    if (epoll_ctl(m_epollDescriptor, EPOLL_CTL_ADD, fileDescriptor, &event) == -1) {
+        LOG_ERROR("Failed to watch file descriptor %d: %s", fileDescriptor, strerror(errno));
+        m_eventSources.remove(fileDescriptor);
+        return false;
+    }
+    return true;
+}
+
+void WorkQueuePool::rearmEventSource(int fileDescriptor, uint32_t events)
+{
+    LockHolder locker(m_eventSourcesLock);
+    if (!m_eventSources.contains(fileDescriptor))
+        return;
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events | EPOLLONESHOT;
+    event.data.fd = fileDescriptor;
+    epoll_ctl(m_epollDescriptor, EPOLL_CTL_MOD, fileDescriptor, &event);
+}
+
+void WorkQueuePool::removeEventSource(int fileDescriptor)
+{
+    RefPtr<EventSource> source;
+    {
+        LockHolder locker(m_eventSourcesLock);
+        source = m_eventSources.take(fileDescriptor);
+        // The descriptor may have been closed already, which removes it from the epoll set.
+        epoll_ctl(m_epollDescriptor, EPOLL_CTL_DEL, fileDescriptor, nullptr);
+    }
+}
+
+void WorkQueuePool::pollThreadBody()
+{
+    static const int maxEvents = 32;
+    struct epoll_event events[maxEvents];
+
+    for (;;) {
+        int numberOfEvents = epoll_wait(m_epollDescriptor, events, maxEvents, -1);
+        if (numberOfEvents == -1) {
+            RELEASE_ASSERT(errno == EINTR);
+            continue;
+        }
+
+        for (int i = 0; i < numberOfEvents; ++i) {
+            if (events[i].data.fd == m_starvationTimerDescriptor) {
+                checkForStarvation();
+                continue;
+            }
+
+            RefPtr<EventSource> source;
+            {
+                LockHolder locker(m_eventSourcesLock);
+                source = m_eventSources.get(events[i].data.fd);
+            }
+            if (source)
+                source->dispatchEvent(events[i].events);
+        }
+    }
+}
+
+class TimerEventSource final : public WorkQueuePool::EventSource {
+public:
+    static Ref<TimerEventSource> create(int fileDescriptor, Ref<WorkQueue>&& queue, std::function<void ()>&& function)
+    {
+        return adoptRef(*new TimerEventSource(fileDescriptor, WTF::move(queue), WTF::move(function)));
+    }
+
+    ~TimerEventSource()
+    {
+        close(m_fileDescriptor);
+    }
+
+    void dispatchEvent(uint32_t) override
+    {
+        // Timers fire once. Removing the source drops the pool's reference, so keep ourselves alive.
+        Ref<TimerEventSource> protectedThis(*this);
+        WorkQueuePool::singleton().removeEventSource(m_fileDescriptor);
+        m_queue->dispatch(WTF::move(m_function));
+    }
+
+private:
+    TimerEventSource(int fileDescriptor, Ref<WorkQueue>&& queue, std::function<void ()>&& function)
+        : m_fileDescriptor(fileDescriptor)
+        , m_queue(WTF::move(queue))
+        , m_function(WTF::move(function))
+    {
+    }
+
+    int m_fileDescriptor;
+    Ref<WorkQueue> m_queue;
+    std::function<void ()> m_function;
+};
+
+class SocketEventSource final : public WorkQueuePool::EventSource {
+public:
+    static Ref<SocketEventSource> create(int fileDescriptor, Ref<WorkQueue>&& queue, std::function<void ()>&& function, std::function<void ()>&& closeFunction)
+    {
+        return adoptRef(*new SocketEventSource(fileDescriptor, WTF::move(queue), WTF::move(function), WTF::move(closeFunction)));
+    }
+
+    void dispatchEvent(uint32_t events) override
+    {
+        // The descriptor stays disarmed until the handler has run on the queue, which keeps the
+        // handler serialized with everything else dispatched to it.
+        RefPtr<SocketEventSource> protectedThis(this);
+        m_queue->dispatch([protectedThis, events] {
+            protectedThis->handleEvent(events);
+        });
+    }
+
+private:
+    SocketEventSource(int fileDescriptor, Ref<WorkQueue>&& queue, std::function<void ()>&& function, std::function<void ()>&& closeFunction)
+        : m_fileDescriptor(fileDescriptor)
+        , m_queue(WTF::move(queue))
+        , m_function(WTF::move(function))
+        , m_closeFunction(WTF::move(closeFunction))
+    {
+    }
+
+    void handleEvent(uint32_t events)
+    {
+        if (events & (EPOLLHUP | EPOLLERR)) {
+            WorkQueuePool::singleton().removeEventSource(m_fileDescriptor);
+            m_closeFunction();
+            return;
+        }
+
+        if (events & EPOLLIN)
+            m_function();
+
+        // This is a no-op if the handler was unregistered meanwhile.
+        WorkQueuePool::singleton().rearmEventSource(m_fileDescriptor, EPOLLIN);
+    }
+
+    int m_fileDescriptor;
+    Ref<WorkQueue> m_queue;
+    std::function<void ()> m_function;
+    std::function<void ()> m_closeFunction;
+};
+
+void WorkQueue::platformInitialize(const char*, Type type, QOS)
+{
+    m_type = type;
+}
+
+void WorkQueue::platformInvalidate()
+{
+    ASSERT(m_functions.isEmpty());
+    ASSERT(!m_isScheduled);
+}
+
+void WorkQueue::registerSocketEventHandler(int fileDescriptor, std::function<void ()> function, std::function<void ()> closeFunction)
+{
+    auto source = SocketEventSource::create(fileDescriptor, *this, WTF::move(function), WTF::move(closeFunction));
+    WorkQueuePool::singleton().addEventSource(fileDescriptor, EPOLLIN, WTF::move(source));
+}
+
+void WorkQueue::unregisterSocketEventHandler(int fileDescriptor)
+{
+    WorkQueuePool::singleton().removeEventSource(fileDescriptor);
+}
+
+void WorkQueue::dispatch(std::function<void ()> function)
+{
+    if (m_type == Type::Concurrent) {
+        WorkQueuePool::singleton().schedule(*this, WTF::move(function));
+        return;
+    }
+
+    {
+        LockHolder locker(m_functionsLock);
+        m_functions.append(WTF::move(function));
+        if (m_isScheduled)
+            return;
+        m_isScheduled = true;
+    }
+
+    WorkQueuePool::singleton().schedule(*this, nullptr);
+}
+
+void WorkQueue::performWork()
+{
+    ASSERT(m_type == Type::Serial);
+
+    // Run a bounded batch before yielding the thread, so a busy queue cannot starve the others.
+    static const unsigned maxFunctionsPerBatch = 64;
+    for (unsigned i = 0; i < maxFunctionsPerBatch; ++i) {
+        std::function<void ()> function;
+        {
+            LockHolder locker(m_functionsLock);
+            if (m_functions.isEmpty()) {
+                m_isScheduled = false;
+                return;
+            }
+            function = m_functions.takeFirst();
+        }
+        function();
+    }
+
+    WorkQueuePool::singleton().schedule(*this, nullptr);
+}
+
+void WorkQueue::dispatchAfter(std::chrono::nanoseconds duration, std::function<void ()> function)
+{
+    int fileDescriptor = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    RELEASE_ASSERT(fileDescriptor != -1);
+
+    // A zero it_value would disarm the timer instead of firing it right away.
+    auto nanoseconds = std::max<std::chrono::nanoseconds::rep>(duration.count(), 1);
+    struct itimerspec timerSpec;
+    memset(&timerSpec, 0, sizeof(timerSpec));
+    timerSpec.it_value.tv_sec = nanoseconds / 1000000000;
+    timerSpec.it_value.tv_nsec = nanoseconds % 1000000000;
+    timerfd_settime(fileDescriptor, 0, &timerSpec, nullptr);
+
+    WorkQueuePool::singleton().addEventSource(fileDescriptor, EPOLLIN, TimerEventSource::create(fileDescriptor, *this, WTF::move(function)));
+}
+
+} // namespace WTF
+
+#endif // USE(EPOLL_WORK_QUEUE)
@@ -32,7 +32,7 @@
 #include "WTFThreadData.h"
 #include <wtf/unicode/UTF8.h>
 
-#if USE(WEB_THREAD)
+#if USE(WEB_THREAD) || USE(SHARED_ATOMIC_STRING_TABLE)
 #include "Lock.h"
 #endif
 
@@ -40,6 +40,39 @@ namespace WTF {
 
 using namespace Unicode;
 
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+
+// Every operation locks only the stripe that the string's hash maps to. The lock is held while a
+// reference to a found entry is taken, which is what lets StringImpl::deref() resolve a race between
+// dropping the last reference and a concurrent lookup resurrecting the string.
+class AtomicStringTableLocker : public LockHolder {
+    WTF_MAKE_NONCOPYABLE(AtomicStringTableLocker);
+public:
+    AtomicStringTableLocker(AtomicStringTable::Stripe& stripe)
+        : LockHolder(stripe.lock)
+        , m_table(stripe.table)
+    {
+    }
+
+    HashSet<StringImpl*>& table() { return m_table; }
+
+private:
+    HashSet<StringImpl*>& m_table;
+};
+
+template<typename HashTranslator, typename T>
+static ALWAYS_INLINE AtomicStringTable::Stripe& stringTableFor(AtomicStringTable& table, const T& value)
+{
+    return table.stripeForHash(HashTranslator::hash(value));
+}
+
+static ALWAYS_INLINE AtomicStringTable::Stripe& stringTableFor(AtomicStringTable& table, StringImpl& string)
+{
+    return table.stripeForHash(string.hash());
+}
+
+#else
+
 #if USE(WEB_THREAD)
 
 class AtomicStringTableLocker : public LockHolder {
@@ -47,10 +80,16 @@ class AtomicStringTableLocker : public LockHolder {
 
     static StaticLock s_stringTableLock;
 public:
-    AtomicStringTableLocker()
+    AtomicStringTableLocker(HashSet<StringImpl*>& table)
         : LockHolder(&s_stringTableLock)
+        , m_table(table)
     {
     }
+
+    HashSet<StringImpl*>& table() { return m_table; }
+
+private:
+    HashSet<StringImpl*>& m_table;
 };
 
 StaticLock AtomicStringTableLocker::s_stringTableLock;
@@ -60,22 +99,43 @@ StaticLock AtomicStringTableLocker::s_stringTableLock;
 class AtomicStringTableLocker {
     WTF_MAKE_NONCOPYABLE(AtomicStringTableLocker);
 public:
-    AtomicStringTableLocker() { }
+    AtomicStringTableLocker(HashSet<StringImpl*>& table)
+        : m_table(table)
+    {
+    }
+
+    HashSet<StringImpl*>& table() { return m_table; }
+
+private:
+    HashSet<StringImpl*>& m_table;
 };
 
 #endif // USE(WEB_THREAD)
 
-static ALWAYS_INLINE HashSet<StringImpl*>& stringTable()
+template<typename HashTranslator, typename T>
+static ALWAYS_INLINE HashSet<StringImpl*>& stringTableFor(AtomicStringTable& table, const T&)
+{
+    return table.table();
+}
+
+static ALWAYS_INLINE HashSet<StringImpl*>& stringTableFor(AtomicStringTable& table, StringImpl&)
+{
+    return table.table();
+}
+
+#endif // USE(SHARED_ATOMIC_STRING_TABLE)
+
+static ALWAYS_INLINE AtomicStringTable& stringTable()
 {
-    return wtfThreadData().atomicStringTable()->table();
+    return *wtfThreadData().atomicStringTable();
 }
 
 template<typename T, typename HashTranslator>
 static inline Ref<AtomicStringImpl> addToStringTable(const T& value)
 {
-    AtomicStringTableLocker locker;
+    AtomicStringTableLocker locker(stringTableFor<HashTranslator>(stringTable(), value));
 
-    HashSet<StringImpl*>::AddResult addResult = stringTable().add<HashTranslator>(value);
+    HashSet<StringImpl*>::AddResult addResult = locker.table().add<HashTranslator>(value);
 
     // If the string is newly-translated, then we need to adopt it.
     // The boolean in the pair tells us if that is so.
@@ -284,7 +344,15 @@ struct SubstringLocation {
 struct SubstringTranslator {
     static void translate(StringImpl*& location, const SubstringLocation& buffer, unsigned hash)
     {
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+        // The base string is not thread-safe to reference from the shared table, so copy the characters.
+        if (buffer.baseString->is8Bit())
+            location = &StringImpl::create(buffer.baseString->characters8() + buffer.start, buffer.length).leakRef();
+        else
+            location = &StringImpl::create(buffer.baseString->characters16() + buffer.start, buffer.length).leakRef();
+#else
         location = &StringImpl::createSubstringSharingImpl(buffer.baseString, buffer.start, buffer.length).leakRef();
+#endif
         location->setHash(hash);
         location->setIsAtomic(true);
     }
@@ -409,8 +477,17 @@ Ref<AtomicStringImpl> AtomicStringImpl::addSlowCase(StringImpl& string)
 
     ASSERT_WITH_MESSAGE(!string.isAtomic(), "AtomicStringImpl should not hit the slow case if the string is already atomic.");
 
-    AtomicStringTableLocker locker;
-    auto addResult = stringTable().add(&string);
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+    // A substring keeps its base string alive with a non-atomic reference, so it cannot be shared.
+    if (string.bufferOwnership() == StringImpl::BufferSubstring) {
+        if (string.is8Bit())
+            return *add(string.characters8(), string.length());
+        return *add(string.characters16(), string.length());
+    }
+#endif
+
+    AtomicStringTableLocker locker(stringTableFor(stringTable(), string));
+    auto addResult = locker.table().add(&string);
 
     if (addResult.isNewEntry) {
         ASSERT(*addResult.iterator == &string);
@@ -433,8 +510,16 @@ Ref<AtomicStringImpl> AtomicStringImpl::addSlowCase(AtomicStringTable& stringTab
 
     ASSERT_WITH_MESSAGE(!string.isAtomic(), "AtomicStringImpl should not hit the slow case if the string is already atomic.");
 
-    AtomicStringTableLocker locker;
-    auto addResult = stringTable.table().add(&string);
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+    if (string.bufferOwnership() == StringImpl::BufferSubstring) {
+        if (string.is8Bit())
+            return *add(string.characters8(), string.length());
+        return *add(string.characters16(), string.length());
+    }
+#endif
+
+    AtomicStringTableLocker locker(stringTableFor(stringTable, string));
+    auto addResult = locker.table().add(&string);
 
     if (addResult.isNewEntry) {
         ASSERT(*addResult.iterator == &string);
@@ -447,13 +532,35 @@ Ref<AtomicStringImpl> AtomicStringImpl::addSlowCase(AtomicStringTable& stringTab
 void AtomicStringImpl::remove(AtomicStringImpl* string)
 {
     ASSERT(string->isAtomic());
-    AtomicStringTableLocker locker;
-    HashSet<StringImpl*>& atomicStringTable = stringTable();
+    AtomicStringTableLocker locker(stringTableFor(stringTable(), *string));
+    HashSet<StringImpl*>& atomicStringTable = locker.table();
     HashSet<StringImpl*>::iterator iterator = atomicStringTable.find(string);
     ASSERT_WITH_MESSAGE(iterator != atomicStringTable.end(), "The string being removed is atomic in the string table of an other thread!");
     atomicStringTable.remove(iterator);
 }
 
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+bool AtomicStringImpl::removeIfLastReference(AtomicStringImpl& string)
+{
+    ASSERT(string.isAtomic());
+    ASSERT(string.length());
+
+    AtomicStringTableLocker locker(stringTableFor(stringTable(), string));
+
+    // Lookups take their reference while holding this lock, so once the count drops to zero
+    // under it, no other thread can find the string anymore.
+    if (!string.derefAtomicRefCount())
+        return false;
+
+    HashSet<StringImpl*>& atomicStringTable = locker.table();
+    HashSet<StringImpl*>::iterator iterator = atomicStringTable.find(&string);
+    ASSERT_WITH_MESSAGE(iterator != atomicStringTable.end(), "The string being removed is not in the shared string table!");
+    atomicStringTable.remove(iterator);
+    string.setIsAtomic(false);
+    return true;
+}
+#endif
+
 RefPtr<AtomicStringImpl> AtomicStringImpl::lookUpSlowCase(StringImpl& string)
 {
     ASSERT_WITH_MESSAGE(!string.isAtomic(), "AtomicStringImpls should return from the fast case.");
@@ -467,8 +574,8 @@ RefPtr<AtomicStringImpl> AtomicStringImpl::lookUpSlowCase(StringImpl& string)
         return lookUpInternal(string.characters16(), string.length());
     }
 
-    AtomicStringTableLocker locker;
-    HashSet<StringImpl*>& atomicStringTable = stringTable();
+    AtomicStringTableLocker locker(stringTableFor(stringTable(), string));
+    HashSet<StringImpl*>& atomicStringTable = locker.table();
     auto iterator = atomicStringTable.find(&string);
     if (iterator != atomicStringTable.end())
         return static_cast<AtomicStringImpl*>(*iterator);
@@ -489,10 +596,10 @@ RefPtr<AtomicStringImpl> AtomicStringImpl::addUTF8(const char* charactersStart,
 
 RefPtr<AtomicStringImpl> AtomicStringImpl::lookUpInternal(const LChar* characters, unsigned length)
 {
-    AtomicStringTableLocker locker;
-    auto& table = stringTable();
-
     LCharBuffer buffer = { characters, length };
+    AtomicStringTableLocker locker(stringTableFor<LCharBufferTranslator>(stringTable(), buffer));
+    auto& table = locker.table();
+
     auto iterator = table.find<LCharBufferTranslator>(buffer);
     if (iterator != table.end())
         return static_cast<AtomicStringImpl*>(*iterator);
@@ -501,10 +608,10 @@ RefPtr<AtomicStringImpl> AtomicStringImpl::lookUpInternal(const LChar* character
 
 RefPtr<AtomicStringImpl> AtomicStringImpl::lookUpInternal(const UChar* characters, unsigned length)
 {
-    AtomicStringTableLocker locker;
-    auto& table = stringTable();
-
     UCharBuffer buffer = { characters, length };
+    AtomicStringTableLocker locker(stringTableFor<UCharBufferTranslator>(stringTable(), buffer));
+    auto& table = locker.table();
+
     auto iterator = table.find<UCharBufferTranslator>(buffer);
     if (iterator != table.end())
         return static_cast<AtomicStringImpl*>(*iterator);
@@ -514,8 +621,8 @@ RefPtr<AtomicStringImpl> AtomicStringImpl::lookUpInternal(const UChar* character
 #if !ASSERT_DISABLED
 bool AtomicStringImpl::isInAtomicStringTable(StringImpl* string)
 {
-    AtomicStringTableLocker locker;
-    return stringTable().contains(string);
+    AtomicStringTableLocker locker(stringTableFor(stringTable(), *string));
+    return locker.table().contains(string);
 }
 #endif
 
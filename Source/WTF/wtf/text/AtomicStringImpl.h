@@ -45,6 +45,9 @@ public:
     }
 
     static void remove(AtomicStringImpl*);
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+    static bool removeIfLastReference(AtomicStringImpl&);
+#endif
 
     WTF_EXPORT_STRING_API static RefPtr<AtomicStringImpl> add(const LChar*);
     ALWAYS_INLINE static RefPtr<AtomicStringImpl> add(const char* s) { return add(reinterpret_cast<const LChar*>(s)); };
@@ -25,13 +25,17 @@
 
 #include <wtf/HashSet.h>
 #include <wtf/MainThread.h>
+#include <wtf/NeverDestroyed.h>
 #include <wtf/WTFThreadData.h>
 
 namespace WTF {
 
 void AtomicStringTable::create(WTFThreadData& data)
 {
-#if USE(WEB_THREAD)
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+    // The shared table outlives every thread, so no destructor is registered.
+    data.m_defaultAtomicStringTable = &shared();
+#elif USE(WEB_THREAD)
     // On iOS, one AtomicStringTable is shared between the main UI thread and the WebThread.
     static AtomicStringTable* sharedStringTable = new AtomicStringTable;
 
@@ -51,10 +55,35 @@ void AtomicStringTable::create(WTFThreadData& data)
 #endif // USE(WEB_THREAD)
 }
 
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+AtomicStringTable& AtomicStringTable::shared()
+{
+    static NeverDestroyed<AtomicStringTable> sharedTable;
+    return sharedTable;
+}
+
+size_t AtomicStringTable::size()
+{
+    size_t size = 0;
+    for (auto& stripe : m_stripes) {
+        LockHolder locker(stripe.lock);
+        size += stripe.table.size();
+    }
+    return size;
+}
+#endif
+
 AtomicStringTable::~AtomicStringTable()
 {
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+    for (auto& stripe : m_stripes) {
+        for (auto* string : stripe.table)
+            string->setIsAtomic(false);
+    }
+#else
     for (auto* string : m_table)
         string->setIsAtomic(false);
+#endif
 }
 
 void AtomicStringTable::destroy(AtomicStringTable* table)
@@ -26,6 +26,11 @@
 #include <wtf/HashSet.h>
 #include <wtf/WTFThreadData.h>
 
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+#include <wtf/Hasher.h>
+#include <wtf/Lock.h>
+#endif
+
 namespace WTF {
 
 class StringImpl;
@@ -36,12 +41,40 @@ public:
     WTF_EXPORT_PRIVATE ~AtomicStringTable();
 
     static void create(WTFThreadData&);
+
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+    // A single table is shared by every thread in the process. It is split into independently
+    // locked stripes so that threads interning unrelated strings rarely contend. The stripe is
+    // picked from the high bits of the 24-bit string hash, leaving the low bits that index the
+    // buckets of each stripe's HashSet well distributed.
+    static const unsigned stripeCountLog2 = 5;
+    static const unsigned stripeCount = 1 << stripeCountLog2;
+
+    struct Stripe {
+        Lock lock;
+        HashSet<StringImpl*> table;
+    };
+
+    Stripe& stripeForHash(unsigned hash)
+    {
+        static const unsigned shift = 8 * sizeof(unsigned) - StringHasher::flagCount - stripeCountLog2;
+        return m_stripes[(hash >> shift) & (stripeCount - 1)];
+    }
+
+    WTF_EXPORT_PRIVATE static AtomicStringTable& shared();
+    WTF_EXPORT_PRIVATE size_t size();
+#else
     HashSet<StringImpl*>& table() { return m_table; }
+#endif
 
 private:
     static void destroy(AtomicStringTable*);
 
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+    Stripe m_stripes[stripeCount];
+#else
     HashSet<StringImpl*> m_table;
+#endif
 };
 
 }
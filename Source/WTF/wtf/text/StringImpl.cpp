@@ -139,6 +139,14 @@ void StringImpl::destroy(StringImpl* stringImpl)
     fastFree(stringImpl);
 }
 
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+void StringImpl::derefAtomicSlowCase()
+{
+    if (AtomicStringImpl::removeIfLastReference(static_cast<AtomicStringImpl&>(*this)))
+        StringImpl::destroy(this);
+}
+#endif
+
 Ref<StringImpl> StringImpl::createFromLiteral(const char* characters, unsigned length)
 {
     ASSERT_WITH_MESSAGE(length, "Use StringImpl::empty() to create an empty string");
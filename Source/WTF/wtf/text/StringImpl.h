@@ -27,6 +27,7 @@
 #include <unicode/uchar.h>
 #include <unicode/ustring.h>
 #include <wtf/ASCIICType.h>
+#include <wtf/Atomics.h>
 #include <wtf/Forward.h>
 #include <wtf/Hasher.h>
 #include <wtf/MathExtras.h>
@@ -133,6 +134,7 @@ class StringImpl {
     friend struct WTF::LCharBufferTranslator;
     friend struct WTF::SubstringTranslator;
     friend struct WTF::UCharBufferTranslator;
+    friend class AtomicStringImpl;
     friend class JSC::LLInt::Data;
     friend class JSC::LLIntOffsetsExtractor;
     
@@ -601,6 +603,13 @@ public:
 
         STRING_STATS_REF_STRING(*this);
 
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+        if (isAtomic()) {
+            atomicRefCount().fetch_add(s_refCountIncrement, std::memory_order_relaxed);
+            return;
+        }
+#endif
+
         m_refCount += s_refCountIncrement;
     }
 
@@ -610,6 +619,13 @@ public:
 
         STRING_STATS_DEREF_STRING(*this);
 
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+        if (isAtomic()) {
+            derefAtomic();
+            return;
+        }
+#endif
+
         unsigned tempRefCount = m_refCount - s_refCountIncrement;
         if (!tempRefCount) {
             StringImpl::destroy(this);
@@ -868,6 +884,32 @@ private:
     static const unsigned s_copyCharsInlineCutOff = 20;
 
     BufferOwnership bufferOwnership() const { return static_cast<BufferOwnership>(m_hashAndFlags & s_hashMaskBufferOwnership); }
+
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+    // Atomic strings live in the process-wide AtomicStringTable and may be referenced from any
+    // thread, so their reference count is only ever updated atomically.
+    std::atomic<unsigned>& atomicRefCount() { return *reinterpret_cast<std::atomic<unsigned>*>(&m_refCount); }
+
+    ALWAYS_INLINE void derefAtomic()
+    {
+        unsigned refCount = atomicRefCount().load(std::memory_order_relaxed);
+        while (refCount != s_refCountIncrement) {
+            if (atomicRefCount().compare_exchange_weak(refCount, refCount - s_refCountIncrement, std::memory_order_release, std::memory_order_relaxed))
+                return;
+        }
+        // This looks like the last reference, but a lookup on another thread may still resurrect the
+        // string. The final decrement happens under the string table lock to settle that race.
+        derefAtomicSlowCase();
+    }
+
+    // Returns true if the reference count dropped to zero.
+    bool derefAtomicRefCount()
+    {
+        return atomicRefCount().fetch_sub(s_refCountIncrement, std::memory_order_acq_rel) == s_refCountIncrement;
+    }
+
+    WTF_EXPORT_STRING_API void derefAtomicSlowCase();
+#endif
     template <class UCharPredicate> Ref<StringImpl> stripMatchedCharacters(UCharPredicate);
     template <typename CharType, class UCharPredicate> Ref<StringImpl> simplifyMatchedCharactersToSpace(UCharPredicate);
     template <typename CharType> static Ref<StringImpl> constructInternal(StringImpl*, unsigned);
@@ -1177,6 +1219,12 @@ inline unsigned lengthOfNullTerminatedString(const CharacterType* string)
 
 inline Ref<StringImpl> StringImpl::isolatedCopy() const
 {
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+    // Atomic strings are owned by the process-wide table and can be used from any thread as is.
+    if (isAtomic())
+        return const_cast<StringImpl&>(*this);
+#endif
+
     if (!requiresCopy()) {
         if (is8Bit())
             return StringImpl::createWithoutCopying(m_data8, m_length);
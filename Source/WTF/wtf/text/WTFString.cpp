@@ -686,10 +686,16 @@ bool String::isSafeToSendToAnotherThread() const
         return true;
     if (isEmpty())
         return true;
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+    // AtomicStrings live in the process-wide AtomicStringTable and are reference counted atomically.
+    if (impl()->isAtomic())
+        return true;
+#else
     // AtomicStrings are not safe to send between threads as ~StringImpl()
     // will try to remove them from the wrong AtomicStringTable.
     if (impl()->isAtomic())
         return false;
+#endif
     if (impl()->hasOneRef())
         return true;
     return false;
@@ -144,6 +144,7 @@ list(APPEND WebCore_SOURCES
 
     platform/graphics/harfbuzz/HarfBuzzFace.cpp
     platform/graphics/harfbuzz/HarfBuzzFaceCairo.cpp
+    platform/graphics/harfbuzz/HarfBuzzShapeCache.cpp
     platform/graphics/harfbuzz/HarfBuzzShaper.cpp
 
     platform/graphics/opengl/Extensions3DOpenGLCommon.cpp
@@ -421,6 +422,7 @@ if (USE_TEXTURE_MAPPER)
     if (USE_TEXTURE_MAPPER_GL)
         list(APPEND WebCore_SOURCES
             platform/graphics/texmap/BitmapTextureGL.cpp
+            platform/graphics/texmap/BitmapTextureUploadStream.cpp
             platform/graphics/texmap/TextureMapperGL.cpp
             platform/graphics/texmap/TextureMapperShaderProgram.cpp
         )
@@ -127,6 +127,7 @@ list(APPEND WebCore_SOURCES
 
     platform/graphics/harfbuzz/HarfBuzzFace.cpp
     platform/graphics/harfbuzz/HarfBuzzFaceCairo.cpp
+    platform/graphics/harfbuzz/HarfBuzzShapeCache.cpp
     platform/graphics/harfbuzz/HarfBuzzShaper.cpp
 
     platform/graphics/opengl/Extensions3DOpenGLCommon.cpp
@@ -140,6 +141,7 @@ list(APPEND WebCore_SOURCES
     platform/graphics/texmap/BitmapTexture.cpp
     platform/graphics/texmap/BitmapTextureGL.cpp
     platform/graphics/texmap/BitmapTexturePool.cpp
+    platform/graphics/texmap/BitmapTextureUploadStream.cpp
     platform/graphics/texmap/TextureMapperGL.cpp
     platform/graphics/texmap/TextureMapperPlatformLayerBuffer.cpp
     platform/graphics/texmap/TextureMapperPlatformLayerProxy.cpp
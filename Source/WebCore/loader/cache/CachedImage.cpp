@@ -497,6 +497,30 @@ void CachedImage::changedInRect(const Image* image, const IntRect& rect)
     notifyObservers(&rect);
 }
 
+bool CachedImage::shouldStartAsyncDecoding(const Image* image)
+{
+    if (!image || image != m_image)
+        return false;
+    CachedResourceClientWalker<CachedImageClient> clientWalker(m_clients);
+    while (CachedImageClient* client = clientWalker.next()) {
+        if (client->shouldStartAsyncImageDecoding(*this))
+            return true;
+    }
+    return false;
+}
+
+bool CachedImage::isVisibleInViewport(const Image* image)
+{
+    if (!image || image != m_image)
+        return false;
+    CachedResourceClientWalker<CachedImageClient> clientWalker(m_clients);
+    while (CachedImageClient* client = clientWalker.next()) {
+        if (client->showsImageInViewport(*this))
+            return true;
+    }
+    return false;
+}
+
 bool CachedImage::currentFrameKnownToBeOpaque(const RenderElement* renderer)
 {
     Image* image = imageForRenderer(renderer);
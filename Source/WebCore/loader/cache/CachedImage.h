@@ -124,6 +124,8 @@ private:
 
     virtual void animationAdvanced(const Image*) override;
     virtual void changedInRect(const Image*, const IntRect&) override;
+    virtual bool shouldStartAsyncDecoding(const Image*) override;
+    virtual bool isVisibleInViewport(const Image*) override;
 
     void addIncrementalDataBuffer(SharedBuffer&);
 
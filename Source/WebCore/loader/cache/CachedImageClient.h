@@ -42,6 +42,14 @@ public:
 
     // Called when GIF animation progresses.
     virtual void newImageAnimationFrameAvailable(CachedImage& image) { imageChanged(&image); }
+
+    // Called before a queued asynchronous decode of the image starts; it only goes ahead if a client
+    // still shows the image. A client that returns false has to paint the image again once it does
+    // show it, which asks for the decode again.
+    virtual bool shouldStartAsyncImageDecoding(CachedImage&) { return false; }
+
+    // Whether the client shows the image in the visible part of its view.
+    virtual bool showsImageInViewport(CachedImage&) { return false; }
 };
 
 }
@@ -52,6 +52,7 @@
 #include "HTMLFrameSetElement.h"
 #include "HTMLNames.h"
 #include "HTMLPlugInImageElement.h"
+#include "ImageDecodingQueue.h"
 #include "ImageDocument.h"
 #include "InspectorClient.h"
 #include "InspectorController.h"
@@ -3985,6 +3986,13 @@ void FrameView::willPaintContents(GraphicsContext& context, const IntRect&, Pain
     if (paintingState.isFlatteningPaintOfRootFrame)
         notifyWidgetsInAllFrames(WillPaintFlattened);
 
+    // Large images may be decoded asynchronously and show up in a later paint, which is fine for what
+    // ends up on screen but not for snapshots and printing.
+    auto& imageDecodingQueue = ImageDecodingQueue::singleton();
+    paintingState.imageDecodingGroup = imageDecodingQueue.currentGroup();
+    bool canDecodeImagesAsynchronously = frame().settings().asyncImageDecodingEnabled() && !(m_paintBehavior & PaintBehaviorFlattenCompositingLayers) && !m_nodeToDraw;
+    imageDecodingQueue.setCurrentGroup(canDecodeImagesAsynchronously ? document : nullptr);
+
     ASSERT(!m_isPainting);
     m_isPainting = true;
 }
@@ -3996,6 +4004,8 @@ void FrameView::didPaintContents(GraphicsContext& context, const IntRect& dirtyR
     if (paintingState.isFlatteningPaintOfRootFrame)
         notifyWidgetsInAllFrames(DidPaintFlattened);
 
+    ImageDecodingQueue::singleton().setCurrentGroup(paintingState.imageDecodingGroup);
+
     m_paintBehavior = paintingState.paintBehavior;
     m_lastPaintTime = monotonicallyIncreasingTime();
 
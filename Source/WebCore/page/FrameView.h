@@ -329,10 +329,12 @@ public:
         PaintBehavior paintBehavior;
         bool isTopLevelPainter;
         bool isFlatteningPaintOfRootFrame;
+        const void* imageDecodingGroup;
         PaintingState()
             : paintBehavior()
             , isTopLevelPainter(false)
             , isFlatteningPaintOfRootFrame(false)
+            , imageDecodingGroup(nullptr)
         {
         }
     };
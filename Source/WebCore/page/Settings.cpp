@@ -141,7 +141,11 @@ static const bool defaultRequiresUserGestureForMediaPlayback = false;
 static const bool defaultAudioPlaybackRequiresUserGesture = false;
 static const bool defaultMediaDataLoadsAutomatically = true;
 static const bool defaultShouldRespectImageOrientation = false;
+#if PLATFORM(WPE)
+static const bool defaultImageSubsamplingEnabled = true;
+#else
 static const bool defaultImageSubsamplingEnabled = false;
+#endif
 static const bool defaultScrollingTreeIncludesFrames = false;
 static const bool defaultMediaControlsScaleWithPageZoom = true;
 #endif
@@ -26,6 +26,7 @@
 #include "config.h"
 #include "MemoryPressureHandler.h"
 
+#include "AnimatedImageFrameCache.h"
 #include "CSSValuePool.h"
 #include "Document.h"
 #include "FontCache.h"
@@ -37,6 +38,7 @@
 #include "Page.h"
 #include "PageCache.h"
 #include "ScrollingThread.h"
+#include "ShadowBlur.h"
 #include "StyledElement.h"
 #include "WorkerThread.h"
 #include <JavaScriptCore/IncrementalSweeper.h>
@@ -44,6 +46,14 @@
 #include <wtf/FastMalloc.h>
 #include <wtf/StdLibExtras.h>
 
+#if USE(HARFBUZZ)
+#include "HarfBuzzShapeCache.h"
+#endif
+
+#if USE(TEXTURE_MAPPER)
+#include "BitmapTexturePool.h"
+#endif
+
 namespace WebCore {
 
 WEBCORE_EXPORT bool MemoryPressureHandler::ReliefLogger::s_loggingEnabled = false;
@@ -86,6 +96,18 @@ void MemoryPressureHandler::releaseNoncriticalMemory()
         clearWidthCaches();
     }
 
+#if USE(HARFBUZZ)
+    {
+        ReliefLogger log("Clear HarfBuzz shape cache");
+        HarfBuzzShapeCache::singleton().clear();
+    }
+#endif
+
+    {
+        ReliefLogger log("Purge shadow templates");
+        ShadowBlur::purgeTemplateCache();
+    }
+
     {
         ReliefLogger log("Discard Selector Query Cache");
         for (auto* document : Document::allDocuments())
@@ -106,6 +128,18 @@ void MemoryPressureHandler::releaseNoncriticalMemory()
         ReliefLogger log("Prune presentation attribute cache");
         StyledElement::clearPresentationAttributeCache();
     }
+
+    {
+        ReliefLogger log("Evict decoded animated image frames");
+        AnimatedImageFrameCache::singleton().evictAllImages();
+    }
+
+#if USE(TEXTURE_MAPPER)
+    {
+        ReliefLogger log("Release unused pooled textures");
+        BitmapTexturePool::releaseUnusedTexturesInAllPools();
+    }
+#endif
 }
 
 void MemoryPressureHandler::releaseCriticalMemory(Synchronous synchronous)
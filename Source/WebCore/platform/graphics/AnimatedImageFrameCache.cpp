@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "AnimatedImageFrameCache.h"
+
+#include "Logging.h"
+#include <wtf/MainThread.h>
+#include <wtf/TemporaryChange.h>
+#include <wtf/Vector.h>
+#include <wtf/text/WTFString.h>
+
+namespace WebCore {
+
+const size_t s_defaultMemoryBudget = 32 * 1024 * 1024;
+
+// WEBKIT_ANIMATED_IMAGE_CACHE_BUDGET sets the budget in megabytes.
+static size_t defaultMemoryBudget()
+{
+    String budgetEnvironment = getenv("WEBKIT_ANIMATED_IMAGE_CACHE_BUDGET");
+    bool ok = false;
+    unsigned budget = budgetEnvironment.toUIntStrict(&ok);
+    return ok ? budget * 1024 * 1024 : s_defaultMemoryBudget;
+}
+
+AnimatedImageFrameCache& AnimatedImageFrameCache::singleton()
+{
+    ASSERT(isMainThread());
+    static NeverDestroyed<AnimatedImageFrameCache> cache;
+    return cache;
+}
+
+AnimatedImageFrameCache::AnimatedImageFrameCache()
+    : m_memoryBudget(defaultMemoryBudget())
+{
+}
+
+void AnimatedImageFrameCache::decodedSizeChanged(Client& image, size_t decodedSize)
+{
+    if (!decodedSize) {
+        remove(image);
+        return;
+    }
+
+    auto result = m_decodedSizes.add(&image, decodedSize);
+    if (!result.isNewEntry) {
+        m_bytes -= result.iterator->value;
+        result.iterator->value = decodedSize;
+    }
+    m_bytes += decodedSize;
+
+    // The images that shrink while evicting keep their place; they were not used.
+    if (m_isEvicting) {
+        if (result.isNewEntry)
+            m_images.appendOrMoveToLast(&image);
+        return;
+    }
+    m_images.appendOrMoveToLast(&image);
+
+    // The image that grew is in use; the others make room for it.
+    if (m_bytes > m_memoryBudget)
+        evictImages(&image);
+}
+
+void AnimatedImageFrameCache::didRequestFrame(Client& image, bool frameWasDecoded)
+{
+    if (frameWasDecoded)
+        ++m_hits;
+    else
+        ++m_misses;
+
+    if (m_decodedSizes.contains(&image))
+        m_images.appendOrMoveToLast(&image);
+}
+
+void AnimatedImageFrameCache::remove(Client& image)
+{
+    auto it = m_decodedSizes.find(&image);
+    if (it == m_decodedSizes.end())
+        return;
+
+    m_bytes -= it->value;
+    m_decodedSizes.remove(it);
+    m_images.remove(&image);
+}
+
+void AnimatedImageFrameCache::setMemoryBudget(size_t bytes)
+{
+    m_memoryBudget = bytes;
+    if (m_bytes > m_memoryBudget)
+        evictImages(nullptr);
+}
+
+void AnimatedImageFrameCache::evictAllImages()
+{
+    TemporaryChange<bool> isEvicting(m_isEvicting, true);
+
+    Vector<Client*> images;
+    copyToVector(m_images, images);
+    for (auto* image : images) {
+        image->evictAllFrames();
+        // In case the image could not drop everything.
+        remove(*image);
+        ++m_evictedImages;
+    }
+}
+
+void AnimatedImageFrameCache::evictImages(Client* imageToKeep)
+{
+    // Evicting frames makes images report their new size, which changes m_images; go through a copy.
+    // |imageToKeep| is in the middle of caching a frame, so it is left alone.
+    TemporaryChange<bool> isEvicting(m_isEvicting, true);
+    Vector<Client*> images;
+    copyToVector(m_images, images);
+    size_t initialBytes = m_bytes;
+
+    unsigned trimmedImages = 0;
+    for (auto* image : images) {
+        if (m_bytes <= m_memoryBudget)
+            break;
+        if (image == imageToKeep)
+            continue;
+        image->evictNonCurrentFrames();
+        ++trimmedImages;
+    }
+
+    unsigned evictedImages = 0;
+    for (auto* image : images) {
+        if (m_bytes <= m_memoryBudget)
+            break;
+        if (image == imageToKeep || !m_decodedSizes.contains(image) || image->isAnimatingOrVisible())
+            continue;
+        image->evictAllFrames();
+        // In case the image could not drop everything.
+        remove(*image);
+        ++evictedImages;
+    }
+
+    LOG(Images, "AnimatedImageFrameCache: freed %zu bytes from %u images, %u of which lost all their frames, to stay within the %zu bytes budget", initialBytes - m_bytes, trimmedImages, evictedImages, m_memoryBudget);
+    m_trimmedImages += trimmedImages;
+    m_evictedImages += evictedImages;
+}
+
+AnimatedImageFrameCache::Stats AnimatedImageFrameCache::stats() const
+{
+    Stats stats;
+    stats.imageCount = m_images.size();
+    stats.bytes = m_bytes;
+    stats.memoryBudget = m_memoryBudget;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.trimmedImages = m_trimmedImages;
+    stats.evictedImages = m_evictedImages;
+    return stats;
+}
+
+} // namespace WebCore
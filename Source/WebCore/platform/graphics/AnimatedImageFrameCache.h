@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef AnimatedImageFrameCache_h
+#define AnimatedImageFrameCache_h
+
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
+#include <wtf/NeverDestroyed.h>
+#include <wtf/Noncopyable.h>
+
+namespace WebCore {
+
+// Keeps the decoded frames of all the animated images in the process within one memory budget.
+// Animated images report their decoded size whenever it changes and every frame they are asked
+// for. Once the total goes over the budget, the least recently used images first lose the frames
+// they are not showing; if that is not enough, those that are neither animating nor visible lose
+// all of them. Frames are decoded again on demand, starting from the closest frame that does not
+// depend on a discarded one.
+//
+// Main thread only.
+class AnimatedImageFrameCache {
+    WTF_MAKE_NONCOPYABLE(AnimatedImageFrameCache);
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    class Client {
+    public:
+        // Both report the new decoded size through decodedSizeChanged().
+        virtual void evictNonCurrentFrames() = 0;
+        virtual void evictAllFrames() = 0;
+
+        // Images that are animating or on screen would have to decode their current frame again right away.
+        virtual bool isAnimatingOrVisible() = 0;
+
+    protected:
+        virtual ~Client() { }
+    };
+
+    WEBCORE_EXPORT static AnimatedImageFrameCache& singleton();
+
+    WEBCORE_EXPORT void decodedSizeChanged(Client&, size_t decodedSize);
+    WEBCORE_EXPORT void didRequestFrame(Client&, bool frameWasDecoded);
+    WEBCORE_EXPORT void remove(Client&);
+
+    WEBCORE_EXPORT void setMemoryBudget(size_t bytes);
+
+    // Called on memory pressure. Unlike going over the budget, this drops every decoded frame.
+    WEBCORE_EXPORT void evictAllImages();
+
+    struct Stats {
+        unsigned imageCount { 0 };
+        size_t bytes { 0 };
+        size_t memoryBudget { 0 };
+        unsigned hits { 0 };
+        unsigned misses { 0 };
+        unsigned trimmedImages { 0 };
+        unsigned evictedImages { 0 };
+    };
+    WEBCORE_EXPORT Stats stats() const;
+
+private:
+    friend class NeverDestroyed<AnimatedImageFrameCache>;
+
+    AnimatedImageFrameCache();
+
+    void evictImages(Client* imageToKeep);
+
+    // Least recently used first.
+    ListHashSet<Client*> m_images;
+    HashMap<Client*, size_t> m_decodedSizes;
+    size_t m_bytes { 0 };
+    size_t m_memoryBudget;
+    bool m_isEvicting { false };
+    unsigned m_hits { 0 };
+    unsigned m_misses { 0 };
+    unsigned m_trimmedImages { 0 };
+    unsigned m_evictedImages { 0 };
+};
+
+} // namespace WebCore
+
+#endif // AnimatedImageFrameCache_h
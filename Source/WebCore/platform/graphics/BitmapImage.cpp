@@ -27,6 +27,7 @@
 #include "config.h"
 #include "BitmapImage.h"
 
+#include "AnimatedImageFrameCache.h"
 #include "FloatRect.h"
 #include "GraphicsContext.h"
 #include "ImageBuffer.h"
@@ -35,6 +36,7 @@
 #include "MIMETypeRegistry.h"
 #include "TextStream.h"
 #include "Timer.h"
+#include "YUVImage.h"
 #include <wtf/CurrentTime.h>
 #include <wtf/Vector.h>
 #include <wtf/text/WTFString.h>
@@ -75,11 +77,14 @@ BitmapImage::BitmapImage(ImageObserver* observer)
     , m_hasUniformFrameSize(true)
     , m_haveFrameCount(false)
     , m_animationFinishedWhenCatchingUp(false)
+    , m_asyncDecodingFailed(false)
 {
 }
 
 BitmapImage::~BitmapImage()
 {
+    AnimatedImageFrameCache::singleton().remove(*this);
+    cancelAsyncDecoding();
     invalidatePlatformData();
     stopAnimation();
 }
@@ -121,6 +126,9 @@ bool BitmapImage::hasSingleSecurityOrigin() const
 
 void BitmapImage::destroyDecodedData(bool destroyAll)
 {
+    if (destroyAll)
+        cancelAsyncDecoding();
+
     unsigned frameBytesCleared = 0;
     const size_t clearBeforeFrame = destroyAll ? m_frames.size() : m_currentFrame;
 
@@ -185,6 +193,8 @@ void BitmapImage::destroyMetadataAndNotify(unsigned frameBytesCleared, ClearedSo
 
     if (frameBytesCleared && imageObserver())
         imageObserver()->decodedSizeChanged(this, -safeCast<int>(frameBytesCleared));
+
+    updateAnimatedImageFrameCache();
 }
 
 void BitmapImage::cacheFrame(size_t index, SubsamplingLevel subsamplingLevel, ImageFrameCaching frameCaching)
@@ -225,7 +235,44 @@ void BitmapImage::cacheFrame(size_t index, SubsamplingLevel subsamplingLevel, Im
         m_decodedPropertiesSize = 0;
         if (imageObserver())
             imageObserver()->decodedSizeChanged(this, deltaBytes);
+
+        updateAnimatedImageFrameCache();
+    }
+}
+
+void BitmapImage::updateAnimatedImageFrameCache()
+{
+    // Without the encoded data, discarded frames could not be decoded again.
+    if (!isAnimated() || !data())
+        return;
+
+    AnimatedImageFrameCache::singleton().decodedSizeChanged(*this, m_decodedSize);
+}
+
+void BitmapImage::evictNonCurrentFrames()
+{
+    unsigned frameBytesCleared = 0;
+    for (size_t i = 0; i < m_frames.size(); ++i) {
+        if (i == m_currentFrame)
+            continue;
+        unsigned frameBytes = m_frames[i].m_frameBytes;
+        if (m_frames[i].clear(false))
+            frameBytesCleared += frameBytes;
     }
+
+    // The decoder keeps whatever it needs to decode the frames that follow the current one.
+    m_source.clear(false, m_currentFrame, data(), m_allDataReceived);
+    destroyMetadataAndNotify(frameBytesCleared, ClearedSource::Yes);
+}
+
+void BitmapImage::evictAllFrames()
+{
+    destroyDecodedData(true);
+}
+
+bool BitmapImage::isAnimatingOrVisible()
+{
+    return m_frameTimer || (imageObserver() && imageObserver()->isVisibleInViewport(this));
 }
 
 void BitmapImage::didDecodeProperties() const
@@ -329,7 +376,11 @@ bool BitmapImage::dataChanged(bool allDataReceived)
     }
     destroyMetadataAndNotify(deltaBytes, ClearedSource::No);
 #endif
-    
+
+    // A decode in flight works on a copy of the old data.
+    cancelAsyncDecoding();
+    m_asyncDecodingFailed = false;
+
     // Feed all the data we've seen so far to the image decoder.
     m_allDataReceived = allDataReceived;
 #if PLATFORM(IOS)
@@ -409,21 +460,197 @@ PassNativeImagePtr BitmapImage::frameAtIndex(size_t index, float presentationSca
     // re-decode with a lower level.
     if (index < m_frames.size() && m_frames[index].m_frame && subsamplingLevel < m_frames[index].m_subsamplingLevel) {
         // If the image is already cached, but at too small a size, re-decode a larger version.
-        int sizeChange = -m_frames[index].m_frameBytes;
-        m_frames[index].clear(true);
-        invalidatePlatformData();
-        m_decodedSize += sizeChange;
-        if (imageObserver())
-            imageObserver()->decodedSizeChanged(this, sizeChange);
+        clearFrameAtIndex(index);
     }
 
     // If we haven't fetched a frame yet, do so.
-    if (index >= m_frames.size() || !m_frames[index].m_frame)
+    bool frameWasDecoded = index < m_frames.size() && m_frames[index].m_frame;
+    if (!frameWasDecoded)
         cacheFrame(index, subsamplingLevel, CacheMetadataAndFrame);
 
+    if (isAnimated())
+        AnimatedImageFrameCache::singleton().didRequestFrame(*this, frameWasDecoded);
+
     return m_frames[index].m_frame;
 }
 
+void BitmapImage::clearFrameAtIndex(size_t index)
+{
+    int sizeChange = -m_frames[index].m_frameBytes;
+    m_frames[index].clear(true);
+    invalidatePlatformData();
+    m_decodedSize += sizeChange;
+    if (imageObserver())
+        imageObserver()->decodedSizeChanged(this, sizeChange);
+
+    updateAnimatedImageFrameCache();
+}
+
+PassNativeImagePtr BitmapImage::frameAtIndexForPainting(size_t index, float presentationScaleHint)
+{
+#if !USE(CG)
+    SubsamplingLevel subsamplingLevel = std::min(m_source.subsamplingLevelForScale(presentationScaleHint), m_minimumSubsamplingLevel);
+    if (!m_asyncDecodingJob && shouldDecodeFrameAsynchronously(index, subsamplingLevel))
+        startAsyncDecoding(index, subsamplingLevel);
+
+    if (m_asyncDecodingJob) {
+        if (index < m_frames.size() && m_frames[index].m_frame)
+            return m_frames[index].m_frame;
+
+        // Meanwhile, paint the frame at the lowest resolution, where the decoder can make it for a
+        // fraction of the work. didFinishAsyncDecoding() replaces it.
+        SubsamplingLevel coarseSubsamplingLevel = m_minimumSubsamplingLevel;
+        if (coarseSubsamplingLevel > subsamplingLevel && m_source.decodesSubsampledFramesCheaply()) {
+            cacheFrame(index, coarseSubsamplingLevel, CacheMetadataAndFrame);
+            if (index < m_frames.size())
+                return m_frames[index].m_frame;
+        }
+        return nullptr;
+    }
+#endif
+
+    return frameAtIndex(index, presentationScaleHint);
+}
+
+#if !USE(CG)
+// Below this many pixels, decoding takes about as long as handing the frame to another thread and back.
+static const unsigned minimumPixelsForAsyncDecoding = 512 * 512;
+
+bool BitmapImage::shouldDecodeFrameAsynchronously(size_t index, SubsamplingLevel subsamplingLevel)
+{
+    // Decoding finishes with a notification to the observer, which repaints the image.
+    if (!ImageDecodingQueue::singleton().currentGroup() || !imageObserver())
+        return false;
+
+    // A frame at the same or a higher resolution is good enough.
+    if (haveFrameAtIndex(index) && m_frames[index].m_subsamplingLevel <= subsamplingLevel)
+        return false;
+
+    if (m_asyncDecodingFailed)
+        return false;
+
+    // Frames of animated images build on the previous ones, which live in the decoder; only decode
+    // complete, single-frame images on their own.
+    if (!m_allDataReceived || !data() || frameCount() != 1)
+        return false;
+
+    FloatSize frameSize = m_source.frameSizeAtIndex(index, subsamplingLevel);
+    if (frameSize.width() * frameSize.height() < minimumPixelsForAsyncDecoding)
+        return false;
+
+    return ImageDecodingQueue::singleton().isAvailable();
+}
+
+void BitmapImage::startAsyncDecoding(size_t index, SubsamplingLevel subsamplingLevel)
+{
+    ASSERT(!m_asyncDecodingJob);
+
+    RefPtr<AsyncImageDecodingJob> job = m_source.createAsyncDecodingJob(*data(), index, subsamplingLevel);
+    m_asyncDecodingJob = job;
+
+    auto& queue = ImageDecodingQueue::singleton();
+    queue.enqueue(*this, queue.currentGroup(), [job] {
+        job->decode();
+    }, [this, job] {
+        didFinishAsyncDecoding(*job);
+    });
+}
+
+void BitmapImage::didFinishAsyncDecoding(AsyncImageDecodingJob& job)
+{
+    ASSERT(m_asyncDecodingJob == &job);
+    m_asyncDecodingJob = nullptr;
+
+    size_t index = job.frameIndex();
+    SubsamplingLevel subsamplingLevel = job.subsamplingLevel();
+    if (haveFrameAtIndex(index)) {
+        if (m_frames[index].m_subsamplingLevel <= subsamplingLevel)
+            return;
+        // The lower-resolution frame's pixels belong to the decoder that is about to be replaced.
+        clearFrameAtIndex(index);
+    }
+
+    m_source.adoptDecoder(job);
+    cacheFrame(index, subsamplingLevel, CacheMetadataAndFrame);
+
+    if (!haveFrameAtIndex(index)) {
+        m_asyncDecodingFailed = true;
+        return;
+    }
+
+    // Same notification as for a new animation frame: visible clients repaint now, the others once
+    // they scroll into view.
+    if (imageObserver())
+        imageObserver()->animationAdvanced(this);
+}
+#endif
+
+bool BitmapImage::shouldStartDecoding()
+{
+    if (imageObserver() && imageObserver()->shouldStartAsyncDecoding(this))
+        return true;
+
+#if !USE(CG)
+    // The request is dropped; the next paint asks again.
+    m_asyncDecodingJob = nullptr;
+#endif
+    return false;
+}
+
+void BitmapImage::prefetchFrameAtIndex(size_t index)
+{
+#if !USE(CG)
+    // While data is still coming in, the decoder is busy with it on the main thread.
+    if (!m_allDataReceived || haveFrameAtIndex(index))
+        return;
+
+    m_source.prefetchFrameAtIndex(index);
+#else
+    UNUSED_PARAM(index);
+#endif
+}
+
+PassRefPtr<YUVImage> BitmapImage::createYUVImage()
+{
+#if !USE(CG)
+    if (!canCreateYUVImage())
+        return nullptr;
+
+    return m_source.createYUVImage();
+#else
+    return nullptr;
+#endif
+}
+
+bool BitmapImage::canCreateYUVImage()
+{
+#if !USE(CG)
+    return m_allDataReceived && frameCount() == 1 && !haveFrameAtIndex(0);
+#else
+    return false;
+#endif
+}
+
+void BitmapImage::cancelAsyncDecoding()
+{
+#if !USE(CG)
+    if (!m_asyncDecodingJob)
+        return;
+
+    ImageDecodingQueue::singleton().cancel(*this);
+    m_asyncDecodingJob = nullptr;
+#endif
+}
+
+bool BitmapImage::isDecodingAsynchronously() const
+{
+#if !USE(CG)
+    return m_asyncDecodingJob;
+#else
+    return false;
+#endif
+}
+
 bool BitmapImage::frameIsCompleteAtIndex(size_t index)
 {
     if (!ensureFrameIsCached(index, CacheMetadataOnly))
@@ -555,6 +782,7 @@ void BitmapImage::startAnimation(CatchUpAnimation catchUpIfNecessary)
     if (catchUpIfNecessary == DoNotCatchUp || time < m_desiredFrameStartTime) {
         // Haven't yet reached time for next frame to start; delay until then.
         startTimer(std::max<double>(m_desiredFrameStartTime - time, 0));
+        prefetchFrameAtIndex(nextFrame);
         return;
     }
 
@@ -596,6 +824,7 @@ void BitmapImage::stopAnimation()
 
 void BitmapImage::resetAnimation()
 {
+    cancelAsyncDecoding();
     stopAnimation();
     m_currentFrame = 0;
     m_repetitionsComplete = 0;
@@ -29,7 +29,9 @@
 #define BitmapImage_h
 
 #include "Image.h"
+#include "AnimatedImageFrameCache.h"
 #include "Color.h"
+#include "ImageDecodingQueue.h"
 #include "ImageOrientation.h"
 #include "ImageSource.h"
 #include "IntSize.h"
@@ -59,6 +61,7 @@ namespace WTF {
 namespace WebCore {
 
 class Timer;
+class YUVImage;
 
 // ================================================
 // FrameData Class
@@ -102,7 +105,7 @@ public:
 // BitmapImage Class
 // =================================================
 
-class BitmapImage final : public Image {
+class BitmapImage final : public Image, private ImageDecodingQueue::Client, private AnimatedImageFrameCache::Client {
     friend class GeneratedImage;
     friend class CrossfadeGeneratedImage;
     friend class GradientImage;
@@ -177,6 +180,13 @@ public:
 
     virtual bool currentFrameKnownToBeOpaque() override;
 
+    // Decodes a fully loaded single frame image into planar YCbCr instead of
+    // RGB, for callers that convert it on the GPU. Returns null if the decoder
+    // can't, or if the RGB frame is already decoded anyway.
+    PassRefPtr<YUVImage> createYUVImage();
+    // Whether createYUVImage() may succeed. This does not decode anything.
+    bool canCreateYUVImage();
+
     virtual bool isAnimated() const override { return m_frameCount > 1; }
     
     bool canAnimate();
@@ -216,6 +226,13 @@ protected:
     PassNativeImagePtr frameAtIndex(size_t, float presentationScaleHint = 1);
     PassNativeImagePtr copyUnscaledFrameAtIndex(size_t);
 
+    // Used by draw(). Like frameAtIndex(), but while painting a document that allows it, large frames
+    // are decoded on the ImageDecodingQueue instead. Until they are ready, this returns a previously
+    // decoded lower-resolution frame or one decoded on the spot at the lowest resolution, where that
+    // is cheap, and null otherwise; isDecodingAsynchronously() then tells draw() to paint a placeholder.
+    PassNativeImagePtr frameAtIndexForPainting(size_t, float presentationScaleHint = 1);
+    bool isDecodingAsynchronously() const;
+
     bool haveFrameAtIndex(size_t);
 
     bool frameIsCompleteAtIndex(size_t);
@@ -226,6 +243,8 @@ protected:
     // Decodes and caches a frame. Never accessed except internally.
     enum ImageFrameCaching { CacheMetadataOnly, CacheMetadataAndFrame };
     void cacheFrame(size_t index, SubsamplingLevel, ImageFrameCaching = CacheMetadataAndFrame);
+    // Drops a decoded frame, e.g. to replace it with one at a different subsampling level.
+    void clearFrameAtIndex(size_t index);
 
     // Called before accessing m_frames[index] for info without decoding. Returns false on index out of bounds.
     bool ensureFrameIsCached(size_t index, ImageFrameCaching = CacheMetadataAndFrame);
@@ -291,6 +310,27 @@ private:
     void clearTimer();
     void startTimer(double delay);
 
+    // ImageDecodingQueue::Client
+    virtual bool shouldStartDecoding() override;
+
+#if !USE(CG)
+    bool shouldDecodeFrameAsynchronously(size_t index, SubsamplingLevel);
+    void startAsyncDecoding(size_t index, SubsamplingLevel);
+    void didFinishAsyncDecoding(AsyncImageDecodingJob&);
+#endif
+    void cancelAsyncDecoding();
+
+    // Decodes an upcoming animation frame ahead of time, on a worker thread.
+    void prefetchFrameAtIndex(size_t);
+
+    // Animated images share the AnimatedImageFrameCache budget for their decoded frames.
+    void updateAnimatedImageFrameCache();
+
+    // AnimatedImageFrameCache::Client
+    virtual void evictNonCurrentFrames() override;
+    virtual void evictAllFrames() override;
+    virtual bool isAnimatingOrVisible() override;
+
     virtual void dump(TextStream&) const override;
 
     ImageSource m_source;
@@ -306,6 +346,9 @@ private:
     Vector<FrameData, 1> m_frames; // An array of the cached frames of the animation. We have to ref frames to pin them in the cache.
 
     std::unique_ptr<Timer> m_frameTimer;
+#if !USE(CG)
+    RefPtr<AsyncImageDecodingJob> m_asyncDecodingJob; // The decode in flight on the ImageDecodingQueue, if any.
+#endif
     int m_repetitionCount; // How many total animation loops we should do. This will be cAnimationNone if this image type is incapable of animation.
     RepetitionCountStatus m_repetitionCountStatus;
     int m_repetitionsComplete;  // How many repetitions we've finished.
@@ -342,6 +385,7 @@ private:
     mutable bool m_hasUniformFrameSize : 1;
     mutable bool m_haveFrameCount : 1;
     bool m_animationFinishedWhenCatchingUp : 1;
+    bool m_asyncDecodingFailed : 1; // Whether a decoding thread failed to decode the frame, so painting should decode it itself.
 
     RefPtr<Image> m_cachedImage;
 };
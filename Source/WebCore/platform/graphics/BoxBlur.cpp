@@ -0,0 +1,411 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "BoxBlur.h"
+
+#include <algorithm>
+#include <string.h>
+#include <wtf/Assertions.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if HAVE(ARM_NEON_INTRINSICS) && !CPU(BIG_ENDIAN)
+#include <arm_neon.h>
+#define BOX_BLUR_NEON 1
+#endif
+
+namespace WebCore {
+
+#ifdef __SSE2__
+// Sums are at most 255 * divisor, below 2^20, so they convert to floats exactly. (sum + 0.5) / divisor
+// is at least 0.5 / divisor away from the integers around it, and rounding 1 / divisor and the
+// product loses less than that, so truncating the product rounds sum / divisor down exactly. The
+// divisor is at most 4096. Windows of a single pixel are copied instead.
+static inline __m128i divide(__m128i sums, __m128 inverseDivisor)
+{
+    __m128 halfUp = _mm_add_ps(_mm_cvtepi32_ps(sums), _mm_set1_ps(0.5f));
+    return _mm_cvttps_epi32(_mm_mul_ps(halfUp, inverseDivisor));
+}
+
+static inline __m128 inverse(int divisor)
+{
+    ASSERT(divisor > 1 && divisor <= 4096);
+    return _mm_set1_ps(1.0f / divisor);
+}
+
+// Widens the channels of four pixels, each times count, into 32-bit sums, the low two pixels
+// into low and the high ones into high.
+static inline void multiplyChannels(__m128i pixels, __m128i counts, __m128i sums[4])
+{
+    // Channels and counts both fit in 16 bits, products need 32.
+    __m128i zero = _mm_setzero_si128();
+    __m128i halves[2] = { _mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero) };
+    for (int i = 0; i < 2; ++i) {
+        __m128i low = _mm_mullo_epi16(halves[i], counts);
+        __m128i high = _mm_mulhi_epu16(halves[i], counts);
+        sums[i * 2] = _mm_unpacklo_epi16(low, high);
+        sums[i * 2 + 1] = _mm_unpackhi_epi16(low, high);
+    }
+}
+#else
+// Dividing by multiplying with ceil(2^32 / divisor) and keeping the high 32 bits of the product
+// rounds down exactly as long as every sum is below 2^32 / divisor. Sums are at most 255 * divisor,
+// so that holds for any divisor from 2 up to 4103. Windows of a single pixel are copied instead.
+static inline uint32_t reciprocal(int divisor)
+{
+    ASSERT(divisor > 1 && divisor <= 4096);
+    return static_cast<uint32_t>(((static_cast<uint64_t>(1) << 32) + divisor - 1) / divisor);
+}
+#endif
+
+// Sums of the four 8-bit channels of pixels read as 32-bit values, the first channel in memory
+// being the lowest byte.
+#ifdef __SSE2__
+class PixelSum {
+public:
+    explicit PixelSum(int divisor)
+        : m_sum(_mm_setzero_si128())
+        , m_inverseDivisor(inverse(divisor))
+    {
+    }
+
+    void add(uint32_t pixel) { m_sum = _mm_add_epi32(m_sum, load(pixel)); }
+    void subtract(uint32_t pixel) { m_sum = _mm_sub_epi32(m_sum, load(pixel)); }
+
+    void addRepeated(uint32_t pixel, int count)
+    {
+        __m128i products[4];
+        multiplyChannels(_mm_cvtsi32_si128(static_cast<int>(pixel)), _mm_set1_epi16(static_cast<short>(count)), products);
+        m_sum = _mm_add_epi32(m_sum, products[0]);
+    }
+
+    uint32_t average() const
+    {
+        __m128i quotient = divide(m_sum, m_inverseDivisor);
+        quotient = _mm_packs_epi32(quotient, quotient);
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(quotient, quotient)));
+    }
+
+private:
+    static __m128i load(uint32_t pixel)
+    {
+        __m128i zero = _mm_setzero_si128();
+        __m128i channels = _mm_cvtsi32_si128(static_cast<int>(pixel));
+        return _mm_unpacklo_epi16(_mm_unpacklo_epi8(channels, zero), zero);
+    }
+
+    __m128i m_sum;
+    __m128 m_inverseDivisor;
+};
+
+// Sums of the channels of four pixels at once, the first pixel in memory being the lowest.
+class FourPixelSum {
+public:
+    explicit FourPixelSum(int divisor)
+        : m_inverseDivisor(inverse(divisor))
+    {
+        for (auto& sum : m_sums)
+            sum = _mm_setzero_si128();
+    }
+
+    void add(__m128i pixels)
+    {
+        __m128i channels[4];
+        multiplyChannels(pixels, _mm_set1_epi16(1), channels);
+        for (int i = 0; i < 4; ++i)
+            m_sums[i] = _mm_add_epi32(m_sums[i], channels[i]);
+    }
+
+    void subtract(__m128i pixels)
+    {
+        __m128i channels[4];
+        multiplyChannels(pixels, _mm_set1_epi16(1), channels);
+        for (int i = 0; i < 4; ++i)
+            m_sums[i] = _mm_sub_epi32(m_sums[i], channels[i]);
+    }
+
+    void addRepeated(__m128i pixels, int count)
+    {
+        __m128i products[4];
+        multiplyChannels(pixels, _mm_set1_epi16(static_cast<short>(count)), products);
+        for (int i = 0; i < 4; ++i)
+            m_sums[i] = _mm_add_epi32(m_sums[i], products[i]);
+    }
+
+    __m128i average() const
+    {
+        __m128i low = _mm_packs_epi32(divide(m_sums[0], m_inverseDivisor), divide(m_sums[1], m_inverseDivisor));
+        __m128i high = _mm_packs_epi32(divide(m_sums[2], m_inverseDivisor), divide(m_sums[3], m_inverseDivisor));
+        return _mm_packus_epi16(low, high);
+    }
+
+private:
+    __m128i m_sums[4];
+    __m128 m_inverseDivisor;
+};
+#elif BOX_BLUR_NEON
+class PixelSum {
+public:
+    explicit PixelSum(int divisor)
+        : m_sum(vdupq_n_u32(0))
+        , m_reciprocal(vdup_n_u32(reciprocal(divisor)))
+    {
+    }
+
+    void add(uint32_t pixel) { m_sum = vaddq_u32(m_sum, vmovl_u16(load(pixel))); }
+    void subtract(uint32_t pixel) { m_sum = vsubq_u32(m_sum, vmovl_u16(load(pixel))); }
+    void addRepeated(uint32_t pixel, int count) { m_sum = vmlal_n_u16(m_sum, load(pixel), count); }
+
+    uint32_t average() const
+    {
+        uint32x2_t low = vshrn_n_u64(vmull_u32(vget_low_u32(m_sum), m_reciprocal), 32);
+        uint32x2_t high = vshrn_n_u64(vmull_u32(vget_high_u32(m_sum), m_reciprocal), 32);
+        uint16x4_t quotient = vmovn_u32(vcombine_u32(low, high));
+        uint8x8_t channels = vmovn_u16(vcombine_u16(quotient, quotient));
+        return vget_lane_u32(vreinterpret_u32_u8(channels), 0);
+    }
+
+private:
+    static uint16x4_t load(uint32_t pixel)
+    {
+        uint32x2_t channels = vset_lane_u32(pixel, vdup_n_u32(0), 0);
+        return vget_low_u16(vmovl_u8(vreinterpret_u8_u32(channels)));
+    }
+
+    uint32x4_t m_sum;
+    uint32x2_t m_reciprocal;
+};
+#else
+class PixelSum {
+public:
+    explicit PixelSum(int divisor)
+        : m_divisor(divisor)
+    {
+    }
+
+    void add(uint32_t pixel)
+    {
+        for (int i = 0; i < 4; ++i)
+            m_sum[i] += channel(pixel, i);
+    }
+
+    void subtract(uint32_t pixel)
+    {
+        for (int i = 0; i < 4; ++i)
+            m_sum[i] -= channel(pixel, i);
+    }
+
+    void addRepeated(uint32_t pixel, int count)
+    {
+        for (int i = 0; i < 4; ++i)
+            m_sum[i] += channel(pixel, i) * count;
+    }
+
+    uint32_t average() const
+    {
+        uint32_t pixel = 0;
+        for (int i = 0; i < 4; ++i)
+            pixel |= (m_sum[i] / m_divisor) << (i * 8);
+        return pixel;
+    }
+
+private:
+    static unsigned channel(uint32_t pixel, int i) { return (pixel >> (i * 8)) & 0xff; }
+
+    unsigned m_sum[4] { 0, 0, 0, 0 };
+    unsigned m_divisor;
+};
+#endif
+
+// Reads and writes whole pixels of a line.
+class PixelLine {
+public:
+    PixelLine(const uint8_t* source, uint8_t* destination, int pixelStride)
+        : m_source(source)
+        , m_destination(destination)
+        , m_pixelStride(pixelStride)
+    {
+    }
+
+    uint32_t load(int x) const
+    {
+        uint32_t pixel;
+        memcpy(&pixel, m_source + x * m_pixelStride, 4);
+        return pixel;
+    }
+
+    void store(int x, uint32_t pixel) const { memcpy(m_destination + x * m_pixelStride, &pixel, 4); }
+
+private:
+    const uint8_t* m_source;
+    uint8_t* m_destination;
+    int m_pixelStride;
+};
+
+#ifdef __SSE2__
+// Reads and writes the pixels of four adjacent lines at once, like four columns of an image.
+class FourPixelLines {
+public:
+    FourPixelLines(const uint8_t* source, uint8_t* destination, int pixelStride)
+        : m_source(source)
+        , m_destination(destination)
+        , m_pixelStride(pixelStride)
+    {
+    }
+
+    __m128i load(int x) const { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_source + x * m_pixelStride)); }
+    void store(int x, __m128i pixels) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(m_destination + x * m_pixelStride), pixels); }
+
+private:
+    const uint8_t* m_source;
+    uint8_t* m_destination;
+    int m_pixelStride;
+};
+#endif
+
+// Reads and writes one channel of up to four lines at once, as the channels of a single pixel.
+// Lanes past lineCount repeat the first line and are never stored.
+class ChannelLines {
+public:
+    ChannelLines(const uint8_t* source, uint8_t* destination, int pixelStride, int lineStride, int lineCount)
+        : m_source(source)
+        , m_destination(destination)
+        , m_pixelStride(pixelStride)
+        , m_lineCount(lineCount)
+    {
+        for (int i = 0; i < 4; ++i)
+            m_lineOffsets[i] = i < lineCount ? i * lineStride : 0;
+    }
+
+    uint32_t load(int x) const
+    {
+        const uint8_t* channels = m_source + x * m_pixelStride;
+        return channels[m_lineOffsets[0]] | channels[m_lineOffsets[1]] << 8 | channels[m_lineOffsets[2]] << 16 | static_cast<uint32_t>(channels[m_lineOffsets[3]]) << 24;
+    }
+
+    void store(int x, uint32_t pixel) const
+    {
+        uint8_t* channels = m_destination + x * m_pixelStride;
+        for (int i = 0; i < m_lineCount; ++i)
+            channels[m_lineOffsets[i]] = pixel >> (i * 8);
+    }
+
+private:
+    const uint8_t* m_source;
+    uint8_t* m_destination;
+    int m_pixelStride;
+    int m_lineCount;
+    int m_lineOffsets[4];
+};
+
+template<typename Sum, typename Line>
+static void boxBlurLine(const Line& line, int length, int left, int right, BoxBlurEdgeMode edgeMode)
+{
+    bool duplicateEdges = edgeMode == BoxBlurEdgeMode::Duplicate;
+    auto firstPixel = line.load(0);
+    auto lastPixel = line.load(length - 1);
+
+    // Fill the window of the first pixel, [-left, right].
+    Sum sum(left + 1 + right);
+    if (duplicateEdges)
+        sum.addRepeated(firstPixel, left);
+    for (int i = 0; i <= right && i < length; ++i)
+        sum.add(line.load(i));
+    if (duplicateEdges && right >= length)
+        sum.addRepeated(lastPixel, right - length + 1);
+
+    // Then slide it along the line. Sources are read before the destination pixel is written,
+    // so the channels of ChannelLines may be in the same pixels.
+    for (int x = 0; x < length; ++x) {
+        auto average = sum.average();
+
+        int leaving = x - left;
+        if (leaving >= 0)
+            sum.subtract(line.load(leaving));
+        else if (duplicateEdges)
+            sum.subtract(firstPixel);
+
+        int entering = x + right + 1;
+        if (entering < length)
+            sum.add(line.load(entering));
+        else if (duplicateEdges)
+            sum.add(lastPixel);
+
+        line.store(x, average);
+    }
+}
+
+void boxBlurPixelLines(const uint8_t* source, uint8_t* destination, int pixelStride, int lineStride, int length, int lineCount, int left, int right, BoxBlurEdgeMode edgeMode)
+{
+    ASSERT(left >= 0 && right >= 0);
+
+    if (length <= 0)
+        return;
+
+    if (!left && !right) {
+        for (int y = 0; y < lineCount; ++y) {
+            for (int x = 0; x < length; ++x)
+                memcpy(destination + y * lineStride + x * pixelStride, source + y * lineStride + x * pixelStride, 4);
+        }
+        return;
+    }
+
+    int y = 0;
+#ifdef __SSE2__
+    // Columns are read and written four pixels at a time, instead of one pixel per row.
+    if (lineStride == 4) {
+        for (; y + 4 <= lineCount; y += 4)
+            boxBlurLine<FourPixelSum>(FourPixelLines(source + y * lineStride, destination + y * lineStride, pixelStride), length, left, right, edgeMode);
+    }
+#endif
+    for (; y < lineCount; ++y)
+        boxBlurLine<PixelSum>(PixelLine(source + y * lineStride, destination + y * lineStride, pixelStride), length, left, right, edgeMode);
+}
+
+void boxBlurChannelLines(const uint8_t* source, uint8_t* destination, int pixelStride, int lineStride, int length, int lineCount, int left, int right, BoxBlurEdgeMode edgeMode)
+{
+    ASSERT(left >= 0 && right >= 0);
+    ASSERT(source != destination);
+
+    if (length <= 0)
+        return;
+
+    if (!left && !right) {
+        for (int y = 0; y < lineCount; ++y) {
+            for (int x = 0; x < length; ++x)
+                destination[y * lineStride + x * pixelStride] = source[y * lineStride + x * pixelStride];
+        }
+        return;
+    }
+
+    for (int y = 0; y < lineCount; y += 4)
+        boxBlurLine<PixelSum>(ChannelLines(source + y * lineStride, destination + y * lineStride, pixelStride, lineStride, std::min(lineCount - y, 4)), length, left, right, edgeMode);
+}
+
+} // namespace WebCore
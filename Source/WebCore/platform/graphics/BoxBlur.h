@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BoxBlur_h
+#define BoxBlur_h
+
+#include <stdint.h>
+
+// Box blur shared by FEGaussianBlur and ShadowBlur. Both approximate a gaussian blur with three
+// successive box blurs along each axis, and spend nearly all of their time in this function.
+
+namespace WebCore {
+
+enum class BoxBlurEdgeMode {
+    // Pixels outside of a line are transparent black.
+    Transparent,
+    // Pixels outside of a line repeat the first and last pixels of the line.
+    Duplicate
+};
+
+// Blurs lineCount lines of length 32-bit pixels. Every channel of a destination pixel is the
+// average, rounded down, of that channel over the source pixels from left pixels before it up to
+// right pixels after it. Pixels of a line are pixelStride bytes apart and lines are lineStride
+// bytes apart, in both the source and the destination, so rows are blurred with a pixelStride of
+// 4 and columns with a lineStride of 4. The source and destination must not overlap.
+//
+// The averages are exact, so the SSE2 and NEON versions give the same results as the scalar one.
+void boxBlurPixelLines(const uint8_t* source, uint8_t* destination, int pixelStride, int lineStride, int length, int lineCount, int left, int right, BoxBlurEdgeMode);
+
+// Same as boxBlurPixelLines(), for a single 8-bit channel of the pixels, four lines at a time.
+// source and destination point to the channel of the first pixel. They may be different channels
+// of the same pixels, which lets successive passes hop between the channels of an image in place
+// when only one of them matters.
+void boxBlurChannelLines(const uint8_t* source, uint8_t* destination, int pixelStride, int lineStride, int length, int lineCount, int left, int right, BoxBlurEdgeMode);
+
+} // namespace WebCore
+
+#endif // BoxBlur_h
@@ -74,6 +74,9 @@ public:
     //   GL_EXT_debug_marker
     //   GL_ARB_draw_buffers / GL_EXT_draw_buffers
     //   GL_ANGLE_instanced_arrays
+    //   GL_OES_get_program_binary
+    //   GL_EXT_map_buffer_range
+    //   GL_APPLE_sync, or the fences of OpenGL ES 3
 
     // Takes full name of extension; for example,
     // "GL_EXT_texture_format_BGRA8888".
@@ -138,6 +141,17 @@ public:
         // GL_OES_vertex_array_object names
         VERTEX_ARRAY_BINDING_OES = 0x85B5,
 
+        // GL_OES_get_program_binary names
+        PROGRAM_BINARY_LENGTH_OES = 0x8741,
+        NUM_PROGRAM_BINARY_FORMATS_OES = 0x87FE,
+        PROGRAM_BINARY_FORMATS_OES = 0x87FF,
+
+        // GL_EXT_map_buffer_range names
+        MAP_WRITE_BIT_EXT = 0x0002,
+        MAP_INVALIDATE_RANGE_BIT_EXT = 0x0004,
+        MAP_INVALIDATE_BUFFER_BIT_EXT = 0x0008,
+        MAP_UNSYNCHRONIZED_BIT_EXT = 0x0020,
+
         // GL_ANGLE_translated_shader_source
         TRANSLATED_SHADER_SOURCE_LENGTH_ANGLE = 0x93A0,
 
@@ -249,6 +263,19 @@ public:
     virtual void drawElementsInstanced(GC3Denum mode, GC3Dsizei count, GC3Denum type, long long offset, GC3Dsizei primcount) = 0;
     virtual void vertexAttribDivisor(GC3Duint index, GC3Duint divisor) = 0;
 
+    // GL_OES_get_program_binary
+    virtual void getProgramBinaryOES(Platform3DObject program, GC3Dsizei bufSize, GC3Dsizei* length, GC3Denum* binaryFormat, void* binary) = 0;
+    virtual void programBinaryOES(Platform3DObject program, GC3Denum binaryFormat, const void* binary, GC3Dint length) = 0;
+
+    // GL_EXT_map_buffer_range, which relies on glUnmapBufferOES from GL_OES_mapbuffer
+    virtual void* mapBufferRangeEXT(GC3Denum target, GC3Dintptr offset, GC3Dsizeiptr length, GC3Dbitfield access) = 0;
+    virtual GC3Dboolean unmapBufferOES(GC3Denum target) = 0;
+
+    // GL_APPLE_sync. The enums are the same as those of OpenGL ES 3 in GraphicsContext3D.
+    virtual GC3Dsync fenceSyncAPPLE(GC3Denum condition, GC3Dbitfield flags) = 0;
+    virtual GC3Denum clientWaitSyncAPPLE(GC3Dsync, GC3Dbitfield flags, GC3Duint64 timeout) = 0;
+    virtual void deleteSyncAPPLE(GC3Dsync) = 0;
+
     virtual bool isNVIDIA() = 0;
     virtual bool isAMD() = 0;
     virtual bool isIntel() = 0;
@@ -24,6 +24,7 @@
 #include "Widget.h"
 #include <memory>
 #include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
 
 // FIXME: WPE should use EGLNativeWindowType once we can use the Wayland EGL platform.
 #if USE(EGL)
@@ -66,6 +67,12 @@ public:
     virtual ~GLContext();
     virtual bool makeContextCurrent();
     virtual void swapBuffers() = 0;
+
+    // Number of frames since the back buffer was last presented, or 0 if its contents are undefined.
+    virtual unsigned bufferAge() { return 0; }
+    // Like swapBuffers(), but tells the presentation engine that only the given rects, in
+    // top-left origin window coordinates, changed since the previous frame.
+    virtual void swapBuffersWithDamage(const Vector<IntRect>&) { swapBuffers(); }
     virtual void waitNative() = 0;
     virtual bool canRenderToDefaultFramebuffer() = 0;
     virtual IntSize defaultFrameBufferSize() = 0;
@@ -28,6 +28,7 @@
 
 #include "BidiResolver.h"
 #include "BitmapImage.h"
+#include "DisplayListRecorder.h"
 #include "FloatRoundedRect.h"
 #include "Gradient.h"
 #include "ImageBuffer.h"
@@ -109,9 +110,26 @@ GraphicsContext::~GraphicsContext()
 {
     ASSERT(m_stack.isEmpty());
     ASSERT(!m_transparencyCount);
+    ASSERT(!m_displayListRecorder);
     platformDestroy();
 }
 
+void GraphicsContext::setDisplayListRecorder(DisplayList::Recorder* recorder)
+{
+    ASSERT(!recorder || !m_displayListRecorder);
+    m_displayListRecorder = recorder;
+
+    // A recording context has no platform context, but painting code must not bail out.
+    if (recorder)
+        setPaintingDisabled(false);
+}
+
+void GraphicsContext::markRecordingAsNotReplayable()
+{
+    ASSERT(isRecording());
+    m_displayListRecorder->markAsNotReplayable();
+}
+
 void GraphicsContext::save()
 {
     if (paintingDisabled())
@@ -119,6 +137,11 @@ void GraphicsContext::save()
 
     m_stack.append(m_state);
 
+    if (isRecording()) {
+        m_displayListRecorder->save();
+        return;
+    }
+
     savePlatformState();
 }
 
@@ -139,6 +162,11 @@ void GraphicsContext::restore()
     if (m_stack.isEmpty())
         m_stack.clear();
 
+    if (isRecording()) {
+        m_displayListRecorder->restore();
+        return;
+    }
+
     restorePlatformState();
 }
 
@@ -297,13 +325,19 @@ void GraphicsContext::setFillGradient(Ref<Gradient>&& gradient)
 
 void GraphicsContext::beginTransparencyLayer(float opacity)
 {
-    beginPlatformTransparencyLayer(opacity);
+    if (isRecording())
+        m_displayListRecorder->beginTransparencyLayer(opacity);
+    else
+        beginPlatformTransparencyLayer(opacity);
     ++m_transparencyCount;
 }
 
 void GraphicsContext::endTransparencyLayer()
 {
-    endPlatformTransparencyLayer();
+    if (isRecording())
+        m_displayListRecorder->endTransparencyLayer();
+    else
+        endPlatformTransparencyLayer();
     ASSERT(m_transparencyCount > 0);
     --m_transparencyCount;
 }
@@ -327,6 +361,11 @@ void GraphicsContext::drawGlyphs(const FontCascade& fontCascade, const Font& fon
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->drawGlyphs(font, buffer, from, numGlyphs, point);
+        return;
+    }
+
     fontCascade.drawGlyphs(*this, font, buffer, from, numGlyphs, point);
 }
 
@@ -395,6 +434,12 @@ void GraphicsContext::drawImage(Image& image, const FloatRect& destination, cons
 
     // FIXME (49002): Should be InterpolationLow
     InterpolationQualityMaintainer interpolationQualityForThisScope(*this, imagePaintingOptions.m_useLowQualityScale ? InterpolationNone : imageInterpolationQuality());
+
+    if (isRecording()) {
+        m_displayListRecorder->drawImage(image, destination, source, imagePaintingOptions);
+        return;
+    }
+
     image.draw(*this, destination, source, imagePaintingOptions.m_compositeOperator, imagePaintingOptions.m_blendMode, imagePaintingOptions.m_orientationDescription);
 }
 
@@ -404,6 +449,12 @@ void GraphicsContext::drawTiledImage(Image& image, const FloatRect& destination,
         return;
 
     InterpolationQualityMaintainer interpolationQualityForThisScope(*this, imagePaintingOptions.m_useLowQualityScale ? InterpolationLow : imageInterpolationQuality());
+
+    if (isRecording()) {
+        m_displayListRecorder->drawTiledImage(image, destination, source, tileSize, spacing, imagePaintingOptions);
+        return;
+    }
+
     image.drawTiled(*this, destination, source, tileSize, spacing, imagePaintingOptions.m_compositeOperator, imagePaintingOptions.m_blendMode);
 }
 
@@ -420,6 +471,12 @@ void GraphicsContext::drawTiledImage(Image& image, const FloatRect& destination,
     }
 
     InterpolationQualityMaintainer interpolationQualityForThisScope(*this, imagePaintingOptions.m_useLowQualityScale ? InterpolationLow : imageInterpolationQuality());
+
+    if (isRecording()) {
+        m_displayListRecorder->drawTiledImage(image, destination, source, tileScaleFactor, hRule, vRule, imagePaintingOptions);
+        return;
+    }
+
     image.drawTiled(*this, destination, source, tileScaleFactor, hRule, vRule, imagePaintingOptions.m_compositeOperator);
 }
 
@@ -440,6 +497,14 @@ void GraphicsContext::drawImageBuffer(ImageBuffer& image, const FloatRect& desti
 
     // FIXME (49002): Should be InterpolationLow
     InterpolationQualityMaintainer interpolationQualityForThisScope(*this, imagePaintingOptions.m_useLowQualityScale ? InterpolationNone : imageInterpolationQuality());
+
+    if (isRecording()) {
+        // The buffer may be drawn into after recording, so the list keeps a snapshot.
+        if (RefPtr<Image> snapshot = image.copyImage(CopyBackingStore))
+            m_displayListRecorder->drawImage(*snapshot, destination, source, imagePaintingOptions);
+        return;
+    }
+
     image.draw(*this, destination, source, imagePaintingOptions.m_compositeOperator, imagePaintingOptions.m_blendMode, imagePaintingOptions.m_useLowQualityScale);
 }
 
@@ -477,6 +542,12 @@ void GraphicsContext::clipToImageBuffer(ImageBuffer& buffer, const FloatRect& re
 {
     if (paintingDisabled())
         return;
+
+    if (isRecording()) {
+        m_displayListRecorder->clipToImageBuffer(buffer, rect);
+        return;
+    }
+
     buffer.clip(*this, rect);
 }
 
@@ -500,6 +571,12 @@ void GraphicsContext::fillRect(const FloatRect& rect, Gradient& gradient)
 {
     if (paintingDisabled())
         return;
+
+    if (isRecording()) {
+        m_displayListRecorder->fillRect(rect, gradient);
+        return;
+    }
+
     gradient.fill(this, rect);
 }
 
@@ -516,6 +593,11 @@ void GraphicsContext::fillRect(const FloatRect& rect, const Color& color, Compos
 
 void GraphicsContext::fillRoundedRect(const FloatRoundedRect& rect, const Color& color, BlendMode blendMode)
 {
+    if (isRecording()) {
+        m_displayListRecorder->fillRoundedRect(rect, color, blendMode);
+        return;
+    }
+
     if (rect.isRounded()) {
         setCompositeOperation(compositeOperation(), blendMode);
         platformFillRoundedRect(rect, color);
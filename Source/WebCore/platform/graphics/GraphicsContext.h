@@ -72,6 +72,10 @@ const int cMisspellingLineThickness = 3;
 const int cMisspellingLinePatternWidth = 4;
 const int cMisspellingLinePatternGapWidth = 1;
 
+namespace DisplayList {
+class Recorder;
+}
+
 class AffineTransform;
 class FloatRoundedRect;
 class Gradient;
@@ -203,6 +207,14 @@ public:
 
     WEBCORE_EXPORT PlatformGraphicsContext* platformContext() const;
 
+    // While recording, operations are captured by the DisplayList::Recorder instead of
+    // reaching the platform context.
+    bool isRecording() const { return m_displayListRecorder; }
+    void setDisplayListRecorder(DisplayList::Recorder*);
+    // Painting code that can only draw through platformContext() calls this instead of
+    // drawing while recording. Whoever recorded the list then paints directly.
+    WEBCORE_EXPORT void markRecordingAsNotReplayable();
+
     void setStrokeThickness(float);
     float strokeThickness() const { return m_state.strokeThickness; }
 
@@ -553,6 +565,7 @@ private:
     FloatRect computeLineBoundsAndAntialiasingModeForText(const FloatPoint&, float width, bool printing, bool& shouldAntialias, Color&);
 
     GraphicsContextPlatformPrivate* m_data;
+    DisplayList::Recorder* m_displayListRecorder { nullptr };
 
     GraphicsContextState m_state;
     Vector<GraphicsContextState, 1> m_stack;
@@ -48,6 +48,7 @@ typedef intptr_t GC3Dsizeiptr;
 typedef char GC3Dchar;
 typedef long long GC3Dint64;
 typedef unsigned long long GC3Duint64;
+typedef struct __GLsync* GC3Dsync;
 
 typedef GC3Duint Platform3DObject;
 
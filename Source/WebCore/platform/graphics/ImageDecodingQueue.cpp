@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "ImageDecodingQueue.h"
+
+#include <wtf/MainThread.h>
+#include <wtf/TaskScheduler.h>
+
+namespace WebCore {
+
+ImageDecodingQueue& ImageDecodingQueue::singleton()
+{
+    static NeverDestroyed<ImageDecodingQueue> queue;
+    return queue;
+}
+
+ImageDecodingQueue::ImageDecodingQueue()
+{
+}
+
+bool ImageDecodingQueue::isAvailable() const
+{
+    return TaskScheduler::singleton().numberOfWorkers();
+}
+
+void ImageDecodingQueue::setMaximumDecodesPerGroup(unsigned maximumDecodesPerGroup)
+{
+    ASSERT(isMainThread());
+    m_maximumDecodesPerGroup = std::max(1U, maximumDecodesPerGroup);
+
+    Vector<Group> groups;
+    copyKeysToVector(m_groups, groups);
+    for (auto group : groups)
+        startPendingRequests(group);
+}
+
+void ImageDecodingQueue::enqueue(Client& client, Group group, std::function<void ()> decodeFunction, std::function<void ()> completionHandler)
+{
+    ASSERT(isMainThread());
+    ASSERT(group);
+
+    auto& groupState = m_groups.add(group, nullptr).iterator->value;
+    if (!groupState)
+        groupState = std::make_unique<GroupState>();
+
+    Request request { m_nextRequestIdentifier++, &client, WTF::move(decodeFunction), WTF::move(completionHandler) };
+    if (groupState->numberOfRunningDecodes < m_maximumDecodesPerGroup) {
+        startRequest(group, *groupState, WTF::move(request));
+        return;
+    }
+    groupState->pendingRequests.append(WTF::move(request));
+}
+
+void ImageDecodingQueue::cancel(Client& client)
+{
+    ASSERT(isMainThread());
+
+    for (auto& groupState : m_groups.values()) {
+        auto& pendingRequests = groupState->pendingRequests;
+        while (true) {
+            auto it = pendingRequests.findIf([&client] (const Request& request) { return request.client == &client; });
+            if (it == pendingRequests.end())
+                break;
+            pendingRequests.remove(it);
+        }
+    }
+
+    // Running decodes cannot be interrupted; forget their client so the result is thrown away.
+    for (auto& runningRequest : m_runningRequests.values()) {
+        if (runningRequest.client != &client)
+            continue;
+        runningRequest.client = nullptr;
+        runningRequest.completionHandler = nullptr;
+    }
+}
+
+void ImageDecodingQueue::startRequest(Group group, GroupState& groupState, Request&& request)
+{
+    ++groupState.numberOfRunningDecodes;
+    m_runningRequests.add(request.identifier, RunningRequest { group, request.client, WTF::move(request.completionHandler) });
+
+    uint64_t identifier = request.identifier;
+    std::function<void ()> decodeFunction = WTF::move(request.decodeFunction);
+    TaskScheduler::singleton().dispatch([this, identifier, decodeFunction] {
+        decodeFunction();
+        callOnMainThread([this, identifier] {
+            didFinishRequest(identifier);
+        });
+    }, TaskScheduler::Priority::Low);
+}
+
+void ImageDecodingQueue::startPendingRequests(Group group)
+{
+    auto it = m_groups.find(group);
+    if (it == m_groups.end())
+        return;
+
+    GroupState& groupState = *it->value;
+    while (groupState.numberOfRunningDecodes < m_maximumDecodesPerGroup && !groupState.pendingRequests.isEmpty()) {
+        Request request = groupState.pendingRequests.takeFirst();
+        if (!request.client->shouldStartDecoding())
+            continue;
+        startRequest(group, groupState, WTF::move(request));
+    }
+
+    if (!groupState.numberOfRunningDecodes && groupState.pendingRequests.isEmpty())
+        m_groups.remove(group);
+}
+
+void ImageDecodingQueue::didFinishRequest(uint64_t identifier)
+{
+    ASSERT(isMainThread());
+
+    RunningRequest runningRequest = m_runningRequests.take(identifier);
+    auto it = m_groups.find(runningRequest.group);
+    ASSERT(it != m_groups.end());
+    ASSERT(it->value->numberOfRunningDecodes);
+    --it->value->numberOfRunningDecodes;
+
+    if (runningRequest.completionHandler)
+        runningRequest.completionHandler();
+
+    startPendingRequests(runningRequest.group);
+}
+
+} // namespace WebCore
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ImageDecodingQueue_h
+#define ImageDecodingQueue_h
+
+#include <functional>
+#include <wtf/Deque.h>
+#include <wtf/HashMap.h>
+#include <wtf/NeverDestroyed.h>
+#include <wtf/Noncopyable.h>
+
+namespace WebCore {
+
+// Runs image decodes on the TaskScheduler worker threads on behalf of the main thread. Requests are
+// grouped (one group per document being painted) and each group only gets a few decodes running at
+// once, so a page full of large images cannot starve the workers. Requests that wait for a slot can
+// still be dropped, either explicitly with cancel() or by their client when they come up.
+//
+// All functions must be called on the main thread.
+class ImageDecodingQueue {
+    WTF_MAKE_NONCOPYABLE(ImageDecodingQueue);
+    WTF_MAKE_FAST_ALLOCATED;
+    friend class NeverDestroyed<ImageDecodingQueue>;
+public:
+    typedef const void* Group;
+
+    static const unsigned defaultMaximumDecodesPerGroup = 2;
+
+    class Client {
+    public:
+        // Called right before a request that had to wait for a slot is started. Returning false drops
+        // it without running it, e.g. because the image is no longer visible. Must not call back into
+        // the queue.
+        virtual bool shouldStartDecoding() = 0;
+
+    protected:
+        virtual ~Client() { }
+    };
+
+    WEBCORE_EXPORT static ImageDecodingQueue& singleton();
+
+    // False when there are no worker threads to decode on, in which case callers should decode synchronously.
+    bool isAvailable() const;
+
+    // |decodeFunction| runs on a worker thread; |completionHandler| runs on the main thread once it is
+    // done, unless the request was cancelled in the meantime.
+    WEBCORE_EXPORT void enqueue(Client&, Group, std::function<void ()> decodeFunction, std::function<void ()> completionHandler);
+
+    // Drops all requests of |client|. Running decodes finish, but their completion handlers are not called.
+    WEBCORE_EXPORT void cancel(Client&);
+
+    unsigned maximumDecodesPerGroup() const { return m_maximumDecodesPerGroup; }
+    WEBCORE_EXPORT void setMaximumDecodesPerGroup(unsigned);
+
+    // The group that paints going on right now belong to, or null outside of painting or when that
+    // painting has to decode synchronously. Set by FrameView around painting.
+    Group currentGroup() const { return m_currentGroup; }
+    void setCurrentGroup(Group group) { m_currentGroup = group; }
+
+private:
+    ImageDecodingQueue();
+
+    struct Request {
+        uint64_t identifier;
+        Client* client;
+        std::function<void ()> decodeFunction;
+        std::function<void ()> completionHandler;
+    };
+
+    struct GroupState {
+        WTF_MAKE_FAST_ALLOCATED;
+    public:
+        unsigned numberOfRunningDecodes { 0 };
+        Deque<Request> pendingRequests;
+    };
+
+    struct RunningRequest {
+        Group group;
+        Client* client;
+        std::function<void ()> completionHandler;
+    };
+
+    void startPendingRequests(Group);
+    void startRequest(Group, GroupState&, Request&&);
+    void didFinishRequest(uint64_t identifier);
+
+    HashMap<Group, std::unique_ptr<GroupState>> m_groups;
+    HashMap<uint64_t, RunningRequest> m_runningRequests;
+    uint64_t m_nextRequestIdentifier { 1 };
+    unsigned m_maximumDecodesPerGroup { defaultMaximumDecodesPerGroup };
+    Group m_currentGroup { nullptr };
+};
+
+} // namespace WebCore
+
+#endif // ImageDecodingQueue_h
@@ -43,6 +43,14 @@ public:
     virtual void animationAdvanced(const Image*) = 0;
 
     virtual void changedInRect(const Image*, const IntRect&) = 0;
+
+    // Asked before an asynchronous decode that had to wait for a decoding thread starts. Returning false
+    // drops the decode, for instance because the image has scrolled out of view in the meantime.
+    virtual bool shouldStartAsyncDecoding(const Image*) { return true; }
+
+    // Whether the image is shown in a viewport right now. Images that aren't give up their decoded
+    // frames first when memory is short.
+    virtual bool isVisibleInViewport(const Image*) { return false; }
 };
 
 }
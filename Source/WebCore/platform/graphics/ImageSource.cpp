@@ -35,6 +35,11 @@
 
 #include "ImageOrientation.h"
 #include "NotImplemented.h"
+#include "SharedBuffer.h"
+#include <atomic>
+#include <wtf/Lock.h>
+#include <wtf/MathExtras.h>
+#include <wtf/TaskScheduler.h>
 
 namespace WebCore {
 
@@ -42,6 +47,27 @@ namespace WebCore {
 unsigned ImageSource::s_maxPixelsPerDecodedImage = 1024 * 1024;
 #endif
 
+// Shared between the ImageSource and the worker thread doing the prefetch. The worker holds the lock
+// while it uses the decoder, so taking it is enough to make sure the worker is done with the decoder,
+// or never starts.
+class ImageSource::FramePrefetch : public ThreadSafeRefCounted<FramePrefetch> {
+public:
+    Lock lock;
+    bool cancelled { false };
+    // Set by the worker once it no longer uses the decoder, so a finished prefetch is dropped without locking.
+    std::atomic<bool> done { false };
+
+    // Decoder metadata, read before the prefetch started. All data has been received by then, so it can't
+    // change, and getters answer from here rather than wait for the decoding to finish. Only animated
+    // images are prefetched, and their frames all have the size of the image.
+    IntSize size;
+    size_t frameCount { 0 };
+    int repetitionCount { cAnimationNone };
+    ImageOrientation orientation;
+    bool hasHotSpot { false };
+    IntPoint hotSpot;
+};
+
 ImageSource::ImageSource(ImageSource::AlphaOption alphaOption, ImageSource::GammaAndColorProfileOption gammaAndColorProfileOption)
     : m_decoder(0)
     , m_alphaOption(alphaOption)
@@ -56,6 +82,8 @@ ImageSource::~ImageSource()
 
 void ImageSource::clear(bool destroyAll, size_t clearBeforeFrame, SharedBuffer* data, bool allDataReceived)
 {
+    finishFramePrefetch();
+
     if (!destroyAll) {
         if (m_decoder)
             m_decoder->clearFrameBufferCache(clearBeforeFrame);
@@ -75,6 +103,8 @@ bool ImageSource::initialized() const
 
 void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
 {
+    finishFramePrefetch();
+
     // Make the decoder by sniffing the bytes.
     // This method will examine the data and instantiate an instance of the appropriate decoder plugin.
     // If insufficient bytes are available to determine the image type, no decoder plugin will be
@@ -96,18 +126,35 @@ String ImageSource::filenameExtension() const
     return m_decoder ? m_decoder->filenameExtension() : String();
 }
 
-SubsamplingLevel ImageSource::subsamplingLevelForScale(float) const
+SubsamplingLevel ImageSource::subsamplingLevelForScale(float scale) const
 {
-    return 0;
+    if (!allowSubsamplingOfFrameAtIndex(0))
+        return 0;
+
+    // There are four subsampling levels: 0 = 1x, 1 = 0.5x, 2 = 0.25x, 3 = 0.125x. Round down so that
+    // the frame is never smaller than what it is painted at.
+    float clampedScale = std::max<float>(0.125, std::min<float>(1, scale));
+    int result = floorf(log2f(1 / clampedScale));
+    ASSERT(result >= 0 && result <= 3);
+    return result;
 }
 
 bool ImageSource::allowSubsamplingOfFrameAtIndex(size_t) const
 {
-    return false;
+    if (!m_decoder || !m_decoder->supportsSubsampling())
+        return false;
+
+    // Animated frames are composited onto each other at full size.
+    if (const FramePrefetch* prefetch = framePrefetchInProgress())
+        return prefetch->frameCount == 1;
+    return m_decoder->frameCount() == 1;
 }
 
 bool ImageSource::isSizeAvailable()
 {
+    if (framePrefetchInProgress())
+        return true;
+
     return m_decoder && m_decoder->isSizeAvailable();
 }
 
@@ -116,13 +163,17 @@ IntSize ImageSource::size(ImageOrientationDescription description) const
     return frameSizeAtIndex(0, 0, description);
 }
 
-IntSize ImageSource::frameSizeAtIndex(size_t index, SubsamplingLevel, ImageOrientationDescription description) const
+IntSize ImageSource::frameSizeAtIndex(size_t index, SubsamplingLevel subsamplingLevel, ImageOrientationDescription description) const
 {
     if (!m_decoder)
         return IntSize();
 
-    IntSize size = m_decoder->frameSizeAtIndex(index);
-    if ((description.respectImageOrientation() == RespectImageOrientation) && m_decoder->orientation().usesWidthAsHeight())
+    const FramePrefetch* prefetch = framePrefetchInProgress();
+    IntSize size = prefetch ? prefetch->size : m_decoder->frameSizeAtIndex(index);
+    if (subsamplingLevel && m_decoder->supportsSubsampling())
+        size = ImageDecoder::subsampledSize(size, subsamplingLevel);
+    ImageOrientation orientation = prefetch ? prefetch->orientation : m_decoder->orientation();
+    if ((description.respectImageOrientation() == RespectImageOrientation) && orientation.usesWidthAsHeight())
         return IntSize(size.height(), size.width());
 
     return size;
@@ -130,6 +181,11 @@ IntSize ImageSource::frameSizeAtIndex(size_t index, SubsamplingLevel, ImageOrien
 
 bool ImageSource::getHotSpot(IntPoint& hotSpot) const
 {
+    if (const FramePrefetch* prefetch = framePrefetchInProgress()) {
+        hotSpot = prefetch->hotSpot;
+        return prefetch->hasHotSpot;
+    }
+
     return m_decoder ? m_decoder->hotSpot(hotSpot) : false;
 }
 
@@ -140,19 +196,36 @@ size_t ImageSource::bytesDecodedToDetermineProperties() const
 
 int ImageSource::repetitionCount()
 {
+    if (const FramePrefetch* prefetch = framePrefetchInProgress())
+        return prefetch->repetitionCount;
+
     return m_decoder ? m_decoder->repetitionCount() : cAnimationNone;
 }
 
 size_t ImageSource::frameCount() const
 {
+    if (const FramePrefetch* prefetch = framePrefetchInProgress())
+        return prefetch->frameCount;
+
     return m_decoder ? m_decoder->frameCount() : 0;
 }
 
-PassNativeImagePtr ImageSource::createFrameAtIndex(size_t index, SubsamplingLevel)
+PassNativeImagePtr ImageSource::createFrameAtIndex(size_t index, SubsamplingLevel subsamplingLevel)
 {
+    finishFramePrefetch();
+
     if (!m_decoder)
         return 0;
 
+    if (m_decoder->supportsSubsampling() && subsamplingLevel != m_decoder->subsamplingLevel()) {
+        // The decoder's frames all have one size; start over with a decoder for the new one.
+        RefPtr<SharedBuffer> data = m_decoder->data();
+        clear(true, 0, data.get(), m_decoder->isAllDataReceived());
+        if (!m_decoder)
+            return 0;
+        m_decoder->setSubsamplingLevel(subsamplingLevel);
+    }
+
     ImageFrame* buffer = m_decoder->frameBufferAtIndex(index);
     if (!buffer || buffer->status() == ImageFrame::FrameEmpty)
         return 0;
@@ -169,6 +242,8 @@ PassNativeImagePtr ImageSource::createFrameAtIndex(size_t index, SubsamplingLeve
 
 float ImageSource::frameDurationAtIndex(size_t index)
 {
+    finishFramePrefetch();
+
     if (!m_decoder)
         return 0;
 
@@ -188,11 +263,16 @@ float ImageSource::frameDurationAtIndex(size_t index)
 
 ImageOrientation ImageSource::orientationAtIndex(size_t) const
 {
+    if (const FramePrefetch* prefetch = framePrefetchInProgress())
+        return prefetch->orientation;
+
     return m_decoder ? m_decoder->orientation() : DefaultImageOrientation;
 }
 
 bool ImageSource::frameHasAlphaAtIndex(size_t index)
 {
+    finishFramePrefetch();
+
     if (!m_decoder)
         return true;
     return m_decoder->frameHasAlphaAtIndex(index);
@@ -200,6 +280,8 @@ bool ImageSource::frameHasAlphaAtIndex(size_t index)
 
 bool ImageSource::frameIsCompleteAtIndex(size_t index)
 {
+    finishFramePrefetch();
+
     if (!m_decoder)
         return false;
 
@@ -209,11 +291,134 @@ bool ImageSource::frameIsCompleteAtIndex(size_t index)
 
 unsigned ImageSource::frameBytesAtIndex(size_t index, SubsamplingLevel) const
 {
+    finishFramePrefetch();
+
     if (!m_decoder)
         return 0;
     return m_decoder->frameBytesAtIndex(index);
 }
 
+Ref<AsyncImageDecodingJob> ImageSource::createAsyncDecodingJob(const SharedBuffer& data, size_t index, SubsamplingLevel subsamplingLevel) const
+{
+    return adoptRef(*new AsyncImageDecodingJob(data, index, subsamplingLevel, m_alphaOption, m_gammaAndColorProfileOption));
+}
+
+void ImageSource::adoptDecoder(AsyncImageDecodingJob& job)
+{
+    finishFramePrefetch();
+
+    if (!job.m_decoder)
+        return;
+
+    delete m_decoder;
+    m_decoder = job.m_decoder.release();
+}
+
+bool ImageSource::decodesSubsampledFramesCheaply() const
+{
+    return m_decoder && m_decoder->decodesSubsampledFramesCheaply();
+}
+
+void ImageSource::prefetchFrameAtIndex(size_t index)
+{
+    finishFramePrefetch();
+
+    if (!m_decoder || !TaskScheduler::singleton().numberOfWorkers())
+        return;
+
+    RefPtr<FramePrefetch> prefetch = adoptRef(new FramePrefetch);
+    prefetch->size = m_decoder->size();
+    prefetch->frameCount = m_decoder->frameCount();
+    prefetch->repetitionCount = m_decoder->repetitionCount();
+    prefetch->orientation = m_decoder->orientation();
+    prefetch->hasHotSpot = m_decoder->hotSpot(prefetch->hotSpot);
+    m_framePrefetch = prefetch;
+
+    // The decoder outlives the task: it is only deleted after finishFramePrefetch().
+    NativeImageDecoderPtr decoder = m_decoder;
+    TaskScheduler::singleton().dispatch([prefetch, decoder, index] {
+        LockHolder locker(prefetch->lock);
+        if (!prefetch->cancelled)
+            decoder->frameBufferAtIndex(index);
+        prefetch->done.store(true);
+    });
+}
+
+PassRefPtr<YUVImage> ImageSource::createYUVImage()
+{
+    finishFramePrefetch();
+
+    if (!initialized())
+        return nullptr;
+
+    return m_decoder->createYUVImage();
+}
+
+void ImageSource::finishFramePrefetch() const
+{
+    if (!m_framePrefetch)
+        return;
+
+    if (!m_framePrefetch->done.load()) {
+        LockHolder locker(m_framePrefetch->lock);
+        m_framePrefetch->cancelled = true;
+    }
+    m_framePrefetch = nullptr;
+}
+
+const ImageSource::FramePrefetch* ImageSource::framePrefetchInProgress() const
+{
+    if (!m_framePrefetch)
+        return nullptr;
+
+    if (m_framePrefetch->done.load()) {
+        m_framePrefetch = nullptr;
+        return nullptr;
+    }
+
+    // Failing to take the lock means the worker is decoding. Otherwise it hasn't started, and never will.
+    if (!m_framePrefetch->lock.tryLock())
+        return m_framePrefetch.get();
+    m_framePrefetch->cancelled = true;
+    m_framePrefetch->lock.unlock();
+    m_framePrefetch = nullptr;
+    return nullptr;
+}
+
+AsyncImageDecodingJob::AsyncImageDecodingJob(const SharedBuffer& data, size_t frameIndex, SubsamplingLevel subsamplingLevel, ImageSource::AlphaOption alphaOption, ImageSource::GammaAndColorProfileOption gammaAndColorProfileOption)
+    : m_frameIndex(frameIndex)
+    , m_subsamplingLevel(subsamplingLevel)
+    , m_alphaOption(alphaOption)
+    , m_gammaAndColorProfileOption(gammaAndColorProfileOption)
+{
+    m_data.append(data.data(), data.size());
+}
+
+AsyncImageDecodingJob::~AsyncImageDecodingJob()
+{
+}
+
+void AsyncImageDecodingJob::decode()
+{
+    // The SharedBuffer is created here and either dies with the job or moves to the main thread
+    // together with the decoder, so it is never shared between threads.
+    RefPtr<SharedBuffer> data = SharedBuffer::adoptVector(m_data);
+    m_decoder.reset(ImageDecoder::create(*data, m_alphaOption, m_gammaAndColorProfileOption));
+    if (!m_decoder)
+        return;
+
+#if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
+    if (ImageSource::maxPixelsPerDecodedImage())
+        m_decoder->setMaxNumPixels(ImageSource::maxPixelsPerDecodedImage());
+#endif
+    m_decoder->setSubsamplingLevel(m_subsamplingLevel);
+    m_decoder->setData(data.get(), true);
+
+    ImageFrame* buffer = m_decoder->frameBufferAtIndex(m_frameIndex);
+    if (!buffer || buffer->status() != ImageFrame::FrameComplete)
+        m_decoder = nullptr;
+}
+
 }
 
 #endif // USE(CG)
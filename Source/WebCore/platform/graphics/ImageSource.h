@@ -30,8 +30,11 @@
 #include "ImageOrientation.h"
 #include "NativeImagePtr.h"
 
+#include <memory>
 #include <wtf/Forward.h>
 #include <wtf/Noncopyable.h>
+#include <wtf/RefPtr.h>
+#include <wtf/ThreadSafeRefCounted.h>
 #include <wtf/Vector.h>
 
 #if USE(CG)
@@ -45,6 +48,7 @@ class ImageOrientation;
 class IntPoint;
 class IntSize;
 class SharedBuffer;
+class YUVImage;
 
 #if USE(CG)
 typedef CGImageSourceRef NativeImageDecoderPtr;
@@ -80,6 +84,10 @@ const int cAnimationNone = -2;
 // SubsamplingLevel. 0 is no subsampling, 1 is half dimensions on each axis etc.
 typedef short SubsamplingLevel;
 
+#if !USE(CG)
+class AsyncImageDecodingJob;
+#endif
+
 class ImageSource {
     WTF_MAKE_NONCOPYABLE(ImageSource);
 public:
@@ -157,6 +165,25 @@ public:
     // decoded then return 0.
     unsigned frameBytesAtIndex(size_t, SubsamplingLevel = 0) const;
 
+#if !USE(CG)
+    // Asynchronous decoding: the job decodes the frame at |index| of |data| with a decoder of its own,
+    // and adoptDecoder() installs that decoder here afterwards so createFrameAtIndex() finds the frame
+    // already decoded.
+    Ref<AsyncImageDecodingJob> createAsyncDecodingJob(const SharedBuffer& data, size_t index, SubsamplingLevel = 0) const;
+    void adoptDecoder(AsyncImageDecodingJob&);
+
+    // Whether a low-resolution frame can be decoded on the spot while the full one is decoded asynchronously.
+    bool decodesSubsampledFramesCheaply() const;
+
+    // Starts decoding the frame at |index| on a worker thread, so that createFrameAtIndex() finds it
+    // ready, e.g. by the time an animation gets to it. Getters of image metadata, like size() and
+    // frameCount(), don't wait for the prefetch. Everything else that needs the decoder waits for it
+    // to finish, or cancels it if it has not started yet.
+    void prefetchFrameAtIndex(size_t index);
+
+    PassRefPtr<YUVImage> createYUVImage();
+#endif
+
 #if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
     static unsigned maxPixelsPerDecodedImage() { return s_maxPixelsPerDecodedImage; }
     static void setMaxPixelsPerDecodedImage(unsigned maxPixels) { s_maxPixelsPerDecodedImage = maxPixels; }
@@ -166,14 +193,47 @@ private:
     NativeImageDecoderPtr m_decoder;
 
 #if !USE(CG)
+    class FramePrefetch;
+    void finishFramePrefetch() const;
+    // The prefetch whose worker is using the decoder right now, if any.
+    const FramePrefetch* framePrefetchInProgress() const;
+
     AlphaOption m_alphaOption;
     GammaAndColorProfileOption m_gammaAndColorProfileOption;
+    mutable RefPtr<FramePrefetch> m_framePrefetch;
 #endif
 #if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
     static unsigned s_maxPixelsPerDecodedImage;
 #endif
 };
 
+#if !USE(CG)
+// Decodes one frame on a decoding thread. The job owns a copy of the encoded data and creates its own
+// decoder for it, so decode() shares nothing with the ImageSource that created the job and may run on
+// any thread. Hand the job back to the main thread before passing it to ImageSource::adoptDecoder().
+class AsyncImageDecodingJob : public ThreadSafeRefCounted<AsyncImageDecodingJob> {
+public:
+    ~AsyncImageDecodingJob();
+
+    size_t frameIndex() const { return m_frameIndex; }
+    SubsamplingLevel subsamplingLevel() const { return m_subsamplingLevel; }
+
+    void decode();
+
+private:
+    friend class ImageSource;
+
+    AsyncImageDecodingJob(const SharedBuffer&, size_t frameIndex, SubsamplingLevel, ImageSource::AlphaOption, ImageSource::GammaAndColorProfileOption);
+
+    Vector<char> m_data;
+    size_t m_frameIndex;
+    SubsamplingLevel m_subsamplingLevel;
+    ImageSource::AlphaOption m_alphaOption;
+    ImageSource::GammaAndColorProfileOption m_gammaAndColorProfileOption;
+    std::unique_ptr<ImageDecoder> m_decoder;
+};
+#endif
+
 }
 
 #endif
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "PixelRowConversion.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if HAVE(ARM_NEON_INTRINSICS) && !CPU(BIG_ENDIAN)
+#include <arm_neon.h>
+#define PIXEL_ROW_CONVERSION_NEON 1
+#endif
+
+namespace WebCore {
+
+namespace PixelRowConversion {
+
+static inline uint32_t swapRedAndBlueOfPixel(uint32_t pixel)
+{
+    return (pixel & 0xff00ff00) | ((pixel << 16) & 0x00ff0000) | ((pixel >> 16) & 0x000000ff);
+}
+
+// Computes value / 255 rounded down. This is exact for every product of two 8-bit values, which
+// makes premultiplication match ImageFrame::setRGBA() bit for bit.
+static inline unsigned divideBy255(unsigned value)
+{
+    return (value + (value >> 8) + 1) >> 8;
+}
+
+#ifdef __SSE2__
+static inline __m128i swapRedAndBlueOfPixels(__m128i pixels)
+{
+    const __m128i greenAndAlphaMask = _mm_set1_epi32(static_cast<int>(0xff00ff00));
+    const __m128i lowByteMask = _mm_set1_epi32(0x000000ff);
+    __m128i redAndBlue = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(pixels, lowByteMask), 16), _mm_and_si128(_mm_srli_epi32(pixels, 16), lowByteMask));
+    return _mm_or_si128(_mm_and_si128(pixels, greenAndAlphaMask), redAndBlue);
+}
+
+// Premultiplies two RGBA pixels whose channels have been widened to 16 bits.
+static inline __m128i premultiplyWidenedPixels(__m128i pixels)
+{
+    const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i product = _mm_mullo_epi16(pixels, alpha);
+    __m128i quotient = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), _mm_set1_epi16(1)), 8);
+    return _mm_or_si128(_mm_and_si128(pixels, alphaMask), _mm_andnot_si128(alphaMask, quotient));
+}
+#endif
+
+#if PIXEL_ROW_CONVERSION_NEON
+static inline uint8x16_t multiplyAndDivideBy255(uint8x16_t channel, uint8x16_t alpha)
+{
+    uint16x8_t low = vmull_u8(vget_low_u8(channel), vget_low_u8(alpha));
+    uint16x8_t high = vmull_u8(vget_high_u8(channel), vget_high_u8(alpha));
+    low = vaddq_u16(vaddq_u16(low, vshrq_n_u16(low, 8)), vdupq_n_u16(1));
+    high = vaddq_u16(vaddq_u16(high, vshrq_n_u16(high, 8)), vdupq_n_u16(1));
+    return vcombine_u8(vshrn_n_u16(low, 8), vshrn_n_u16(high, 8));
+}
+#endif
+
+void swapRedAndBlue(const uint32_t* source, uint32_t* destination, size_t pixelCount)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    for (; i + 4 <= pixelCount; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), swapRedAndBlueOfPixels(pixels));
+    }
+#elif PIXEL_ROW_CONVERSION_NEON
+    for (; i + 16 <= pixelCount; i += 16) {
+        uint8x16x4_t pixels = vld4q_u8(reinterpret_cast<const uint8_t*>(source + i));
+        uint8x16_t blue = pixels.val[0];
+        pixels.val[0] = pixels.val[2];
+        pixels.val[2] = blue;
+        vst4q_u8(reinterpret_cast<uint8_t*>(destination + i), pixels);
+    }
+#endif
+
+    for (; i < pixelCount; ++i)
+        destination[i] = swapRedAndBlueOfPixel(source[i]);
+}
+
+void packRGB(const uint8_t* source, uint32_t* destination, size_t pixelCount)
+{
+    size_t i = 0;
+
+    // SSE2 has no byte shuffle to split up the 3 byte pixels, so only NEON gets a vector loop here.
+#if PIXEL_ROW_CONVERSION_NEON
+    for (; i + 16 <= pixelCount; i += 16) {
+        uint8x16x3_t rgb = vld3q_u8(source + i * 3);
+        uint8x16x4_t pixels;
+        pixels.val[0] = rgb.val[2];
+        pixels.val[1] = rgb.val[1];
+        pixels.val[2] = rgb.val[0];
+        pixels.val[3] = vdupq_n_u8(0xff);
+        vst4q_u8(reinterpret_cast<uint8_t*>(destination + i), pixels);
+    }
+#endif
+
+    for (; i < pixelCount; ++i) {
+        const uint8_t* pixel = source + i * 3;
+        destination[i] = 0xff000000 | pixel[0] << 16 | pixel[1] << 8 | pixel[2];
+    }
+}
+
+bool packRGBA(const uint8_t* source, uint32_t* destination, size_t pixelCount, bool premultiplyAlpha)
+{
+    size_t i = 0;
+    unsigned alphaProduct = 0xff;
+
+#ifdef __SSE2__
+    __m128i alphaAccumulator = _mm_set1_epi32(-1);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= pixelCount; i += 4) {
+        // Loaded as 32-bit words, RGBA bytes read as 0xAABBGGRR.
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4));
+        alphaAccumulator = _mm_and_si128(alphaAccumulator, pixels);
+        if (premultiplyAlpha) {
+            __m128i low = premultiplyWidenedPixels(_mm_unpacklo_epi8(pixels, zero));
+            __m128i high = premultiplyWidenedPixels(_mm_unpackhi_epi8(pixels, zero));
+            pixels = _mm_packus_epi16(low, high);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), swapRedAndBlueOfPixels(pixels));
+    }
+    uint32_t accumulatedPixels[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(accumulatedPixels), alphaAccumulator);
+    for (unsigned j = 0; j < 4; ++j)
+        alphaProduct &= accumulatedPixels[j] >> 24;
+#elif PIXEL_ROW_CONVERSION_NEON
+    uint8x16_t alphaAccumulator = vdupq_n_u8(0xff);
+    for (; i + 16 <= pixelCount; i += 16) {
+        uint8x16x4_t rgba = vld4q_u8(source + i * 4);
+        alphaAccumulator = vandq_u8(alphaAccumulator, rgba.val[3]);
+        if (premultiplyAlpha) {
+            rgba.val[0] = multiplyAndDivideBy255(rgba.val[0], rgba.val[3]);
+            rgba.val[1] = multiplyAndDivideBy255(rgba.val[1], rgba.val[3]);
+            rgba.val[2] = multiplyAndDivideBy255(rgba.val[2], rgba.val[3]);
+        }
+        uint8x16_t red = rgba.val[0];
+        rgba.val[0] = rgba.val[2];
+        rgba.val[2] = red;
+        vst4q_u8(reinterpret_cast<uint8_t*>(destination + i), rgba);
+    }
+    uint8_t accumulatedAlpha[16];
+    vst1q_u8(accumulatedAlpha, alphaAccumulator);
+    for (unsigned j = 0; j < 16; ++j)
+        alphaProduct &= accumulatedAlpha[j];
+#endif
+
+    for (; i < pixelCount; ++i) {
+        const uint8_t* pixel = source + i * 4;
+        unsigned r = pixel[0];
+        unsigned g = pixel[1];
+        unsigned b = pixel[2];
+        unsigned a = pixel[3];
+        if (premultiplyAlpha) {
+            r = divideBy255(r * a);
+            g = divideBy255(g * a);
+            b = divideBy255(b * a);
+        }
+        destination[i] = a << 24 | r << 16 | g << 8 | b;
+        alphaProduct &= a;
+    }
+
+    return alphaProduct != 0xff;
+}
+
+bool expandPalette(const uint8_t* indices, const uint32_t* palette, uint32_t* destination, size_t pixelCount, bool writeTransparentPixels)
+{
+    // Neither SSE2 nor NEON can gather 32-bit values, so this stays a scalar table lookup.
+    bool sawTransparentPixel = false;
+    for (size_t i = 0; i < pixelCount; ++i) {
+        if (uint32_t color = palette[indices[i]]) {
+            destination[i] = color;
+            continue;
+        }
+        sawTransparentPixel = true;
+        if (writeTransparentPixels)
+            destination[i] = 0;
+    }
+    return sawTransparentPixel;
+}
+
+} // namespace PixelRowConversion
+
+} // namespace WebCore
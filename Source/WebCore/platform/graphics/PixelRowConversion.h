@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PixelRowConversion_h
+#define PixelRowConversion_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Row conversion routines shared by the image decoders and the texture uploaders. Destination
+// pixels are 32-bit native-endian 0xAARRGGBB words, the layout of ImageFrame::PixelData and of
+// cairo image surfaces. The implementations are vectorized with SSE2 or NEON when available.
+
+namespace WebCore {
+
+namespace PixelRowConversion {
+
+// Swaps the red and blue channels of each pixel, turning BGRA into RGBA and vice versa.
+// The source and destination may be the same buffer.
+void swapRedAndBlue(const uint32_t* source, uint32_t* destination, size_t pixelCount);
+
+// Packs tightly packed RGB bytes into opaque pixels.
+void packRGB(const uint8_t* source, uint32_t* destination, size_t pixelCount);
+
+// Packs tightly packed RGBA bytes into pixels, premultiplying the color channels by alpha if
+// requested. Returns true if any of the pixels is not fully opaque.
+bool packRGBA(const uint8_t* source, uint32_t* destination, size_t pixelCount, bool premultiplyAlpha);
+
+// Looks every index up in a 256 entry palette of pixels. Transparent palette entries must be 0;
+// they are only written when writeTransparentPixels is true. Returns true if any of the indices
+// referred to a transparent entry.
+bool expandPalette(const uint8_t* indices, const uint32_t* palette, uint32_t* destination, size_t pixelCount, bool writeTransparentPixels);
+
+} // namespace PixelRowConversion
+
+} // namespace WebCore
+
+#endif // PixelRowConversion_h
@@ -31,11 +31,13 @@
 #include "ShadowBlur.h"
 
 #include "AffineTransform.h"
+#include "BoxBlur.h"
 #include "FloatQuad.h"
 #include "GraphicsContext.h"
 #include "ImageBuffer.h"
 #include "Timer.h"
 #include <wtf/MathExtras.h>
+#include <wtf/NeverDestroyed.h>
 #include <wtf/Noncopyable.h>
 
 namespace WebCore {
@@ -159,6 +161,125 @@ ScratchBuffer& ScratchBuffer::singleton()
     return scratchBuffer;
 }
 
+// Blurred and colored nine-slice templates of rounded rect shadows. A template only depends on the
+// blur radius, corner radii and color of a shadow, not on the size of the rect it is drawn for, so
+// boxes with the same shadow share it across elements and paints. Pages only use a handful of
+// different shadows, so templates are looked up linearly, the most recently used one last.
+class ShadowTemplateCache {
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    struct Key {
+        bool isInset;
+        bool shadowsIgnoreTransforms;
+        FloatSize blurRadius;
+        Color color;
+        FloatRoundedRect::Radii radii;
+
+        bool operator==(const Key& other) const
+        {
+            return isInset == other.isInset && shadowsIgnoreTransforms == other.shadowsIgnoreTransforms
+                && blurRadius == other.blurRadius && color == other.color && radii == other.radii;
+        }
+    };
+
+    ShadowTemplateCache()
+        : m_purgeTimer(*this, &ShadowTemplateCache::clear)
+    {
+    }
+
+    ImageBuffer* find(const Key& key)
+    {
+        for (size_t i = m_templates.size(); i; --i) {
+            if (!(m_templates[i - 1].key == key))
+                continue;
+
+            if (i != m_templates.size()) {
+                Template shadowTemplate = WTF::move(m_templates[i - 1]);
+                m_templates.remove(i - 1);
+                m_templates.append(WTF::move(shadowTemplate));
+            }
+            ++m_hits;
+            return m_templates.last().image.get();
+        }
+        ++m_misses;
+        return nullptr;
+    }
+
+    // Evicts the least recently used templates to make room for the new one. A template larger
+    // than the whole budget isn't cached, and is handed back to be drawn once.
+    std::unique_ptr<ImageBuffer> add(const Key& key, std::unique_ptr<ImageBuffer> image)
+    {
+        IntSize size = image->internalSize();
+        size_t bytes = size.width() * size.height() * 4;
+        if (bytes > maximumBytes)
+            return image;
+
+        while (!m_templates.isEmpty() && (m_templates.size() >= maximumTemplateCount || m_bytes + bytes > maximumBytes)) {
+            m_bytes -= m_templates.first().bytes;
+            m_templates.remove(0);
+            ++m_evictedTemplates;
+        }
+
+        m_templates.append(Template { key, WTF::move(image), bytes });
+        m_bytes += bytes;
+        return nullptr;
+    }
+
+    void schedulePurge()
+    {
+        if (m_purgeTimer.isActive())
+            m_purgeTimer.stop();
+
+        // Long enough to outlive a scroll or an animation, during which the same shadows are painted again and again.
+        const double templatePurgeInterval = 10;
+        m_purgeTimer.startOneShot(templatePurgeInterval);
+    }
+
+    void clear()
+    {
+        m_templates.clear();
+        m_bytes = 0;
+    }
+
+    ShadowBlur::TemplateCacheStats stats() const
+    {
+        ShadowBlur::TemplateCacheStats stats;
+        stats.templateCount = m_templates.size();
+        stats.bytes = m_bytes;
+        stats.maximumTemplateCount = maximumTemplateCount;
+        stats.maximumBytes = maximumBytes;
+        stats.hits = m_hits;
+        stats.misses = m_misses;
+        stats.evictedTemplates = m_evictedTemplates;
+        return stats;
+    }
+
+    static ShadowTemplateCache& singleton();
+
+private:
+    static const size_t maximumTemplateCount = 32;
+    static const size_t maximumBytes = 2 * 1024 * 1024;
+
+    struct Template {
+        Key key;
+        std::unique_ptr<ImageBuffer> image;
+        size_t bytes;
+    };
+
+    Vector<Template> m_templates;
+    size_t m_bytes { 0 };
+    unsigned m_hits { 0 };
+    unsigned m_misses { 0 };
+    unsigned m_evictedTemplates { 0 };
+    Timer m_purgeTimer;
+};
+
+ShadowTemplateCache& ShadowTemplateCache::singleton()
+{
+    static NeverDestroyed<ShadowTemplateCache> templateCache;
+    return templateCache;
+}
+
 static const int templateSideLength = 1;
 
 #if USE(CG)
@@ -230,9 +351,6 @@ void ShadowBlur::updateShadowBlurValues()
         m_type = SolidShadow;
 }
 
-// Instead of integer division, we use 17.15 for fixed-point division.
-static const int blurSumShift = 15;
-
 // Takes a two dimensional array with three rows and two columns for the lobes.
 static void calculateLobes(int lobes[][2], float blurRadius, bool shadowsIgnoreTransforms)
 {
@@ -274,6 +392,16 @@ static void calculateLobes(int lobes[][2], float blurRadius, bool shadowsIgnoreT
     }
 }
 
+void ShadowBlur::purgeTemplateCache()
+{
+    ShadowTemplateCache::singleton().clear();
+}
+
+ShadowBlur::TemplateCacheStats ShadowBlur::templateCacheStats()
+{
+    return ShadowTemplateCache::singleton().stats();
+}
+
 void ShadowBlur::clear()
 {
     m_type = NoShadow;
@@ -284,83 +412,24 @@ void ShadowBlur::clear()
 
 void ShadowBlur::blurLayerImage(unsigned char* imageData, const IntSize& size, int rowStride)
 {
+    // Only the alpha channel matters. Each step blurs the alpha in a channel and stores the
+    // result in another channel for the subsequent step, so the image is blurred in place.
     const int channels[4] = { 3, 0, 1, 3 };
 
     int lobes[3][2]; // indexed by pass, and left/right lobe
-    calculateLobes(lobes, m_blurRadius.width(), m_shadowsIgnoreTransforms);
 
     // First pass is horizontal.
-    int stride = 4;
-    int delta = rowStride;
-    int final = size.height();
-    int dim = size.width();
-
-    // Two stages: horizontal and vertical
-    for (int pass = 0; pass < 2; ++pass) {
-        unsigned char* pixels = imageData;
-        
-        if (!pass && !m_blurRadius.width())
-            final = 0; // Do no work if horizonal blur is zero.
-
-        for (int j = 0; j < final; ++j, pixels += delta) {
-            // For each step, we blur the alpha in a channel and store the result
-            // in another channel for the subsequent step.
-            // We use sliding window algorithm to accumulate the alpha values.
-            // This is much more efficient than computing the sum of each pixels
-            // covered by the box kernel size for each x.
-            for (int step = 0; step < 3; ++step) {
-                int side1 = lobes[step][leftLobe];
-                int side2 = lobes[step][rightLobe];
-                int pixelCount = side1 + 1 + side2;
-                int invCount = ((1 << blurSumShift) + pixelCount - 1) / pixelCount;
-                int ofs = 1 + side2;
-                int alpha1 = pixels[channels[step]];
-                int alpha2 = pixels[(dim - 1) * stride + channels[step]];
-
-                unsigned char* ptr = pixels + channels[step + 1];
-                unsigned char* prev = pixels + stride + channels[step];
-                unsigned char* next = pixels + ofs * stride + channels[step];
-
-                int i;
-                int sum = side1 * alpha1 + alpha1;
-                int limit = (dim < side2 + 1) ? dim : side2 + 1;
-
-                for (i = 1; i < limit; ++i, prev += stride)
-                    sum += *prev;
-
-                if (limit <= side2)
-                    sum += (side2 - limit + 1) * alpha2;
-
-                limit = (side1 < dim) ? side1 : dim;
-                for (i = 0; i < limit; ptr += stride, next += stride, ++i, ++ofs) {
-                    *ptr = (sum * invCount) >> blurSumShift;
-                    sum += ((ofs < dim) ? *next : alpha2) - alpha1;
-                }
-                
-                prev = pixels + channels[step];
-                for (; ofs < dim; ptr += stride, prev += stride, next += stride, ++i, ++ofs) {
-                    *ptr = (sum * invCount) >> blurSumShift;
-                    sum += (*next) - (*prev);
-                }
-                
-                for (; i < dim; ptr += stride, prev += stride, ++i) {
-                    *ptr = (sum * invCount) >> blurSumShift;
-                    sum += alpha2 - (*prev);
-                }
-            }
-        }
-
-        // Last pass is vertical.
-        stride = rowStride;
-        delta = 4;
-        final = size.width();
-        dim = size.height();
-
-        if (!m_blurRadius.height())
-            break;
+    if (m_blurRadius.width()) {
+        calculateLobes(lobes, m_blurRadius.width(), m_shadowsIgnoreTransforms);
+        for (int step = 0; step < 3; ++step)
+            boxBlurChannelLines(imageData + channels[step], imageData + channels[step + 1], 4, rowStride, size.width(), size.height(), lobes[step][leftLobe], lobes[step][rightLobe], BoxBlurEdgeMode::Duplicate);
+    }
 
-        if (m_blurRadius.width() != m_blurRadius.height())
-            calculateLobes(lobes, m_blurRadius.height(), m_shadowsIgnoreTransforms);
+    // Last pass is vertical.
+    if (m_blurRadius.height()) {
+        calculateLobes(lobes, m_blurRadius.height(), m_shadowsIgnoreTransforms);
+        for (int step = 0; step < 3; ++step)
+            boxBlurChannelLines(imageData + channels[step], imageData + channels[step + 1], rowStride, 4, size.height(), size.width(), lobes[step][leftLobe], lobes[step][rightLobe], BoxBlurEdgeMode::Duplicate);
     }
 }
 
@@ -666,21 +735,23 @@ void ShadowBlur::drawInsetShadowWithoutTiling(GraphicsContext& graphicsContext,
 
 void ShadowBlur::drawInsetShadowWithTiling(GraphicsContext& graphicsContext, const FloatRect& rect, const FloatRoundedRect& holeRect, const IntSize& templateSize, const IntSize& edgeSize)
 {
-    m_layerImage = ScratchBuffer::singleton().getScratchBuffer(templateSize);
-    if (!m_layerImage)
-        return;
+    auto& templateCache = ShadowTemplateCache::singleton();
+    ShadowTemplateCache::Key templateKey = { true, m_shadowsIgnoreTransforms, m_blurRadius, m_color, holeRect.radii() };
+    std::unique_ptr<ImageBuffer> uncachedTemplate;
+    m_layerImage = templateCache.find(templateKey);
+    if (!m_layerImage) {
+        // ShadowBlur is not used with accelerated drawing, so it's OK to make an unconditionally unaccelerated buffer.
+        std::unique_ptr<ImageBuffer> templateImage = ImageBuffer::create(templateSize, Unaccelerated, 1);
+        if (!templateImage)
+            return;
+        m_layerImage = templateImage.get();
 
-    // Draw the rectangle with hole.
-    FloatRect templateBounds(0, 0, templateSize.width(), templateSize.height());
-    FloatRect templateHole = FloatRect(edgeSize.width(), edgeSize.height(), templateSize.width() - 2 * edgeSize.width(), templateSize.height() - 2 * edgeSize.height());
+        // Draw the rectangle with hole.
+        FloatRect templateBounds(0, 0, templateSize.width(), templateSize.height());
+        FloatRect templateHole = FloatRect(edgeSize.width(), edgeSize.height(), templateSize.width() - 2 * edgeSize.width(), templateSize.height() - 2 * edgeSize.height());
 
-    // Only redraw in the scratch buffer if its cached contents don't match our needs
-    bool redrawNeeded = ScratchBuffer::singleton().setCachedInsetShadowValues(m_blurRadius, m_color, templateBounds, templateHole, holeRect.radii());
-    if (redrawNeeded) {
-        // Draw shadow into a new ImageBuffer.
         GraphicsContext& shadowContext = m_layerImage->context();
         GraphicsContextStateSaver shadowStateSaver(shadowContext);
-        shadowContext.clearRect(templateBounds);
         shadowContext.setFillRule(RULE_EVENODD);
         shadowContext.setFillColor(Color::black);
 
@@ -694,6 +765,7 @@ void ShadowBlur::drawInsetShadowWithTiling(GraphicsContext& graphicsContext, con
         shadowContext.fillPath(path);
 
         blurAndColorShadowBuffer(templateSize);
+        uncachedTemplate = templateCache.add(templateKey, WTF::move(templateImage));
     }
     FloatSize offset = m_offset;
     if (shadowsIgnoreTransforms()) {
@@ -726,28 +798,29 @@ void ShadowBlur::drawInsetShadowWithTiling(GraphicsContext& graphicsContext, con
     drawLayerPieces(graphicsContext, destHoleBounds, holeRect.radii(), edgeSize, templateSize, InnerShadow);
 
     m_layerImage = nullptr;
-    ScratchBuffer::singleton().scheduleScratchBufferPurge();
+    templateCache.schedulePurge();
 }
 
 void ShadowBlur::drawRectShadowWithTiling(GraphicsContext& graphicsContext, const FloatRoundedRect& shadowedRect, const IntSize& templateSize, const IntSize& edgeSize)
 {
-    auto& scratchBuffer = ScratchBuffer::singleton();
-    m_layerImage = scratchBuffer.getScratchBuffer(templateSize);
-    if (!m_layerImage)
-        return;
+    auto& templateCache = ShadowTemplateCache::singleton();
+    ShadowTemplateCache::Key templateKey = { false, m_shadowsIgnoreTransforms, m_blurRadius, m_color, shadowedRect.radii() };
+    std::unique_ptr<ImageBuffer> uncachedTemplate;
+    m_layerImage = templateCache.find(templateKey);
+    if (!m_layerImage) {
+        // ShadowBlur is not used with accelerated drawing, so it's OK to make an unconditionally unaccelerated buffer.
+        std::unique_ptr<ImageBuffer> templateImage = ImageBuffer::create(templateSize, Unaccelerated, 1);
+        if (!templateImage)
+            return;
+        m_layerImage = templateImage.get();
 
-    FloatRect templateShadow = FloatRect(edgeSize.width(), edgeSize.height(), templateSize.width() - 2 * edgeSize.width(), templateSize.height() - 2 * edgeSize.height());
+        FloatRect templateShadow = FloatRect(edgeSize.width(), edgeSize.height(), templateSize.width() - 2 * edgeSize.width(), templateSize.height() - 2 * edgeSize.height());
 
-    // Only redraw in the scratch buffer if its cached contents don't match our needs
-    bool redrawNeeded = scratchBuffer.setCachedShadowValues(m_blurRadius, m_color, templateShadow, shadowedRect.radii(), m_layerSize);
-    if (redrawNeeded) {
         // Draw shadow into the ImageBuffer.
         GraphicsContext& shadowContext = m_layerImage->context();
         GraphicsContextStateSaver shadowStateSaver(shadowContext);
-
-        shadowContext.clearRect(FloatRect(0, 0, templateSize.width(), templateSize.height()));
         shadowContext.setFillColor(Color::black);
-        
+
         if (shadowedRect.radii().isZero())
             shadowContext.fillRect(templateShadow);
         else {
@@ -757,6 +830,7 @@ void ShadowBlur::drawRectShadowWithTiling(GraphicsContext& graphicsContext, cons
         }
 
         blurAndColorShadowBuffer(templateSize);
+        uncachedTemplate = templateCache.add(templateKey, WTF::move(templateImage));
     }
     FloatSize offset = m_offset;
     if (shadowsIgnoreTransforms()) {
@@ -772,7 +846,7 @@ void ShadowBlur::drawRectShadowWithTiling(GraphicsContext& graphicsContext, cons
     drawLayerPieces(graphicsContext, shadowBounds, shadowedRect.radii(), edgeSize, templateSize, OuterShadow);
 
     m_layerImage = nullptr;
-    ScratchBuffer::singleton().scheduleScratchBufferPurge();
+    templateCache.schedulePurge();
 }
 
 void ShadowBlur::drawLayerPieces(GraphicsContext& graphicsContext, const FloatRect& shadowBounds, const FloatRoundedRect::Radii& radii, const IntSize& bufferPadding, const IntSize& templateSize, ShadowDirection direction)
@@ -72,6 +72,20 @@ public:
 
     ShadowType type() const { return m_type; }
 
+    // Drops the blurred templates that rounded rect shadows keep for reuse, on memory pressure.
+    static void purgeTemplateCache();
+
+    struct TemplateCacheStats {
+        unsigned templateCount { 0 };
+        size_t bytes { 0 };
+        unsigned maximumTemplateCount { 0 };
+        size_t maximumBytes { 0 };
+        unsigned hits { 0 };
+        unsigned misses { 0 };
+        unsigned evictedTemplates { 0 };
+    };
+    static TemplateCacheStats templateCacheStats();
+
 private:
     void updateShadowBlurValues();
 
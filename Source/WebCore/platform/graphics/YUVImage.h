@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef YUVImage_h
+#define YUVImage_h
+
+#include "IntSize.h"
+#include <wtf/PassRefPtr.h>
+#include <wtf/ThreadSafeRefCounted.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+// Planar 8-bit YCbCr samples, as stored in JPEG files, for converting to RGB on the GPU.
+// The chroma planes may be subsampled. All planes are padded to the same number of
+// subsampling units, so a coordinate normalized to the padded size of one plane refers
+// to the same point of the image in every plane.
+class YUVImage : public ThreadSafeRefCounted<YUVImage> {
+public:
+    enum Plane { YPlane, CbPlane, CrPlane };
+    static const unsigned planeCount = 3;
+
+    static PassRefPtr<YUVImage> create(const IntSize& size) { return adoptRef(new YUVImage(size)); }
+
+    // The size of the image, in luma samples.
+    const IntSize& size() const { return m_size; }
+
+    uint8_t* allocatePlane(Plane plane, const IntSize& paddedSize)
+    {
+        m_planes[plane].paddedSize = paddedSize;
+        m_planes[plane].samples.resize(paddedSize.width() * paddedSize.height());
+        return m_planes[plane].samples.data();
+    }
+
+    // Rows are paddedPlaneSize(plane).width() samples long.
+    const IntSize& paddedPlaneSize(Plane plane) const { return m_planes[plane].paddedSize; }
+    const uint8_t* planeData(Plane plane) const { return m_planes[plane].samples.data(); }
+
+    size_t sizeInBytes() const
+    {
+        size_t size = 0;
+        for (auto& plane : m_planes)
+            size += plane.samples.size();
+        return size;
+    }
+
+private:
+    explicit YUVImage(const IntSize& size)
+        : m_size(size)
+    {
+    }
+
+    struct PlaneData {
+        IntSize paddedSize;
+        Vector<uint8_t> samples;
+    };
+
+    IntSize m_size;
+    PlaneData m_planes[planeCount];
+};
+
+} // namespace WebCore
+
+#endif // YUVImage_h
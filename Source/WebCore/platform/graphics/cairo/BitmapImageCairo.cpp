@@ -38,6 +38,9 @@
 
 namespace WebCore {
 
+// Painted in place of a frame that is still being decoded on another thread.
+static const RGBA32 asyncDecodingPlaceholderColor = 0xffeeeeee;
+
 BitmapImage::BitmapImage(PassRefPtr<cairo_surface_t> nativeImage, ImageObserver* observer)
     : Image(observer)
     , m_size(cairoSurfaceSize(nativeImage.get()))
@@ -55,6 +58,7 @@ BitmapImage::BitmapImage(PassRefPtr<cairo_surface_t> nativeImage, ImageObserver*
     , m_haveSize(true)
     , m_sizeAvailable(true)
     , m_haveFrameCount(true)
+    , m_asyncDecodingFailed(false)
 {
     m_frames.grow(1);
     m_frames[0].m_hasAlpha = cairo_surface_get_content(nativeImage.get()) != CAIRO_CONTENT_COLOR;
@@ -72,9 +76,17 @@ void BitmapImage::draw(GraphicsContext& context, const FloatRect& dst, const Flo
 
     startAnimation();
 
-    RefPtr<cairo_surface_t> surface = frameAtIndex(m_currentFrame);
-    if (!surface) // If it's too early we won't have an image yet.
+    FloatRect transformedDestinationRect = context.getCTM().mapRect(dst);
+    float subsamplingScale = std::min<float>(1, std::max(transformedDestinationRect.width() / src.width(), transformedDestinationRect.height() / src.height()));
+
+    RefPtr<cairo_surface_t> surface = frameAtIndexForPainting(m_currentFrame, subsamplingScale);
+    if (!surface) {
+        // Rather than leave a hole until a frame decoded on another thread arrives, show where the image goes.
+        if (isDecodingAsynchronously())
+            fillWithSolidColor(context, dst, Color(asyncDecodingPlaceholderColor), op);
+        // If it's too early, we won't have an image yet.
         return;
+    }
 
     if (mayFillWithSolidColor()) {
         fillWithSolidColor(context, dst, solidColor(), op);
@@ -89,12 +101,8 @@ void BitmapImage::draw(GraphicsContext& context, const FloatRect& dst, const Flo
     else
         context.setCompositeOperation(op, blendMode);
 
-#if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
-    IntSize scaledSize = cairoSurfaceSize(surface.get());
-    FloatRect adjustedSrcRect = adjustSourceRectForDownSampling(src, scaledSize);
-#else
-    FloatRect adjustedSrcRect(src);
-#endif
+    // Subsampling may have given us a surface that is smaller than size().
+    FloatRect adjustedSrcRect = adjustSourceRectForDownSampling(src, cairoSurfaceSize(surface.get()));
 
     ImageOrientation frameOrientation(description.imageOrientation());
     if (description.respectImageOrientation() == RespectImageOrientation)
@@ -124,7 +132,9 @@ void BitmapImage::draw(GraphicsContext& context, const FloatRect& dst, const Flo
 
 void BitmapImage::determineMinimumSubsamplingLevel() const
 {
-    m_minimumSubsamplingLevel = 0;
+    // Frames are decoded at the size they are painted at, down to 1/8 of the image size. The source
+    // has the final word on whether a frame can be subsampled at all.
+    m_minimumSubsamplingLevel = m_allowSubsampling ? 3 : 0;
 }
 
 void BitmapImage::checkForSolidColor()
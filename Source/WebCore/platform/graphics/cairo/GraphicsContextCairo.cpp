@@ -37,6 +37,7 @@
 
 #include "AffineTransform.h"
 #include "CairoUtilities.h"
+#include "DisplayListRecorder.h"
 #include "DrawErrorUnderline.h"
 #include "FloatConversion.h"
 #include "FloatRect.h"
@@ -199,6 +200,9 @@ AffineTransform GraphicsContext::getCTM(IncludeDeviceScale) const
     if (paintingDisabled())
         return AffineTransform();
 
+    if (isRecording())
+        return m_displayListRecorder->getCTM();
+
     cairo_t* cr = platformContext()->cr();
     cairo_matrix_t m;
     cairo_get_matrix(cr, &m);
@@ -207,6 +211,7 @@ AffineTransform GraphicsContext::getCTM(IncludeDeviceScale) const
 
 PlatformContextCairo* GraphicsContext::platformContext() const
 {
+    ASSERT(!isRecording());
     return m_data->platformContext;
 }
 
@@ -228,11 +233,16 @@ void GraphicsContext::restorePlatformState()
 }
 
 // Draws a filled rectangle with a stroked border.
-void GraphicsContext::drawRect(const FloatRect& rect, float)
+void GraphicsContext::drawRect(const FloatRect& rect, float borderThickness)
 {
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->drawRect(rect, borderThickness);
+        return;
+    }
+
     ASSERT(!rect.isEmpty());
 
     cairo_t* cr = platformContext()->cr();
@@ -258,6 +268,11 @@ void GraphicsContext::drawLine(const FloatPoint& point1, const FloatPoint& point
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->drawLine(point1, point2);
+        return;
+    }
+
     if (strokeStyle() == NoStroke)
         return;
 
@@ -346,6 +361,11 @@ void GraphicsContext::drawEllipse(const FloatRect& rect)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->drawEllipse(rect);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
     cairo_save(cr);
     float yRadius = .5 * rect.height();
@@ -373,6 +393,11 @@ void GraphicsContext::drawConvexPolygon(size_t npoints, const FloatPoint* points
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->drawConvexPolygon(npoints, points, shouldAntialias);
+        return;
+    }
+
     if (npoints <= 1)
         return;
 
@@ -403,6 +428,11 @@ void GraphicsContext::clipConvexPolygon(size_t numPoints, const FloatPoint* poin
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->clipConvexPolygon(numPoints, points, antialiased);
+        return;
+    }
+
     if (numPoints <= 1)
         return;
 
@@ -426,6 +456,11 @@ void GraphicsContext::fillPath(const Path& path)
     if (paintingDisabled() || path.isEmpty())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->fillPath(path);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
     setPathOnCairoContext(cr, path.platformPath()->context());
     shadowAndFillCurrentCairoPath(*this);
@@ -436,6 +471,11 @@ void GraphicsContext::strokePath(const Path& path)
     if (paintingDisabled() || path.isEmpty())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->strokePath(path);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
     setPathOnCairoContext(cr, path.platformPath()->context());
     shadowAndStrokeCurrentCairoPath(*this);
@@ -446,6 +486,11 @@ void GraphicsContext::fillRect(const FloatRect& rect)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->fillRect(rect);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
     cairo_rectangle(cr, rect.x(), rect.y(), rect.width(), rect.height());
     shadowAndFillCurrentCairoPath(*this);
@@ -456,6 +501,11 @@ void GraphicsContext::fillRect(const FloatRect& rect, const Color& color)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->fillRect(rect, color);
+        return;
+    }
+
     if (hasShadow())
         platformContext()->shadowBlur().drawRectShadow(*this, FloatRoundedRect(rect));
 
@@ -467,6 +517,11 @@ void GraphicsContext::clip(const FloatRect& rect)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->clip(rect);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
     cairo_rectangle(cr, rect.x(), rect.y(), rect.width(), rect.height());
     cairo_fill_rule_t savedFillRule = cairo_get_fill_rule(cr);
@@ -489,6 +544,11 @@ void GraphicsContext::clipPath(const Path& path, WindRule clipRule)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->clipPath(path, clipRule);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
     if (!path.isNull())
         setPathOnCairoContext(cr, path.platformPath()->context());
@@ -503,6 +563,9 @@ void GraphicsContext::clipPath(const Path& path, WindRule clipRule)
 
 IntRect GraphicsContext::clipBounds() const
 {
+    if (isRecording())
+        return m_displayListRecorder->clipBounds();
+
     double x1, x2, y1, y2;
     cairo_clip_extents(platformContext()->cr(), &x1, &y1, &x2, &y2);
     return enclosingIntRect(FloatRect(x1, y1, x2 - x1, y2 - y1));
@@ -536,8 +599,16 @@ static inline StrokeStyle focusRingStrokeStyle()
 #endif
 }
 
-void GraphicsContext::drawFocusRing(const Path& path, int width, int /* offset */, const Color& color)
+void GraphicsContext::drawFocusRing(const Path& path, int width, int offset, const Color& color)
 {
+    if (paintingDisabled())
+        return;
+
+    if (isRecording()) {
+        m_displayListRecorder->drawFocusRing(path, width, offset, color);
+        return;
+    }
+
     // FIXME: We should draw paths that describe a rectangle with rounded corners
     // so as to be consistent with how we draw rectangular focus rings.
     Color ringColor = color;
@@ -554,11 +625,16 @@ void GraphicsContext::drawFocusRing(const Path& path, int width, int /* offset *
     cairo_restore(cr);
 }
 
-void GraphicsContext::drawFocusRing(const Vector<IntRect>& rects, int width, int /* offset */, const Color& color)
+void GraphicsContext::drawFocusRing(const Vector<IntRect>& rects, int width, int offset, const Color& color)
 {
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->drawFocusRing(rects, width, offset, color);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
     cairo_save(cr);
     cairo_push_group(cr);
@@ -621,6 +697,11 @@ void GraphicsContext::drawLinesForText(const FloatPoint& point, const DashArray&
     if (widths.size() <= 0)
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->drawLinesForText(point, widths, printing, doubleUnderlines);
+        return;
+    }
+
     Color localStrokeColor(strokeColor());
 
     bool shouldAntialiasLine;
@@ -657,6 +738,11 @@ void GraphicsContext::drawLineForDocumentMarker(const FloatPoint& origin, float
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->drawLineForDocumentMarker(origin, width, style);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
     cairo_save(cr);
 
@@ -679,6 +765,9 @@ void GraphicsContext::drawLineForDocumentMarker(const FloatPoint& origin, float
 
 FloatRect GraphicsContext::roundToDevicePixels(const FloatRect& frect, RoundingMode)
 {
+    if (isRecording())
+        return m_displayListRecorder->roundToDevicePixels(frect);
+
     FloatRect result;
     double x = frect.x();
     double y = frect.y();
@@ -719,6 +808,11 @@ void GraphicsContext::translate(float x, float y)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->translate(x, y);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
     cairo_translate(cr, x, y);
     m_data->translate(x, y);
@@ -738,7 +832,7 @@ void GraphicsContext::setPlatformStrokeColor(const Color&)
 
 void GraphicsContext::setPlatformStrokeThickness(float strokeThickness)
 {
-    if (paintingDisabled())
+    if (paintingDisabled() || isRecording())
         return;
 
     cairo_set_line_width(platformContext()->cr(), strokeThickness);
@@ -749,7 +843,7 @@ void GraphicsContext::setPlatformStrokeStyle(StrokeStyle strokeStyle)
     static const double dashPattern[] = { 5.0, 5.0 };
     static const double dotPattern[] = { 1.0, 1.0 };
 
-    if (paintingDisabled())
+    if (paintingDisabled() || isRecording())
         return;
 
     switch (strokeStyle) {
@@ -781,6 +875,11 @@ void GraphicsContext::concatCTM(const AffineTransform& transform)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->concatCTM(transform);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
     const cairo_matrix_t matrix = cairo_matrix_t(transform);
     cairo_transform(cr, &matrix);
@@ -792,6 +891,11 @@ void GraphicsContext::setCTM(const AffineTransform& transform)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->setCTM(transform);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
     const cairo_matrix_t matrix = cairo_matrix_t(transform);
     cairo_set_matrix(cr, &matrix);
@@ -800,7 +904,7 @@ void GraphicsContext::setCTM(const AffineTransform& transform)
 
 void GraphicsContext::setPlatformShadow(FloatSize const& size, float, Color const&)
 {
-    if (paintingDisabled())
+    if (paintingDisabled() || isRecording())
         return;
 
     if (m_state.shadowsIgnoreTransforms) {
@@ -818,7 +922,7 @@ void GraphicsContext::setPlatformShadow(FloatSize const& size, float, Color cons
 
 void GraphicsContext::clearPlatformShadow()
 {
-    if (paintingDisabled())
+    if (paintingDisabled() || isRecording())
         return;
 
     platformContext()->shadowBlur().clear();
@@ -826,7 +930,7 @@ void GraphicsContext::clearPlatformShadow()
 
 void GraphicsContext::beginPlatformTransparencyLayer(float opacity)
 {
-    if (paintingDisabled())
+    if (paintingDisabled() || isRecording())
         return;
 
     cairo_t* cr = platformContext()->cr();
@@ -836,7 +940,7 @@ void GraphicsContext::beginPlatformTransparencyLayer(float opacity)
 
 void GraphicsContext::endPlatformTransparencyLayer()
 {
-    if (paintingDisabled())
+    if (paintingDisabled() || isRecording())
         return;
 
     cairo_t* cr = platformContext()->cr();
@@ -856,6 +960,11 @@ void GraphicsContext::clearRect(const FloatRect& rect)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->clearRect(rect);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
 
     cairo_save(cr);
@@ -870,6 +979,11 @@ void GraphicsContext::strokeRect(const FloatRect& rect, float width)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->strokeRect(rect, width);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
     cairo_save(cr);
     cairo_rectangle(cr, rect.x(), rect.y(), rect.width(), rect.height());
@@ -883,6 +997,11 @@ void GraphicsContext::setLineCap(LineCap lineCap)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->setLineCap(lineCap);
+        return;
+    }
+
     cairo_line_cap_t cairoCap = CAIRO_LINE_CAP_BUTT;
     switch (lineCap) {
     case ButtCap:
@@ -909,6 +1028,14 @@ static inline bool isDashArrayAllZero(const DashArray& dashes)
 
 void GraphicsContext::setLineDash(const DashArray& dashes, float dashOffset)
 {
+    if (paintingDisabled())
+        return;
+
+    if (isRecording()) {
+        m_displayListRecorder->setLineDash(dashes, dashOffset);
+        return;
+    }
+
     if (isDashArrayAllZero(dashes))
         cairo_set_dash(platformContext()->cr(), 0, 0, 0);
     else
@@ -920,6 +1047,11 @@ void GraphicsContext::setLineJoin(LineJoin lineJoin)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->setLineJoin(lineJoin);
+        return;
+    }
+
     cairo_line_join_t cairoJoin = CAIRO_LINE_JOIN_MITER;
     switch (lineJoin) {
     case MiterJoin:
@@ -940,17 +1072,25 @@ void GraphicsContext::setMiterLimit(float miter)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->setMiterLimit(miter);
+        return;
+    }
+
     cairo_set_miter_limit(platformContext()->cr(), miter);
 }
 
 void GraphicsContext::setPlatformAlpha(float alpha)
 {
+    if (paintingDisabled() || isRecording())
+        return;
+
     platformContext()->setGlobalAlpha(alpha);
 }
 
 void GraphicsContext::setPlatformCompositeOperation(CompositeOperator op, BlendMode blendOp)
 {
-    if (paintingDisabled())
+    if (paintingDisabled() || isRecording())
         return;
 
     cairo_operator_t cairo_op;
@@ -972,6 +1112,11 @@ void GraphicsContext::clipOut(const Path& path)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->clipOut(path);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
     double x1, y1, x2, y2;
     cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
@@ -989,6 +1134,11 @@ void GraphicsContext::rotate(float radians)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->rotate(radians);
+        return;
+    }
+
     cairo_rotate(platformContext()->cr(), radians);
     m_data->rotate(radians);
 }
@@ -998,6 +1148,11 @@ void GraphicsContext::scale(const FloatSize& size)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->scale(size);
+        return;
+    }
+
     cairo_scale(platformContext()->cr(), size.width(), size.height());
     m_data->scale(size);
 }
@@ -1007,6 +1162,11 @@ void GraphicsContext::clipOut(const FloatRect& r)
     if (paintingDisabled())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->clipOut(r);
+        return;
+    }
+
     cairo_t* cr = platformContext()->cr();
     double x1, y1, x2, y2;
     cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
@@ -1041,6 +1201,11 @@ void GraphicsContext::fillRectWithRoundedHole(const FloatRect& rect, const Float
     if (paintingDisabled() || !color.isValid())
         return;
 
+    if (isRecording()) {
+        m_displayListRecorder->fillRectWithRoundedHole(rect, roundedHoleRect, color);
+        return;
+    }
+
     if (this->mustUseShadowBlur())
         platformContext()->shadowBlur().drawInsetShadow(*this, rect, roundedHoleRect);
 
@@ -1058,8 +1223,16 @@ void GraphicsContext::fillRectWithRoundedHole(const FloatRect& rect, const Float
     cairo_restore(cr);
 }
 
-void GraphicsContext::drawPattern(Image& image, const FloatRect& tileRect, const AffineTransform& patternTransform, const FloatPoint& phase, const FloatSize&, CompositeOperator op, const FloatRect& destRect, BlendMode blendMode)
+void GraphicsContext::drawPattern(Image& image, const FloatRect& tileRect, const AffineTransform& patternTransform, const FloatPoint& phase, const FloatSize& spacing, CompositeOperator op, const FloatRect& destRect, BlendMode blendMode)
 {
+    if (paintingDisabled())
+        return;
+
+    if (isRecording()) {
+        m_displayListRecorder->drawPattern(image, tileRect, patternTransform, phase, spacing, op, destRect, blendMode);
+        return;
+    }
+
     RefPtr<cairo_surface_t> surface = image.nativeImageForCurrentFrame();
     if (!surface) // If it's too early we won't have an image yet.
         return;
@@ -1076,7 +1249,7 @@ void GraphicsContext::drawPattern(Image& image, const FloatRect& tileRect, const
 
 void GraphicsContext::setPlatformShouldAntialias(bool enable)
 {
-    if (paintingDisabled())
+    if (paintingDisabled() || isRecording())
         return;
 
     // When true, use the default Cairo backend antialias mode (usually this
@@ -1087,11 +1260,17 @@ void GraphicsContext::setPlatformShouldAntialias(bool enable)
 
 void GraphicsContext::setPlatformImageInterpolationQuality(InterpolationQuality quality)
 {
+    if (isRecording())
+        return;
+
     platformContext()->setImageInterpolationQuality(quality);
 }
 
 bool GraphicsContext::isAcceleratedContext() const
 {
+    if (isRecording())
+        return false;
+
     return cairo_surface_get_type(cairo_get_target(platformContext()->cr())) == CAIRO_SURFACE_TYPE_GL;
 }
 
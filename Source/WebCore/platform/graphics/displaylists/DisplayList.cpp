@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "DisplayList.h"
+
+#include "TextStream.h"
+
+namespace WebCore {
+namespace DisplayList {
+
+FloatRect DisplayList::bounds() const
+{
+    FloatRect bounds;
+    for (auto& item : m_list) {
+        if (!is<DrawingItem>(item.get()))
+            continue;
+
+        auto& extent = downcast<DrawingItem>(item.get()).extent();
+        if (!extent)
+            return FloatRect::infiniteRect();
+        bounds.unite(extent.value());
+    }
+    return bounds;
+}
+
+static bool stateCanBeUsedOnWorkerThread(const GraphicsContextState& state)
+{
+    if (state.fillGradient || state.fillPattern || state.strokeGradient || state.strokePattern)
+        return false;
+    return !state.shadowColor.isValid() || !state.shadowColor.alpha();
+}
+
+bool DisplayList::canReplayOnWorkerThread() const
+{
+    if (!m_isReplayable)
+        return false;
+
+    for (auto& item : m_list) {
+        switch (item->type()) {
+        case ItemType::DrawImage:
+        case ItemType::DrawTiledImage:
+        case ItemType::DrawTiledScaledImage:
+        case ItemType::DrawPattern:
+        case ItemType::FillRectWithGradient:
+            return false;
+        case ItemType::SetState:
+            if (!stateCanBeUsedOnWorkerThread(static_cast<const SetState&>(item.get()).state()))
+                return false;
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+String DisplayList::asText() const
+{
+    TextStream ts;
+    for (size_t i = 0; i < m_list.size(); ++i)
+        ts << i << ": " << m_list[i].get() << "\n";
+    return ts.release();
+}
+
+} // namespace DisplayList
+} // namespace WebCore
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DisplayList_h
+#define DisplayList_h
+
+#include "DisplayListItems.h"
+#include <wtf/FastMalloc.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+#include <wtf/text/WTFString.h>
+
+namespace WebCore {
+
+namespace DisplayList {
+
+// A display list is an immutable-once-recorded sequence of GraphicsContext operations,
+// produced by a Recorder and consumed by a Replayer. Painting into a display list is
+// decoupled from rasterization: the same list can be replayed into several contexts,
+// at different scales, or only partially when a subregion needs to be redrawn.
+class DisplayList {
+    WTF_MAKE_NONCOPYABLE(DisplayList); WTF_MAKE_FAST_ALLOCATED;
+    friend class Recorder;
+public:
+    DisplayList() { }
+    DisplayList(DisplayList&&) = default;
+
+    DisplayList& operator=(DisplayList&&) = default;
+
+    void clear()
+    {
+        m_list.clear();
+        m_isReplayable = true;
+    }
+    void shrinkToFit() { m_list.shrinkToFit(); }
+
+    bool isEmpty() const { return m_list.isEmpty(); }
+
+    // False when some painting code could not be recorded, like native theme parts drawn
+    // straight into a platform context. Replaying such a list would leave them out, so the
+    // area it was recorded for has to be painted directly instead.
+    bool isReplayable() const { return m_isReplayable; }
+    size_t itemCount() const { return m_list.size(); }
+
+    const Item& itemAt(size_t index) const { return m_list[index].get(); }
+
+    // Union of the extents of all the drawing items, or the infinite rect if some
+    // drawing item has no extent.
+    WEBCORE_EXPORT FloatRect bounds() const;
+
+    // Whether replaying the list only touches objects owned by the list or safe to share
+    // between threads. Images, patterns and gradients cache decoded or platform data lazily,
+    // and shadows go through a shared scratch buffer, so lists using them must be replayed
+    // on the main thread.
+    WEBCORE_EXPORT bool canReplayOnWorkerThread() const;
+
+    WEBCORE_EXPORT String asText() const;
+
+private:
+    void append(Ref<Item>&& item) { m_list.append(WTF::move(item)); }
+
+    Vector<Ref<Item>> m_list;
+    bool m_isReplayable { true };
+};
+
+} // namespace DisplayList
+
+} // namespace WebCore
+
+#endif // DisplayList_h
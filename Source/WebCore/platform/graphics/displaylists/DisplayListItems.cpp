@@ -0,0 +1,492 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "DisplayListItems.h"
+
+#include "FontCascade.h"
+#include "TextStream.h"
+
+namespace WebCore {
+namespace DisplayList {
+
+// Strokes straddle the geometry; sharp miter joins may extend further, up to the default miter limit.
+static const float defaultMiterLimit = 10;
+
+static float strokeOutset(const GraphicsContext& context)
+{
+    return std::max(context.strokeThickness(), 1.0f) / 2;
+}
+
+void Save::apply(GraphicsContext& context) const
+{
+    context.save();
+}
+
+void Restore::apply(GraphicsContext& context) const
+{
+    context.restore();
+}
+
+void Translate::apply(GraphicsContext& context) const
+{
+    context.translate(m_x, m_y);
+}
+
+void Rotate::apply(GraphicsContext& context) const
+{
+    context.rotate(m_angle);
+}
+
+void Scale::apply(GraphicsContext& context) const
+{
+    context.scale(m_size);
+}
+
+void ConcatenateCTM::apply(GraphicsContext& context) const
+{
+    context.concatCTM(m_transform);
+}
+
+bool SetState::statesAreEqual(const GraphicsContextState& a, const GraphicsContextState& b)
+{
+    return a.strokeGradient == b.strokeGradient
+        && a.strokePattern == b.strokePattern
+        && a.fillGradient == b.fillGradient
+        && a.fillPattern == b.fillPattern
+        && a.shadowOffset == b.shadowOffset
+        && a.strokeThickness == b.strokeThickness
+        && a.shadowBlur == b.shadowBlur
+        && a.textDrawingMode == b.textDrawingMode
+        && a.strokeColor == b.strokeColor
+        && a.fillColor == b.fillColor
+        && a.shadowColor == b.shadowColor
+        && a.strokeStyle == b.strokeStyle
+        && a.fillRule == b.fillRule
+        && a.alpha == b.alpha
+        && a.compositeOperator == b.compositeOperator
+        && a.blendMode == b.blendMode
+        && a.imageInterpolationQuality == b.imageInterpolationQuality
+        && a.shouldAntialias == b.shouldAntialias
+        && a.shouldSmoothFonts == b.shouldSmoothFonts
+        && a.antialiasedFontDilationEnabled == b.antialiasedFontDilationEnabled
+        && a.shouldSubpixelQuantizeFonts == b.shouldSubpixelQuantizeFonts
+        && a.shadowsIgnoreTransforms == b.shadowsIgnoreTransforms
+        && a.drawLuminanceMask == b.drawLuminanceMask;
+}
+
+void SetState::apply(GraphicsContext& context) const
+{
+    context.setStrokeThickness(m_state.strokeThickness);
+    context.setStrokeStyle(m_state.strokeStyle);
+    context.setStrokeColor(m_state.strokeColor);
+    if (m_state.strokeGradient)
+        context.setStrokeGradient(*m_state.strokeGradient);
+    else if (m_state.strokePattern)
+        context.setStrokePattern(*m_state.strokePattern);
+
+    context.setFillRule(m_state.fillRule);
+    context.setFillColor(m_state.fillColor);
+    if (m_state.fillGradient)
+        context.setFillGradient(*m_state.fillGradient);
+    else if (m_state.fillPattern)
+        context.setFillPattern(*m_state.fillPattern);
+
+    // The platform shadow depends on shadowsIgnoreTransforms, so that goes first.
+    context.setShadowsIgnoreTransforms(m_state.shadowsIgnoreTransforms);
+    if (m_state.shadowColor.isValid())
+        context.setShadow(m_state.shadowOffset, m_state.shadowBlur, m_state.shadowColor);
+    else
+        context.clearShadow();
+
+    context.setAlpha(m_state.alpha);
+    context.setCompositeOperation(m_state.compositeOperator, m_state.blendMode);
+    context.setImageInterpolationQuality(m_state.imageInterpolationQuality);
+    context.setTextDrawingMode(m_state.textDrawingMode);
+    context.setShouldAntialias(m_state.shouldAntialias);
+    context.setShouldSmoothFonts(m_state.shouldSmoothFonts);
+    context.setAntialiasedFontDilationEnabled(m_state.antialiasedFontDilationEnabled);
+    context.setShouldSubpixelQuantizeFonts(m_state.shouldSubpixelQuantizeFonts);
+    context.setDrawLuminanceMask(m_state.drawLuminanceMask);
+}
+
+void SetLineCap::apply(GraphicsContext& context) const
+{
+    context.setLineCap(m_lineCap);
+}
+
+void SetLineDash::apply(GraphicsContext& context) const
+{
+    context.setLineDash(m_dashArray, m_dashOffset);
+}
+
+void SetLineJoin::apply(GraphicsContext& context) const
+{
+    context.setLineJoin(m_lineJoin);
+}
+
+void SetMiterLimit::apply(GraphicsContext& context) const
+{
+    context.setMiterLimit(m_miterLimit);
+}
+
+void Clip::apply(GraphicsContext& context) const
+{
+    context.clip(m_rect);
+}
+
+void ClipOut::apply(GraphicsContext& context) const
+{
+    context.clipOut(m_rect);
+}
+
+void ClipOutToPath::apply(GraphicsContext& context) const
+{
+    context.clipOut(m_path);
+}
+
+void ClipPath::apply(GraphicsContext& context) const
+{
+    context.clipPath(m_path, m_windRule);
+}
+
+ClipConvexPolygon::ClipConvexPolygon(size_t numberOfPoints, const FloatPoint* points, bool antialiased)
+    : Item(ItemType::ClipConvexPolygon)
+    , m_antialiased(antialiased)
+{
+    m_points.append(points, numberOfPoints);
+}
+
+void ClipConvexPolygon::apply(GraphicsContext& context) const
+{
+    context.clipConvexPolygon(m_points.size(), m_points.data(), m_antialiased);
+}
+
+void ClipToImageBuffer::apply(GraphicsContext& context) const
+{
+    context.clipToImageBuffer(*m_imageBuffer, m_destinationRect);
+}
+
+DrawGlyphs::DrawGlyphs(const Font& font, const GlyphBuffer& glyphBuffer, int from, int numberOfGlyphs, const FloatPoint& point)
+    : DrawingItem(ItemType::DrawGlyphs)
+    , m_font(const_cast<Font&>(font))
+    , m_point(point)
+{
+    m_glyphs.reserveInitialCapacity(numberOfGlyphs);
+    m_advances.reserveInitialCapacity(numberOfGlyphs);
+    for (int i = 0; i < numberOfGlyphs; ++i) {
+        m_glyphs.uncheckedAppend(glyphBuffer.glyphAt(from + i));
+        m_advances.uncheckedAppend(glyphBuffer.advanceAt(from + i));
+    }
+}
+
+void DrawGlyphs::apply(GraphicsContext& context) const
+{
+    GlyphBuffer glyphBuffer;
+    for (size_t i = 0; i < m_glyphs.size(); ++i)
+        glyphBuffer.add(m_glyphs[i], m_font.ptr(), m_advances[i]);
+
+    // The platform glyph drawing code only needs the font data, not the font cascade.
+    context.drawGlyphs(FontCascade(), m_font.get(), glyphBuffer, 0, glyphBuffer.size(), m_point);
+}
+
+Optional<FloatRect> DrawGlyphs::localBounds(const GraphicsContext& context) const
+{
+    float width = 0;
+    for (auto& advance : m_advances)
+        width += advance.width();
+
+    const FontMetrics& fontMetrics = m_font->fontMetrics();
+    FloatRect bounds(m_point.x(), m_point.y() - fontMetrics.floatAscent(), width, fontMetrics.floatHeight());
+
+    // Leave room for glyphs that overhang their advance or the ascent, like italics and diacritics.
+    bounds.inflate(fontMetrics.floatHeight() / 2);
+    if (context.textDrawingMode() & TextModeStroke)
+        bounds.inflate(strokeOutset(context));
+    return bounds;
+}
+
+void DrawImage::apply(GraphicsContext& context) const
+{
+    context.drawImage(m_image.get(), m_destination, m_source, m_imagePaintingOptions);
+}
+
+void DrawTiledImage::apply(GraphicsContext& context) const
+{
+    context.drawTiledImage(m_image.get(), m_destination, m_source, m_tileSize, m_spacing, m_imagePaintingOptions);
+}
+
+void DrawTiledScaledImage::apply(GraphicsContext& context) const
+{
+    context.drawTiledImage(m_image.get(), m_destination, m_source, m_tileScaleFactor, m_hRule, m_vRule, m_imagePaintingOptions);
+}
+
+void DrawPattern::apply(GraphicsContext& context) const
+{
+    context.drawPattern(m_image.get(), m_tileRect, m_patternTransform, m_phase, m_spacing, m_op, m_destination, m_blendMode);
+}
+
+void DrawRect::apply(GraphicsContext& context) const
+{
+    context.drawRect(m_rect, m_borderThickness);
+}
+
+void DrawLine::apply(GraphicsContext& context) const
+{
+    context.drawLine(m_point1, m_point2);
+}
+
+Optional<FloatRect> DrawLine::localBounds(const GraphicsContext& context) const
+{
+    FloatRect bounds;
+    bounds.fitToPoints(m_point1, m_point2);
+    bounds.inflate(strokeOutset(context) + 1);
+    return bounds;
+}
+
+void DrawLinesForText::apply(GraphicsContext& context) const
+{
+    context.drawLinesForText(m_point, m_widths, m_printing, m_doubleLines);
+}
+
+Optional<FloatRect> DrawLinesForText::localBounds(const GraphicsContext& context) const
+{
+    if (m_widths.isEmpty())
+        return FloatRect();
+
+    // The platform code may nudge the origin to a device pixel and draws double lines
+    // one line thickness apart.
+    float thickness = std::max(context.strokeThickness(), 0.5f);
+    FloatRect bounds(m_point, FloatSize(m_widths.last(), thickness * (m_doubleLines ? 3 : 1)));
+    bounds.inflate(1);
+    return bounds;
+}
+
+void DrawLineForDocumentMarker::apply(GraphicsContext& context) const
+{
+    context.drawLineForDocumentMarker(m_point, m_width, m_style);
+}
+
+Optional<FloatRect> DrawLineForDocumentMarker::localBounds(const GraphicsContext&) const
+{
+    FloatRect bounds(m_point, FloatSize(m_width, cMisspellingLineThickness));
+    bounds.inflate(1);
+    return bounds;
+}
+
+void DrawEllipse::apply(GraphicsContext& context) const
+{
+    context.drawEllipse(m_rect);
+}
+
+Optional<FloatRect> DrawEllipse::localBounds(const GraphicsContext& context) const
+{
+    FloatRect bounds = m_rect;
+    bounds.inflate(strokeOutset(context));
+    return bounds;
+}
+
+DrawConvexPolygon::DrawConvexPolygon(size_t numberOfPoints, const FloatPoint* points, bool antialiased)
+    : DrawingItem(ItemType::DrawConvexPolygon)
+    , m_antialiased(antialiased)
+{
+    m_points.append(points, numberOfPoints);
+}
+
+void DrawConvexPolygon::apply(GraphicsContext& context) const
+{
+    context.drawConvexPolygon(m_points.size(), m_points.data(), m_antialiased);
+}
+
+Optional<FloatRect> DrawConvexPolygon::localBounds(const GraphicsContext& context) const
+{
+    if (m_points.isEmpty())
+        return FloatRect();
+
+    FloatRect bounds(m_points[0], FloatSize());
+    for (auto& point : m_points)
+        bounds.extend(point);
+    bounds.inflate(strokeOutset(context) * defaultMiterLimit);
+    return bounds;
+}
+
+void DrawFocusRingPath::apply(GraphicsContext& context) const
+{
+    context.drawFocusRing(m_path, m_width, m_offset, m_color);
+}
+
+Optional<FloatRect> DrawFocusRingPath::localBounds(const GraphicsContext&) const
+{
+    FloatRect bounds = m_path.fastBoundingRect();
+    bounds.inflate(m_width + m_offset);
+    return bounds;
+}
+
+void DrawFocusRingRects::apply(GraphicsContext& context) const
+{
+    context.drawFocusRing(m_rects, m_width, m_offset, m_color);
+}
+
+Optional<FloatRect> DrawFocusRingRects::localBounds(const GraphicsContext&) const
+{
+    FloatRect bounds;
+    for (auto& rect : m_rects)
+        bounds.unite(rect);
+    bounds.inflate(m_width + m_offset);
+    return bounds;
+}
+
+void FillRect::apply(GraphicsContext& context) const
+{
+    context.fillRect(m_rect);
+}
+
+void FillRectWithColor::apply(GraphicsContext& context) const
+{
+    context.fillRect(m_rect, m_color);
+}
+
+void FillRectWithGradient::apply(GraphicsContext& context) const
+{
+    context.fillRect(m_rect, m_gradient.get());
+}
+
+void FillRoundedRect::apply(GraphicsContext& context) const
+{
+    context.fillRoundedRect(m_rect, m_color, m_blendMode);
+}
+
+void FillRectWithRoundedHole::apply(GraphicsContext& context) const
+{
+    context.fillRectWithRoundedHole(m_rect, m_roundedHoleRect, m_color);
+}
+
+void FillPath::apply(GraphicsContext& context) const
+{
+    context.fillPath(m_path);
+}
+
+void StrokeRect::apply(GraphicsContext& context) const
+{
+    context.strokeRect(m_rect, m_lineWidth);
+}
+
+Optional<FloatRect> StrokeRect::localBounds(const GraphicsContext&) const
+{
+    FloatRect bounds = m_rect;
+    bounds.inflate(m_lineWidth / 2);
+    return bounds;
+}
+
+void StrokePath::apply(GraphicsContext& context) const
+{
+    context.strokePath(m_path);
+}
+
+Optional<FloatRect> StrokePath::localBounds(const GraphicsContext& context) const
+{
+    FloatRect bounds = m_path.fastBoundingRect();
+    bounds.inflate(strokeOutset(context) * defaultMiterLimit);
+    return bounds;
+}
+
+void ClearRect::apply(GraphicsContext& context) const
+{
+    context.clearRect(m_rect);
+}
+
+void BeginTransparencyLayer::apply(GraphicsContext& context) const
+{
+    context.beginTransparencyLayer(m_opacity);
+}
+
+void EndTransparencyLayer::apply(GraphicsContext& context) const
+{
+    context.endTransparencyLayer();
+}
+
+static const char* itemTypeName(ItemType type)
+{
+    switch (type) {
+    case ItemType::Save: return "save";
+    case ItemType::Restore: return "restore";
+    case ItemType::Translate: return "translate";
+    case ItemType::Rotate: return "rotate";
+    case ItemType::Scale: return "scale";
+    case ItemType::ConcatenateCTM: return "concatenate-ctm";
+    case ItemType::SetState: return "set-state";
+    case ItemType::SetLineCap: return "set-line-cap";
+    case ItemType::SetLineDash: return "set-line-dash";
+    case ItemType::SetLineJoin: return "set-line-join";
+    case ItemType::SetMiterLimit: return "set-miter-limit";
+    case ItemType::Clip: return "clip";
+    case ItemType::ClipOut: return "clip-out";
+    case ItemType::ClipOutToPath: return "clip-out-to-path";
+    case ItemType::ClipPath: return "clip-path";
+    case ItemType::ClipConvexPolygon: return "clip-convex-polygon";
+    case ItemType::ClipToImageBuffer: return "clip-to-image-buffer";
+    case ItemType::DrawGlyphs: return "draw-glyphs";
+    case ItemType::DrawImage: return "draw-image";
+    case ItemType::DrawTiledImage: return "draw-tiled-image";
+    case ItemType::DrawTiledScaledImage: return "draw-tiled-scaled-image";
+    case ItemType::DrawPattern: return "draw-pattern";
+    case ItemType::DrawRect: return "draw-rect";
+    case ItemType::DrawLine: return "draw-line";
+    case ItemType::DrawLinesForText: return "draw-lines-for-text";
+    case ItemType::DrawLineForDocumentMarker: return "draw-line-for-document-marker";
+    case ItemType::DrawEllipse: return "draw-ellipse";
+    case ItemType::DrawConvexPolygon: return "draw-convex-polygon";
+    case ItemType::DrawFocusRingPath: return "draw-focus-ring-path";
+    case ItemType::DrawFocusRingRects: return "draw-focus-ring-rects";
+    case ItemType::FillRect: return "fill-rect";
+    case ItemType::FillRectWithColor: return "fill-rect-with-color";
+    case ItemType::FillRectWithGradient: return "fill-rect-with-gradient";
+    case ItemType::FillRoundedRect: return "fill-rounded-rect";
+    case ItemType::FillRectWithRoundedHole: return "fill-rect-with-rounded-hole";
+    case ItemType::FillPath: return "fill-path";
+    case ItemType::StrokeRect: return "stroke-rect";
+    case ItemType::StrokePath: return "stroke-path";
+    case ItemType::ClearRect: return "clear-rect";
+    case ItemType::BeginTransparencyLayer: return "begin-transparency-layer";
+    case ItemType::EndTransparencyLayer: return "end-transparency-layer";
+    }
+    ASSERT_NOT_REACHED();
+    return "";
+}
+
+TextStream& operator<<(TextStream& ts, const Item& item)
+{
+    ts << itemTypeName(item.type());
+    if (is<DrawingItem>(item)) {
+        auto& extent = downcast<DrawingItem>(item).extent();
+        if (extent)
+            ts << " extent " << extent.value();
+    }
+    return ts;
+}
+
+} // namespace DisplayList
+} // namespace WebCore
@@ -0,0 +1,958 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DisplayListItems_h
+#define DisplayListItems_h
+
+#include "FloatRect.h"
+#include "FloatRoundedRect.h"
+#include "Font.h"
+#include "GlyphBuffer.h"
+#include "GraphicsContext.h"
+#include "Image.h"
+#include "ImageBuffer.h"
+#include "Path.h"
+#include <wtf/Optional.h>
+#include <wtf/RefCounted.h>
+#include <wtf/TypeCasts.h>
+
+namespace WebCore {
+
+class TextStream;
+
+namespace DisplayList {
+
+enum class ItemType {
+    Save,
+    Restore,
+    Translate,
+    Rotate,
+    Scale,
+    ConcatenateCTM,
+    SetState,
+    SetLineCap,
+    SetLineDash,
+    SetLineJoin,
+    SetMiterLimit,
+    Clip,
+    ClipOut,
+    ClipOutToPath,
+    ClipPath,
+    ClipConvexPolygon,
+    ClipToImageBuffer,
+    DrawGlyphs,
+    DrawImage,
+    DrawTiledImage,
+    DrawTiledScaledImage,
+    DrawPattern,
+    DrawRect,
+    DrawLine,
+    DrawLinesForText,
+    DrawLineForDocumentMarker,
+    DrawEllipse,
+    DrawConvexPolygon,
+    DrawFocusRingPath,
+    DrawFocusRingRects,
+    FillRect,
+    FillRectWithColor,
+    FillRectWithGradient,
+    FillRoundedRect,
+    FillRectWithRoundedHole,
+    FillPath,
+    StrokeRect,
+    StrokePath,
+    ClearRect,
+    BeginTransparencyLayer,
+    EndTransparencyLayer,
+};
+
+class Item : public RefCounted<Item> {
+public:
+    explicit Item(ItemType type)
+        : m_type(type)
+    {
+    }
+
+    virtual ~Item() { }
+
+    ItemType type() const { return m_type; }
+
+    virtual void apply(GraphicsContext&) const = 0;
+
+    virtual bool isDrawingItem() const { return false; }
+
+private:
+    ItemType m_type;
+};
+
+class DrawingItem : public Item {
+public:
+    explicit DrawingItem(ItemType type)
+        : Item(type)
+    {
+    }
+
+    // Bounds of the pixels this item touches, in the user space it was recorded in,
+    // ignoring stroke width and shadows. Nullopt means the bounds are unknown.
+    virtual Optional<FloatRect> localBounds(const GraphicsContext&) const { return Nullopt; }
+
+    // Bounds in the coordinate space the display list was recorded in, clipped to the
+    // clip that was active when the item was recorded. Computed by the Recorder; items
+    // without an extent are never culled on replay.
+    const Optional<FloatRect>& extent() const { return m_extent; }
+    void setExtent(const Optional<FloatRect>& extent) { m_extent = extent; }
+
+private:
+    bool isDrawingItem() const override { return true; }
+
+    Optional<FloatRect> m_extent;
+};
+
+class Save final : public Item {
+public:
+    static Ref<Save> create() { return adoptRef(*new Save); }
+
+private:
+    Save()
+        : Item(ItemType::Save)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+};
+
+class Restore final : public Item {
+public:
+    static Ref<Restore> create() { return adoptRef(*new Restore); }
+
+private:
+    Restore()
+        : Item(ItemType::Restore)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+};
+
+class Translate final : public Item {
+public:
+    static Ref<Translate> create(float x, float y) { return adoptRef(*new Translate(x, y)); }
+
+    float x() const { return m_x; }
+    float y() const { return m_y; }
+
+private:
+    Translate(float x, float y)
+        : Item(ItemType::Translate)
+        , m_x(x)
+        , m_y(y)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    float m_x;
+    float m_y;
+};
+
+class Rotate final : public Item {
+public:
+    static Ref<Rotate> create(float angleInRadians) { return adoptRef(*new Rotate(angleInRadians)); }
+
+    float angle() const { return m_angle; }
+
+private:
+    explicit Rotate(float angle)
+        : Item(ItemType::Rotate)
+        , m_angle(angle)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    float m_angle;
+};
+
+class Scale final : public Item {
+public:
+    static Ref<Scale> create(const FloatSize& size) { return adoptRef(*new Scale(size)); }
+
+    const FloatSize& amount() const { return m_size; }
+
+private:
+    explicit Scale(const FloatSize& size)
+        : Item(ItemType::Scale)
+        , m_size(size)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    FloatSize m_size;
+};
+
+// GraphicsContext::setCTM() is recorded as the equivalent ConcatenateCTM, so that a display
+// list can be replayed under any base transform.
+class ConcatenateCTM final : public Item {
+public:
+    static Ref<ConcatenateCTM> create(const AffineTransform& transform) { return adoptRef(*new ConcatenateCTM(transform)); }
+
+    const AffineTransform& transform() const { return m_transform; }
+
+private:
+    explicit ConcatenateCTM(const AffineTransform& transform)
+        : Item(ItemType::ConcatenateCTM)
+        , m_transform(transform)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    AffineTransform m_transform;
+};
+
+// A snapshot of the GraphicsContextState in effect for the drawing items that follow it.
+class SetState final : public Item {
+public:
+    static Ref<SetState> create(const GraphicsContextState& state) { return adoptRef(*new SetState(state)); }
+
+    const GraphicsContextState& state() const { return m_state; }
+
+    static bool statesAreEqual(const GraphicsContextState&, const GraphicsContextState&);
+
+private:
+    explicit SetState(const GraphicsContextState& state)
+        : Item(ItemType::SetState)
+        , m_state(state)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    GraphicsContextState m_state;
+};
+
+class SetLineCap final : public Item {
+public:
+    static Ref<SetLineCap> create(LineCap lineCap) { return adoptRef(*new SetLineCap(lineCap)); }
+
+private:
+    explicit SetLineCap(LineCap lineCap)
+        : Item(ItemType::SetLineCap)
+        , m_lineCap(lineCap)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    LineCap m_lineCap;
+};
+
+class SetLineDash final : public Item {
+public:
+    static Ref<SetLineDash> create(const DashArray& dashArray, float dashOffset) { return adoptRef(*new SetLineDash(dashArray, dashOffset)); }
+
+private:
+    SetLineDash(const DashArray& dashArray, float dashOffset)
+        : Item(ItemType::SetLineDash)
+        , m_dashArray(dashArray)
+        , m_dashOffset(dashOffset)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    DashArray m_dashArray;
+    float m_dashOffset;
+};
+
+class SetLineJoin final : public Item {
+public:
+    static Ref<SetLineJoin> create(LineJoin lineJoin) { return adoptRef(*new SetLineJoin(lineJoin)); }
+
+private:
+    explicit SetLineJoin(LineJoin lineJoin)
+        : Item(ItemType::SetLineJoin)
+        , m_lineJoin(lineJoin)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    LineJoin m_lineJoin;
+};
+
+class SetMiterLimit final : public Item {
+public:
+    static Ref<SetMiterLimit> create(float miterLimit) { return adoptRef(*new SetMiterLimit(miterLimit)); }
+
+private:
+    explicit SetMiterLimit(float miterLimit)
+        : Item(ItemType::SetMiterLimit)
+        , m_miterLimit(miterLimit)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    float m_miterLimit;
+};
+
+class Clip final : public Item {
+public:
+    static Ref<Clip> create(const FloatRect& rect) { return adoptRef(*new Clip(rect)); }
+
+    const FloatRect& rect() const { return m_rect; }
+
+private:
+    explicit Clip(const FloatRect& rect)
+        : Item(ItemType::Clip)
+        , m_rect(rect)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    FloatRect m_rect;
+};
+
+class ClipOut final : public Item {
+public:
+    static Ref<ClipOut> create(const FloatRect& rect) { return adoptRef(*new ClipOut(rect)); }
+
+private:
+    explicit ClipOut(const FloatRect& rect)
+        : Item(ItemType::ClipOut)
+        , m_rect(rect)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    FloatRect m_rect;
+};
+
+class ClipOutToPath final : public Item {
+public:
+    static Ref<ClipOutToPath> create(const Path& path) { return adoptRef(*new ClipOutToPath(path)); }
+
+private:
+    explicit ClipOutToPath(const Path& path)
+        : Item(ItemType::ClipOutToPath)
+        , m_path(path)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    Path m_path;
+};
+
+class ClipPath final : public Item {
+public:
+    static Ref<ClipPath> create(const Path& path, WindRule windRule) { return adoptRef(*new ClipPath(path, windRule)); }
+
+private:
+    ClipPath(const Path& path, WindRule windRule)
+        : Item(ItemType::ClipPath)
+        , m_path(path)
+        , m_windRule(windRule)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    Path m_path;
+    WindRule m_windRule;
+};
+
+class ClipConvexPolygon final : public Item {
+public:
+    static Ref<ClipConvexPolygon> create(size_t numberOfPoints, const FloatPoint* points, bool antialiased)
+    {
+        return adoptRef(*new ClipConvexPolygon(numberOfPoints, points, antialiased));
+    }
+
+private:
+    ClipConvexPolygon(size_t numberOfPoints, const FloatPoint*, bool antialiased);
+
+    void apply(GraphicsContext&) const override;
+
+    Vector<FloatPoint> m_points;
+    bool m_antialiased;
+};
+
+// Holds a private copy of the mask, since the source buffer may be drawn into after recording.
+class ClipToImageBuffer final : public Item {
+public:
+    static Ref<ClipToImageBuffer> create(std::unique_ptr<ImageBuffer> imageBuffer, const FloatRect& destinationRect)
+    {
+        return adoptRef(*new ClipToImageBuffer(WTF::move(imageBuffer), destinationRect));
+    }
+
+private:
+    ClipToImageBuffer(std::unique_ptr<ImageBuffer> imageBuffer, const FloatRect& destinationRect)
+        : Item(ItemType::ClipToImageBuffer)
+        , m_imageBuffer(WTF::move(imageBuffer))
+        , m_destinationRect(destinationRect)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    std::unique_ptr<ImageBuffer> m_imageBuffer;
+    FloatRect m_destinationRect;
+};
+
+class DrawGlyphs final : public DrawingItem {
+public:
+    static Ref<DrawGlyphs> create(const Font& font, const GlyphBuffer& glyphBuffer, int from, int numberOfGlyphs, const FloatPoint& point)
+    {
+        return adoptRef(*new DrawGlyphs(font, glyphBuffer, from, numberOfGlyphs, point));
+    }
+
+private:
+    DrawGlyphs(const Font&, const GlyphBuffer&, int from, int numberOfGlyphs, const FloatPoint&);
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override;
+
+    Ref<Font> m_font;
+    Vector<Glyph, 128> m_glyphs;
+    Vector<GlyphBufferAdvance, 128> m_advances;
+    FloatPoint m_point;
+};
+
+class DrawImage final : public DrawingItem {
+public:
+    static Ref<DrawImage> create(Image& image, const FloatRect& destination, const FloatRect& source, const ImagePaintingOptions& imagePaintingOptions)
+    {
+        return adoptRef(*new DrawImage(image, destination, source, imagePaintingOptions));
+    }
+
+private:
+    DrawImage(Image& image, const FloatRect& destination, const FloatRect& source, const ImagePaintingOptions& imagePaintingOptions)
+        : DrawingItem(ItemType::DrawImage)
+        , m_image(image)
+        , m_destination(destination)
+        , m_source(source)
+        , m_imagePaintingOptions(imagePaintingOptions)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override { return m_destination; }
+
+    mutable Ref<Image> m_image;
+    FloatRect m_destination;
+    FloatRect m_source;
+    ImagePaintingOptions m_imagePaintingOptions;
+};
+
+class DrawTiledImage final : public DrawingItem {
+public:
+    static Ref<DrawTiledImage> create(Image& image, const FloatRect& destination, const FloatPoint& source, const FloatSize& tileSize, const FloatSize& spacing, const ImagePaintingOptions& imagePaintingOptions)
+    {
+        return adoptRef(*new DrawTiledImage(image, destination, source, tileSize, spacing, imagePaintingOptions));
+    }
+
+private:
+    DrawTiledImage(Image& image, const FloatRect& destination, const FloatPoint& source, const FloatSize& tileSize, const FloatSize& spacing, const ImagePaintingOptions& imagePaintingOptions)
+        : DrawingItem(ItemType::DrawTiledImage)
+        , m_image(image)
+        , m_destination(destination)
+        , m_source(source)
+        , m_tileSize(tileSize)
+        , m_spacing(spacing)
+        , m_imagePaintingOptions(imagePaintingOptions)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override { return m_destination; }
+
+    mutable Ref<Image> m_image;
+    FloatRect m_destination;
+    FloatPoint m_source;
+    FloatSize m_tileSize;
+    FloatSize m_spacing;
+    ImagePaintingOptions m_imagePaintingOptions;
+};
+
+class DrawTiledScaledImage final : public DrawingItem {
+public:
+    static Ref<DrawTiledScaledImage> create(Image& image, const FloatRect& destination, const FloatRect& source, const FloatSize& tileScaleFactor, Image::TileRule hRule, Image::TileRule vRule, const ImagePaintingOptions& imagePaintingOptions)
+    {
+        return adoptRef(*new DrawTiledScaledImage(image, destination, source, tileScaleFactor, hRule, vRule, imagePaintingOptions));
+    }
+
+private:
+    DrawTiledScaledImage(Image& image, const FloatRect& destination, const FloatRect& source, const FloatSize& tileScaleFactor, Image::TileRule hRule, Image::TileRule vRule, const ImagePaintingOptions& imagePaintingOptions)
+        : DrawingItem(ItemType::DrawTiledScaledImage)
+        , m_image(image)
+        , m_destination(destination)
+        , m_source(source)
+        , m_tileScaleFactor(tileScaleFactor)
+        , m_hRule(hRule)
+        , m_vRule(vRule)
+        , m_imagePaintingOptions(imagePaintingOptions)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override { return m_destination; }
+
+    mutable Ref<Image> m_image;
+    FloatRect m_destination;
+    FloatRect m_source;
+    FloatSize m_tileScaleFactor;
+    Image::TileRule m_hRule;
+    Image::TileRule m_vRule;
+    ImagePaintingOptions m_imagePaintingOptions;
+};
+
+class DrawPattern final : public DrawingItem {
+public:
+    static Ref<DrawPattern> create(Image& image, const FloatRect& tileRect, const AffineTransform& patternTransform, const FloatPoint& phase, const FloatSize& spacing, CompositeOperator op, const FloatRect& destination, BlendMode blendMode)
+    {
+        return adoptRef(*new DrawPattern(image, tileRect, patternTransform, phase, spacing, op, destination, blendMode));
+    }
+
+private:
+    DrawPattern(Image& image, const FloatRect& tileRect, const AffineTransform& patternTransform, const FloatPoint& phase, const FloatSize& spacing, CompositeOperator op, const FloatRect& destination, BlendMode blendMode)
+        : DrawingItem(ItemType::DrawPattern)
+        , m_image(image)
+        , m_patternTransform(patternTransform)
+        , m_tileRect(tileRect)
+        , m_destination(destination)
+        , m_phase(phase)
+        , m_spacing(spacing)
+        , m_op(op)
+        , m_blendMode(blendMode)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override { return m_destination; }
+
+    mutable Ref<Image> m_image;
+    AffineTransform m_patternTransform;
+    FloatRect m_tileRect;
+    FloatRect m_destination;
+    FloatPoint m_phase;
+    FloatSize m_spacing;
+    CompositeOperator m_op;
+    BlendMode m_blendMode;
+};
+
+class DrawRect final : public DrawingItem {
+public:
+    static Ref<DrawRect> create(const FloatRect& rect, float borderThickness) { return adoptRef(*new DrawRect(rect, borderThickness)); }
+
+private:
+    DrawRect(const FloatRect& rect, float borderThickness)
+        : DrawingItem(ItemType::DrawRect)
+        , m_rect(rect)
+        , m_borderThickness(borderThickness)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override { return m_rect; }
+
+    FloatRect m_rect;
+    float m_borderThickness;
+};
+
+class DrawLine final : public DrawingItem {
+public:
+    static Ref<DrawLine> create(const FloatPoint& point1, const FloatPoint& point2) { return adoptRef(*new DrawLine(point1, point2)); }
+
+private:
+    DrawLine(const FloatPoint& point1, const FloatPoint& point2)
+        : DrawingItem(ItemType::DrawLine)
+        , m_point1(point1)
+        , m_point2(point2)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override;
+
+    FloatPoint m_point1;
+    FloatPoint m_point2;
+};
+
+class DrawLinesForText final : public DrawingItem {
+public:
+    static Ref<DrawLinesForText> create(const FloatPoint& point, const DashArray& widths, bool printing, bool doubleLines)
+    {
+        return adoptRef(*new DrawLinesForText(point, widths, printing, doubleLines));
+    }
+
+private:
+    DrawLinesForText(const FloatPoint& point, const DashArray& widths, bool printing, bool doubleLines)
+        : DrawingItem(ItemType::DrawLinesForText)
+        , m_point(point)
+        , m_widths(widths)
+        , m_printing(printing)
+        , m_doubleLines(doubleLines)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override;
+
+    FloatPoint m_point;
+    DashArray m_widths;
+    bool m_printing;
+    bool m_doubleLines;
+};
+
+class DrawLineForDocumentMarker final : public DrawingItem {
+public:
+    static Ref<DrawLineForDocumentMarker> create(const FloatPoint& point, float width, GraphicsContext::DocumentMarkerLineStyle style)
+    {
+        return adoptRef(*new DrawLineForDocumentMarker(point, width, style));
+    }
+
+private:
+    DrawLineForDocumentMarker(const FloatPoint& point, float width, GraphicsContext::DocumentMarkerLineStyle style)
+        : DrawingItem(ItemType::DrawLineForDocumentMarker)
+        , m_point(point)
+        , m_width(width)
+        , m_style(style)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override;
+
+    FloatPoint m_point;
+    float m_width;
+    GraphicsContext::DocumentMarkerLineStyle m_style;
+};
+
+class DrawEllipse final : public DrawingItem {
+public:
+    static Ref<DrawEllipse> create(const FloatRect& rect) { return adoptRef(*new DrawEllipse(rect)); }
+
+private:
+    explicit DrawEllipse(const FloatRect& rect)
+        : DrawingItem(ItemType::DrawEllipse)
+        , m_rect(rect)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override;
+
+    FloatRect m_rect;
+};
+
+class DrawConvexPolygon final : public DrawingItem {
+public:
+    static Ref<DrawConvexPolygon> create(size_t numberOfPoints, const FloatPoint* points, bool antialiased)
+    {
+        return adoptRef(*new DrawConvexPolygon(numberOfPoints, points, antialiased));
+    }
+
+private:
+    DrawConvexPolygon(size_t numberOfPoints, const FloatPoint*, bool antialiased);
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override;
+
+    Vector<FloatPoint> m_points;
+    bool m_antialiased;
+};
+
+class DrawFocusRingPath final : public DrawingItem {
+public:
+    static Ref<DrawFocusRingPath> create(const Path& path, int width, int offset, const Color& color)
+    {
+        return adoptRef(*new DrawFocusRingPath(path, width, offset, color));
+    }
+
+private:
+    DrawFocusRingPath(const Path& path, int width, int offset, const Color& color)
+        : DrawingItem(ItemType::DrawFocusRingPath)
+        , m_path(path)
+        , m_width(width)
+        , m_offset(offset)
+        , m_color(color)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override;
+
+    Path m_path;
+    int m_width;
+    int m_offset;
+    Color m_color;
+};
+
+class DrawFocusRingRects final : public DrawingItem {
+public:
+    static Ref<DrawFocusRingRects> create(const Vector<IntRect>& rects, int width, int offset, const Color& color)
+    {
+        return adoptRef(*new DrawFocusRingRects(rects, width, offset, color));
+    }
+
+private:
+    DrawFocusRingRects(const Vector<IntRect>& rects, int width, int offset, const Color& color)
+        : DrawingItem(ItemType::DrawFocusRingRects)
+        , m_rects(rects)
+        , m_width(width)
+        , m_offset(offset)
+        , m_color(color)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override;
+
+    Vector<IntRect> m_rects;
+    int m_width;
+    int m_offset;
+    Color m_color;
+};
+
+class FillRect final : public DrawingItem {
+public:
+    static Ref<FillRect> create(const FloatRect& rect) { return adoptRef(*new FillRect(rect)); }
+
+private:
+    explicit FillRect(const FloatRect& rect)
+        : DrawingItem(ItemType::FillRect)
+        , m_rect(rect)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override { return m_rect; }
+
+    FloatRect m_rect;
+};
+
+class FillRectWithColor final : public DrawingItem {
+public:
+    static Ref<FillRectWithColor> create(const FloatRect& rect, const Color& color) { return adoptRef(*new FillRectWithColor(rect, color)); }
+
+private:
+    FillRectWithColor(const FloatRect& rect, const Color& color)
+        : DrawingItem(ItemType::FillRectWithColor)
+        , m_rect(rect)
+        , m_color(color)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override { return m_rect; }
+
+    FloatRect m_rect;
+    Color m_color;
+};
+
+class FillRectWithGradient final : public DrawingItem {
+public:
+    static Ref<FillRectWithGradient> create(const FloatRect& rect, Gradient& gradient) { return adoptRef(*new FillRectWithGradient(rect, gradient)); }
+
+private:
+    FillRectWithGradient(const FloatRect& rect, Gradient& gradient)
+        : DrawingItem(ItemType::FillRectWithGradient)
+        , m_rect(rect)
+        , m_gradient(gradient)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override { return m_rect; }
+
+    FloatRect m_rect;
+    mutable Ref<Gradient> m_gradient;
+};
+
+class FillRoundedRect final : public DrawingItem {
+public:
+    static Ref<FillRoundedRect> create(const FloatRoundedRect& rect, const Color& color, BlendMode blendMode)
+    {
+        return adoptRef(*new FillRoundedRect(rect, color, blendMode));
+    }
+
+private:
+    FillRoundedRect(const FloatRoundedRect& rect, const Color& color, BlendMode blendMode)
+        : DrawingItem(ItemType::FillRoundedRect)
+        , m_rect(rect)
+        , m_color(color)
+        , m_blendMode(blendMode)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override { return m_rect.rect(); }
+
+    FloatRoundedRect m_rect;
+    Color m_color;
+    BlendMode m_blendMode;
+};
+
+class FillRectWithRoundedHole final : public DrawingItem {
+public:
+    static Ref<FillRectWithRoundedHole> create(const FloatRect& rect, const FloatRoundedRect& roundedHoleRect, const Color& color)
+    {
+        return adoptRef(*new FillRectWithRoundedHole(rect, roundedHoleRect, color));
+    }
+
+private:
+    FillRectWithRoundedHole(const FloatRect& rect, const FloatRoundedRect& roundedHoleRect, const Color& color)
+        : DrawingItem(ItemType::FillRectWithRoundedHole)
+        , m_rect(rect)
+        , m_roundedHoleRect(roundedHoleRect)
+        , m_color(color)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override { return m_rect; }
+
+    FloatRect m_rect;
+    FloatRoundedRect m_roundedHoleRect;
+    Color m_color;
+};
+
+class FillPath final : public DrawingItem {
+public:
+    static Ref<FillPath> create(const Path& path) { return adoptRef(*new FillPath(path)); }
+
+private:
+    explicit FillPath(const Path& path)
+        : DrawingItem(ItemType::FillPath)
+        , m_path(path)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override { return m_path.fastBoundingRect(); }
+
+    Path m_path;
+};
+
+class StrokeRect final : public DrawingItem {
+public:
+    static Ref<StrokeRect> create(const FloatRect& rect, float lineWidth) { return adoptRef(*new StrokeRect(rect, lineWidth)); }
+
+private:
+    StrokeRect(const FloatRect& rect, float lineWidth)
+        : DrawingItem(ItemType::StrokeRect)
+        , m_rect(rect)
+        , m_lineWidth(lineWidth)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override;
+
+    FloatRect m_rect;
+    float m_lineWidth;
+};
+
+class StrokePath final : public DrawingItem {
+public:
+    static Ref<StrokePath> create(const Path& path) { return adoptRef(*new StrokePath(path)); }
+
+private:
+    explicit StrokePath(const Path& path)
+        : DrawingItem(ItemType::StrokePath)
+        , m_path(path)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override;
+
+    Path m_path;
+};
+
+class ClearRect final : public DrawingItem {
+public:
+    static Ref<ClearRect> create(const FloatRect& rect) { return adoptRef(*new ClearRect(rect)); }
+
+private:
+    explicit ClearRect(const FloatRect& rect)
+        : DrawingItem(ItemType::ClearRect)
+        , m_rect(rect)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override { return m_rect; }
+
+    FloatRect m_rect;
+};
+
+// Transparency layers composite everything drawn since the matching begin, so both
+// ends are drawing items without bounds and are never culled.
+class BeginTransparencyLayer final : public DrawingItem {
+public:
+    static Ref<BeginTransparencyLayer> create(float opacity) { return adoptRef(*new BeginTransparencyLayer(opacity)); }
+
+private:
+    explicit BeginTransparencyLayer(float opacity)
+        : DrawingItem(ItemType::BeginTransparencyLayer)
+        , m_opacity(opacity)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+
+    float m_opacity;
+};
+
+class EndTransparencyLayer final : public DrawingItem {
+public:
+    static Ref<EndTransparencyLayer> create() { return adoptRef(*new EndTransparencyLayer); }
+
+private:
+    EndTransparencyLayer()
+        : DrawingItem(ItemType::EndTransparencyLayer)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+};
+
+TextStream& operator<<(TextStream&, const Item&);
+
+} // namespace DisplayList
+} // namespace WebCore
+
+SPECIALIZE_TYPE_TRAITS_BEGIN(WebCore::DisplayList::DrawingItem)
+    static bool isType(const WebCore::DisplayList::Item& item) { return item.isDrawingItem(); }
+SPECIALIZE_TYPE_TRAITS_END()
+
+#endif // DisplayListItems_h
@@ -0,0 +1,425 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "DisplayListRecorder.h"
+
+#include "ImageBuffer.h"
+#include <wtf/MathExtras.h>
+
+namespace WebCore {
+namespace DisplayList {
+
+Recorder::Recorder(GraphicsContext& context, DisplayList& displayList, const FloatRect& initialClip, const AffineTransform& baseCTM)
+    : m_graphicsContext(context)
+    , m_displayList(displayList)
+    , m_baseCTM(baseCTM)
+{
+    ASSERT(!context.isRecording());
+
+    ContextState initialState;
+    initialState.clipBounds = initialClip;
+    m_stateStack.append(initialState);
+
+    m_graphicsContext.setDisplayListRecorder(this);
+}
+
+Recorder::~Recorder()
+{
+    ASSERT(m_stateStack.size() == 1);
+    m_graphicsContext.setDisplayListRecorder(nullptr);
+}
+
+void Recorder::appendItem(Ref<Item>&& item)
+{
+    m_displayList.append(WTF::move(item));
+}
+
+void Recorder::appendStateChangeIfNeeded()
+{
+    // The state is recorded lazily, right before the drawing item that uses it, so
+    // that runs of setters between two drawing items collapse into a single item.
+    const GraphicsContextState& state = m_graphicsContext.state();
+    Optional<GraphicsContextState>& recordedState = currentState().recordedState;
+    if (recordedState && SetState::statesAreEqual(recordedState.value(), state))
+        return;
+
+    appendItem(SetState::create(state));
+    recordedState = state;
+}
+
+static bool compositeOperatorIsUnbounded(CompositeOperator op)
+{
+    // These clear the destination outside of the source, so they affect the whole clip.
+    switch (op) {
+    case CompositeSourceIn:
+    case CompositeSourceOut:
+    case CompositeDestinationIn:
+    case CompositeDestinationAtop:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static FloatRect shadowBounds(const FloatRect& bounds, const FloatSize& offset, float blur)
+{
+    // A blurred shadow fades out over twice the blur radius at most.
+    FloatRect shadowBounds = bounds;
+    shadowBounds.move(offset);
+    shadowBounds.inflate(2 * blur);
+    return shadowBounds;
+}
+
+Optional<FloatRect> Recorder::extentFromLocalBounds(const Optional<FloatRect>& localBounds) const
+{
+    const ContextState& state = currentState();
+    if (compositeOperatorIsUnbounded(m_graphicsContext.compositeOperation()))
+        return state.clipBounds;
+
+    if (!localBounds)
+        return Nullopt;
+
+    FloatRect bounds = localBounds.value();
+
+    FloatSize shadowOffset;
+    float shadowBlur;
+    Color shadowColor;
+    bool hasShadow = m_graphicsContext.getShadow(shadowOffset, shadowBlur, shadowColor);
+    if (hasShadow && !m_graphicsContext.shadowsIgnoreTransforms())
+        bounds.unite(shadowBounds(bounds, shadowOffset, shadowBlur));
+
+    bounds = state.ctm.mapRect(bounds);
+
+    // Shadows that ignore transforms are specified in device space. Treating them as
+    // recording space is conservative as long as the base CTM does not scale down.
+    if (hasShadow && m_graphicsContext.shadowsIgnoreTransforms())
+        bounds.unite(shadowBounds(bounds, shadowOffset, shadowBlur));
+
+    bounds.intersect(state.clipBounds);
+    return bounds;
+}
+
+void Recorder::appendDrawingItem(Ref<DrawingItem>&& item)
+{
+    appendStateChangeIfNeeded();
+    item->setExtent(extentFromLocalBounds(item->localBounds(m_graphicsContext)));
+    appendItem(WTF::move(item));
+}
+
+void Recorder::intersectClip(const FloatRect& localRect)
+{
+    ContextState& state = currentState();
+    state.clipBounds.intersect(state.ctm.mapRect(localRect));
+}
+
+void Recorder::save()
+{
+    appendItem(Save::create());
+
+    ContextState state = currentState();
+    m_stateStack.append(state);
+}
+
+void Recorder::restore()
+{
+    if (m_stateStack.size() == 1)
+        return;
+
+    appendItem(Restore::create());
+    m_stateStack.removeLast();
+}
+
+void Recorder::translate(float x, float y)
+{
+    appendItem(Translate::create(x, y));
+    currentState().ctm.translate(x, y);
+}
+
+void Recorder::rotate(float angleInRadians)
+{
+    appendItem(Rotate::create(angleInRadians));
+    currentState().ctm.rotate(rad2deg(angleInRadians));
+}
+
+void Recorder::scale(const FloatSize& size)
+{
+    appendItem(Scale::create(size));
+    currentState().ctm.scale(size.width(), size.height());
+}
+
+void Recorder::concatCTM(const AffineTransform& transform)
+{
+    appendItem(ConcatenateCTM::create(transform));
+    currentState().ctm.multiply(transform);
+}
+
+void Recorder::setCTM(const AffineTransform& transform)
+{
+    // Turn the absolute transform into one relative to the current transform, so that
+    // the list stays correct when it is replayed under a different base transform.
+    auto inverseBaseCTM = m_baseCTM.inverse();
+    auto inverseCTM = currentState().ctm.inverse();
+    if (!inverseBaseCTM || !inverseCTM)
+        return;
+
+    AffineTransform relativeTransform = inverseBaseCTM.value();
+    relativeTransform.multiply(transform);
+
+    AffineTransform delta = inverseCTM.value();
+    delta.multiply(relativeTransform);
+    concatCTM(delta);
+}
+
+AffineTransform Recorder::getCTM() const
+{
+    AffineTransform transform = m_baseCTM;
+    transform.multiply(currentState().ctm);
+    return transform;
+}
+
+void Recorder::setLineCap(LineCap lineCap)
+{
+    appendItem(SetLineCap::create(lineCap));
+}
+
+void Recorder::setLineDash(const DashArray& dashArray, float dashOffset)
+{
+    appendItem(SetLineDash::create(dashArray, dashOffset));
+}
+
+void Recorder::setLineJoin(LineJoin lineJoin)
+{
+    appendItem(SetLineJoin::create(lineJoin));
+}
+
+void Recorder::setMiterLimit(float miterLimit)
+{
+    appendItem(SetMiterLimit::create(miterLimit));
+}
+
+void Recorder::clip(const FloatRect& rect)
+{
+    appendItem(Clip::create(rect));
+    intersectClip(rect);
+}
+
+void Recorder::clipOut(const FloatRect& rect)
+{
+    appendItem(ClipOut::create(rect));
+}
+
+void Recorder::clipOut(const Path& path)
+{
+    appendItem(ClipOutToPath::create(path));
+}
+
+void Recorder::clipPath(const Path& path, WindRule windRule)
+{
+    appendItem(ClipPath::create(path, windRule));
+    intersectClip(path.fastBoundingRect());
+}
+
+void Recorder::clipConvexPolygon(size_t numberOfPoints, const FloatPoint* points, bool antialiased)
+{
+    if (numberOfPoints <= 1)
+        return;
+
+    appendItem(ClipConvexPolygon::create(numberOfPoints, points, antialiased));
+
+    FloatRect bounds(points[0], FloatSize());
+    for (size_t i = 1; i < numberOfPoints; ++i)
+        bounds.extend(points[i]);
+    intersectClip(bounds);
+}
+
+void Recorder::clipToImageBuffer(ImageBuffer& imageBuffer, const FloatRect& destinationRect)
+{
+    std::unique_ptr<ImageBuffer> mask = ImageBuffer::create(imageBuffer.logicalSize(), Unaccelerated, imageBuffer.resolutionScale());
+    if (!mask)
+        return;
+
+    mask->context().drawImageBuffer(imageBuffer, FloatPoint(), ImagePaintingOptions(CompositeCopy));
+    appendItem(ClipToImageBuffer::create(WTF::move(mask), destinationRect));
+    intersectClip(destinationRect);
+}
+
+IntRect Recorder::clipBounds() const
+{
+    auto inverseCTM = currentState().ctm.inverse();
+    if (!inverseCTM)
+        return IntRect();
+    return enclosingIntRect(inverseCTM.value().mapRect(currentState().clipBounds));
+}
+
+void Recorder::drawGlyphs(const Font& font, const GlyphBuffer& glyphBuffer, int from, int numberOfGlyphs, const FloatPoint& point)
+{
+    appendDrawingItem(DrawGlyphs::create(font, glyphBuffer, from, numberOfGlyphs, point));
+}
+
+void Recorder::drawImage(Image& image, const FloatRect& destination, const FloatRect& source, const ImagePaintingOptions& imagePaintingOptions)
+{
+    appendDrawingItem(DrawImage::create(image, destination, source, imagePaintingOptions));
+}
+
+void Recorder::drawTiledImage(Image& image, const FloatRect& destination, const FloatPoint& source, const FloatSize& tileSize, const FloatSize& spacing, const ImagePaintingOptions& imagePaintingOptions)
+{
+    appendDrawingItem(DrawTiledImage::create(image, destination, source, tileSize, spacing, imagePaintingOptions));
+}
+
+void Recorder::drawTiledImage(Image& image, const FloatRect& destination, const FloatRect& source, const FloatSize& tileScaleFactor, Image::TileRule hRule, Image::TileRule vRule, const ImagePaintingOptions& imagePaintingOptions)
+{
+    appendDrawingItem(DrawTiledScaledImage::create(image, destination, source, tileScaleFactor, hRule, vRule, imagePaintingOptions));
+}
+
+void Recorder::drawPattern(Image& image, const FloatRect& tileRect, const AffineTransform& patternTransform, const FloatPoint& phase, const FloatSize& spacing, CompositeOperator op, const FloatRect& destination, BlendMode blendMode)
+{
+    appendDrawingItem(DrawPattern::create(image, tileRect, patternTransform, phase, spacing, op, destination, blendMode));
+}
+
+void Recorder::drawRect(const FloatRect& rect, float borderThickness)
+{
+    appendDrawingItem(DrawRect::create(rect, borderThickness));
+}
+
+void Recorder::drawLine(const FloatPoint& point1, const FloatPoint& point2)
+{
+    appendDrawingItem(DrawLine::create(point1, point2));
+}
+
+void Recorder::drawLinesForText(const FloatPoint& point, const DashArray& widths, bool printing, bool doubleLines)
+{
+    appendDrawingItem(DrawLinesForText::create(point, widths, printing, doubleLines));
+}
+
+void Recorder::drawLineForDocumentMarker(const FloatPoint& point, float width, GraphicsContext::DocumentMarkerLineStyle style)
+{
+    appendDrawingItem(DrawLineForDocumentMarker::create(point, width, style));
+}
+
+void Recorder::drawEllipse(const FloatRect& rect)
+{
+    appendDrawingItem(DrawEllipse::create(rect));
+}
+
+void Recorder::drawConvexPolygon(size_t numberOfPoints, const FloatPoint* points, bool antialiased)
+{
+    appendDrawingItem(DrawConvexPolygon::create(numberOfPoints, points, antialiased));
+}
+
+void Recorder::drawFocusRing(const Path& path, int width, int offset, const Color& color)
+{
+    appendDrawingItem(DrawFocusRingPath::create(path, width, offset, color));
+}
+
+void Recorder::drawFocusRing(const Vector<IntRect>& rects, int width, int offset, const Color& color)
+{
+    appendDrawingItem(DrawFocusRingRects::create(rects, width, offset, color));
+}
+
+void Recorder::fillRect(const FloatRect& rect)
+{
+    appendDrawingItem(FillRect::create(rect));
+}
+
+void Recorder::fillRect(const FloatRect& rect, const Color& color)
+{
+    appendDrawingItem(FillRectWithColor::create(rect, color));
+}
+
+void Recorder::fillRect(const FloatRect& rect, Gradient& gradient)
+{
+    appendDrawingItem(FillRectWithGradient::create(rect, gradient));
+}
+
+void Recorder::fillRoundedRect(const FloatRoundedRect& rect, const Color& color, BlendMode blendMode)
+{
+    appendDrawingItem(FillRoundedRect::create(rect, color, blendMode));
+}
+
+void Recorder::fillRectWithRoundedHole(const FloatRect& rect, const FloatRoundedRect& roundedHoleRect, const Color& color)
+{
+    appendDrawingItem(FillRectWithRoundedHole::create(rect, roundedHoleRect, color));
+}
+
+void Recorder::fillPath(const Path& path)
+{
+    appendDrawingItem(FillPath::create(path));
+}
+
+void Recorder::strokeRect(const FloatRect& rect, float lineWidth)
+{
+    appendDrawingItem(StrokeRect::create(rect, lineWidth));
+}
+
+void Recorder::strokePath(const Path& path)
+{
+    appendDrawingItem(StrokePath::create(path));
+}
+
+void Recorder::clearRect(const FloatRect& rect)
+{
+    appendDrawingItem(ClearRect::create(rect));
+}
+
+void Recorder::beginTransparencyLayer(float opacity)
+{
+    appendDrawingItem(BeginTransparencyLayer::create(opacity));
+}
+
+void Recorder::endTransparencyLayer()
+{
+    appendDrawingItem(EndTransparencyLayer::create());
+}
+
+static float roundDeviceDistance(float distance)
+{
+    // Like the Cairo implementation, never round a non-zero distance down to zero.
+    if (distance > -1 && distance < 0)
+        return -1;
+    if (distance > 0 && distance < 1)
+        return 1;
+    return roundf(distance);
+}
+
+FloatRect Recorder::roundToDevicePixels(const FloatRect& rect) const
+{
+    AffineTransform ctm = getCTM();
+    auto inverseCTM = ctm.inverse();
+    if (!inverseCTM)
+        return rect;
+
+    FloatPoint deviceOrigin = ctm.mapPoint(rect.location());
+    FloatSize deviceSize = ctm.mapPoint(rect.maxXMaxYCorner()) - deviceOrigin;
+    deviceOrigin = FloatPoint(roundf(deviceOrigin.x()), roundf(deviceOrigin.y()));
+    deviceSize = FloatSize(roundDeviceDistance(deviceSize.width()), roundDeviceDistance(deviceSize.height()));
+
+    FloatPoint origin = inverseCTM.value().mapPoint(deviceOrigin);
+    return FloatRect(origin, inverseCTM.value().mapPoint(deviceOrigin + deviceSize) - origin);
+}
+
+} // namespace DisplayList
+} // namespace WebCore
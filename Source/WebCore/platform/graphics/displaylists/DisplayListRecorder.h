@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DisplayListRecorder_h
+#define DisplayListRecorder_h
+
+#include "AffineTransform.h"
+#include "DisplayList.h"
+#include "GraphicsContext.h"
+#include <wtf/Noncopyable.h>
+
+namespace WebCore {
+
+namespace DisplayList {
+
+// While a Recorder is alive, every operation on its GraphicsContext is appended to the
+// DisplayList instead of being rasterized. The context should be created with a null
+// PlatformGraphicsContext.
+//
+// The recorder mirrors the transform and clip so that each drawing item gets an extent
+// in the coordinate space of the context when recording started, clipped to initialClip.
+// baseCTM is what getCTM() reports before any transform is recorded, so that code which
+// snaps to device pixels sees the transform the list will be replayed under.
+class Recorder {
+    WTF_MAKE_NONCOPYABLE(Recorder); WTF_MAKE_FAST_ALLOCATED;
+public:
+    WEBCORE_EXPORT Recorder(GraphicsContext&, DisplayList&, const FloatRect& initialClip, const AffineTransform& baseCTM = AffineTransform());
+    WEBCORE_EXPORT ~Recorder();
+
+    void save();
+    void restore();
+
+    void translate(float x, float y);
+    void rotate(float angleInRadians);
+    void scale(const FloatSize&);
+    void concatCTM(const AffineTransform&);
+    void setCTM(const AffineTransform&);
+    AffineTransform getCTM() const;
+
+    void setLineCap(LineCap);
+    void setLineDash(const DashArray&, float dashOffset);
+    void setLineJoin(LineJoin);
+    void setMiterLimit(float);
+
+    void clip(const FloatRect&);
+    void clipOut(const FloatRect&);
+    void clipOut(const Path&);
+    void clipPath(const Path&, WindRule);
+    void clipConvexPolygon(size_t numberOfPoints, const FloatPoint*, bool antialiased);
+    void clipToImageBuffer(ImageBuffer&, const FloatRect&);
+    IntRect clipBounds() const;
+
+    void drawGlyphs(const Font&, const GlyphBuffer&, int from, int numberOfGlyphs, const FloatPoint&);
+    void drawImage(Image&, const FloatRect& destination, const FloatRect& source, const ImagePaintingOptions&);
+    void drawTiledImage(Image&, const FloatRect& destination, const FloatPoint& source, const FloatSize& tileSize, const FloatSize& spacing, const ImagePaintingOptions&);
+    void drawTiledImage(Image&, const FloatRect& destination, const FloatRect& source, const FloatSize& tileScaleFactor, Image::TileRule hRule, Image::TileRule vRule, const ImagePaintingOptions&);
+    void drawPattern(Image&, const FloatRect& tileRect, const AffineTransform& patternTransform, const FloatPoint& phase, const FloatSize& spacing, CompositeOperator, const FloatRect& destination, BlendMode);
+
+    void drawRect(const FloatRect&, float borderThickness);
+    void drawLine(const FloatPoint&, const FloatPoint&);
+    void drawLinesForText(const FloatPoint&, const DashArray& widths, bool printing, bool doubleLines);
+    void drawLineForDocumentMarker(const FloatPoint&, float width, GraphicsContext::DocumentMarkerLineStyle);
+    void drawEllipse(const FloatRect&);
+    void drawConvexPolygon(size_t numberOfPoints, const FloatPoint*, bool antialiased);
+    void drawFocusRing(const Path&, int width, int offset, const Color&);
+    void drawFocusRing(const Vector<IntRect>&, int width, int offset, const Color&);
+
+    void fillRect(const FloatRect&);
+    void fillRect(const FloatRect&, const Color&);
+    void fillRect(const FloatRect&, Gradient&);
+    void fillRoundedRect(const FloatRoundedRect&, const Color&, BlendMode);
+    void fillRectWithRoundedHole(const FloatRect&, const FloatRoundedRect& roundedHoleRect, const Color&);
+    void fillPath(const Path&);
+    void strokeRect(const FloatRect&, float lineWidth);
+    void strokePath(const Path&);
+    void clearRect(const FloatRect&);
+
+    void beginTransparencyLayer(float opacity);
+    void endTransparencyLayer();
+
+    FloatRect roundToDevicePixels(const FloatRect&) const;
+
+    void markAsNotReplayable() { m_displayList.m_isReplayable = false; }
+
+private:
+    struct ContextState {
+        // Relative to the base CTM, i.e. mapping user space to recording space.
+        AffineTransform ctm;
+        // In recording space.
+        FloatRect clipBounds;
+        // The state the last SetState item established, if any.
+        Optional<GraphicsContextState> recordedState;
+    };
+
+    ContextState& currentState() { return m_stateStack.last(); }
+    const ContextState& currentState() const { return m_stateStack.last(); }
+
+    void appendItem(Ref<Item>&&);
+    void appendDrawingItem(Ref<DrawingItem>&&);
+    void appendStateChangeIfNeeded();
+    Optional<FloatRect> extentFromLocalBounds(const Optional<FloatRect>&) const;
+    void intersectClip(const FloatRect& localRect);
+
+    GraphicsContext& m_graphicsContext;
+    DisplayList& m_displayList;
+    AffineTransform m_baseCTM;
+    Vector<ContextState, 32> m_stateStack;
+};
+
+} // namespace DisplayList
+
+} // namespace WebCore
+
+#endif // DisplayListRecorder_h
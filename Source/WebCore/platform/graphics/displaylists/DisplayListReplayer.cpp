@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "DisplayListReplayer.h"
+
+#include "GraphicsContext.h"
+
+namespace WebCore {
+namespace DisplayList {
+
+Replayer::Replayer(GraphicsContext& context, const DisplayList& displayList)
+    : m_context(context)
+    , m_displayList(displayList)
+{
+}
+
+Replayer::~Replayer()
+{
+}
+
+void Replayer::replay(const FloatRect& clipRect)
+{
+    bool cullItems = clipRect != FloatRect::infiniteRect();
+
+    for (size_t i = 0; i < m_displayList.itemCount(); ++i) {
+        auto& item = m_displayList.itemAt(i);
+
+        if (cullItems && is<DrawingItem>(item)) {
+            auto& extent = downcast<DrawingItem>(item).extent();
+            if (extent && !extent.value().intersects(clipRect))
+                continue;
+        }
+
+        item.apply(m_context);
+    }
+}
+
+} // namespace DisplayList
+} // namespace WebCore
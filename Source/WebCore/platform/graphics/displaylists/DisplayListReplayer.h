@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DisplayListReplayer_h
+#define DisplayListReplayer_h
+
+#include "DisplayList.h"
+#include <wtf/Noncopyable.h>
+
+namespace WebCore {
+
+class GraphicsContext;
+
+namespace DisplayList {
+
+// Plays a display list back into a context. The context's current transform maps the
+// recording space onto the destination, so a list can be rasterized at a different
+// scale, or translated into a tile, by transforming the context first.
+class Replayer {
+    WTF_MAKE_NONCOPYABLE(Replayer);
+public:
+    WEBCORE_EXPORT Replayer(GraphicsContext&, const DisplayList&);
+    WEBCORE_EXPORT ~Replayer();
+
+    // Replays the whole list, skipping drawing items whose extent misses the given
+    // rect, which is in recording space. State items are always replayed, so the
+    // result inside the rect is the same as for a full replay.
+    WEBCORE_EXPORT void replay(const FloatRect& clipRect = FloatRect::infiniteRect());
+
+private:
+    GraphicsContext& m_context;
+    const DisplayList& m_displayList;
+};
+
+} // namespace DisplayList
+
+} // namespace WebCore
+
+#endif // DisplayListReplayer_h
@@ -23,6 +23,8 @@
 
 #include "GraphicsContext3D.h"
 #include "PlatformDisplay.h"
+#include <EGL/eglext.h>
+#include <wtf/text/WTFString.h>
 
 #if USE(CAIRO)
 #include <cairo.h>
@@ -122,7 +124,16 @@ std::unique_ptr<GLContextEGL> GLContextEGL::createWindowContext(EGLNativeWindowT
     return glContext;
 }
 
-std::unique_ptr<GLContextEGL> GLContextEGL::createPbufferContext(EGLContext sharingContext)
+std::unique_ptr<GLContextEGL> GLContextEGL::createPbufferContext(const IntSize& size, GLContext* sharingContext, std::unique_ptr<GLContext::Data>&& contextData)
+{
+    EGLContext eglSharingContext = sharingContext ? static_cast<GLContextEGL*>(sharingContext)->m_context : 0;
+    auto glContext = createPbufferContext(eglSharingContext, size);
+    if (glContext)
+        glContext->m_contextData = WTF::move(contextData);
+    return glContext;
+}
+
+std::unique_ptr<GLContextEGL> GLContextEGL::createPbufferContext(EGLContext sharingContext, const IntSize& size)
 {
     EGLDisplay display = sharedEGLDisplay();
     if (display == EGL_NO_DISPLAY)
@@ -136,7 +147,7 @@ std::unique_ptr<GLContextEGL> GLContextEGL::createPbufferContext(EGLContext shar
     if (context == EGL_NO_CONTEXT)
         return nullptr;
 
-    static const int pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+    const EGLint pbufferAttributes[] = { EGL_WIDTH, std::max(1, size.width()), EGL_HEIGHT, std::max(1, size.height()), EGL_NONE };
     EGLSurface surface = eglCreatePbufferSurface(display, config, pbufferAttributes);
     if (surface == EGL_NO_SURFACE) {
         eglDestroyContext(display, context);
@@ -207,7 +218,7 @@ std::unique_ptr<GLContextEGL> GLContextEGL::createContext(EGLNativeWindowType wi
         context = createPixmapContext(eglSharingContext);
 #endif
     if (!context)
-        context = createPbufferContext(eglSharingContext);
+        context = createPbufferContext(eglSharingContext, IntSize(1, 1));
 
     if (context)
         context->m_contextData = WTF::move(contextData);
@@ -252,7 +263,7 @@ GLContextEGL::~GLContextEGL()
 
 bool GLContextEGL::canRenderToDefaultFramebuffer()
 {
-    return m_type == WindowSurface;
+    return m_type == WindowSurface || m_type == PbufferSurface;
 }
 
 IntSize GLContextEGL::defaultFrameBufferSize()
@@ -285,6 +296,64 @@ void GLContextEGL::swapBuffers()
     eglSwapBuffers(sharedEGLDisplay(), m_surface);
 }
 
+static bool isEGLExtensionSupported(const char* name)
+{
+    const char* extensions = eglQueryString(sharedEGLDisplay(), EGL_EXTENSIONS);
+    if (!extensions)
+        return false;
+
+    Vector<String> extensionList;
+    String(extensions).split(' ', extensionList);
+    return extensionList.contains(name);
+}
+
+unsigned GLContextEGL::bufferAge()
+{
+#if defined(EGL_EXT_buffer_age)
+    ASSERT(m_surface);
+    static bool hasBufferAge = isEGLExtensionSupported("EGL_EXT_buffer_age");
+    if (!hasBufferAge || m_type != WindowSurface)
+        return 0;
+
+    EGLint age;
+    if (!eglQuerySurface(sharedEGLDisplay(), m_surface, EGL_BUFFER_AGE_EXT, &age) || age < 0)
+        return 0;
+    return age;
+#else
+    return 0;
+#endif
+}
+
+void GLContextEGL::swapBuffersWithDamage(const Vector<IntRect>& rects)
+{
+    ASSERT(m_surface);
+    typedef EGLBoolean (*SwapBuffersWithDamageFunction)(EGLDisplay, EGLSurface, EGLint*, EGLint);
+    static SwapBuffersWithDamageFunction swapBuffersWithDamage = [] {
+        if (isEGLExtensionSupported("EGL_KHR_swap_buffers_with_damage"))
+            return reinterpret_cast<SwapBuffersWithDamageFunction>(eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
+        if (isEGLExtensionSupported("EGL_EXT_swap_buffers_with_damage"))
+            return reinterpret_cast<SwapBuffersWithDamageFunction>(eglGetProcAddress("eglSwapBuffersWithDamageEXT"));
+        return static_cast<SwapBuffersWithDamageFunction>(nullptr);
+    }();
+
+    IntSize size = defaultFrameBufferSize();
+    if (!swapBuffersWithDamage || rects.isEmpty() || size.isEmpty()) {
+        swapBuffers();
+        return;
+    }
+
+    // EGL damage rects have their origin at the bottom-left corner of the surface.
+    Vector<EGLint> eglRects;
+    eglRects.reserveInitialCapacity(rects.size() * 4);
+    for (const auto& rect : rects) {
+        eglRects.uncheckedAppend(rect.x());
+        eglRects.uncheckedAppend(size.height() - rect.maxY());
+        eglRects.uncheckedAppend(rect.width());
+        eglRects.uncheckedAppend(rect.height());
+    }
+    swapBuffersWithDamage(sharedEGLDisplay(), m_surface, eglRects.data(), rects.size());
+}
+
 void GLContextEGL::waitNative()
 {
     eglWaitNative(EGL_CORE_NATIVE_ENGINE);
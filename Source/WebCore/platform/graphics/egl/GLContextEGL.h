@@ -37,6 +37,7 @@ public:
     enum EGLSurfaceType { PbufferSurface, WindowSurface, PixmapSurface };
     static std::unique_ptr<GLContextEGL> createContext(EGLNativeWindowType, GLContext* sharingContext = 0, std::unique_ptr<GLContext::Data>&& = nullptr);
     static std::unique_ptr<GLContextEGL> createWindowContext(EGLNativeWindowType, GLContext* sharingContext, std::unique_ptr<GLContext::Data>&& = nullptr);
+    static std::unique_ptr<GLContextEGL> createPbufferContext(const IntSize&, GLContext* sharingContext, std::unique_ptr<GLContext::Data>&& = nullptr);
 
     GLContextEGL(EGLContext, EGLSurface, EGLSurfaceType);
 #if PLATFORM(X11)
@@ -45,6 +46,8 @@ public:
     virtual ~GLContextEGL();
     virtual bool makeContextCurrent();
     virtual void swapBuffers();
+    virtual unsigned bufferAge();
+    virtual void swapBuffersWithDamage(const Vector<IntRect>&);
     virtual void waitNative();
     virtual bool canRenderToDefaultFramebuffer();
     virtual IntSize defaultFrameBufferSize();
@@ -58,7 +61,7 @@ public:
 #endif
 
 private:
-    static std::unique_ptr<GLContextEGL> createPbufferContext(EGLContext sharingContext);
+    static std::unique_ptr<GLContextEGL> createPbufferContext(EGLContext sharingContext, const IntSize&);
 #if PLATFORM(X11)
     static std::unique_ptr<GLContextEGL> createPixmapContext(EGLContext sharingContext);
 #endif
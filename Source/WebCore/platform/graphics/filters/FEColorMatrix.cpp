@@ -29,6 +29,7 @@
 
 #include <runtime/Uint8ClampedArray.h>
 #include <wtf/MathExtras.h>
+#include <wtf/TaskScheduler.h>
 
 namespace WebCore {
 
@@ -113,30 +114,38 @@ void effectType(Uint8ClampedArray* pixelArray, const Vector<float>& values)
     else if (filterType == FECOLORMATRIX_TYPE_HUEROTATE)
         FEColorMatrix::calculateHueRotateComponents(components, values[0]);
 
-    for (unsigned pixelByteOffset = 0; pixelByteOffset < pixelArrayLength; pixelByteOffset += 4) {
-        float red = pixelArray->item(pixelByteOffset);
-        float green = pixelArray->item(pixelByteOffset + 1);
-        float blue = pixelArray->item(pixelByteOffset + 2);
-        float alpha = pixelArray->item(pixelByteOffset + 3);
-
-        switch (filterType) {
-            case FECOLORMATRIX_TYPE_MATRIX:
-                matrix(red, green, blue, alpha, values);
-                break;
-            case FECOLORMATRIX_TYPE_SATURATE:
-            case FECOLORMATRIX_TYPE_HUEROTATE:
-                saturateAndHueRotate(red, green, blue, components);
-                break;
-            case FECOLORMATRIX_TYPE_LUMINANCETOALPHA:
-                luminance(red, green, blue, alpha);
-                break;
+    // Every pixel is transformed on its own, so large images are split into bands that are
+    // transformed in parallel.
+    static const unsigned bytesPerBand = 64 * 1024;
+    unsigned numberOfBands = (pixelArrayLength + bytesPerBand - 1) / bytesPerBand;
+    parallelFor(0, numberOfBands, [&](size_t band) {
+        unsigned bandBegin = band * bytesPerBand;
+        unsigned bandEnd = std::min(pixelArrayLength, bandBegin + bytesPerBand);
+        for (unsigned pixelByteOffset = bandBegin; pixelByteOffset < bandEnd; pixelByteOffset += 4) {
+            float red = pixelArray->item(pixelByteOffset);
+            float green = pixelArray->item(pixelByteOffset + 1);
+            float blue = pixelArray->item(pixelByteOffset + 2);
+            float alpha = pixelArray->item(pixelByteOffset + 3);
+
+            switch (filterType) {
+                case FECOLORMATRIX_TYPE_MATRIX:
+                    matrix(red, green, blue, alpha, values);
+                    break;
+                case FECOLORMATRIX_TYPE_SATURATE:
+                case FECOLORMATRIX_TYPE_HUEROTATE:
+                    saturateAndHueRotate(red, green, blue, components);
+                    break;
+                case FECOLORMATRIX_TYPE_LUMINANCETOALPHA:
+                    luminance(red, green, blue, alpha);
+                    break;
+            }
+
+            pixelArray->set(pixelByteOffset, red);
+            pixelArray->set(pixelByteOffset + 1, green);
+            pixelArray->set(pixelByteOffset + 2, blue);
+            pixelArray->set(pixelByteOffset + 3, alpha);
         }
-
-        pixelArray->set(pixelByteOffset, red);
-        pixelArray->set(pixelByteOffset + 1, green);
-        pixelArray->set(pixelByteOffset + 2, blue);
-        pixelArray->set(pixelByteOffset + 3, alpha);
-    }
+    });
 }
 
 void FEColorMatrix::platformApplySoftware()
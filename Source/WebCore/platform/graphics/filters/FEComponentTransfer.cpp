@@ -31,6 +31,7 @@
 #include <runtime/Uint8ClampedArray.h>
 #include <wtf/MathExtras.h>
 #include <wtf/StdLibExtras.h>
+#include <wtf/TaskScheduler.h>
 
 namespace WebCore {
 
@@ -164,12 +165,20 @@ void FEComponentTransfer::platformApplySoftware()
 
     unsigned pixelArrayLength = pixelArray->length();
     unsigned char* data = pixelArray->data();
-    for (unsigned pixelOffset = 0; pixelOffset < pixelArrayLength; pixelOffset += 4) {
-        for (unsigned channel = 0; channel < 4; ++channel) {
-            unsigned char c = data[pixelOffset + channel];
-            data[pixelOffset + channel] = tables[channel][c];
+
+    // The lookups are cheap, so only images of several bands are worth splitting between threads.
+    static const unsigned bytesPerBand = 256 * 1024;
+    unsigned numberOfBands = (pixelArrayLength + bytesPerBand - 1) / bytesPerBand;
+    parallelFor(0, numberOfBands, [&](size_t band) {
+        unsigned bandBegin = band * bytesPerBand;
+        unsigned bandEnd = std::min(pixelArrayLength, bandBegin + bytesPerBand);
+        for (unsigned pixelOffset = bandBegin; pixelOffset < bandEnd; pixelOffset += 4) {
+            for (unsigned channel = 0; channel < 4; ++channel) {
+                unsigned char c = data[pixelOffset + channel];
+                data[pixelOffset + channel] = tables[channel][c];
+            }
         }
-    }
+    });
 }
 
 void FEComponentTransfer::getValues(unsigned char rValues[256], unsigned char gValues[256], unsigned char bValues[256], unsigned char aValues[256])
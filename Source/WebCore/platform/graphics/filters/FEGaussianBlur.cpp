@@ -26,7 +26,7 @@
 #include "config.h"
 #include "FEGaussianBlur.h"
 
-#include "FEGaussianBlurNEON.h"
+#include "BoxBlur.h"
 #include "Filter.h"
 #include "GraphicsContext.h"
 #include "TextStream.h"
@@ -172,127 +172,11 @@ inline void boxBlur(const Uint8ClampedArray* srcPixelArray, Uint8ClampedArray* d
             effectWidth, effectHeight, maxKernelSize);
     }
 
-    unsigned char* srcData = srcPixelArray->data();
-    unsigned char* dstData = dstPixelArray->data();
-
-    // Concerning the array width/length: it is Element size + Margin + Border. The number of pixels will be
-    // P = width * height * channels.
-    for (int y = 0; y < effectHeight; ++y) {
-        int line = y * strideLine;
-        int sumR = 0, sumG = 0, sumB = 0, sumA = 0;
-
-        if (edgeMode == EDGEMODE_NONE) {
-            // Fill the kernel.
-            for (int i = 0; i < maxKernelSize; ++i) {
-                unsigned offset = line + i * stride;
-                unsigned char* srcPtr = srcData + offset;
-                sumR += *srcPtr++;
-                sumG += *srcPtr++;
-                sumB += *srcPtr++;
-                sumA += *srcPtr;
-            }
-
-            // Blurring.
-            for (int x = 0; x < effectWidth; ++x) {
-                unsigned pixelByteOffset = line + x * stride;
-                unsigned char* dstPtr = dstData + pixelByteOffset;
-
-                *dstPtr++ = static_cast<unsigned char>(sumR / dx);
-                *dstPtr++ = static_cast<unsigned char>(sumG / dx);
-                *dstPtr++ = static_cast<unsigned char>(sumB / dx);
-                *dstPtr = static_cast<unsigned char>(sumA / dx);
-
-                // Shift kernel.
-                if (x >= dxLeft) {
-                    unsigned leftOffset = pixelByteOffset - dxLeft * stride;
-                    unsigned char* srcPtr = srcData + leftOffset;
-                    sumR -= srcPtr[0];
-                    sumG -= srcPtr[1];
-                    sumB -= srcPtr[2];
-                    sumA -= srcPtr[3];
-                }
-
-                if (x + dxRight < effectWidth) {
-                    unsigned rightOffset = pixelByteOffset + dxRight * stride;
-                    unsigned char* srcPtr = srcData + rightOffset;
-                    sumR += srcPtr[0];
-                    sumG += srcPtr[1];
-                    sumB += srcPtr[2];
-                    sumA += srcPtr[3];
-                }
-            }
-
-        } else {
-            // FIXME: Add support for 'wrap' here.
-            // Get edge values for edgeMode 'duplicate'.
-            unsigned char* edgeValueLeft = srcData + line;
-            unsigned char* edgeValueRight  = srcData + (line + (effectWidth - 1) * stride);
-
-            // Fill the kernel.
-            for (int i = dxLeft * -1; i < dxRight; ++i) {
-                // Is this right for negative values of 'i'?
-                unsigned offset = line + i * stride;
-                unsigned char* srcPtr = srcData + offset;
-
-                if (i < 0) {
-                    sumR += edgeValueLeft[0];
-                    sumG += edgeValueLeft[1];
-                    sumB += edgeValueLeft[2];
-                    sumA += edgeValueLeft[3];
-                } else if (i >= effectWidth) {
-                    sumR += edgeValueRight[0];
-                    sumG += edgeValueRight[1];
-                    sumB += edgeValueRight[2];
-                    sumA += edgeValueRight[3];
-                } else {
-                    sumR += *srcPtr++;
-                    sumG += *srcPtr++;
-                    sumB += *srcPtr++;
-                    sumA += *srcPtr;
-                }
-            }
-
-            // Blurring.
-            for (int x = 0; x < effectWidth; ++x) {
-                unsigned pixelByteOffset = line + x * stride;
-                unsigned char* dstPtr = dstData + pixelByteOffset;
-
-                *dstPtr++ = static_cast<unsigned char>(sumR / dx);
-                *dstPtr++ = static_cast<unsigned char>(sumG / dx);
-                *dstPtr++ = static_cast<unsigned char>(sumB / dx);
-                *dstPtr = static_cast<unsigned char>(sumA / dx);
-
-                // Shift kernel.
-                if (x < dxLeft) {
-                    sumR -= edgeValueLeft[0];
-                    sumG -= edgeValueLeft[1];
-                    sumB -= edgeValueLeft[2];
-                    sumA -= edgeValueLeft[3];
-                } else {
-                    unsigned leftOffset = pixelByteOffset - dxLeft * stride;
-                    unsigned char* srcPtr = srcData + leftOffset;
-                    sumR -= srcPtr[0];
-                    sumG -= srcPtr[1];
-                    sumB -= srcPtr[2];
-                    sumA -= srcPtr[3];
-                }
-
-                if (x + dxRight >= effectWidth) {
-                    sumR += edgeValueRight[0];
-                    sumG += edgeValueRight[1];
-                    sumB += edgeValueRight[2];
-                    sumA += edgeValueRight[3];
-                } else {
-                    unsigned rightOffset = pixelByteOffset + dxRight * stride;
-                    unsigned char* srcPtr = srcData + rightOffset;
-                    sumR += srcPtr[0];
-                    sumG += srcPtr[1];
-                    sumB += srcPtr[2];
-                    sumA += srcPtr[3];
-                }
-            }
-        }
-    }
+    // The kernel covers dxLeft pixels before the output pixel, and dxRight - 1 after it.
+    ASSERT_UNUSED(dx, dx == static_cast<unsigned>(dxLeft + dxRight));
+    // FIXME: Add support for 'wrap' here.
+    boxBlurPixelLines(srcPixelArray->data(), dstPixelArray->data(), stride, strideLine, effectWidth, effectHeight, dxLeft, dxRight - 1,
+        edgeMode == EDGEMODE_NONE ? BoxBlurEdgeMode::Transparent : BoxBlurEdgeMode::Duplicate);
 }
 
 #if USE(ACCELERATE)
@@ -344,27 +228,13 @@ inline void standardBoxBlur(Uint8ClampedArray* src, Uint8ClampedArray* dst, unsi
     for (int i = 0; i < 3; ++i) {
         if (kernelSizeX) {
             kernelPosition(i, kernelSizeX, dxLeft, dxRight);
-#if HAVE(ARM_NEON_INTRINSICS)
-            if (!isAlphaImage)
-                boxBlurNEON(src, dst, kernelSizeX, dxLeft, dxRight, 4, stride, paintSize.width(), paintSize.height());
-            else
-                boxBlur(src, dst, kernelSizeX, dxLeft, dxRight, 4, stride, paintSize.width(), paintSize.height(), true, edgeMode);
-#else
             boxBlur(src, dst, kernelSizeX, dxLeft, dxRight, 4, stride, paintSize.width(), paintSize.height(), isAlphaImage, edgeMode);
-#endif
             std::swap(src, dst);
         }
 
         if (kernelSizeY) {
             kernelPosition(i, kernelSizeY, dyLeft, dyRight);
-#if HAVE(ARM_NEON_INTRINSICS)
-            if (!isAlphaImage)
-                boxBlurNEON(src, dst, kernelSizeY, dyLeft, dyRight, stride, 4, paintSize.height(), paintSize.width());
-            else
-                boxBlur(src, dst, kernelSizeY, dyLeft, dyRight, stride, 4, paintSize.height(), paintSize.width(), true, edgeMode);
-#else
             boxBlur(src, dst, kernelSizeY, dyLeft, dyRight, stride, 4, paintSize.height(), paintSize.width(), isAlphaImage, edgeMode);
-#endif
             std::swap(src, dst);
         }
     }
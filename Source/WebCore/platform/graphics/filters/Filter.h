@@ -54,6 +54,10 @@ public:
 
     virtual bool isSVGFilter() const { return false; }
 
+    // Whether the results of all effects stay around after the last effect was applied. Filters that
+    // never reuse them can have them released as soon as the last effect reading them is done.
+    virtual bool keepsIntermediateResults() const { return true; }
+
     virtual float applyHorizontalScale(float value) const { return value * m_filterResolution.width(); }
     virtual float applyVerticalScale(float value) const { return value * m_filterResolution.height(); }
     
@@ -30,6 +30,8 @@
 #include <runtime/JSCInlines.h>
 #include <runtime/TypedArrayInlines.h>
 #include <runtime/Uint8ClampedArray.h>
+#include <wtf/HashMap.h>
+#include <wtf/MainThread.h>
 
 #if HAVE(ARM_NEON_INTRINSICS)
 #include <arm_neon.h>
@@ -114,10 +116,115 @@ unsigned FilterEffect::totalNumberOfEffectInputs() const
     return collectEffects(this, allEffects);
 }
 
+// State shared by all effects applied while the last effect of a filter is applied. When the filter
+// does not keep intermediate results, it counts how many effects still have to read each result and
+// drops the result once none is left, keeping its pixel arrays to back the results that come after.
+class FilterEffect::ApplyContext {
+    WTF_MAKE_NONCOPYABLE(ApplyContext);
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    explicit ApplyContext(FilterEffect& lastEffect)
+        : m_filter(lastEffect.filter())
+        , m_previous(s_current)
+    {
+        ASSERT(isMainThread());
+        if (!m_filter.keepsIntermediateResults()) {
+            HashSet<FilterEffect*> visitedEffects;
+            countPendingReads(lastEffect, visitedEffects);
+        }
+        s_current = this;
+    }
+
+    ~ApplyContext()
+    {
+        ASSERT(s_current == this);
+        s_current = m_previous;
+    }
+
+    static ApplyContext* current() { return s_current; }
+    const Filter& filter() const { return m_filter; }
+
+    void didApply(FilterEffect& effect)
+    {
+        for (auto& input : effect.m_inputEffects) {
+            auto it = m_pendingReads.find(input.get());
+            // An effect without a result may be applied again for another consumer.
+            if (it == m_pendingReads.end() || !it->value)
+                continue;
+            if (!--it->value)
+                releaseResult(*input);
+        }
+    }
+
+    static RefPtr<Uint8ClampedArray> createImageResultArray(unsigned length)
+    {
+        if (s_current) {
+            auto& recycledArrays = s_current->m_recycledArrays;
+            for (size_t i = 0; i < recycledArrays.size(); ++i) {
+                if (recycledArrays[i]->length() != length)
+                    continue;
+                RefPtr<Uint8ClampedArray> array = recycledArrays[i].release();
+                recycledArrays.remove(i);
+                return array;
+            }
+        }
+        return Uint8ClampedArray::createUninitialized(length);
+    }
+
+private:
+    // Effects that already have a result are not applied again, so they read nothing.
+    void countPendingReads(FilterEffect& effect, HashSet<FilterEffect*>& visitedEffects)
+    {
+        if (effect.hasResult() || !visitedEffects.add(&effect).isNewEntry)
+            return;
+        for (auto& input : effect.m_inputEffects) {
+            ++m_pendingReads.add(input.get(), 0).iterator->value;
+            countPendingReads(*input, visitedEffects);
+        }
+    }
+
+    void releaseResult(FilterEffect& effect)
+    {
+        recycleArray(effect.m_unmultipliedImageResult.release());
+        recycleArray(effect.m_premultipliedImageResult.release());
+        effect.clearResult();
+    }
+
+    void recycleArray(PassRefPtr<Uint8ClampedArray> prpArray)
+    {
+        RefPtr<Uint8ClampedArray> array = prpArray;
+        // Nothing but the result can be holding on to the array for it to be overwritten.
+        static const size_t maximumRecycledArrays = 4;
+        if (array && array->hasOneRef() && m_recycledArrays.size() < maximumRecycledArrays)
+            m_recycledArrays.append(array.release());
+    }
+
+    static ApplyContext* s_current;
+
+    Filter& m_filter;
+    ApplyContext* m_previous;
+    HashMap<FilterEffect*, unsigned> m_pendingReads;
+    Vector<RefPtr<Uint8ClampedArray>> m_recycledArrays;
+};
+
+FilterEffect::ApplyContext* FilterEffect::ApplyContext::s_current = nullptr;
+
 void FilterEffect::apply()
 {
     if (hasResult())
         return;
+
+    // An feImage may paint content with a filter of its own, which is applied in a context of its own.
+    std::unique_ptr<ApplyContext> context;
+    if (!ApplyContext::current() || &ApplyContext::current()->filter() != &m_filter)
+        context = std::make_unique<ApplyContext>(*this);
+
+    applyInputsAndEffect();
+    ApplyContext::current()->didApply(*this);
+}
+
+void FilterEffect::applyInputsAndEffect()
+{
     unsigned size = m_inputEffects.size();
     for (unsigned i = 0; i < size; ++i) {
         FilterEffect* in = m_inputEffects.at(i).get();
@@ -314,7 +421,7 @@ void FilterEffect::copyUnmultipliedImage(Uint8ClampedArray* destination, const I
             IntSize inputSize(m_absolutePaintRect.size());
             ASSERT(!ImageBuffer::sizeNeedsClamping(inputSize));
             inputSize.scale(m_filter.filterScale());
-            m_unmultipliedImageResult = Uint8ClampedArray::createUninitialized(inputSize.width() * inputSize.height() * 4);
+            m_unmultipliedImageResult = ApplyContext::createImageResultArray(inputSize.width() * inputSize.height() * 4);
             unsigned char* sourceComponent = m_premultipliedImageResult->data();
             unsigned char* destinationComponent = m_unmultipliedImageResult->data();
             unsigned char* end = sourceComponent + (inputSize.width() * inputSize.height() * 4);
@@ -350,7 +457,7 @@ void FilterEffect::copyPremultipliedImage(Uint8ClampedArray* destination, const
             IntSize inputSize(m_absolutePaintRect.size());
             ASSERT(!ImageBuffer::sizeNeedsClamping(inputSize));
             inputSize.scale(m_filter.filterScale());
-            m_premultipliedImageResult = Uint8ClampedArray::createUninitialized(inputSize.width() * inputSize.height() * 4);
+            m_premultipliedImageResult = ApplyContext::createImageResultArray(inputSize.width() * inputSize.height() * 4);
             unsigned char* sourceComponent = m_unmultipliedImageResult->data();
             unsigned char* destinationComponent = m_premultipliedImageResult->data();
             unsigned char* end = sourceComponent + (inputSize.width() * inputSize.height() * 4);
@@ -393,7 +500,7 @@ Uint8ClampedArray* FilterEffect::createUnmultipliedImageResult()
     IntSize resultSize(m_absolutePaintRect.size());
     ASSERT(!ImageBuffer::sizeNeedsClamping(resultSize));
     resultSize.scale(m_filter.filterScale());
-    m_unmultipliedImageResult = Uint8ClampedArray::createUninitialized(resultSize.width() * resultSize.height() * 4);
+    m_unmultipliedImageResult = ApplyContext::createImageResultArray(resultSize.width() * resultSize.height() * 4);
     return m_unmultipliedImageResult.get();
 }
 
@@ -407,7 +514,7 @@ Uint8ClampedArray* FilterEffect::createPremultipliedImageResult()
     IntSize resultSize(m_absolutePaintRect.size());
     ASSERT(!ImageBuffer::sizeNeedsClamping(resultSize));
     resultSize.scale(m_filter.filterScale());
-    m_premultipliedImageResult = Uint8ClampedArray::createUninitialized(resultSize.width() * resultSize.height() * 4);
+    m_premultipliedImageResult = ApplyContext::createImageResultArray(resultSize.width() * resultSize.height() * 4);
     return m_premultipliedImageResult.get();
 }
 
@@ -190,6 +190,10 @@ private:
     Filter& m_filter;
     
 private:
+    class ApplyContext;
+
+    void applyInputsAndEffect();
+
     inline void copyImageBytes(Uint8ClampedArray* source, Uint8ClampedArray* destination, const IntRect&);
 
     // The following member variables are SVG specific and will move to RenderSVGResourceFilterPrimitive.
@@ -118,6 +118,11 @@ void Icon::paint(GraphicsContext& context, const FloatRect& rect)
     if (context.paintingDisabled())
         return;
 
+    if (context.isRecording()) {
+        context.markRecordingAsNotReplayable();
+        return;
+    }
+
     // TODO: Scale/clip the image if necessary.
     cairo_t* cr = context.platformContext()->cr();
     cairo_save(cr);
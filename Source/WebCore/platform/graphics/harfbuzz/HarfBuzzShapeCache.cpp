@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "HarfBuzzShapeCache.h"
+
+#include <wtf/Hasher.h>
+#include <wtf/MainThread.h>
+#include <wtf/text/StringHash.h>
+
+namespace WebCore {
+
+static const size_t s_defaultMemoryBudget = 4 * 1024 * 1024;
+
+HarfBuzzShapeCache::Key::Key(const UChar* characters, unsigned length, const FontPlatformData& platformData, hb_script_t script, hb_direction_t direction, const hb_feature_t* features, unsigned featureCount)
+    : m_text(characters, length)
+    , m_platformData(platformData)
+    , m_script(script)
+    , m_direction(direction)
+    , m_features(featureCount)
+{
+    IntegerHasher hasher;
+    hasher.add(m_text.impl()->hash());
+    hasher.add(m_platformData.hash());
+    hasher.add(m_script);
+    hasher.add(m_direction);
+    for (unsigned i = 0; i < featureCount; ++i) {
+        m_features[i] = features[i];
+        hasher.add(features[i].tag);
+        hasher.add(features[i].value);
+        hasher.add(features[i].start);
+        hasher.add(features[i].end);
+    }
+    m_hash = hasher.hash();
+}
+
+size_t HarfBuzzShapeCache::Key::sizeInBytes() const
+{
+    return sizeof(Key) + m_text.sizeInBytes() + m_features.size() * sizeof(hb_feature_t);
+}
+
+bool HarfBuzzShapeCache::Key::operator==(const Key& other) const
+{
+    if (m_hash != other.m_hash || m_script != other.m_script || m_direction != other.m_direction || m_text != other.m_text)
+        return false;
+
+    if (m_features.size() != other.m_features.size())
+        return false;
+    for (size_t i = 0; i < m_features.size(); ++i) {
+        const hb_feature_t& a = m_features[i];
+        const hb_feature_t& b = other.m_features[i];
+        if (a.tag != b.tag || a.value != b.value || a.start != b.start || a.end != b.end)
+            return false;
+    }
+
+    return m_platformData == other.m_platformData;
+}
+
+HarfBuzzShapeCache::ShapeResult::ShapeResult(hb_buffer_t* buffer)
+{
+    unsigned numGlyphs = hb_buffer_get_length(buffer);
+    glyphInfos.append(hb_buffer_get_glyph_infos(buffer, 0), numGlyphs);
+    glyphPositions.append(hb_buffer_get_glyph_positions(buffer, 0), numGlyphs);
+}
+
+const FontPlatformData& HarfBuzzShapeCache::FontHashTraits::emptyValue()
+{
+    static NeverDestroyed<FontPlatformData> platformData(0.f, false, false);
+    return platformData;
+}
+
+HarfBuzzShapeCache& HarfBuzzShapeCache::singleton()
+{
+    ASSERT(isMainThread());
+    static NeverDestroyed<HarfBuzzShapeCache> cache;
+    return cache;
+}
+
+HarfBuzzShapeCache::HarfBuzzShapeCache()
+    : m_memoryBudget(s_defaultMemoryBudget)
+{
+}
+
+const HarfBuzzShapeCache::ShapeResult* HarfBuzzShapeCache::find(const Key& key)
+{
+    auto it = m_results.find(key);
+    if (it == m_results.end()) {
+        ++m_misses;
+        return nullptr;
+    }
+
+    ++m_hits;
+    m_keys.appendOrMoveToLast(key);
+    return &it->value;
+}
+
+void HarfBuzzShapeCache::add(const Key& key, ShapeResult&& result)
+{
+    size_t size = key.sizeInBytes() + result.sizeInBytes();
+    if (size > m_memoryBudget)
+        return;
+
+    auto addResult = m_results.add(key, WTF::move(result));
+    if (!addResult.isNewEntry)
+        return;
+
+    m_keys.appendOrMoveToLast(key);
+    m_keysByFont.add(key.platformData(), Vector<Key>()).iterator->value.append(key);
+    m_bytes += size;
+    if (m_bytes > m_memoryBudget)
+        evictEntries(m_bytes - m_memoryBudget);
+}
+
+void HarfBuzzShapeCache::removeEntriesForFont(const FontPlatformData& platformData)
+{
+    Vector<Key> keysToRemove = m_keysByFont.take(platformData);
+    for (auto& key : keysToRemove) {
+        auto it = m_results.find(key);
+        ASSERT(it != m_results.end());
+        m_bytes -= key.sizeInBytes() + it->value.sizeInBytes();
+        m_results.remove(it);
+        m_keys.remove(key);
+    }
+}
+
+void HarfBuzzShapeCache::setMemoryBudget(size_t bytes)
+{
+    m_memoryBudget = bytes;
+    if (m_bytes > m_memoryBudget)
+        evictEntries(m_bytes - m_memoryBudget);
+}
+
+void HarfBuzzShapeCache::clear()
+{
+    m_evictedEntries += m_results.size();
+    m_results.clear();
+    m_keys.clear();
+    m_keysByFont.clear();
+    m_bytes = 0;
+}
+
+void HarfBuzzShapeCache::evictEntries(size_t bytesToFree)
+{
+    size_t freedBytes = 0;
+    while (freedBytes < bytesToFree && !m_keys.isEmpty()) {
+        const Key& key = m_keys.first();
+        auto it = m_results.find(key);
+        ASSERT(it != m_results.end());
+        freedBytes += key.sizeInBytes() + it->value.sizeInBytes();
+        m_results.remove(it);
+        removeKeyFromFontIndex(key);
+        m_keys.removeFirst();
+        ++m_evictedEntries;
+    }
+
+    ASSERT(freedBytes <= m_bytes);
+    m_bytes -= freedBytes;
+}
+
+void HarfBuzzShapeCache::removeKeyFromFontIndex(const Key& key)
+{
+    auto it = m_keysByFont.find(key.platformData());
+    ASSERT(it != m_keysByFont.end());
+    bool removed = it->value.removeFirst(key);
+    ASSERT_UNUSED(removed, removed);
+    if (it->value.isEmpty())
+        m_keysByFont.remove(it);
+}
+
+HarfBuzzShapeCache::Stats HarfBuzzShapeCache::stats() const
+{
+    Stats stats;
+    stats.entryCount = m_results.size();
+    stats.bytes = m_bytes;
+    stats.memoryBudget = m_memoryBudget;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictedEntries = m_evictedEntries;
+    return stats;
+}
+
+} // namespace WebCore
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HarfBuzzShapeCache_h
+#define HarfBuzzShapeCache_h
+
+#include "FontPlatformData.h"
+#include "hb.h"
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
+#include <wtf/NeverDestroyed.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+#include <wtf/text/WTFString.h>
+
+namespace WebCore {
+
+// Keeps the glyphs HarfBuzz produced for recently shaped runs of text, so that measuring and
+// painting the same text, or laying it out again, doesn't shape it every time. Results are
+// stored as hb_shape() returned them; letter spacing, word spacing and justification are
+// applied by the shaper afterwards. Entries are evicted least recently used first once the
+// cache goes over its memory budget, and all of them on memory pressure. Entries for a font are
+// dropped when the font is destroyed.
+//
+// Main thread only.
+class HarfBuzzShapeCache {
+    WTF_MAKE_NONCOPYABLE(HarfBuzzShapeCache);
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    class Key {
+    public:
+        Key()
+            : m_script(HB_SCRIPT_INVALID)
+            , m_direction(HB_DIRECTION_INVALID)
+            , m_hash(0)
+        {
+        }
+
+        Key(WTF::HashTableDeletedValueType)
+            : m_text(WTF::HashTableDeletedValue)
+            , m_script(HB_SCRIPT_INVALID)
+            , m_direction(HB_DIRECTION_INVALID)
+            , m_hash(0)
+        {
+        }
+
+        Key(const UChar* characters, unsigned length, const FontPlatformData&, hb_script_t, hb_direction_t, const hb_feature_t* features, unsigned featureCount);
+
+        unsigned hash() const { return m_hash; }
+        size_t sizeInBytes() const;
+        const FontPlatformData& platformData() const { return m_platformData; }
+
+        bool isHashTableDeletedValue() const { return m_text.isHashTableDeletedValue(); }
+        bool isHashTableEmptyValue() const { return m_text.isNull(); }
+
+        bool operator==(const Key&) const;
+
+    private:
+        String m_text;
+        FontPlatformData m_platformData;
+        hb_script_t m_script;
+        hb_direction_t m_direction;
+        Vector<hb_feature_t> m_features;
+        unsigned m_hash;
+    };
+
+    struct ShapeResult {
+        ShapeResult() { }
+        explicit ShapeResult(hb_buffer_t*);
+
+        unsigned numGlyphs() const { return glyphInfos.size(); }
+        size_t sizeInBytes() const { return glyphInfos.size() * sizeof(hb_glyph_info_t) + glyphPositions.size() * sizeof(hb_glyph_position_t); }
+
+        Vector<hb_glyph_info_t> glyphInfos;
+        Vector<hb_glyph_position_t> glyphPositions;
+    };
+
+    static HarfBuzzShapeCache& singleton();
+
+    // Returns null if the run isn't in the cache.
+    const ShapeResult* find(const Key&);
+    void add(const Key&, ShapeResult&&);
+
+    // Called when a Font is destroyed, so that the entries don't keep its platform data alive.
+    void removeEntriesForFont(const FontPlatformData&);
+
+    void setMemoryBudget(size_t bytes);
+
+    // Called on memory pressure.
+    void clear();
+
+    struct Stats {
+        unsigned entryCount { 0 };
+        size_t bytes { 0 };
+        size_t memoryBudget { 0 };
+        unsigned hits { 0 };
+        unsigned misses { 0 };
+        unsigned evictedEntries { 0 };
+    };
+    Stats stats() const;
+
+private:
+    friend class NeverDestroyed<HarfBuzzShapeCache>;
+
+    HarfBuzzShapeCache();
+
+    void evictEntries(size_t bytesToFree);
+
+    struct KeyHash {
+        static unsigned hash(const Key& key) { return key.hash(); }
+        static bool equal(const Key& a, const Key& b) { return a == b; }
+        static const bool safeToCompareToEmptyOrDeleted = false;
+    };
+
+    struct KeyHashTraits : WTF::SimpleClassHashTraits<Key> {
+        static const bool emptyValueIsZero = false;
+        static const bool hasIsEmptyValueFunction = true;
+        static bool isEmptyValue(const Key& key) { return key.isHashTableEmptyValue(); }
+    };
+
+    struct FontHash {
+        static unsigned hash(const FontPlatformData& platformData) { return platformData.hash(); }
+        static bool equal(const FontPlatformData& a, const FontPlatformData& b) { return a == b; }
+        static const bool safeToCompareToEmptyOrDeleted = true;
+    };
+
+    struct FontHashTraits : WTF::GenericHashTraits<FontPlatformData> {
+        static const bool emptyValueIsZero = true;
+        static const FontPlatformData& emptyValue();
+        static void constructDeletedValue(FontPlatformData& slot) { new (NotNull, &slot) FontPlatformData(WTF::HashTableDeletedValue); }
+        static bool isDeletedValue(const FontPlatformData& value) { return value.isHashTableDeletedValue(); }
+    };
+
+    void removeKeyFromFontIndex(const Key&);
+
+    HashMap<Key, ShapeResult, KeyHash, KeyHashTraits> m_results;
+    // Least recently used first.
+    ListHashSet<Key, KeyHash> m_keys;
+    // The keys of each font, so that removeEntriesForFont() doesn't have to look at every entry.
+    HashMap<FontPlatformData, Vector<Key>, FontHash, FontHashTraits> m_keysByFont;
+    size_t m_bytes { 0 };
+    size_t m_memoryBudget;
+    unsigned m_hits { 0 };
+    unsigned m_misses { 0 };
+    unsigned m_evictedEntries { 0 };
+};
+
+} // namespace WebCore
+
+#endif // HarfBuzzShapeCache_h
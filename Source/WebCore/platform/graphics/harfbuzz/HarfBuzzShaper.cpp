@@ -81,9 +81,9 @@ HarfBuzzShaper::HarfBuzzRun::HarfBuzzRun(const Font* fontData, unsigned startInd
 {
 }
 
-void HarfBuzzShaper::HarfBuzzRun::applyShapeResult(hb_buffer_t* harfBuzzBuffer)
+void HarfBuzzShaper::HarfBuzzRun::applyShapeResult(const HarfBuzzShapeCache::ShapeResult& shapeResult)
 {
-    m_numGlyphs = hb_buffer_get_length(harfBuzzBuffer);
+    m_numGlyphs = shapeResult.numGlyphs();
     m_glyphs.resize(m_numGlyphs);
     m_advances.resize(m_numGlyphs);
     m_glyphToCharacterIndexes.resize(m_numGlyphs);
@@ -470,39 +470,59 @@ bool HarfBuzzShaper::shapeHarfBuzzRuns(bool shouldSetDirection)
             return false;
 
         hb_buffer_set_script(harfBuzzBuffer.get(), currentRun->script());
-        if (shouldSetDirection)
-            hb_buffer_set_direction(harfBuzzBuffer.get(), currentRun->rtl() ? HB_DIRECTION_RTL : HB_DIRECTION_LTR);
-        else
-            // Leaving direction to HarfBuzz to guess is *really* bad, but will do for now.
-            hb_buffer_guess_segment_properties(harfBuzzBuffer.get());
 
         // Add a space as pre-context to the buffer. This prevents showing dotted-circle
         // for combining marks at the beginning of runs.
         static const uint16_t preContext = ' ';
         hb_buffer_add_utf16(harfBuzzBuffer.get(), &preContext, 1, 1, 0);
 
+        String upperText;
+        const UChar* characters = m_normalizedBuffer.get() + currentRun->startIndex();
         if (m_font->isSmallCaps() && u_islower(m_normalizedBuffer[currentRun->startIndex()])) {
-            String upperText = String(m_normalizedBuffer.get() + currentRun->startIndex(), currentRun->numCharacters()).upper();
+            upperText = String(characters, currentRun->numCharacters()).upper();
+            if (upperText.is8Bit())
+                upperText = String::make16BitFrom8BitSource(upperText.characters8(), upperText.length());
             currentFontData = m_font->glyphDataForCharacter(upperText[0], false, SmallCapsVariant).font;
-            const UChar* characters = StringView(upperText).upconvertedCharacters();
-            hb_buffer_add_utf16(harfBuzzBuffer.get(), reinterpret_cast<const uint16_t*>(characters), currentRun->numCharacters(), 0, currentRun->numCharacters());
-        } else
-            hb_buffer_add_utf16(harfBuzzBuffer.get(), reinterpret_cast<const uint16_t*>(m_normalizedBuffer.get() + currentRun->startIndex()), currentRun->numCharacters(), 0, currentRun->numCharacters());
+            characters = upperText.characters16();
+        }
+        hb_buffer_add_utf16(harfBuzzBuffer.get(), reinterpret_cast<const uint16_t*>(characters), currentRun->numCharacters(), 0, currentRun->numCharacters());
+
+        if (shouldSetDirection)
+            hb_buffer_set_direction(harfBuzzBuffer.get(), currentRun->rtl() ? HB_DIRECTION_RTL : HB_DIRECTION_LTR);
+        else
+            // Leaving direction to HarfBuzz to guess is *really* bad, but will do for now.
+            hb_buffer_guess_segment_properties(harfBuzzBuffer.get());
 
         FontPlatformData* platformData = const_cast<FontPlatformData*>(&currentFontData->platformData());
         HarfBuzzFace* face = platformData->harfBuzzFace();
         if (!face)
             return false;
 
-        if (m_font->fontDescription().orientation() == Vertical)
-            face->setScriptForVerticalGlyphSubstitution(harfBuzzBuffer.get());
+        // The cache is keyed by the resolved direction, so that measuring and painting the
+        // same text share the result whenever HarfBuzz guesses the direction painting uses.
+        HarfBuzzShapeCache::Key cacheKey(characters, currentRun->numCharacters(), *platformData, currentRun->script(),
+            hb_buffer_get_direction(harfBuzzBuffer.get()), m_features.data(), m_features.size());
+        HarfBuzzShapeCache& shapeCache = HarfBuzzShapeCache::singleton();
+        const HarfBuzzShapeCache::ShapeResult* shapeResult = shapeCache.find(cacheKey);
 
-        HarfBuzzScopedPtr<hb_font_t> harfBuzzFont(face->createFont(), hb_font_destroy);
+        HarfBuzzShapeCache::ShapeResult newShapeResult;
+        if (!shapeResult) {
+            if (m_font->fontDescription().orientation() == Vertical)
+                face->setScriptForVerticalGlyphSubstitution(harfBuzzBuffer.get());
+
+            HarfBuzzScopedPtr<hb_font_t> harfBuzzFont(face->createFont(), hb_font_destroy);
+
+            hb_shape(harfBuzzFont.get(), harfBuzzBuffer.get(), m_features.isEmpty() ? 0 : m_features.data(), m_features.size());
+
+            newShapeResult = HarfBuzzShapeCache::ShapeResult(harfBuzzBuffer.get());
+            shapeResult = &newShapeResult;
+        }
 
-        hb_shape(harfBuzzFont.get(), harfBuzzBuffer.get(), m_features.isEmpty() ? 0 : m_features.data(), m_features.size());
+        currentRun->applyShapeResult(*shapeResult);
+        setGlyphPositionsForHarfBuzzRun(currentRun, *shapeResult);
 
-        currentRun->applyShapeResult(harfBuzzBuffer.get());
-        setGlyphPositionsForHarfBuzzRun(currentRun, harfBuzzBuffer.get());
+        if (shapeResult == &newShapeResult)
+            shapeCache.add(cacheKey, WTF::move(newShapeResult));
 
         hb_buffer_reset(harfBuzzBuffer.get());
     }
@@ -510,11 +530,11 @@ bool HarfBuzzShaper::shapeHarfBuzzRuns(bool shouldSetDirection)
     return true;
 }
 
-void HarfBuzzShaper::setGlyphPositionsForHarfBuzzRun(HarfBuzzRun* currentRun, hb_buffer_t* harfBuzzBuffer)
+void HarfBuzzShaper::setGlyphPositionsForHarfBuzzRun(HarfBuzzRun* currentRun, const HarfBuzzShapeCache::ShapeResult& shapeResult)
 {
     const Font* currentFontData = currentRun->fontData();
-    hb_glyph_info_t* glyphInfos = hb_buffer_get_glyph_infos(harfBuzzBuffer, 0);
-    hb_glyph_position_t* glyphPositions = hb_buffer_get_glyph_positions(harfBuzzBuffer, 0);
+    const hb_glyph_info_t* glyphInfos = shapeResult.glyphInfos.data();
+    const hb_glyph_position_t* glyphPositions = shapeResult.glyphPositions.data();
 
     unsigned numGlyphs = currentRun->numGlyphs();
     uint16_t* glyphToCharacterIndexes = currentRun->glyphToCharacterIndexes();
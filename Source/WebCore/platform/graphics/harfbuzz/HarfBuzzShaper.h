@@ -33,6 +33,7 @@
 
 #include "FloatPoint.h"
 #include "GlyphBuffer.h"
+#include "HarfBuzzShapeCache.h"
 #include "TextRun.h"
 #include "hb.h"
 #include <memory>
@@ -66,7 +67,7 @@ private:
     public:
         HarfBuzzRun(const Font*, unsigned startIndex, unsigned numCharacters, TextDirection, hb_script_t);
 
-        void applyShapeResult(hb_buffer_t*);
+        void applyShapeResult(const HarfBuzzShapeCache::ShapeResult&);
         void setGlyphAndPositions(unsigned index, uint16_t glyphId, float advance, float offsetX, float offsetY);
         void setWidth(float width) { m_width = width; }
 
@@ -116,7 +117,7 @@ private:
     bool shapeHarfBuzzRuns(bool shouldSetDirection);
     bool fillGlyphBuffer(GlyphBuffer*);
     void fillGlyphBufferFromHarfBuzzRun(GlyphBuffer*, HarfBuzzRun*, FloatPoint& firstOffsetOfNextRun);
-    void setGlyphPositionsForHarfBuzzRun(HarfBuzzRun*, hb_buffer_t*);
+    void setGlyphPositionsForHarfBuzzRun(HarfBuzzRun*, const HarfBuzzShapeCache::ShapeResult&);
 
     GlyphBufferAdvance createGlyphBufferAdvance(float, float);
 
@@ -223,6 +223,45 @@ void Extensions3DOpenGLCommon::getnUniformivEXT(GC3Duint, int, GC3Dsizei, int *)
     m_context->synthesizeGLError(GL_INVALID_OPERATION);
 }
 
+void Extensions3DOpenGLCommon::getProgramBinaryOES(Platform3DObject, GC3Dsizei, GC3Dsizei*, GC3Denum*, void*)
+{
+    m_context->synthesizeGLError(GL_INVALID_OPERATION);
+}
+
+void Extensions3DOpenGLCommon::programBinaryOES(Platform3DObject, GC3Denum, const void*, GC3Dint)
+{
+    m_context->synthesizeGLError(GL_INVALID_OPERATION);
+}
+
+void* Extensions3DOpenGLCommon::mapBufferRangeEXT(GC3Denum, GC3Dintptr, GC3Dsizeiptr, GC3Dbitfield)
+{
+    m_context->synthesizeGLError(GL_INVALID_OPERATION);
+    return nullptr;
+}
+
+GC3Dboolean Extensions3DOpenGLCommon::unmapBufferOES(GC3Denum)
+{
+    m_context->synthesizeGLError(GL_INVALID_OPERATION);
+    return false;
+}
+
+GC3Dsync Extensions3DOpenGLCommon::fenceSyncAPPLE(GC3Denum, GC3Dbitfield)
+{
+    m_context->synthesizeGLError(GL_INVALID_OPERATION);
+    return nullptr;
+}
+
+GC3Denum Extensions3DOpenGLCommon::clientWaitSyncAPPLE(GC3Dsync, GC3Dbitfield, GC3Duint64)
+{
+    m_context->synthesizeGLError(GL_INVALID_OPERATION);
+    return 0;
+}
+
+void Extensions3DOpenGLCommon::deleteSyncAPPLE(GC3Dsync)
+{
+    m_context->synthesizeGLError(GL_INVALID_OPERATION);
+}
+
 } // namespace WebCore
 
 #endif // ENABLE(GRAPHICS_CONTEXT_3D)
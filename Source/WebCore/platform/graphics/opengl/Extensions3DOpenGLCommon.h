@@ -59,6 +59,16 @@ public:
     virtual void getnUniformfvEXT(GC3Duint program, int location, GC3Dsizei bufSize, float *params);
     virtual void getnUniformivEXT(GC3Duint program, int location, GC3Dsizei bufSize, int *params);
 
+    virtual void getProgramBinaryOES(Platform3DObject program, GC3Dsizei bufSize, GC3Dsizei* length, GC3Denum* binaryFormat, void* binary);
+    virtual void programBinaryOES(Platform3DObject program, GC3Denum binaryFormat, const void* binary, GC3Dint length);
+
+    virtual void* mapBufferRangeEXT(GC3Denum target, GC3Dintptr offset, GC3Dsizeiptr length, GC3Dbitfield access);
+    virtual GC3Dboolean unmapBufferOES(GC3Denum target);
+
+    virtual GC3Dsync fenceSyncAPPLE(GC3Denum condition, GC3Dbitfield flags);
+    virtual GC3Denum clientWaitSyncAPPLE(GC3Dsync, GC3Dbitfield flags, GC3Duint64 timeout);
+    virtual void deleteSyncAPPLE(GC3Dsync);
+
     virtual bool isNVIDIA() { return m_isNVIDIA; }
     virtual bool isAMD() { return m_isAMD; }
     virtual bool isIntel() { return m_isIntel; }
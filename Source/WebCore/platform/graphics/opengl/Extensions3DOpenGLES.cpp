@@ -62,6 +62,13 @@ Extensions3DOpenGLES::Extensions3DOpenGLES(GraphicsContext3D* context)
     , m_glVertexAttribDivisorANGLE(nullptr)
     , m_glDrawArraysInstancedANGLE(nullptr)
     , m_glDrawElementsInstancedANGLE(nullptr)
+    , m_glGetProgramBinaryOES(nullptr)
+    , m_glProgramBinaryOES(nullptr)
+    , m_glMapBufferRangeEXT(nullptr)
+    , m_glUnmapBufferOES(nullptr)
+    , m_glFenceSyncAPPLE(nullptr)
+    , m_glClientWaitSyncAPPLE(nullptr)
+    , m_glDeleteSyncAPPLE(nullptr)
 {
 }
 
@@ -269,6 +276,83 @@ void Extensions3DOpenGLES::vertexAttribDivisor(GC3Duint index, GC3Duint divisor)
     m_glVertexAttribDivisorANGLE(index, divisor);
 }
 
+void Extensions3DOpenGLES::getProgramBinaryOES(Platform3DObject program, GC3Dsizei bufSize, GC3Dsizei* length, GC3Denum* binaryFormat, void* binary)
+{
+    if (!m_glGetProgramBinaryOES) {
+        m_context->synthesizeGLError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    m_context->makeContextCurrent();
+    m_glGetProgramBinaryOES(program, bufSize, length, binaryFormat, binary);
+}
+
+void Extensions3DOpenGLES::programBinaryOES(Platform3DObject program, GC3Denum binaryFormat, const void* binary, GC3Dint length)
+{
+    if (!m_glProgramBinaryOES) {
+        m_context->synthesizeGLError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    m_context->makeContextCurrent();
+    m_glProgramBinaryOES(program, binaryFormat, binary, length);
+}
+
+void* Extensions3DOpenGLES::mapBufferRangeEXT(GC3Denum target, GC3Dintptr offset, GC3Dsizeiptr length, GC3Dbitfield access)
+{
+    if (!m_glMapBufferRangeEXT) {
+        m_context->synthesizeGLError(GL_INVALID_OPERATION);
+        return nullptr;
+    }
+
+    m_context->makeContextCurrent();
+    return m_glMapBufferRangeEXT(target, offset, length, access);
+}
+
+GC3Dboolean Extensions3DOpenGLES::unmapBufferOES(GC3Denum target)
+{
+    if (!m_glUnmapBufferOES) {
+        m_context->synthesizeGLError(GL_INVALID_OPERATION);
+        return false;
+    }
+
+    m_context->makeContextCurrent();
+    return m_glUnmapBufferOES(target);
+}
+
+GC3Dsync Extensions3DOpenGLES::fenceSyncAPPLE(GC3Denum condition, GC3Dbitfield flags)
+{
+    if (!m_glFenceSyncAPPLE) {
+        m_context->synthesizeGLError(GL_INVALID_OPERATION);
+        return nullptr;
+    }
+
+    m_context->makeContextCurrent();
+    return m_glFenceSyncAPPLE(condition, flags);
+}
+
+GC3Denum Extensions3DOpenGLES::clientWaitSyncAPPLE(GC3Dsync sync, GC3Dbitfield flags, GC3Duint64 timeout)
+{
+    if (!m_glClientWaitSyncAPPLE) {
+        m_context->synthesizeGLError(GL_INVALID_OPERATION);
+        return 0;
+    }
+
+    m_context->makeContextCurrent();
+    return m_glClientWaitSyncAPPLE(sync, flags, timeout);
+}
+
+void Extensions3DOpenGLES::deleteSyncAPPLE(GC3Dsync sync)
+{
+    if (!m_glDeleteSyncAPPLE) {
+        m_context->synthesizeGLError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    m_context->makeContextCurrent();
+    m_glDeleteSyncAPPLE(sync);
+}
+
 bool Extensions3DOpenGLES::supportsExtension(const String& name)
 {
 #if defined(GL_OES_texture_float) && GL_OES_texture_float
@@ -316,6 +400,17 @@ bool Extensions3DOpenGLES::supportsExtension(const String& name)
     }
 #endif
 
+    // OpenGL ES 3 has the fences of GL_APPLE_sync in core, with the same tokens, so Mesa, which
+    // doesn't expose the extension, still gets them.
+    if (name == "GL_APPLE_sync" && !m_availableExtensions.contains(name) && m_context->getString(GL_VERSION).startsWith("OpenGL ES 3")) {
+        if (!m_glFenceSyncAPPLE) {
+            m_glFenceSyncAPPLE = reinterpret_cast<PFNGLFENCESYNCAPPLEPROC>(eglGetProcAddress("glFenceSync"));
+            m_glClientWaitSyncAPPLE = reinterpret_cast<PFNGLCLIENTWAITSYNCAPPLEPROC>(eglGetProcAddress("glClientWaitSync"));
+            m_glDeleteSyncAPPLE = reinterpret_cast<PFNGLDELETESYNCAPPLEPROC>(eglGetProcAddress("glDeleteSync"));
+        }
+        return m_glFenceSyncAPPLE && m_glClientWaitSyncAPPLE && m_glDeleteSyncAPPLE;
+    }
+
     if (m_availableExtensions.contains(name)) {
         if (!m_supportsOESvertexArrayObject && name == "GL_OES_vertex_array_object") {
             m_glBindVertexArrayOES = reinterpret_cast<PFNGLBINDVERTEXARRAYOESPROC>(eglGetProcAddress("glBindVertexArrayOES"));
@@ -333,6 +428,16 @@ bool Extensions3DOpenGLES::supportsExtension(const String& name)
             m_glDrawArraysInstancedANGLE = reinterpret_cast<PFNGLDRAWARRAYSINSTANCEDANGLEPROC >(eglGetProcAddress("glDrawArraysInstancedANGLE"));
             m_glDrawElementsInstancedANGLE = reinterpret_cast<PFNGLDRAWELEMENTSINSTANCEDANGLEPROC >(eglGetProcAddress("glDrawElementsInstancedANGLE"));
             m_supportsANGLEinstancedArrays = true;
+        } else if (!m_glProgramBinaryOES && name == "GL_OES_get_program_binary") {
+            m_glGetProgramBinaryOES = reinterpret_cast<PFNGLGETPROGRAMBINARYOESPROC>(eglGetProcAddress("glGetProgramBinaryOES"));
+            m_glProgramBinaryOES = reinterpret_cast<PFNGLPROGRAMBINARYOESPROC>(eglGetProcAddress("glProgramBinaryOES"));
+        } else if (!m_glMapBufferRangeEXT && name == "GL_EXT_map_buffer_range") {
+            m_glMapBufferRangeEXT = reinterpret_cast<PFNGLMAPBUFFERRANGEEXTPROC>(eglGetProcAddress("glMapBufferRangeEXT"));
+            m_glUnmapBufferOES = reinterpret_cast<PFNGLUNMAPBUFFEROESPROC>(eglGetProcAddress("glUnmapBufferOES"));
+        } else if (!m_glFenceSyncAPPLE && name == "GL_APPLE_sync") {
+            m_glFenceSyncAPPLE = reinterpret_cast<PFNGLFENCESYNCAPPLEPROC>(eglGetProcAddress("glFenceSyncAPPLE"));
+            m_glClientWaitSyncAPPLE = reinterpret_cast<PFNGLCLIENTWAITSYNCAPPLEPROC>(eglGetProcAddress("glClientWaitSyncAPPLE"));
+            m_glDeleteSyncAPPLE = reinterpret_cast<PFNGLDELETESYNCAPPLEPROC>(eglGetProcAddress("glDeleteSyncAPPLE"));
         } else if (name == "GL_EXT_draw_buffers") {
             // FIXME: implement the support.
             return false;
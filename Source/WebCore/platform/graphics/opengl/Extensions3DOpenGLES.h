@@ -115,6 +115,19 @@ public:
     virtual void getnUniformfvEXT(GC3Duint program, int location, GC3Dsizei bufSize, float *params);
     virtual void getnUniformivEXT(GC3Duint program, int location, GC3Dsizei bufSize, int *params);
 
+    // GL_OES_get_program_binary
+    virtual void getProgramBinaryOES(Platform3DObject program, GC3Dsizei bufSize, GC3Dsizei* length, GC3Denum* binaryFormat, void* binary);
+    virtual void programBinaryOES(Platform3DObject program, GC3Denum binaryFormat, const void* binary, GC3Dint length);
+
+    // GL_EXT_map_buffer_range
+    virtual void* mapBufferRangeEXT(GC3Denum target, GC3Dintptr offset, GC3Dsizeiptr length, GC3Dbitfield access);
+    virtual GC3Dboolean unmapBufferOES(GC3Denum target);
+
+    // GL_APPLE_sync
+    virtual GC3Dsync fenceSyncAPPLE(GC3Denum condition, GC3Dbitfield flags);
+    virtual GC3Denum clientWaitSyncAPPLE(GC3Dsync, GC3Dbitfield flags, GC3Duint64 timeout);
+    virtual void deleteSyncAPPLE(GC3Dsync);
+
 protected:
     virtual bool supportsExtension(const String&);
     virtual String getExtensions();
@@ -138,6 +151,13 @@ protected:
     PFNGLVERTEXATTRIBDIVISORANGLEPROC m_glVertexAttribDivisorANGLE;
     PFNGLDRAWARRAYSINSTANCEDANGLEPROC m_glDrawArraysInstancedANGLE;
     PFNGLDRAWELEMENTSINSTANCEDANGLEPROC m_glDrawElementsInstancedANGLE;
+    PFNGLGETPROGRAMBINARYOESPROC m_glGetProgramBinaryOES;
+    PFNGLPROGRAMBINARYOESPROC m_glProgramBinaryOES;
+    PFNGLMAPBUFFERRANGEEXTPROC m_glMapBufferRangeEXT;
+    PFNGLUNMAPBUFFEROESPROC m_glUnmapBufferOES;
+    PFNGLFENCESYNCAPPLEPROC m_glFenceSyncAPPLE;
+    PFNGLCLIENTWAITSYNCAPPLEPROC m_glClientWaitSyncAPPLE;
+    PFNGLDELETESYNCAPPLEPROC m_glDeleteSyncAPPLE;
 
     std::unique_ptr<GraphicsContext3D::ContextLostCallback> m_contextLostCallback;
 };
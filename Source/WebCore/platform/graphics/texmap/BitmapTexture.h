@@ -43,6 +43,7 @@ class FilterOperations;
 class GraphicsLayer;
 class Image;
 class TextureMapper;
+class YUVImage;
 
 // A 2D texture that can be the target of software or GL rendering.
 class BitmapTexture : public RefCounted<BitmapTexture> {
@@ -64,6 +65,7 @@ public:
     virtual void updateContents(Image*, const IntRect&, const IntPoint& offset, UpdateContentsFlag) = 0;
     virtual void updateContents(TextureMapper*, GraphicsLayer*, const IntRect& target, const IntPoint& offset, UpdateContentsFlag, float scale = 1);
     virtual void updateContents(const void*, const IntRect& target, const IntPoint& offset, int bytesPerLine, UpdateContentsFlag) = 0;
+    virtual void updateContents(const YUVImage&, const IntRect& target, const IntPoint& offset) = 0;
     virtual bool isValid() const = 0;
 
     virtual int bpp() const { return 32; }
@@ -30,8 +30,10 @@
 #include "Image.h"
 #include "LengthFunctions.h"
 #include "NotImplemented.h"
+#include "PixelRowConversion.h"
 #include "TextureMapperShaderProgram.h"
 #include "Timer.h"
+#include "YUVImage.h"
 #include <wtf/HashMap.h>
 #include <wtf/PassRefPtr.h>
 #include <wtf/RefCounted.h>
@@ -81,6 +83,7 @@ BitmapTextureGL::BitmapTextureGL(PassRefPtr<GraphicsContext3D> context3D)
     , m_depthBufferObject(0)
     , m_shouldClear(true)
     , m_context3D(context3D)
+    , m_uploadStream(BitmapTextureUploadStream::forContext(*m_context3D))
 #if OS(DARWIN)
     , m_type(GL_UNSIGNED_INT_8_8_8_8_REV)
 #else
@@ -103,9 +106,8 @@ static void swizzleBGRAToRGBA(uint32_t* data, const IntRect& rect, int stride =
 {
     stride = stride ? stride : rect.width();
     for (int y = rect.y(); y < rect.maxY(); ++y) {
-        uint32_t* p = data + y * stride;
-        for (int x = rect.x(); x < rect.maxX(); ++x)
-            p[x] = ((p[x] << 16) & 0xff0000) | ((p[x] >> 16) & 0xff) | (p[x] & 0xff00ff00);
+        uint32_t* row = data + y * stride + rect.x();
+        PixelRowConversion::swapRedAndBlue(row, row, rect.width());
     }
 }
 
@@ -141,6 +143,13 @@ void BitmapTextureGL::didReset()
 void BitmapTextureGL::updateContentsNoSwizzle(const void* srcData, const IntRect& targetRect, const IntPoint& sourceOffset, int bytesPerLine, unsigned bytesPerPixel, Platform3DObject glFormat)
 {
     m_context3D->bindTexture(GraphicsContext3D::TEXTURE_2D, m_id);
+
+    if (m_uploadStream) {
+        const char* data = static_cast<const char*>(srcData) + sourceOffset.y() * bytesPerLine + sourceOffset.x() * bytesPerPixel;
+        if (m_uploadStream->upload(data, targetRect, bytesPerLine, bytesPerPixel, glFormat, m_type))
+            return;
+    }
+
     // For ES drivers that don't support sub-images.
     if (driverSupportsSubImage(m_context3D.get())) {
         // Use the OpenGL sub-image extension, now that we know it's available.
@@ -167,30 +176,38 @@ void BitmapTextureGL::updateContents(const void* srcData, const IntRect& targetR
     char* data = reinterpret_cast<char*>(const_cast<void*>(srcData));
     Vector<char> temporaryData;
     IntPoint adjustedSourceOffset = sourceOffset;
+    bool needsSwizzle = m_format == GraphicsContext3D::RGBA;
 
     // Texture upload requires subimage buffer if driver doesn't support subimage and we don't have full image upload.
-    bool requireSubImageBuffer = !driverSupportsSubImage(m_context3D.get())
+    // The upload stream packs the rows on its own.
+    bool canUseUploadStream = m_uploadStream && m_uploadStream->hasBudgetFor(targetRect.size(), bytesPerPixel);
+    bool requireSubImageBuffer = !canUseUploadStream && !driverSupportsSubImage(m_context3D.get())
         && !(bytesPerLine == static_cast<int>(targetRect.width() * bytesPerPixel) && adjustedSourceOffset == IntPoint::zero());
 
     // prepare temporaryData if necessary
-    if ((m_format == GraphicsContext3D::RGBA && updateContentsFlag == UpdateCannotModifyOriginalImageData) || requireSubImageBuffer) {
+    if ((needsSwizzle && updateContentsFlag == UpdateCannotModifyOriginalImageData) || requireSubImageBuffer) {
         temporaryData.reserveCapacity(targetRect.width() * targetRect.height() * bytesPerPixel);
         data = temporaryData.data();
         const char* bits = static_cast<const char*>(srcData);
         const char* src = bits + sourceOffset.y() * bytesPerLine + sourceOffset.x() * bytesPerPixel;
         char* dst = data;
         const int targetBytesPerLine = targetRect.width() * bytesPerPixel;
+        // Swizzle while copying rather than in a second pass over the copy.
         for (int y = 0; y < targetRect.height(); ++y) {
-            memcpy(dst, src, targetBytesPerLine);
+            if (needsSwizzle)
+                PixelRowConversion::swapRedAndBlue(reinterpret_cast_ptr<const uint32_t*>(src), reinterpret_cast_ptr<uint32_t*>(dst), targetRect.width());
+            else
+                memcpy(dst, src, targetBytesPerLine);
             src += bytesPerLine;
             dst += targetBytesPerLine;
         }
 
         bytesPerLine = targetBytesPerLine;
         adjustedSourceOffset = IntPoint(0, 0);
+        needsSwizzle = false;
     }
 
-    if (m_format == GraphicsContext3D::RGBA)
+    if (needsSwizzle)
         swizzleBGRAToRGBA(reinterpret_cast_ptr<uint32_t*>(data), IntRect(adjustedSourceOffset, targetRect.size()), bytesPerLine / bytesPerPixel);
 
     updateContentsNoSwizzle(data, targetRect, adjustedSourceOffset, bytesPerLine, bytesPerPixel, m_format);
@@ -216,6 +233,77 @@ void BitmapTextureGL::updateContents(Image* image, const IntRect& targetRect, co
     updateContents(imageData, targetRect, offset, bytesPerLine, updateContentsFlag);
 }
 
+void BitmapTextureGL::updateContents(const YUVImage& image, const IntRect& targetRect, const IntPoint& sourceOffset)
+{
+    // The planes are converted into this texture by drawing into it, so that it can
+    // be composited like any other RGB texture afterwards.
+    GC3Dint previousFramebuffer = 0;
+    GC3Dint previousProgram = 0;
+    GC3Dint previousViewport[4] = { 0, 0, 0, 0 };
+    m_context3D->getIntegerv(GraphicsContext3D::FRAMEBUFFER_BINDING, &previousFramebuffer);
+    m_context3D->getIntegerv(GraphicsContext3D::CURRENT_PROGRAM, &previousProgram);
+    m_context3D->getIntegerv(GraphicsContext3D::VIEWPORT, previousViewport);
+    bool scissorTestWasEnabled = m_context3D->isEnabled(GraphicsContext3D::SCISSOR_TEST);
+    bool stencilTestWasEnabled = m_context3D->isEnabled(GraphicsContext3D::STENCIL_TEST);
+    bool blendWasEnabled = m_context3D->isEnabled(GraphicsContext3D::BLEND);
+
+    bindAsSurface(m_context3D.get());
+    m_context3D->viewport(targetRect.x(), targetRect.y(), targetRect.width(), targetRect.height());
+    m_context3D->disable(GraphicsContext3D::SCISSOR_TEST);
+    m_context3D->disable(GraphicsContext3D::STENCIL_TEST);
+    m_context3D->disable(GraphicsContext3D::BLEND);
+
+    Platform3DObject planeTextures[YUVImage::planeCount];
+    for (unsigned i = 0; i < YUVImage::planeCount; ++i) {
+        YUVImage::Plane plane = static_cast<YUVImage::Plane>(i);
+        IntSize planeSize = image.paddedPlaneSize(plane);
+        planeTextures[i] = m_context3D->createTexture();
+        m_context3D->activeTexture(GraphicsContext3D::TEXTURE0 + i);
+        m_context3D->bindTexture(GraphicsContext3D::TEXTURE_2D, planeTextures[i]);
+        m_context3D->texParameteri(GraphicsContext3D::TEXTURE_2D, GraphicsContext3D::TEXTURE_MIN_FILTER, GraphicsContext3D::LINEAR);
+        m_context3D->texParameteri(GraphicsContext3D::TEXTURE_2D, GraphicsContext3D::TEXTURE_MAG_FILTER, GraphicsContext3D::LINEAR);
+        m_context3D->texParameteri(GraphicsContext3D::TEXTURE_2D, GraphicsContext3D::TEXTURE_WRAP_S, GraphicsContext3D::CLAMP_TO_EDGE);
+        m_context3D->texParameteri(GraphicsContext3D::TEXTURE_2D, GraphicsContext3D::TEXTURE_WRAP_T, GraphicsContext3D::CLAMP_TO_EDGE);
+        m_context3D->texImage2DDirect(GraphicsContext3D::TEXTURE_2D, 0, GraphicsContext3D::LUMINANCE, planeSize.width(), planeSize.height(), 0, GraphicsContext3D::LUMINANCE, GraphicsContext3D::UNSIGNED_BYTE, image.planeData(plane));
+    }
+
+    RefPtr<TextureMapperShaderProgram> program = TextureMapperGL::sharedShaderProgram(m_context3D.get(), TextureMapperShaderProgram::YCbCrTexture);
+    m_context3D->useProgram(program->programID());
+    m_context3D->uniform1i(program->yPlaneLocation(), 0);
+    m_context3D->uniform1i(program->cbPlaneLocation(), 1);
+    m_context3D->uniform1i(program->crPlaneLocation(), 2);
+
+    // The unit square covers the whole viewport, and maps to the source rect in the
+    // normalized coordinates of the planes, which are the same for all of them.
+    FloatSize lumaSize(image.paddedPlaneSize(YUVImage::YPlane));
+    FloatRect sourceRect(sourceOffset, targetRect.size());
+    sourceRect.scale(1 / lumaSize.width(), 1 / lumaSize.height());
+    program->setMatrix(program->modelViewMatrixLocation(), TransformationMatrix::rectToRect(FloatRect(0, 0, 1, 1), FloatRect(-1, -1, 2, 2)));
+    program->setMatrix(program->projectionMatrixLocation(), TransformationMatrix());
+    program->setMatrix(program->textureSpaceMatrixLocation(), TransformationMatrix::rectToRect(FloatRect(0, 0, 1, 1), sourceRect));
+
+    static const GC3Dfloat unitRect[] = { 0, 0, 1, 0, 1, 1, 0, 1 };
+    m_context3D->bindBuffer(GraphicsContext3D::ARRAY_BUFFER, 0);
+    m_context3D->enableVertexAttribArray(program->vertexLocation());
+    m_context3D->vertexAttribPointer(program->vertexLocation(), 2, GraphicsContext3D::FLOAT, false, 0, GC3Dintptr(unitRect));
+    m_context3D->drawArrays(GraphicsContext3D::TRIANGLE_FAN, 0, 4);
+    m_context3D->disableVertexAttribArray(program->vertexLocation());
+
+    for (unsigned i = 0; i < YUVImage::planeCount; ++i)
+        m_context3D->deleteTexture(planeTextures[i]);
+    m_context3D->activeTexture(GraphicsContext3D::TEXTURE0);
+
+    m_context3D->bindFramebuffer(GraphicsContext3D::FRAMEBUFFER, previousFramebuffer);
+    m_context3D->useProgram(previousProgram);
+    m_context3D->viewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    if (scissorTestWasEnabled)
+        m_context3D->enable(GraphicsContext3D::SCISSOR_TEST);
+    if (stencilTestWasEnabled)
+        m_context3D->enable(GraphicsContext3D::STENCIL_TEST);
+    if (blendWasEnabled)
+        m_context3D->enable(GraphicsContext3D::BLEND);
+}
+
 static unsigned getPassesRequiredForFilter(FilterOperation::OperationType type)
 {
     switch (type) {
@@ -254,26 +342,30 @@ PassRefPtr<BitmapTexture> BitmapTextureGL::applyFilters(TextureMapper* textureMa
         RefPtr<FilterOperation> filter = filters.operations()[i];
         ASSERT(filter);
 
-        int numPasses = getPassesRequiredForFilter(filter->type());
+        // Downsampled blurs are drawn in a single pass, which can't be left for when the texture is drawn.
+        bool downsampled = texmapGL->filterDownsamplingFactor(*filter, contentSize()) > 1;
+        int numPasses = downsampled ? 1 : getPassesRequiredForFilter(filter->type());
         for (int j = 0; j < numPasses; ++j) {
             bool last = (i == filters.size() - 1) && (j == numPasses - 1);
-            if (!last) {
-                if (!intermediateSurface)
-                    intermediateSurface = texmapGL->acquireTextureFromPool(contentSize());
-                texmapGL->bindSurface(intermediateSurface.get());
-            }
-
-            if (last) {
+            if (last && !downsampled) {
                 toBitmapTextureGL(resultSurface.get())->m_filterInfo = BitmapTextureGL::FilterInfo(filter, j, spareSurface);
                 break;
             }
 
+            if (!intermediateSurface)
+                intermediateSurface = texmapGL->acquireTextureFromPool(contentSize());
+            texmapGL->bindSurface(intermediateSurface.get());
+
             texmapGL->drawFiltered(*resultSurface.get(), spareSurface.get(), *filter, j);
             if (!j && filter->type() == FilterOperation::DROP_SHADOW) {
                 spareSurface = resultSurface;
                 resultSurface = nullptr;
             }
             std::swap(resultSurface, intermediateSurface);
+
+            // The result of a downsampled blur is complete, and is drawn as it is.
+            if (last)
+                toBitmapTextureGL(resultSurface.get())->m_filterInfo = FilterInfo();
         }
     }
 
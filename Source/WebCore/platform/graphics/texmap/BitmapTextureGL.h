@@ -24,6 +24,7 @@
 #if USE(TEXTURE_MAPPER_GL)
 
 #include "BitmapTexture.h"
+#include "BitmapTextureUploadStream.h"
 #include "FilterOperation.h"
 #include "GraphicsContext3D.h"
 #include "IntSize.h"
@@ -51,6 +52,7 @@ public:
     IntSize textureSize() const { return m_textureSize; }
     virtual void updateContents(Image*, const IntRect&, const IntPoint&, UpdateContentsFlag) override;
     virtual void updateContents(const void*, const IntRect& target, const IntPoint& sourceOffset, int bytesPerLine, UpdateContentsFlag) override;
+    virtual void updateContents(const YUVImage&, const IntRect& target, const IntPoint& sourceOffset) override;
     void updateContentsNoSwizzle(const void*, const IntRect& target, const IntPoint& sourceOffset, int bytesPerLine, unsigned bytesPerPixel = 4, Platform3DObject glFormat = GraphicsContext3D::RGBA);
     virtual bool isBackedByOpenGL() const override { return true; }
 
@@ -82,6 +84,7 @@ private:
     bool m_shouldClear;
     TextureMapperGL::ClipStack m_clipStack;
     RefPtr<GraphicsContext3D> m_context3D;
+    RefPtr<BitmapTextureUploadStream> m_uploadStream;
 
     BitmapTextureGL();
 
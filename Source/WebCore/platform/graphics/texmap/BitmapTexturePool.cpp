@@ -27,6 +27,13 @@
 #include "config.h"
 #include "BitmapTexturePool.h"
 
+#include "Logging.h"
+#include <wtf/HashSet.h>
+#include <wtf/Lock.h>
+#include <wtf/NeverDestroyed.h>
+#include <wtf/RunLoop.h>
+#include <wtf/text/WTFString.h>
+
 #if USE(TEXTURE_MAPPER_GL)
 #include "BitmapTextureGL.h"
 #include "GLContext.h"
@@ -36,20 +43,76 @@ namespace WebCore {
 
 const double s_releaseUnusedSecondsTolerance = 3;
 const double s_releaseUnusedTexturesTimerInterval = 0.5;
+const size_t s_defaultMemoryBudget = 32 * 1024 * 1024;
+
+static StaticLock poolsLock;
+
+static HashSet<BitmapTexturePool*>& pools()
+{
+    static NeverDestroyed<HashSet<BitmapTexturePool*>> pools;
+    return pools;
+}
+
+// WEBKIT_TEXTURE_POOL_BUDGET sets the budget in megabytes, for devices where texture memory is a small carve-out.
+static size_t defaultMemoryBudget()
+{
+    String budgetEnvironment = getenv("WEBKIT_TEXTURE_POOL_BUDGET");
+    bool ok = false;
+    unsigned budget = budgetEnvironment.toUIntStrict(&ok);
+    return ok ? budget * 1024 * 1024 : s_defaultMemoryBudget;
+}
 
 BitmapTexturePool::BitmapTexturePool()
-    : m_releaseUnusedTexturesTimer(*this, &BitmapTexturePool::releaseUnusedTexturesTimerFired)
+    : m_memoryBudget(defaultMemoryBudget())
+    , m_releaseUnusedTexturesTimer(*this, &BitmapTexturePool::releaseUnusedTexturesTimerFired)
+    , m_runLoop(RunLoop::current())
 {
+    std::lock_guard<StaticLock> lock(poolsLock);
+    pools().add(this);
 }
 
 #if USE(TEXTURE_MAPPER_GL)
 BitmapTexturePool::BitmapTexturePool(PassRefPtr<GraphicsContext3D> context)
     : m_context3D(context)
+    , m_memoryBudget(defaultMemoryBudget())
     , m_releaseUnusedTexturesTimer(*this, &BitmapTexturePool::releaseUnusedTexturesTimerFired)
+    , m_runLoop(RunLoop::current())
 {
+    std::lock_guard<StaticLock> lock(poolsLock);
+    pools().add(this);
 }
 #endif
 
+BitmapTexturePool::~BitmapTexturePool()
+{
+    std::lock_guard<StaticLock> lock(poolsLock);
+    pools().remove(this);
+}
+
+void BitmapTexturePool::releaseUnusedTexturesInAllPools()
+{
+    std::lock_guard<StaticLock> lock(poolsLock);
+    for (auto* pool : pools()) {
+        pool->m_runLoop.dispatch([pool] {
+            // Pools are destroyed on the thread they were created on, so a pool that is still
+            // registered here stays alive until this function returns.
+            {
+                std::lock_guard<StaticLock> lock(poolsLock);
+                if (!pools().contains(pool))
+                    return;
+            }
+            pool->releaseUnusedTextures();
+        });
+    }
+}
+
+void BitmapTexturePool::setMemoryBudget(size_t bytes)
+{
+    m_memoryBudget = bytes;
+    if (m_bytes > m_memoryBudget)
+        evictUnusedTextures(m_bytes - m_memoryBudget);
+}
+
 void BitmapTexturePool::scheduleReleaseUnusedTextures()
 {
     if (m_releaseUnusedTexturesTimer.isActive())
@@ -58,45 +121,121 @@ void BitmapTexturePool::scheduleReleaseUnusedTextures()
     m_releaseUnusedTexturesTimer.startOneShot(s_releaseUnusedTexturesTimerInterval);
 }
 
+template<typename Predicate>
+void BitmapTexturePool::removeTextures(const Predicate& shouldRemove)
+{
+    Vector<IntSize> emptyBuckets;
+    for (auto& bucket : m_textures) {
+        bucket.value.removeAllMatching([this, &shouldRemove](const BitmapTexturePoolEntry& entry) {
+            if (!shouldRemove(entry))
+                return false;
+            m_bytes -= entry.m_bytes;
+            return true;
+        });
+        if (bucket.value.isEmpty())
+            emptyBuckets.append(bucket.key);
+    }
+
+    for (auto& size : emptyBuckets)
+        m_textures.remove(size);
+}
+
 void BitmapTexturePool::releaseUnusedTexturesTimerFired()
 {
     if (m_textures.isEmpty())
         return;
 
     // Delete entries, which have been unused in s_releaseUnusedSecondsTolerance.
-    std::sort(m_textures.begin(), m_textures.end(), BitmapTexturePoolEntry::compareTimeLastUsed);
-
     double minUsedTime = monotonicallyIncreasingTime() - s_releaseUnusedSecondsTolerance;
-    for (size_t i = 0; i < m_textures.size(); ++i) {
-        if (m_textures[i].m_timeLastUsed < minUsedTime) {
-            m_textures.remove(i, m_textures.size() - i);
-            break;
+    removeTextures([minUsedTime](const BitmapTexturePoolEntry& entry) {
+        return entry.m_timeLastUsed < minUsedTime && !entry.isInUse();
+    });
+}
+
+void BitmapTexturePool::releaseUnusedTextures()
+{
+    removeTextures([](const BitmapTexturePoolEntry& entry) {
+        return !entry.isInUse();
+    });
+}
+
+void BitmapTexturePool::evictUnusedTextures(size_t bytesToFree)
+{
+    Vector<const BitmapTexturePoolEntry*> candidates;
+    for (auto& bucket : m_textures.values()) {
+        for (auto& entry : bucket) {
+            if (!entry.isInUse())
+                candidates.append(&entry);
         }
     }
+    std::sort(candidates.begin(), candidates.end(), BitmapTexturePoolEntry::compareTimeLastUsed);
+
+    HashSet<const BitmapTexture*> evictedTextures;
+    size_t freedBytes = 0;
+    for (auto* entry : candidates) {
+        if (freedBytes >= bytesToFree)
+            break;
+        freedBytes += entry->m_bytes;
+        evictedTextures.add(entry->m_texture.get());
+    }
+
+    if (evictedTextures.isEmpty())
+        return;
+
+    LOG(Compositing, "BitmapTexturePool: evicting %u textures (%zu bytes) to stay within the %zu bytes budget", evictedTextures.size(), freedBytes, m_memoryBudget);
+    m_evictedTextures += evictedTextures.size();
+    removeTextures([&evictedTextures](const BitmapTexturePoolEntry& entry) {
+        return evictedTextures.contains(entry.m_texture.get());
+    });
 }
 
 PassRefPtr<BitmapTexture> BitmapTexturePool::acquireTexture(const IntSize& size)
 {
-    BitmapTexturePoolEntry* selectedEntry = 0;
-    for (auto& entry : m_textures) {
-        // If the surface has only one reference (the one in m_textures), we can safely reuse it.
-        if (entry.m_texture->refCount() > 1)
-            continue;
-
-        if (entry.m_texture->size() == size) {
-            selectedEntry = &entry;
-            break;
+    // Empty sizes cannot be used as bucket keys, and there is nothing worth pooling for them anyway.
+    if (size.isEmpty())
+        return createTexture();
+
+    auto it = m_textures.find(size);
+    if (it != m_textures.end()) {
+        for (auto& entry : it->value) {
+            if (entry.isInUse())
+                continue;
+
+            scheduleReleaseUnusedTextures();
+            entry.markUsed();
+            return entry.m_texture;
         }
     }
 
-    if (!selectedEntry) {
-        m_textures.append(BitmapTexturePoolEntry(createTexture()));
-        selectedEntry = &m_textures.last();
-    }
+    size_t bytes = size.width() * size.height() * 4;
+    if (m_bytes + bytes > m_memoryBudget)
+        evictUnusedTextures(m_bytes + bytes - m_memoryBudget);
+
+    Vector<BitmapTexturePoolEntry>& bucket = m_textures.add(size, Vector<BitmapTexturePoolEntry>()).iterator->value;
+    bucket.append(BitmapTexturePoolEntry(createTexture(), bytes));
+    m_bytes += bytes;
 
     scheduleReleaseUnusedTextures();
-    selectedEntry->markUsed();
-    return selectedEntry->m_texture;
+    bucket.last().markUsed();
+    return bucket.last().m_texture;
+}
+
+BitmapTexturePool::Stats BitmapTexturePool::stats() const
+{
+    Stats stats;
+    for (auto& bucket : m_textures.values()) {
+        for (auto& entry : bucket) {
+            ++stats.textureCount;
+            if (entry.isInUse()) {
+                ++stats.texturesInUse;
+                stats.bytesInUse += entry.m_bytes;
+            }
+        }
+    }
+    stats.bytes = m_bytes;
+    stats.memoryBudget = m_memoryBudget;
+    stats.evictedTextures = m_evictedTextures;
+    return stats;
 }
 
 PassRefPtr<BitmapTexture> BitmapTexturePool::createTexture()
@@ -34,28 +34,39 @@
 #include "BitmapTexture.h"
 #include "IntRect.h"
 #include "IntSize.h"
+#include "IntSizeHash.h"
 #include "Timer.h"
 #include <wtf/CurrentTime.h>
+#include <wtf/HashMap.h>
 
 #if USE(TEXTURE_MAPPER_GL)
 #include "GraphicsContext3D.h"
 #endif
 
+namespace WTF {
+class RunLoop;
+}
+
 namespace WebCore {
 
 class TextureMapper;
 
 struct BitmapTexturePoolEntry {
-    explicit BitmapTexturePoolEntry(PassRefPtr<BitmapTexture> texture)
+    BitmapTexturePoolEntry(PassRefPtr<BitmapTexture> texture, size_t bytes)
         : m_texture(texture)
+        , m_bytes(bytes)
     { }
     inline void markUsed() { m_timeLastUsed = monotonicallyIncreasingTime(); }
-    static bool compareTimeLastUsed(const BitmapTexturePoolEntry& a, const BitmapTexturePoolEntry& b)
+    static bool compareTimeLastUsed(const BitmapTexturePoolEntry* a, const BitmapTexturePoolEntry* b)
     {
-        return a.m_timeLastUsed - b.m_timeLastUsed > 0;
+        return a->m_timeLastUsed < b->m_timeLastUsed;
     }
 
+    // If the texture has only one reference (the one in the pool), it can safely be reused.
+    bool isInUse() const { return m_texture->refCount() > 1; }
+
     RefPtr<BitmapTexture> m_texture;
+    size_t m_bytes;
     double m_timeLastUsed;
 };
 
@@ -67,20 +78,50 @@ public:
 #if USE(TEXTURE_MAPPER_GL)
     explicit BitmapTexturePool(PassRefPtr<GraphicsContext3D>);
 #endif
+    ~BitmapTexturePool();
 
     PassRefPtr<BitmapTexture> acquireTexture(const IntSize&);
 
+    // The memory held by the pool is kept under the budget by evicting the least recently
+    // used textures that are not in use. Textures still in use are never evicted, so the
+    // pool can only exceed the budget while they are alive.
+    void setMemoryBudget(size_t bytes);
+
+    // Deletes all the textures that are not in use.
+    void releaseUnusedTextures();
+
+    // Called on memory pressure. Each pool releases its unused textures on the thread it was created on,
+    // where its GL context is current.
+    static void releaseUnusedTexturesInAllPools();
+
+    struct Stats {
+        unsigned textureCount { 0 };
+        unsigned texturesInUse { 0 };
+        size_t bytes { 0 };
+        size_t bytesInUse { 0 };
+        size_t memoryBudget { 0 };
+        unsigned evictedTextures { 0 };
+    };
+    Stats stats() const;
+
 private:
     void scheduleReleaseUnusedTextures();
     void releaseUnusedTexturesTimerFired();
+    void evictUnusedTextures(size_t bytesToFree);
+    template<typename Predicate> void removeTextures(const Predicate&);
     PassRefPtr<BitmapTexture> createTexture();
 
 #if USE(TEXTURE_MAPPER_GL)
     RefPtr<GraphicsContext3D> m_context3D;
 #endif
 
-    Vector<BitmapTexturePoolEntry> m_textures;
+    // Textures can only be reused for the exact size they were allocated with, so they are bucketed by size.
+    HashMap<IntSize, Vector<BitmapTexturePoolEntry>> m_textures;
+    size_t m_bytes { 0 };
+    size_t m_memoryBudget;
+    unsigned m_evictedTextures { 0 };
     Timer m_releaseUnusedTexturesTimer;
+    WTF::RunLoop& m_runLoop;
 };
 
 }
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "BitmapTextureUploadStream.h"
+
+#if USE(TEXTURE_MAPPER_GL)
+
+#include "Extensions3D.h"
+#include <limits>
+#include <wtf/HashMap.h>
+#include <wtf/Lock.h>
+#include <wtf/NeverDestroyed.h>
+
+namespace WebCore {
+
+// Uploads normally find the oldest buffer idle again well before this many are in flight.
+static const unsigned maximumUploadBufferCount = 8;
+// Beyond this many bytes per frame, uploads go straight to the texture instead of piling up driver memory.
+static const size_t frameUploadBudget = 16 * 1024 * 1024;
+
+// Each context is only used by one thread, but the compositors of different views can create and
+// destroy their streams concurrently.
+static StaticLock uploadStreamMapLock;
+
+typedef HashMap<PlatformGraphicsContext3D, BitmapTextureUploadStream*> UploadStreamMap;
+static UploadStreamMap& uploadStreamMap()
+{
+    static NeverDestroyed<UploadStreamMap> map;
+    return map;
+}
+
+static bool contextSupportsUploadStreaming(GraphicsContext3D& context)
+{
+    // Only OpenGL ES is covered. Desktop GL would need the ARB variants of mapping and fences.
+    if (!context.isGLES2Compliant())
+        return false;
+
+    Extensions3D* extensions = context.getExtensions();
+    bool supportsPixelBufferObjects = extensions->supports("GL_NV_pixel_buffer_object")
+        || context.getString(GraphicsContext3D::VERSION).startsWith("OpenGL ES 3");
+    return supportsPixelBufferObjects
+        && extensions->supports("GL_EXT_map_buffer_range")
+        && extensions->supports("GL_APPLE_sync");
+}
+
+RefPtr<BitmapTextureUploadStream> BitmapTextureUploadStream::forContext(GraphicsContext3D& context)
+{
+    {
+        LockHolder locker(uploadStreamMapLock);
+        auto it = uploadStreamMap().find(context.platformGraphicsContext3D());
+        if (it != uploadStreamMap().end())
+            return it->value;
+    }
+
+    if (!contextSupportsUploadStreaming(context))
+        return nullptr;
+
+    return adoptRef(new BitmapTextureUploadStream(context));
+}
+
+BitmapTextureUploadStream::BitmapTextureUploadStream(GraphicsContext3D& context)
+    : m_context(&context)
+    , m_extensions(*context.getExtensions())
+{
+    LockHolder locker(uploadStreamMapLock);
+    uploadStreamMap().add(m_context->platformGraphicsContext3D(), this);
+}
+
+BitmapTextureUploadStream::~BitmapTextureUploadStream()
+{
+    for (auto& buffer : m_buffers) {
+        if (buffer.fence)
+            m_extensions.deleteSyncAPPLE(buffer.fence);
+        m_context->deleteBuffer(buffer.object);
+    }
+
+    LockHolder locker(uploadStreamMapLock);
+    uploadStreamMap().remove(m_context->platformGraphicsContext3D());
+}
+
+bool BitmapTextureUploadStream::hasBudgetFor(const IntSize& size, unsigned bytesPerPixel) const
+{
+    return m_uploadedBytes + size.area() * bytesPerPixel <= frameUploadBudget;
+}
+
+bool BitmapTextureUploadStream::waitForFence(UploadBuffer& buffer, GC3Duint64 timeout)
+{
+    if (!buffer.fence)
+        return true;
+
+    // Waiting only ends if the fence gets to the GPU, so flush when actually waiting.
+    GC3Dbitfield flags = timeout ? GraphicsContext3D::SYNC_FLUSH_COMMANDS_BIT : 0;
+    GC3Denum status = m_extensions.clientWaitSyncAPPLE(buffer.fence, flags, timeout);
+    if (status != GraphicsContext3D::ALREADY_SIGNALED && status != GraphicsContext3D::CONDITION_SATISFIED)
+        return false;
+
+    m_extensions.deleteSyncAPPLE(buffer.fence);
+    buffer.fence = nullptr;
+    return true;
+}
+
+BitmapTextureUploadStream::UploadBuffer& BitmapTextureUploadStream::takeNextBuffer()
+{
+    // Buffers are used in order, so the one at m_nextBuffer always holds the oldest upload.
+    if (m_buffers.isEmpty() || !waitForFence(m_buffers[m_nextBuffer], 0)) {
+        if (m_buffers.size() < maximumUploadBufferCount) {
+            // The new buffer goes right before the oldest one, which makes it the most recent.
+            m_buffers.insert(m_nextBuffer, UploadBuffer { m_context->createBuffer(), 0, nullptr, false });
+        } else if (!waitForFence(m_buffers[m_nextBuffer], std::numeric_limits<GC3Duint64>::max())) {
+            // The wait failed, which leaves no way to tell when the GPU is done with the buffer.
+            // Drop the fence: the buffer is then mapped without the unsynchronized flag.
+            m_extensions.deleteSyncAPPLE(m_buffers[m_nextBuffer].fence);
+            m_buffers[m_nextBuffer].fence = nullptr;
+            m_buffers[m_nextBuffer].needsSynchronizedMap = true;
+        }
+    }
+
+    UploadBuffer& buffer = m_buffers[m_nextBuffer];
+    m_nextBuffer = (m_nextBuffer + 1) % m_buffers.size();
+    return buffer;
+}
+
+bool BitmapTextureUploadStream::upload(const void* data, const IntRect& targetRect, int bytesPerLine, unsigned bytesPerPixel, GC3Denum format, GC3Denum type)
+{
+    if (!hasBudgetFor(targetRect.size(), bytesPerPixel))
+        return false;
+
+    const size_t packedBytesPerLine = targetRect.width() * bytesPerPixel;
+    const size_t size = packedBytesPerLine * targetRect.height();
+    m_uploadedBytes += size;
+
+    UploadBuffer& buffer = takeNextBuffer();
+    m_context->bindBuffer(GraphicsContext3D::PIXEL_UNPACK_BUFFER, buffer.object);
+    if (buffer.size < size) {
+        m_context->bufferData(GraphicsContext3D::PIXEL_UNPACK_BUFFER, size, GraphicsContext3D::STREAM_DRAW);
+        buffer.size = size;
+    }
+
+    // The fence of the buffer has signaled, so the GPU is done with it and mapping needs no synchronization.
+    // The pixels are written straight into driver memory, packing the rows on the way.
+    GC3Dbitfield access = Extensions3D::MAP_WRITE_BIT_EXT | Extensions3D::MAP_INVALIDATE_BUFFER_BIT_EXT;
+    if (!buffer.needsSynchronizedMap)
+        access |= Extensions3D::MAP_UNSYNCHRONIZED_BIT_EXT;
+    buffer.needsSynchronizedMap = false;
+
+    const char* source = static_cast<const char*>(data);
+    char* mapped = static_cast<char*>(m_extensions.mapBufferRangeEXT(GraphicsContext3D::PIXEL_UNPACK_BUFFER, 0, size, access));
+    if (mapped) {
+        if (static_cast<size_t>(bytesPerLine) == packedBytesPerLine)
+            memcpy(mapped, source, size);
+        else {
+            for (int y = 0; y < targetRect.height(); ++y)
+                memcpy(mapped + y * packedBytesPerLine, source + y * bytesPerLine, packedBytesPerLine);
+        }
+        if (!m_extensions.unmapBufferOES(GraphicsContext3D::PIXEL_UNPACK_BUFFER))
+            mapped = nullptr;
+    }
+
+    if (!mapped) {
+        // Mapping fails when the driver is short of memory, and unmapping when the storage was lost
+        // meanwhile, which leaves its contents undefined. Copy through the GL instead.
+        if (static_cast<size_t>(bytesPerLine) == packedBytesPerLine)
+            m_context->bufferSubData(GraphicsContext3D::PIXEL_UNPACK_BUFFER, 0, size, source);
+        else {
+            for (int y = 0; y < targetRect.height(); ++y)
+                m_context->bufferSubData(GraphicsContext3D::PIXEL_UNPACK_BUFFER, y * packedBytesPerLine, packedBytesPerLine, source + y * bytesPerLine);
+        }
+    }
+
+    m_context->texSubImage2D(GraphicsContext3D::TEXTURE_2D, 0, targetRect.x(), targetRect.y(), targetRect.width(), targetRect.height(), format, type, nullptr);
+    buffer.fence = m_extensions.fenceSyncAPPLE(GraphicsContext3D::SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_context->bindBuffer(GraphicsContext3D::PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+} // namespace WebCore
+
+#endif // USE(TEXTURE_MAPPER_GL)
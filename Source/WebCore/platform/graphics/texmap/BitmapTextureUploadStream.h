@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BitmapTextureUploadStream_h
+#define BitmapTextureUploadStream_h
+
+#if USE(TEXTURE_MAPPER_GL)
+
+#include "Extensions3D.h"
+#include "GraphicsContext3D.h"
+#include "IntRect.h"
+#include <wtf/RefCounted.h>
+#include <wtf/RefPtr.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+// Streams texture uploads through a ring of pixel unpack buffers. The pixels are written into a
+// mapped buffer and texSubImage2D() then only queues a transfer from it, so the compositing thread
+// does not stall until the GPU has consumed them. Each upload leaves a fence behind, and a buffer
+// is only mapped again once its fence has signaled; if all of them are busy, the ring grows.
+class BitmapTextureUploadStream : public RefCounted<BitmapTextureUploadStream> {
+public:
+    // Returns the stream shared by the textures of the context, or null if the context lacks pixel
+    // buffer objects, GL_EXT_map_buffer_range or fences, from GL_APPLE_sync or OpenGL ES 3.
+    static RefPtr<BitmapTextureUploadStream> forContext(GraphicsContext3D&);
+    ~BitmapTextureUploadStream();
+
+    bool hasBudgetFor(const IntSize&, unsigned bytesPerPixel = 4) const;
+
+    // Uploads the targetRect sized pixels starting at data into targetRect of the texture bound
+    // to TEXTURE_2D. Returns false, leaving the texture untouched, if the frame budget is spent.
+    bool upload(const void* data, const IntRect& targetRect, int bytesPerLine, unsigned bytesPerPixel, GC3Denum format, GC3Denum type);
+
+    void didFinishFrame() { m_uploadedBytes = 0; }
+
+private:
+    explicit BitmapTextureUploadStream(GraphicsContext3D&);
+
+    struct UploadBuffer {
+        Platform3DObject object;
+        size_t size;
+        // Signals once the GPU is done with the last upload from this buffer.
+        GC3Dsync fence;
+        bool needsSynchronizedMap;
+    };
+
+    // Returns whether the GPU is done with the buffer, waiting at most timeout nanoseconds for it.
+    bool waitForFence(UploadBuffer&, GC3Duint64 timeout);
+    UploadBuffer& takeNextBuffer();
+
+    RefPtr<GraphicsContext3D> m_context;
+    Extensions3D& m_extensions;
+    Vector<UploadBuffer> m_buffers;
+    unsigned m_nextBuffer { 0 };
+    size_t m_uploadedBytes { 0 };
+};
+
+} // namespace WebCore
+
+#endif // USE(TEXTURE_MAPPER_GL)
+
+#endif // BitmapTextureUploadStream_h
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DamageHistory_h
+#define DamageHistory_h
+
+#include "Region.h"
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+// Remembers the damage of the last few presented frames, so that a compositor reusing back
+// buffers (EGL_EXT_buffer_age) can work out which part of the buffer it is about to paint into is
+// stale: the damage of the new frame, plus everything that changed since the buffer was last
+// presented.
+class DamageHistory {
+public:
+    static const size_t maximumSize = 4;
+
+    // Returns the region of the back buffer to repaint for a frame with the given damage, and
+    // records that damage. A buffer age of 0 means the buffer contents are undefined, and so
+    // does an age older than the history, so the whole viewport is repainted in both cases.
+    WEBCORE_EXPORT Region repaintRegionForDamage(const Region& damage, const IntRect& viewportRect, unsigned bufferAge);
+
+    void clear() { m_damage.clear(); }
+    size_t size() const { return m_damage.size(); }
+
+private:
+    // Newest first.
+    Vector<Region, maximumSize> m_damage;
+};
+
+} // namespace WebCore
+
+#endif // DamageHistory_h
@@ -23,6 +23,7 @@
 #include "BitmapTexturePool.h"
 #include "FilterOperations.h"
 #include "GraphicsLayer.h"
+#include "Region.h"
 #include "Timer.h"
 #include <wtf/CurrentTime.h>
 
@@ -53,6 +54,18 @@ TextureMapper::TextureMapper()
 TextureMapper::~TextureMapper()
 { }
 
+bool TextureMapper::isOccluded(const FloatRect& rect, const TransformationMatrix& modelViewMatrix)
+{
+    if (!m_occlusion)
+        return false;
+
+    // Leave room for the antialiased edges of transformed quads.
+    IntRect targetRect = enclosingIntRect(modelViewMatrix.mapRect(rect));
+    targetRect.inflate(1);
+    targetRect.intersect(clipBounds());
+    return !targetRect.isEmpty() && m_occlusion->contains(targetRect);
+}
+
 } // namespace
 
 #endif
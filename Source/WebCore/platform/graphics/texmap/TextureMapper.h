@@ -43,6 +43,7 @@ class BitmapTexturePool;
 class GraphicsLayer;
 class TextureMapper;
 class FilterOperations;
+class Region;
 
 class TextureMapper {
     WTF_MAKE_FAST_ALLOCATED;
@@ -105,9 +106,32 @@ public:
     void setPatternTransform(const TransformationMatrix& p) { m_patternTransform = p; }
     void setWrapMode(WrapMode m) { m_wrapMode = m; }
 
+    // Area of the bound surface, in surface coordinates, that opaque content painted later in the
+    // frame will cover. TextureMapperLayer sets it while a partially occluded layer paints itself,
+    // so that backing stores can skip the tiles that would be overdrawn.
+    void setOcclusion(const Region* occlusion) { m_occlusion = occlusion; }
+    bool isOccluded(const FloatRect&, const TransformationMatrix&);
+
+    struct OcclusionStats {
+        unsigned culledLayers { 0 };
+        unsigned culledTiles { 0 };
+    };
+    OcclusionStats& occlusionStats() { return m_occlusionStats; }
+
+    // Draw calls issued during the last complete frame, and how many quads were merged into
+    // them. Only backends that batch their drawing fill these in.
+    struct DrawStats {
+        unsigned drawCalls { 0 };
+        unsigned batchedQuads { 0 };
+    };
+    const DrawStats& drawStats() const { return m_drawStats; }
+
+    BitmapTexturePool* texturePool() const { return m_texturePool.get(); }
+
 protected:
     GraphicsContext* m_context;
     std::unique_ptr<BitmapTexturePool> m_texturePool;
+    DrawStats m_drawStats;
 
     bool isInMaskMode() const { return m_isMaskMode; }
     WrapMode wrapMode() const { return m_wrapMode; }
@@ -127,6 +151,8 @@ private:
     TransformationMatrix m_patternTransform;
     WrapMode m_wrapMode : 8;
     bool m_isMaskMode : 8;
+    const Region* m_occlusion { nullptr };
+    OcclusionStats m_occlusionStats;
 };
 
 }
@@ -32,6 +32,8 @@ namespace WebCore {
 
 TextureMapperFPSCounter::TextureMapperFPSCounter()
     : m_isShowingFPS(false)
+    , m_isShowingOcclusionStats(!!getenv("WEBKIT_SHOW_OCCLUSION_STATS"))
+    , m_isShowingDrawStats(!!getenv("WEBKIT_SHOW_DRAW_STATS"))
     , m_fpsInterval(0)
     , m_fpsTimestamp(0)
     , m_lastFPS(0)
@@ -48,6 +50,11 @@ TextureMapperFPSCounter::TextureMapperFPSCounter()
 
 void TextureMapperFPSCounter::updateFPSAndDisplay(TextureMapper* textureMapper, const FloatPoint& location, const TransformationMatrix& matrix)
 {
+    if (m_isShowingOcclusionStats)
+        displayOcclusionStats(textureMapper, location, matrix);
+    if (m_isShowingDrawStats)
+        displayDrawStats(textureMapper, location, matrix);
+
     if (!m_isShowingFPS)
         return;
 
@@ -62,6 +69,23 @@ void TextureMapperFPSCounter::updateFPSAndDisplay(TextureMapper* textureMapper,
     textureMapper->drawNumber(m_lastFPS, Color::black, location, matrix);
 }
 
+void TextureMapperFPSCounter::displayOcclusionStats(TextureMapper* textureMapper, const FloatPoint& location, const TransformationMatrix& matrix)
+{
+    // Layers and tiles skipped in the last frame because opaque content covered them,
+    // below the FPS counter.
+    const TextureMapper::OcclusionStats& stats = textureMapper->occlusionStats();
+    textureMapper->drawNumber(stats.culledLayers, Color::darkGray, location + FloatSize(0, 16), matrix);
+    textureMapper->drawNumber(stats.culledTiles, Color::darkGray, location + FloatSize(0, 32), matrix);
+}
+
+void TextureMapperFPSCounter::displayDrawStats(TextureMapper* textureMapper, const FloatPoint& location, const TransformationMatrix& matrix)
+{
+    // Draw calls of the last frame and the quads batched into them, below the occlusion stats.
+    const TextureMapper::DrawStats& stats = textureMapper->drawStats();
+    textureMapper->drawNumber(stats.drawCalls, Color::darkGray, location + FloatSize(0, 48), matrix);
+    textureMapper->drawNumber(stats.batchedQuads, Color::darkGray, location + FloatSize(0, 64), matrix);
+}
+
 } // namespace WebCore
 
 #endif // USE(TEXTURE_MAPPER)
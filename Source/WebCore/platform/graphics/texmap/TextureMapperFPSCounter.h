@@ -36,9 +36,15 @@ class TextureMapperFPSCounter {
 public:
     TextureMapperFPSCounter();
     void updateFPSAndDisplay(TextureMapper*, const FloatPoint& = FloatPoint::zero(), const TransformationMatrix& = TransformationMatrix());
+    bool isVisible() const { return m_isShowingFPS || m_isShowingOcclusionStats || m_isShowingDrawStats; }
 
 private:
+    void displayOcclusionStats(TextureMapper*, const FloatPoint&, const TransformationMatrix&);
+    void displayDrawStats(TextureMapper*, const FloatPoint&, const TransformationMatrix&);
+
     bool m_isShowingFPS;
+    bool m_isShowingOcclusionStats;
+    bool m_isShowingDrawStats;
     double m_fpsInterval;
     double m_fpsTimestamp;
     int m_lastFPS;
@@ -26,6 +26,7 @@
 
 #include "BitmapTextureGL.h"
 #include "BitmapTexturePool.h"
+#include "BitmapTextureUploadStream.h"
 #include "Extensions3D.h"
 #include "FilterOperations.h"
 #include "GraphicsContext.h"
@@ -85,8 +86,34 @@ public:
             return result.iterator->value;
         }
 
+        // Creates the next program of the set that most pages need, unless it already exists.
+        // Called once per frame after the first one, so that the programs are ready before
+        // they are needed without delaying the first paint.
+        void prepareNextCommonProgram()
+        {
+            static const TextureMapperShaderProgram::Options commonOptions[] = {
+                TextureMapperShaderProgram::Texture | TextureMapperShaderProgram::Batched,
+                TextureMapperShaderProgram::Batched,
+                TextureMapperShaderProgram::Texture,
+                TextureMapperShaderProgram::Texture | TextureMapperShaderProgram::Opacity,
+                TextureMapperShaderProgram::SolidColor,
+                TextureMapperShaderProgram::SolidColor | TextureMapperShaderProgram::Antialiasing,
+                TextureMapperShaderProgram::Texture | TextureMapperShaderProgram::Antialiasing,
+                TextureMapperShaderProgram::Texture | TextureMapperShaderProgram::Opacity | TextureMapperShaderProgram::Antialiasing
+            };
+
+            while (m_nextCommonProgram < WTF_ARRAY_LENGTH(commonOptions)) {
+                TextureMapperShaderProgram::Options options = commonOptions[m_nextCommonProgram++];
+                if (!m_programs.contains(options)) {
+                    getShaderProgram(options);
+                    return;
+                }
+            }
+        }
+
         HashMap<TextureMapperShaderProgram::Options, RefPtr<TextureMapperShaderProgram> > m_programs;
         RefPtr<GraphicsContext3D> m_context;
+        unsigned m_nextCommonProgram { 0 };
 
         explicit SharedGLData(GraphicsContext3D* context)
             : m_context(context)
@@ -123,6 +150,7 @@ public:
         , previousScissorState(0)
         , previousDepthState(0)
         , sharedData(TextureMapperGLData::SharedGLData::currentSharedGLData(this->context))
+        , uploadStream(BitmapTextureUploadStream::forContext(*this->context))
         , filterInfo(0)
     { }
 
@@ -140,9 +168,21 @@ public:
     GC3Dint viewport[4];
     GC3Dint previousScissor[4];
     RefPtr<SharedGLData> sharedData;
+    RefPtr<BitmapTextureUploadStream> uploadStream;
     RefPtr<BitmapTexture> currentSurface;
     HashMap<const void*, Platform3DObject> vbos;
     const BitmapTextureGL::FilterInfo* filterInfo;
+
+    struct QuadBatch {
+        TextureMapperShaderProgram::Options options { 0 };
+        Platform3DObject texture { 0 };
+        bool blend { false };
+        Vector<GC3Dfloat> vertices;
+    };
+    QuadBatch batch;
+    Platform3DObject batchVBO { 0 };
+    TextureMapper::DrawStats drawStats;
+    bool didPaintFirstFrame { false };
 };
 
 Platform3DObject TextureMapperGLData::getStaticVBO(GC3Denum target, GC3Dsizeiptr size, const void* data)
@@ -162,6 +202,8 @@ TextureMapperGLData::~TextureMapperGLData()
 {
     for (auto& entry : vbos)
         context->deleteBuffer(entry.value);
+    if (batchVBO)
+        context->deleteBuffer(batchVBO);
 }
 
 void TextureMapperGL::ClipStack::reset(const IntRect& rect, TextureMapperGL::ClipStack::YAxisMode mode)
@@ -240,8 +282,13 @@ void TextureMapperGLData::initializeStencil()
     didModifyStencil = true;
 }
 
+// Blurs are scaled down until the standard deviation is this many texels, at most 8 times.
+static const float minimumDownsampledBlurStdDeviation = 4;
+static const unsigned maximumBlurDownsamplingFactor = 8;
+
 TextureMapperGL::TextureMapperGL()
     : m_enableEdgeDistanceAntialiasing(false)
+    , m_maximumBlurDownsamplingFactor(maximumBlurDownsamplingFactor)
 {
     m_context3D = GraphicsContext3D::createForCurrentGLContext();
     m_data = new TextureMapperGLData(m_context3D.get());
@@ -269,11 +316,15 @@ void TextureMapperGL::beginPainting(PaintFlags flags)
     m_clipStack.reset(IntRect(0, 0, data().viewport[2], data().viewport[3]), flags & PaintingMirrored ? ClipStack::DefaultYAxis : ClipStack::InvertedYAxis);
     m_context3D->getIntegerv(GraphicsContext3D::FRAMEBUFFER_BINDING, &data().targetFrameBuffer);
     data().PaintFlags = flags;
+    data().drawStats = DrawStats();
     bindSurface(0);
 }
 
 void TextureMapperGL::endPainting()
 {
+    flushBatch();
+    m_drawStats = data().drawStats;
+
     if (data().didModifyStencil) {
         m_context3D->clearStencil(1);
         m_context3D->clear(GraphicsContext3D::STENCIL_BUFFER_BIT);
@@ -291,6 +342,13 @@ void TextureMapperGL::endPainting()
         m_context3D->enable(GraphicsContext3D::DEPTH_TEST);
     else
         m_context3D->disable(GraphicsContext3D::DEPTH_TEST);
+
+    if (data().uploadStream)
+        data().uploadStream->didFinishFrame();
+
+    if (data().didPaintFirstFrame)
+        data().sharedGLData().prepareNextCommonProgram();
+    data().didPaintFirstFrame = true;
 }
 
 void TextureMapperGL::drawBorder(const Color& color, float width, const FloatRect& targetRect, const TransformationMatrix& modelViewMatrix)
@@ -298,6 +356,7 @@ void TextureMapperGL::drawBorder(const Color& color, float width, const FloatRec
     if (clipStack().isCurrentScissorBoxEmpty())
         return;
 
+    flushBatch();
     RefPtr<TextureMapperShaderProgram> program = data().sharedGLData().getShaderProgram(TextureMapperShaderProgram::SolidColor);
     m_context3D->useProgram(program->programID());
 
@@ -344,6 +403,8 @@ void TextureMapperGL::drawNumber(int number, const Color& color, const FloatPoin
     int stride = cairo_image_surface_get_stride(surface);
     static_cast<BitmapTextureGL*>(texture.get())->updateContentsNoSwizzle(bits, sourceRect, IntPoint::zero(), stride);
     drawTexture(*texture, targetRect, modelViewMatrix, 1.0f, AllEdges);
+    // The texture goes back to the pool right away and may be refilled by the next number.
+    flushBatch();
 
     cairo_surface_destroy(surface);
     cairo_destroy(cr);
@@ -525,6 +586,14 @@ void TextureMapperGL::drawTexture(Platform3DObject texture, Flags flags, const I
     if (useAntialiasing || opacity < 1)
         flags |= ShouldBlend;
 
+    const Flags textureSpaceFlags = ShouldUseARBTextureRect | ShouldFlipTexture | ShouldRotateTexture90 | ShouldRotateTexture180 | ShouldRotateTexture270;
+    if (!filter && !useAntialiasing && !(flags & textureSpaceFlags) && wrapMode() == StretchWrap && canBatchQuad(modelViewMatrix)) {
+        const GC3Dfloat color[] = { opacity, opacity, opacity, opacity };
+        appendQuadToBatch(TextureMapperShaderProgram::Texture | TextureMapperShaderProgram::Batched, texture, flags & ShouldBlend, targetRect, modelViewMatrix, color);
+        return;
+    }
+
+    flushBatch();
     RefPtr<TextureMapperShaderProgram> program;
     program = data().sharedGLData().getShaderProgram(options);
 
@@ -543,15 +612,22 @@ void TextureMapperGL::drawSolidColor(const FloatRect& rect, const Transformation
         flags |= ShouldAntialias | (allowBlend ? ShouldBlend : 0);
     }
 
-    RefPtr<TextureMapperShaderProgram> program = data().sharedGLData().getShaderProgram(options);
-    m_context3D->useProgram(program->programID());
-
     float r, g, b, a;
     Color(premultipliedARGBFromColor(color)).getRGBA(r, g, b, a);
-    m_context3D->uniform4f(program->colorLocation(), r, g, b, a);
     if (allowBlend && a < 1)
         flags |= ShouldBlend;
 
+    if (!(flags & ShouldAntialias) && canBatchQuad(matrix)) {
+        const GC3Dfloat batchColor[] = { r, g, b, a };
+        appendQuadToBatch(TextureMapperShaderProgram::Batched, 0, flags & ShouldBlend, rect, matrix, batchColor);
+        return;
+    }
+
+    flushBatch();
+    RefPtr<TextureMapperShaderProgram> program = data().sharedGLData().getShaderProgram(options);
+    m_context3D->useProgram(program->programID());
+    m_context3D->uniform4f(program->colorLocation(), r, g, b, a);
+
     draw(rect, matrix, program.get(), GraphicsContext3D::TRIANGLE_FAN, flags);
 }
 
@@ -583,6 +659,7 @@ void TextureMapperGL::drawEdgeTriangles(TextureMapperShaderProgram* program)
     m_context3D->vertexAttribPointer(program->vertexLocation(), 4, GraphicsContext3D::FLOAT, false, 0, 0);
     m_context3D->drawArrays(GraphicsContext3D::TRIANGLES, 0, 12);
     m_context3D->bindBuffer(GraphicsContext3D::ARRAY_BUFFER, 0);
+    ++data().drawStats.drawCalls;
 }
 
 void TextureMapperGL::drawUnitRect(TextureMapperShaderProgram* program, GC3Denum drawingMode)
@@ -593,6 +670,95 @@ void TextureMapperGL::drawUnitRect(TextureMapperShaderProgram* program, GC3Denum
     m_context3D->vertexAttribPointer(program->vertexLocation(), 2, GraphicsContext3D::FLOAT, false, 0, 0);
     m_context3D->drawArrays(drawingMode, 0, 4);
     m_context3D->bindBuffer(GraphicsContext3D::ARRAY_BUFFER, 0);
+    ++data().drawStats.drawCalls;
+}
+
+bool TextureMapperGL::canBatchQuad(const TransformationMatrix& modelViewMatrix) const
+{
+    // Batched vertices are transformed on the CPU and only carry 2D positions and texture coordinates.
+    return !isInMaskMode() && modelViewMatrix.isAffine() && patternTransform().isAffine();
+}
+
+void TextureMapperGL::appendQuadToBatch(unsigned options, Platform3DObject texture, bool blend, const FloatRect& rect, const TransformationMatrix& modelViewMatrix, const GC3Dfloat color[4])
+{
+    TextureMapperGLData::QuadBatch& batch = data().batch;
+    if (!batch.vertices.isEmpty() && (batch.options != options || batch.texture != texture || batch.blend != blend))
+        flushBatch();
+
+    batch.options = options;
+    batch.texture = texture;
+    batch.blend = blend;
+
+    TransformationMatrix matrix(modelViewMatrix);
+    matrix.multiply(TransformationMatrix::rectToRect(FloatRect(0, 0, 1, 1), rect));
+    const TransformationMatrix& textureSpaceMatrix = patternTransform();
+
+    // Two triangles per quad. Each vertex is the position and texture coordinate, followed by the color.
+    static const FloatPoint unitRectTriangles[] = {
+        FloatPoint(0, 0), FloatPoint(1, 0), FloatPoint(1, 1),
+        FloatPoint(0, 0), FloatPoint(1, 1), FloatPoint(0, 1)
+    };
+    static const size_t floatsPerVertex = 8;
+
+    size_t offset = batch.vertices.size();
+    batch.vertices.grow(offset + WTF_ARRAY_LENGTH(unitRectTriangles) * floatsPerVertex);
+    GC3Dfloat* vertex = batch.vertices.data() + offset;
+    for (auto& point : unitRectTriangles) {
+        FloatPoint position = matrix.mapPoint(point);
+        FloatPoint texCoord = textureSpaceMatrix.mapPoint(point);
+        *vertex++ = position.x();
+        *vertex++ = position.y();
+        *vertex++ = texCoord.x();
+        *vertex++ = texCoord.y();
+        for (unsigned i = 0; i < 4; ++i)
+            *vertex++ = color[i];
+    }
+
+    ++data().drawStats.batchedQuads;
+}
+
+void TextureMapperGL::flushBatch()
+{
+    TextureMapperGLData::QuadBatch& batch = data().batch;
+    if (batch.vertices.isEmpty())
+        return;
+
+    RefPtr<TextureMapperShaderProgram> program = data().sharedGLData().getShaderProgram(batch.options);
+    m_context3D->useProgram(program->programID());
+    if (batch.options & TextureMapperShaderProgram::Texture) {
+        m_context3D->activeTexture(GraphicsContext3D::TEXTURE0);
+        m_context3D->bindTexture(GraphicsContext3D::TEXTURE_2D, batch.texture);
+        m_context3D->uniform1i(program->samplerLocation(), 0);
+    }
+    program->setMatrix(program->projectionMatrixLocation(), data().projectionMatrix);
+
+    if (batch.blend) {
+        m_context3D->blendFunc(GraphicsContext3D::ONE, GraphicsContext3D::ONE_MINUS_SRC_ALPHA);
+        m_context3D->enable(GraphicsContext3D::BLEND);
+    } else
+        m_context3D->disable(GraphicsContext3D::BLEND);
+
+    if (!data().batchVBO)
+        data().batchVBO = m_context3D->createBuffer();
+    m_context3D->bindBuffer(GraphicsContext3D::ARRAY_BUFFER, data().batchVBO);
+    m_context3D->bufferData(GraphicsContext3D::ARRAY_BUFFER, batch.vertices.size() * sizeof(GC3Dfloat), batch.vertices.data(), GraphicsContext3D::STREAM_DRAW);
+
+    const GC3Dsizei stride = 8 * sizeof(GC3Dfloat);
+    m_context3D->enableVertexAttribArray(program->vertexLocation());
+    m_context3D->vertexAttribPointer(program->vertexLocation(), 4, GraphicsContext3D::FLOAT, false, stride, 0);
+    m_context3D->enableVertexAttribArray(program->vertexColorLocation());
+    m_context3D->vertexAttribPointer(program->vertexColorLocation(), 4, GraphicsContext3D::FLOAT, false, stride, 4 * sizeof(GC3Dfloat));
+
+    m_context3D->drawArrays(GraphicsContext3D::TRIANGLES, 0, batch.vertices.size() / 8);
+    ++data().drawStats.drawCalls;
+
+    m_context3D->disableVertexAttribArray(program->vertexColorLocation());
+    m_context3D->disableVertexAttribArray(program->vertexLocation());
+    m_context3D->bindBuffer(GraphicsContext3D::ARRAY_BUFFER, 0);
+    m_context3D->blendFunc(GraphicsContext3D::ONE, GraphicsContext3D::ONE_MINUS_SRC_ALPHA);
+    m_context3D->enable(GraphicsContext3D::BLEND);
+
+    batch.vertices.shrink(0);
 }
 
 void TextureMapperGL::draw(const FloatRect& rect, const TransformationMatrix& modelViewMatrix, TextureMapperShaderProgram* shaderProgram, GC3Denum drawingMode, Flags flags)
@@ -662,8 +828,70 @@ void TextureMapperGL::drawTexturedQuadWithProgram(TextureMapperShaderProgram* pr
     m_context3D->texParameteri(GraphicsContext3D::TEXTURE_2D, GraphicsContext3D::TEXTURE_WRAP_T, GraphicsContext3D::CLAMP_TO_EDGE);
 }
 
+unsigned TextureMapperGL::filterDownsamplingFactor(const FilterOperation& filter, const IntSize& size) const
+{
+    if (filter.type() != FilterOperation::BLUR)
+        return 1;
+
+    const BlurFilterOperation& blur = static_cast<const BlurFilterOperation&>(filter);
+    float stdDeviation = std::min(floatValueForLength(blur.stdDeviation(), size.width()), floatValueForLength(blur.stdDeviation(), size.height()));
+
+    unsigned factor = 1;
+    while (factor < m_maximumBlurDownsamplingFactor
+        && stdDeviation / (factor * 2) >= minimumDownsampledBlurStdDeviation
+        && size.width() >= static_cast<int>(factor * 2)
+        && size.height() >= static_cast<int>(factor * 2))
+        factor *= 2;
+    return factor;
+}
+
+void TextureMapperGL::drawDownsampledBlur(const BitmapTexture& sampler, const FilterOperation& filter, unsigned downsamplingFactor)
+{
+    RefPtr<BitmapTexture> targetSurface = data().currentSurface;
+    IntSize size = sampler.contentSize();
+    RefPtr<TextureMapperShaderProgram> textureProgram = data().sharedGLData().getShaderProgram(TextureMapperShaderProgram::Texture);
+
+    // Halve the texture until it is small enough, every linear sample averages 2x2 texels.
+    RefPtr<BitmapTexture> scaledTexture;
+    const BitmapTexture* source = &sampler;
+    IntSize scaledSize;
+    for (unsigned factor = 2; factor <= downsamplingFactor; factor *= 2) {
+        scaledSize = IntSize(size.width() / factor, size.height() / factor);
+        RefPtr<BitmapTexture> halvedTexture = acquireTextureFromPool(scaledSize);
+        bindSurface(halvedTexture.get());
+        drawTexturedQuadWithProgram(textureProgram.get(), static_cast<const BitmapTextureGL*>(source)->id(), 0, IntSize(1, 1), FloatRect(IntPoint::zero(), scaledSize), TransformationMatrix(), 1);
+        scaledTexture = halvedTexture.release();
+        source = scaledTexture.get();
+    }
+
+    // Blur horizontally and vertically at that size. The blur radius is relative to the size of
+    // the texture, so it stays the same.
+    RefPtr<TextureMapperShaderProgram> blurProgram = data().sharedGLData().getShaderProgram(optionsForFilterType(filter.type(), 0));
+    for (unsigned pass = 0; pass < 2; ++pass) {
+        RefPtr<BitmapTexture> blurredTexture = acquireTextureFromPool(scaledSize);
+        bindSurface(blurredTexture.get());
+        prepareFilterProgram(blurProgram.get(), filter, pass, size, 0);
+        drawTexturedQuadWithProgram(blurProgram.get(), static_cast<const BitmapTextureGL*>(source)->id(), 0, IntSize(1, 1), FloatRect(IntPoint::zero(), scaledSize), TransformationMatrix(), 1);
+        scaledTexture = blurredTexture.release();
+        source = scaledTexture.get();
+    }
+
+    // And scale the result back up into the target.
+    bindSurface(targetSurface.get());
+    drawTexturedQuadWithProgram(textureProgram.get(), static_cast<const BitmapTextureGL*>(source)->id(), 0, IntSize(1, 1), FloatRect(IntPoint::zero(), size), TransformationMatrix(), 1);
+}
+
 void TextureMapperGL::drawFiltered(const BitmapTexture& sampler, const BitmapTexture* contentTexture, const FilterOperation& filter, int pass)
 {
+    flushBatch();
+
+    unsigned downsamplingFactor = filterDownsamplingFactor(filter, sampler.contentSize());
+    if (downsamplingFactor > 1) {
+        ASSERT(!pass);
+        drawDownsampledBlur(sampler, filter, downsamplingFactor);
+        return;
+    }
+
     // For standard filters, we always draw the whole texture without transformations.
     TextureMapperShaderProgram::Options options = optionsForFilterType(filter.type(), pass);
     RefPtr<TextureMapperShaderProgram> program = data().sharedGLData().getShaderProgram(options);
@@ -685,6 +913,11 @@ static inline TransformationMatrix createProjectionMatrix(const IntSize& size, b
                                 -1, mirrored ? -1 : 1, -(farValue + nearValue) / (farValue - nearValue), 1);
 }
 
+PassRefPtr<TextureMapperShaderProgram> TextureMapperGL::sharedShaderProgram(GraphicsContext3D* context, unsigned options)
+{
+    return TextureMapperGLData::SharedGLData::currentSharedGLData(context)->getShaderProgram(options);
+}
+
 TextureMapperGL::~TextureMapperGL()
 {
     delete m_data;
@@ -692,6 +925,7 @@ TextureMapperGL::~TextureMapperGL()
 
 void TextureMapperGL::bindDefaultSurface()
 {
+    flushBatch();
     m_context3D->bindFramebuffer(GraphicsContext3D::FRAMEBUFFER, data().targetFrameBuffer);
     auto& viewport = data().viewport;
     data().projectionMatrix = createProjectionMatrix(IntSize(viewport[2], viewport[3]), data().PaintFlags & PaintingMirrored);
@@ -702,6 +936,7 @@ void TextureMapperGL::bindDefaultSurface()
 
 void TextureMapperGL::bindSurface(BitmapTexture *surface)
 {
+    flushBatch();
     if (!surface) {
         bindDefaultSurface();
         return;
@@ -731,6 +966,7 @@ bool TextureMapperGL::beginScissorClip(const TransformationMatrix& modelViewMatr
     if (!quad.isRectilinear() || rect.isEmpty())
         return false;
 
+    flushBatch();
     clipStack().intersect(rect);
     clipStack().applyIfNeeded(m_context3D.get());
     return true;
@@ -742,6 +978,7 @@ void TextureMapperGL::beginClip(const TransformationMatrix& modelViewMatrix, con
     if (beginScissorClip(modelViewMatrix, targetRect))
         return;
 
+    flushBatch();
     data().initializeStencil();
 
     RefPtr<TextureMapperShaderProgram> program = data().sharedGLData().getShaderProgram(TextureMapperShaderProgram::SolidColor);
@@ -777,6 +1014,7 @@ void TextureMapperGL::beginClip(const TransformationMatrix& modelViewMatrix, con
     program->setMatrix(program->projectionMatrixLocation(), data().projectionMatrix);
     program->setMatrix(program->modelViewMatrixLocation(), matrix);
     m_context3D->drawArrays(GraphicsContext3D::TRIANGLE_FAN, 0, 4);
+    data().drawStats.drawCalls += 2;
 
     // Clear the state.
     m_context3D->disableVertexAttribArray(program->vertexLocation());
@@ -789,6 +1027,7 @@ void TextureMapperGL::beginClip(const TransformationMatrix& modelViewMatrix, con
 
 void TextureMapperGL::endClip()
 {
+    flushBatch();
     clipStack().pop();
     clipStack().applyIfNeeded(m_context3D.get());
 }
@@ -121,15 +121,32 @@ public:
 
     void drawFiltered(const BitmapTexture& sourceTexture, const BitmapTexture* contentTexture, const FilterOperation&, int pass);
 
+    // Large blurs are drawn at a fraction of the size of the texture and scaled back up, all in
+    // the first drawFiltered() pass. Returns how many times smaller, or 1 for other filters.
+    unsigned filterDownsamplingFactor(const FilterOperation&, const IntSize&) const;
+
+    // A factor of 1 draws every blur at full size, which tests compare downsampled blurs with.
+    void setMaximumBlurDownsamplingFactor(unsigned factor) { m_maximumBlurDownsamplingFactor = factor; }
+
     void setEnableEdgeDistanceAntialiasing(bool enabled) { m_enableEdgeDistanceAntialiasing = enabled; }
 
+    // Programs are shared by all the texture mappers using the same GL context.
+    static PassRefPtr<TextureMapperShaderProgram> sharedShaderProgram(GraphicsContext3D*, unsigned options);
+
 private:
     void drawTexturedQuadWithProgram(TextureMapperShaderProgram*, uint32_t texture, Flags, const IntSize&, const FloatRect&, const TransformationMatrix& modelViewMatrix, float opacity);
+    void drawDownsampledBlur(const BitmapTexture& sourceTexture, const FilterOperation&, unsigned downsamplingFactor);
     void draw(const FloatRect&, const TransformationMatrix& modelViewMatrix, TextureMapperShaderProgram*, GC3Denum drawingMode, Flags);
 
     void drawUnitRect(TextureMapperShaderProgram*, GC3Denum drawingMode);
     void drawEdgeTriangles(TextureMapperShaderProgram*);
 
+    // Quads that only differ in geometry and color are accumulated into a single vertex buffer,
+    // and drawn once the program, texture or blend state changes, or before any other GL work.
+    bool canBatchQuad(const TransformationMatrix& modelViewMatrix) const;
+    void appendQuadToBatch(unsigned options, Platform3DObject texture, bool blend, const FloatRect&, const TransformationMatrix& modelViewMatrix, const GC3Dfloat color[4]);
+    void flushBatch();
+
     bool beginScissorClip(const TransformationMatrix&, const FloatRect&);
     void bindDefaultSurface();
     ClipStack& clipStack();
@@ -138,6 +155,7 @@ private:
     TextureMapperGLData* m_data;
     ClipStack m_clipStack;
     bool m_enableEdgeDistanceAntialiasing;
+    unsigned m_maximumBlurDownsamplingFactor;
 };
 
 } // namespace WebCore
@@ -36,9 +36,11 @@ public:
     TransformationMatrix transform;
     IntSize offset;
     TextureMapper* textureMapper;
+    bool cullOccludedLayers;
     TextureMapperPaintOptions()
         : opacity(1)
         , textureMapper(0)
+        , cullOccludedLayers(false)
     { }
 };
 
@@ -90,9 +92,125 @@ void TextureMapperLayer::paint()
     TextureMapperPaintOptions options;
     options.textureMapper = m_textureMapper;
     options.textureMapper->bindSurface(0);
+
+    IntRect clipBounds = options.textureMapper->clipBounds();
+    Region occlusion;
+    computeOcclusionRecursive(occlusion, clipBounds, clipBounds, 1);
+    options.textureMapper->occlusionStats() = TextureMapper::OcclusionStats();
+    options.cullOccludedLayers = true;
+
     paintRecursive(options);
 }
 
+static bool preservesAxisAlignment(const TransformationMatrix& matrix)
+{
+    return matrix.isAffine() && matrix.toAffineTransform().preservesAxisAlignment();
+}
+
+static IntRect enclosedIntRect(const FloatRect& rect)
+{
+    IntPoint location = ceiledIntPoint(rect.minXMinYCorner());
+    IntPoint maxPoint = flooredIntPoint(rect.maxXMaxYCorner());
+    return IntRect(location, (maxPoint - location).expandedTo(IntSize()));
+}
+
+bool TextureMapperLayer::paintsThroughIntermediateSurface() const
+{
+    return shouldPaintUsingOverlapRegions() || m_state.replicaLayer;
+}
+
+Optional<FloatRect> TextureMapperLayer::mapRectToSurface(const FloatRect& rect) const
+{
+    for (const TextureMapperLayer* layer = this; layer; layer = layer->m_parent) {
+        if (layer->m_effectTarget || layer->paintsThroughIntermediateSurface())
+            return Nullopt;
+    }
+
+    return m_currentTransform.combined().mapRect(rect);
+}
+
+// Walks the layers in the reverse order of paintRecursive(), accumulating in occlusion the parts of
+// the root surface covered by opaque content. clipRect bounds what a layer may touch, occluderClipRect
+// is the part of it where the clip is known to be exact. Layers painted through intermediate surfaces
+// neither get culled nor occlude anything.
+void TextureMapperLayer::computeOcclusionRecursive(Region& occlusion, const IntRect& clipRect, const IntRect& occluderClipRect, float opacity)
+{
+    m_isOccluded = false;
+    m_occlusion = Region();
+
+    if (!isVisible() || paintsThroughIntermediateSurface())
+        return;
+
+    opacity *= m_currentOpacity;
+    const TransformationMatrix& transform = m_currentTransform.combined();
+
+    if (!m_children.isEmpty()) {
+        IntRect childClipRect = clipRect;
+        IntRect childOccluderClipRect = occluderClipRect;
+        if (m_state.masksToBounds && !m_state.preserves3D) {
+            FloatRect clip = transform.mapRect(layerRect());
+            childClipRect.intersect(enclosingIntRect(clip));
+            if (preservesAxisAlignment(transform))
+                childOccluderClipRect.intersect(enclosedIntRect(clip));
+            else
+                childOccluderClipRect = IntRect();
+        }
+
+        for (size_t i = m_children.size(); i; --i)
+            m_children[i - 1]->computeOcclusionRecursive(occlusion, childClipRect, childOccluderClipRect, opacity);
+    }
+
+    if (!m_state.visible || !m_state.contentsVisible)
+        return;
+
+    // Mirror what paintSelf() draws.
+    FloatRect paintedRect;
+    FloatRect opaqueRect;
+    bool paintsSolidColor = m_state.solidColor.isValid() && !m_state.contentsRect.isEmpty() && m_state.solidColor.alpha();
+    if (paintsSolidColor) {
+        paintedRect = m_state.contentsRect;
+        if (m_state.showDebugBorders)
+            paintedRect.unite(layerRect());
+        if (m_state.solidColor.alpha() == 255)
+            opaqueRect = m_state.contentsRect;
+    } else {
+        if (m_backingStore) {
+            paintedRect = layerRect();
+            if (m_state.contentsOpaque)
+                opaqueRect = layerRect();
+        }
+        if (m_contentsLayer)
+            paintedRect.unite(m_state.contentsRect);
+    }
+
+    if (paintedRect.isEmpty())
+        return;
+
+    // Leave room for the antialiased edges of transformed quads.
+    IntRect targetRect = enclosingIntRect(transform.mapRect(paintedRect));
+    targetRect.inflate(1);
+    targetRect.intersect(clipRect);
+    if (targetRect.isEmpty())
+        return;
+
+    Region visibleRegion(targetRect);
+    if (occlusion.contains(visibleRegion)) {
+        m_isOccluded = true;
+        return;
+    }
+
+    if (!paintsSolidColor && m_backingStore && occlusion.intersects(visibleRegion))
+        m_occlusion = occlusion;
+
+    if (opacity < 1 || opaqueRect.isEmpty() || !preservesAxisAlignment(transform))
+        return;
+
+    IntRect occluderRect = enclosedIntRect(transform.mapRect(opaqueRect));
+    occluderRect.intersect(occluderClipRect);
+    if (!occluderRect.isEmpty())
+        occlusion.unite(occluderRect);
+}
+
 static Color blendWithOpacity(const Color& color, float opacity)
 {
     RGBA32 rgba = color.rgb();
@@ -118,6 +236,11 @@ void TextureMapperLayer::paintSelf(const TextureMapperPaintOptions& options)
     if (!m_state.visible || !m_state.contentsVisible)
         return;
 
+    if (options.cullOccludedLayers && m_isOccluded) {
+        ++options.textureMapper->occlusionStats().culledLayers;
+        return;
+    }
+
     // We apply the following transform to compensate for painting into a surface, and then apply the offset so that the painting fits in the target rect.
     TransformationMatrix transform;
     transform.translate(options.offset.width(), options.offset.height());
@@ -137,7 +260,12 @@ void TextureMapperLayer::paintSelf(const TextureMapperPaintOptions& options)
     if (m_backingStore) {
         FloatRect targetRect = layerRect();
         ASSERT(!targetRect.isEmpty());
+        bool cullsTiles = options.cullOccludedLayers && !m_occlusion.isEmpty();
+        if (cullsTiles)
+            options.textureMapper->setOcclusion(&m_occlusion);
         m_backingStore->paintToTextureMapper(options.textureMapper, targetRect, transform, options.opacity);
+        if (cullsTiles)
+            options.textureMapper->setOcclusion(nullptr);
         if (m_state.showDebugBorders)
             m_backingStore->drawBorder(options.textureMapper, m_state.debugBorderColor, m_state.debugBorderWidth, targetRect, transform);
         // Only draw repaint count for the main backing store.
@@ -436,6 +564,8 @@ void TextureMapperLayer::paintRecursive(const TextureMapperPaintOptions& options
 
     TextureMapperPaintOptions paintOptions(options);
     paintOptions.opacity *= m_currentOpacity;
+    if (paintsThroughIntermediateSurface())
+        paintOptions.cullOccludedLayers = false;
 
     if (shouldPaintUsingOverlapRegions()) {
         paintUsingOverlapRegions(paintOptions);
@@ -753,16 +883,28 @@ void TextureMapperLayer::commitScrollOffset(const FloatSize& offset)
     m_scrollClient->commitScrollOffset(m_id, IntSize(intWidth, intHeight));
 }
 
-void TextureMapperLayer::scrollBy(const FloatSize& offset)
+bool TextureMapperLayer::scrollBy(const FloatSize& offset)
 {
     if (!isScrollable() || !m_scrollClient || offset.isZero())
-        return;
+        return false;
 
     FloatSize scrollOffset = mapScrollOffset(offset);
+    if (m_parent) {
+        FloatPoint position = adjustedPosition();
+        FloatPoint scrolledPosition = position - scrollOffset;
+        scrolledPosition = FloatPoint(
+            clampTo<float>(scrolledPosition.x(), std::min(0.f, m_parent->m_state.size.width() - m_state.size.width()), 0),
+            clampTo<float>(scrolledPosition.y(), std::min(0.f, m_parent->m_state.size.height() - m_state.size.height()), 0));
+        scrollOffset = position - scrolledPosition;
+        if (scrollOffset.isZero())
+            return false;
+    }
+
     m_userScrollOffset += scrollOffset;
 
     m_currentTransform.setPosition(adjustedPosition());
     commitScrollOffset(scrollOffset);
+    return true;
 }
 
 void TextureMapperLayer::didCommitScrollOffset(const IntSize& offset)
@@ -26,14 +26,15 @@
 #include "FilterOperations.h"
 #include "FloatRect.h"
 #include "GraphicsLayerTransform.h"
+#include "Region.h"
 #include "TextureMapper.h"
 #include "TextureMapperAnimation.h"
 #include "TextureMapperBackingStore.h"
+#include <wtf/Optional.h>
 
 namespace WebCore {
 
 class GraphicsLayer;
-class Region;
 class TextureMapperPaintOptions;
 class TextureMapperPlatformLayer;
 
@@ -59,6 +60,7 @@ public:
         , m_scrollClient(0)
         , m_isScrollable(false)
         , m_patternTransformDirty(false)
+        , m_isOccluded(false)
     { }
 
     virtual ~TextureMapperLayer();
@@ -70,7 +72,8 @@ public:
     TextureMapperLayer* findScrollableContentsLayerAt(const FloatPoint& pos);
 
     void setScrollClient(ScrollingClient* scrollClient) { m_scrollClient = scrollClient; }
-    void scrollBy(const WebCore::FloatSize&);
+    // Returns whether the contents moved, they stay within the bounds of the layer clipping them.
+    bool scrollBy(const WebCore::FloatSize&);
 
     void didCommitScrollOffset(const IntSize&);
     void setIsScrollable(bool isScrollable) { m_isScrollable = isScrollable; }
@@ -125,6 +128,10 @@ public:
     void syncAnimations();
     bool descendantsOrSelfHaveRunningAnimations() const;
 
+    // Maps a rect in layer coordinates to the root surface, using the transforms of the last paint.
+    // Returns Nullopt when the layer reaches the surface through an intermediate surface.
+    Optional<FloatRect> mapRectToSurface(const FloatRect&) const;
+
     void paint();
 
     void setScrollPositionDeltaIfNeeded(const FloatSize&);
@@ -157,6 +164,8 @@ private:
         ResolveSelfOverlapIfNeeded
     };
     void computeOverlapRegions(Region& overlapRegion, Region& nonOverlapRegion, ResolveSelfOverlapMode);
+    bool paintsThroughIntermediateSurface() const;
+    void computeOcclusionRecursive(Region& occlusion, const IntRect& clipRect, const IntRect& occluderClipRect, float opacity);
 
     void paintRecursive(const TextureMapperPaintOptions&);
     bool shouldPaintUsingOverlapRegions() const;
@@ -261,6 +270,11 @@ private:
     FloatSize m_accumulatedScrollOffsetFractionalPart;
     TransformationMatrix m_patternTransform;
     bool m_patternTransformDirty;
+
+    // Computed front to back before each frame for the layers painted straight into the
+    // root surface. m_occlusion is only kept when it partially covers the backing store.
+    bool m_isOccluded;
+    Region m_occlusion;
 };
 
 }
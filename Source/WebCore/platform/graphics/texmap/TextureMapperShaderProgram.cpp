@@ -28,8 +28,19 @@
 #include "Logging.h"
 #include "TextureMapperGL.h"
 
+#include "Extensions3D.h"
+#include "FileSystem.h"
+#include <wtf/CryptographicallyRandomNumber.h>
+#include <wtf/NeverDestroyed.h>
+#include <wtf/ProcessID.h>
+#include <wtf/SHA1.h>
 #include <wtf/text/StringBuilder.h>
 
+#if USE(GLIB)
+#include <glib.h>
+#include <wtf/glib/GUniquePtr.h>
+#endif
+
 #define STRINGIFY(...) #__VA_ARGS__
 
 namespace WebCore {
@@ -43,20 +54,147 @@ static inline bool compositingLogEnabled()
 #endif
 }
 
+// Linked programs are stored on disk through GL_OES_get_program_binary, so that later processes
+// can skip compiling the shaders. WEBKIT_SHADER_CACHE_DIR overrides the location, and disables
+// the cache when empty.
+static const String& programBinaryCacheDirectory()
+{
+    static NeverDestroyed<String> directory([] {
+        if (const char* path = getenv("WEBKIT_SHADER_CACHE_DIR"))
+            return String::fromUTF8(path);
+#if USE(GLIB) && PLATFORM(WPE)
+        GUniquePtr<char> path(g_build_filename(g_get_user_cache_dir(), "wpe", "shaders", nullptr));
+        return filenameToString(path.get());
+#else
+        return String();
+#endif
+    }());
+    return directory;
+}
+
+struct ProgramBinaryHeader {
+    uint32_t magic;
+    uint32_t format;
+    uint32_t length;
+};
+
+static const uint32_t programBinaryMagic = 0x42504d54; // "TMPB"
+static const GC3Dint maximumProgramBinaryLength = 1024 * 1024;
+
+// Binaries are only valid for the driver that produced them, so the entries are keyed by the driver
+// strings as well as by the shader sources.
+static String programBinaryCachePath(GraphicsContext3D& context, const String& vertexSource, const String& fragmentSource)
+{
+    const String& directory = programBinaryCacheDirectory();
+    if (directory.isEmpty() || !context.getExtensions()->supports("GL_OES_get_program_binary"))
+        return String();
+
+    GC3Dint formatCount = 0;
+    context.getIntegerv(Extensions3D::NUM_PROGRAM_BINARY_FORMATS_OES, &formatCount);
+    if (formatCount <= 0)
+        return String();
+
+    SHA1 sha1;
+    static const GC3Denum driverStrings[] = { GraphicsContext3D::VENDOR, GraphicsContext3D::RENDERER, GraphicsContext3D::VERSION };
+    for (GC3Denum name : driverStrings)
+        sha1.addBytes(context.getString(name).utf8());
+    sha1.addBytes(vertexSource.utf8());
+    sha1.addBytes(fragmentSource.utf8());
+
+    SHA1::Digest digest;
+    sha1.computeHash(digest);
+    return pathByAppendingComponent(directory, makeString(SHA1::hexDigest(digest).data(), ".bin"));
+}
+
+static bool loadProgramBinary(GraphicsContext3D& context, Platform3DObject program, const String& path)
+{
+    PlatformFileHandle file = openFile(path, OpenForRead);
+    if (!isHandleValid(file))
+        return false;
+
+    ProgramBinaryHeader header;
+    Vector<char> binary;
+    bool success = readFromFile(file, reinterpret_cast<char*>(&header), sizeof(header)) == sizeof(header)
+        && header.magic == programBinaryMagic
+        && header.length && header.length <= static_cast<uint32_t>(maximumProgramBinaryLength);
+    if (success) {
+        binary.resize(header.length);
+        success = readFromFile(file, binary.data(), header.length) == static_cast<int>(header.length);
+    }
+    closeFile(file);
+
+    if (!success)
+        return false;
+
+    context.getExtensions()->programBinaryOES(program, header.format, binary.data(), header.length);
+    GC3Dint linkStatus = 0;
+    context.getProgramiv(program, GraphicsContext3D::LINK_STATUS, &linkStatus);
+    if (linkStatus)
+        return true;
+
+    // Drivers may reject binaries after an update that kept the same version string.
+    deleteFile(path);
+    return false;
+}
+
+static void storeProgramBinary(GraphicsContext3D& context, Platform3DObject program, const String& path)
+{
+    GC3Dint linkStatus = 0;
+    context.getProgramiv(program, GraphicsContext3D::LINK_STATUS, &linkStatus);
+    GC3Dint length = 0;
+    if (linkStatus)
+        context.getProgramiv(program, Extensions3D::PROGRAM_BINARY_LENGTH_OES, &length);
+    if (length <= 0 || length > maximumProgramBinaryLength)
+        return;
+
+    Vector<char> binary(length);
+    GC3Dsizei binaryLength = 0;
+    GC3Denum binaryFormat = 0;
+    context.getExtensions()->getProgramBinaryOES(program, length, &binaryLength, &binaryFormat, binary.data());
+    if (binaryLength <= 0 || !makeAllDirectories(directoryName(path)))
+        return;
+
+    // Write to a temporary file first, so that concurrent processes never read a partial entry. Each
+    // writer needs its own: processes and compositing threads may store the same program at once, and
+    // interleaved writes to a shared file could then be renamed into place.
+    String temporaryPath = makeString(path, '.', String::number(getCurrentProcessID()), '-', String::number(cryptographicallyRandomNumber()), ".tmp");
+    PlatformFileHandle file = openFile(temporaryPath, OpenForWrite);
+    if (!isHandleValid(file))
+        return;
+
+    ProgramBinaryHeader header = { programBinaryMagic, binaryFormat, static_cast<uint32_t>(binaryLength) };
+    bool success = writeToFile(file, reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header)
+        && writeToFile(file, binary.data(), binaryLength) == binaryLength;
+    closeFile(file);
+
+    if (!success || !moveFile(temporaryPath, path))
+        deleteFile(temporaryPath);
+}
+
 TextureMapperShaderProgram::TextureMapperShaderProgram(PassRefPtr<GraphicsContext3D> context, const String& vertex, const String& fragment)
-    : m_context(context)
+    : m_vertexShader(0)
+    , m_fragmentShader(0)
+    , m_context(context)
 {
+    m_id = m_context->createProgram();
+
+    String binaryPath = programBinaryCachePath(*m_context, vertex, fragment);
+    if (!binaryPath.isNull() && loadProgramBinary(*m_context, m_id, binaryPath))
+        return;
+
     m_vertexShader = m_context->createShader(GraphicsContext3D::VERTEX_SHADER);
     m_fragmentShader = m_context->createShader(GraphicsContext3D::FRAGMENT_SHADER);
     m_context->shaderSource(m_vertexShader, vertex);
     m_context->shaderSource(m_fragmentShader, fragment);
-    m_id = m_context->createProgram();
     m_context->compileShader(m_vertexShader);
     m_context->compileShader(m_fragmentShader);
     m_context->attachShader(m_id, m_vertexShader);
     m_context->attachShader(m_id, m_fragmentShader);
     m_context->linkProgram(m_id);
 
+    if (!binaryPath.isNull())
+        storeProgramBinary(*m_context, m_id, binaryPath);
+
     if (!compositingLogEnabled())
         return;
 
@@ -107,10 +245,13 @@ TextureMapperShaderProgram::~TextureMapperShaderProgram()
     if (!programID)
         return;
 
-    m_context->detachShader(programID, m_vertexShader);
-    m_context->deleteShader(m_vertexShader);
-    m_context->detachShader(programID, m_fragmentShader);
-    m_context->deleteShader(m_fragmentShader);
+    // Programs loaded from a binary have no shader objects attached.
+    if (m_vertexShader) {
+        m_context->detachShader(programID, m_vertexShader);
+        m_context->deleteShader(m_vertexShader);
+        m_context->detachShader(programID, m_fragmentShader);
+        m_context->deleteShader(m_fragmentShader);
+    }
     m_context->deleteProgram(programID);
 }
 
@@ -128,6 +269,7 @@ static const char* vertexTemplate =
     STRINGIFY(
         precision TextureSpaceMatrixPrecision float;
         attribute vec4 a_vertex;
+        attribute vec4 a_vertexColor;
         uniform mat4 u_modelViewMatrix;
         uniform mat4 u_projectionMatrix;
         uniform mat4 u_textureSpaceMatrix;
@@ -135,6 +277,7 @@ static const char* vertexTemplate =
         varying vec2 v_texCoord;
         varying vec2 v_transformedTexCoord;
         varying float v_antialias;
+        varying vec4 v_color;
 
         void noop(inout vec2 dummyParameter) { }
 
@@ -173,7 +316,21 @@ static const char* vertexTemplate =
             // we ensure that the center vertex is never inflated.
             position = center + (position - center) * inflationRatio;
         }
-
+    )
+    "\n" GLSL_DIRECTIVE(ifdef ENABLE_Batched)
+    STRINGIFY(
+        // Batched quads are transformed on the CPU: a_vertex holds the position in viewport space
+        // in xy and the transformed texture coordinate in zw.
+        void main(void)
+        {
+            v_texCoord = a_vertex.zw;
+            v_transformedTexCoord = a_vertex.zw;
+            v_color = a_vertexColor;
+            gl_Position = u_projectionMatrix * vec4(a_vertex.xy, 0., 1.);
+        }
+    )
+    "\n" GLSL_DIRECTIVE(else)
+    STRINGIFY(
         void main(void)
         {
             vec2 position = a_vertex.xy;
@@ -184,7 +341,8 @@ static const char* vertexTemplate =
             v_transformedTexCoord = (u_textureSpaceMatrix * clampedPosition).xy;
             gl_Position = u_projectionMatrix * u_modelViewMatrix * vec4(position, 0., 1.);
         }
-    );
+    )
+    "\n" GLSL_DIRECTIVE(endif);
 
 #define RECT_TEXTURE_DIRECTIVE \
     GLSL_DIRECTIVE(ifdef ENABLE_Rect) \
@@ -220,10 +378,14 @@ static const char* fragmentTemplate =
         precision mediump float;
         uniform SamplerType s_sampler;
         uniform sampler2D s_contentTexture;
+        uniform sampler2D s_yPlane;
+        uniform sampler2D s_cbPlane;
+        uniform sampler2D s_crPlane;
         uniform float u_opacity;
         varying float v_antialias;
         varying vec2 v_texCoord;
         varying vec2 v_transformedTexCoord;
+        varying vec4 v_color;
         uniform float u_filterAmount;
         uniform vec2 u_blurRadius;
         uniform vec2 u_shadowOffset;
@@ -348,14 +510,26 @@ static const char* fragmentTemplate =
             color = sourceOver(contentColor, color);
         }
 
+        // Full range BT.601, as used by JFIF.
+        void applyYCbCrTexture(inout vec4 color, vec2 texCoord)
+        {
+            float y = texture2D(s_yPlane, texCoord).r;
+            float cb = texture2D(s_cbPlane, texCoord).r - 0.5;
+            float cr = texture2D(s_crPlane, texCoord).r - 0.5;
+            color = vec4(y + 1.402 * cr, y - 0.344136 * cb - 0.714136 * cr, y + 1.772 * cb, 1.);
+        }
+
         void applySolidColor(inout vec4 color) { color *= u_color; }
+        void applyBatched(inout vec4 color) { color *= v_color; }
 
         void main(void)
         {
             vec4 color = vec4(1., 1., 1., 1.);
             vec2 texCoord = transformTexCoord();
             applyTextureIfNeeded(color, texCoord);
+            applyYCbCrTextureIfNeeded(color, texCoord);
             applySolidColorIfNeeded(color);
+            applyBatchedIfNeeded(color);
             applyAntialiasingIfNeeded(color);
             applyOpacityIfNeeded(color);
             applyGrayscaleFilterIfNeeded(color);
@@ -396,6 +570,8 @@ PassRefPtr<TextureMapperShaderProgram> TextureMapperShaderProgram::create(PassRe
     SET_APPLIER_FROM_OPTIONS(BlurFilter);
     SET_APPLIER_FROM_OPTIONS(AlphaBlur);
     SET_APPLIER_FROM_OPTIONS(ContentTexture);
+    SET_APPLIER_FROM_OPTIONS(Batched);
+    SET_APPLIER_FROM_OPTIONS(YCbCrTexture);
     StringBuilder vertexBuilder;
     vertexBuilder.append(shaderBuilder.toString());
     vertexBuilder.append(vertexTemplate);
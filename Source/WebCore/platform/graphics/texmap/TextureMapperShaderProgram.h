@@ -53,7 +53,9 @@ public:
         OpacityFilter    = 1L << 13,
         BlurFilter       = 1L << 14,
         AlphaBlur        = 1L << 15,
-        ContentTexture   = 1L << 16
+        ContentTexture   = 1L << 16,
+        Batched          = 1L << 17,
+        YCbCrTexture     = 1L << 18
     };
 
     typedef unsigned Options;
@@ -64,6 +66,7 @@ public:
     GraphicsContext3D* context() { return m_context.get(); }
 
     TEXMAP_DECLARE_ATTRIBUTE(vertex)
+    TEXMAP_DECLARE_ATTRIBUTE(vertexColor)
 
     TEXMAP_DECLARE_UNIFORM(modelViewMatrix)
     TEXMAP_DECLARE_UNIFORM(projectionMatrix)
@@ -79,6 +82,9 @@ public:
     TEXMAP_DECLARE_UNIFORM(blurRadius)
     TEXMAP_DECLARE_UNIFORM(shadowOffset)
     TEXMAP_DECLARE_SAMPLER(contentTexture)
+    TEXMAP_DECLARE_SAMPLER(yPlane)
+    TEXMAP_DECLARE_SAMPLER(cbPlane)
+    TEXMAP_DECLARE_SAMPLER(crPlane)
 
     void setMatrix(GC3Duint, const TransformationMatrix&);
 
@@ -71,8 +71,15 @@ void TextureMapperTile::updateContents(TextureMapper* textureMapper, GraphicsLay
 
 void TextureMapperTile::paint(TextureMapper* textureMapper, const TransformationMatrix& transform, float opacity, const unsigned exposedEdges)
 {
-    if (texture().get())
-        textureMapper->drawTexture(*texture().get(), rect(), transform, opacity, exposedEdges);
+    if (!texture().get())
+        return;
+
+    if (textureMapper->isOccluded(rect(), transform)) {
+        ++textureMapper->occlusionStats().culledTiles;
+        return;
+    }
+
+    textureMapper->drawTexture(*texture().get(), rect(), transform, opacity, exposedEdges);
 }
 
 } // namespace WebCore
@@ -134,6 +134,7 @@ CoordinatedGraphicsLayer::CoordinatedGraphicsLayer(Type layerType, GraphicsLayer
 #endif
     , m_coordinator(0)
     , m_compositedNativeImagePtr(0)
+    , m_compositedImageIsYUV(false)
     , m_platformLayer(0)
     , m_animationStartedTimer(*this, &CoordinatedGraphicsLayer::animationStartedTimerFired)
     , m_scrollableArea(0)
@@ -480,12 +481,14 @@ void CoordinatedGraphicsLayer::setShowRepaintCounter(bool show)
 
 void CoordinatedGraphicsLayer::setContentsToImage(Image* image)
 {
-    NativeImagePtr nativeImagePtr = image ? image->nativeImageForCurrentFrame() : nullptr;
-    if (m_compositedImage == image && m_compositedNativeImagePtr == nativeImagePtr)
+    bool isYUVImage = image && CoordinatedImageBacking::shouldUploadAsYUV(*image);
+    NativeImagePtr nativeImagePtr = image && !isYUVImage ? image->nativeImageForCurrentFrame() : nullptr;
+    if (m_compositedImage == image && m_compositedNativeImagePtr == nativeImagePtr && m_compositedImageIsYUV == isYUVImage)
         return;
 
     m_compositedImage = image;
     m_compositedNativeImagePtr = nativeImagePtr;
+    m_compositedImageIsYUV = isYUVImage;
 
     GraphicsLayer::setContentsToImage(image);
     didChangeImageBacking();
@@ -634,7 +637,7 @@ void CoordinatedGraphicsLayer::syncImageBacking()
         return;
     m_shouldSyncImageBacking = false;
 
-    if (m_compositedNativeImagePtr) {
+    if (m_compositedNativeImagePtr || m_compositedImageIsYUV) {
         ASSERT(!shouldHaveBackingStore());
         ASSERT(m_compositedImage);
 
@@ -28,8 +28,10 @@
 #if USE(COORDINATED_GRAPHICS)
 #include "CoordinatedImageBacking.h"
 
+#include "BitmapImage.h"
 #include "CoordinatedGraphicsState.h"
 #include "GraphicsContext.h"
+#include "YUVImage.h"
 
 namespace WebCore {
 
@@ -114,12 +116,22 @@ void CoordinatedImageBacking::update()
         if (!m_isDirty)
             return;
 
-        if (m_nativeImagePtr == m_image->nativeImageForCurrentFrame()) {
+        // m_nativeImagePtr is null for contents uploaded from YCbCr planes.
+        NativeImagePtr nativeImagePtr = shouldUploadAsYUV(*m_image) ? nullptr : m_image->nativeImageForCurrentFrame();
+        if (m_nativeImagePtr == nativeImagePtr) {
             m_isDirty = false;
             return;
         }
     }
 
+    m_surface = createYUVSurfaceIfPossible();
+    if (m_surface) {
+        m_nativeImagePtr = nullptr;
+        m_client->updateImageBacking(id(), m_surface);
+        m_isDirty = false;
+        return;
+    }
+
     m_surface = CoordinatedSurface::create(IntSize(m_image->size()), !m_image->currentFrameKnownToBeOpaque() ? CoordinatedSurface::SupportsAlpha : CoordinatedSurface::NoFlags);
     if (!m_surface) {
         m_isDirty = false;
@@ -137,6 +149,33 @@ void CoordinatedImageBacking::update()
     m_isDirty = false;
 }
 
+// Below this area, decoding to RGB on the CPU is cheap enough that it isn't worth the extra uploads.
+static const int minimumYUVImageArea = 256 * 256;
+
+bool CoordinatedImageBacking::shouldUploadAsYUV(Image& image)
+{
+    if (!CoordinatedSurface::supportsYUVImages() || !is<BitmapImage>(image))
+        return false;
+
+    IntSize size(image.size());
+    if (size.area() < minimumYUVImageArea)
+        return false;
+
+    return downcast<BitmapImage>(image).canCreateYUVImage();
+}
+
+PassRefPtr<CoordinatedSurface> CoordinatedImageBacking::createYUVSurfaceIfPossible()
+{
+    if (!shouldUploadAsYUV(*m_image))
+        return nullptr;
+
+    RefPtr<YUVImage> yuvImage = downcast<BitmapImage>(*m_image).createYUVImage();
+    if (!yuvImage)
+        return nullptr;
+
+    return CoordinatedSurface::create(yuvImage.release());
+}
+
 void CoordinatedImageBacking::releaseSurfaceIfNeeded()
 {
     // We must keep m_surface until UI Process reads m_surface.
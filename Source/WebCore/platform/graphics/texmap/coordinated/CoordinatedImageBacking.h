@@ -58,6 +58,11 @@ public:
     static CoordinatedImageBackingID getCoordinatedImageBackingID(Image*);
     CoordinatedImageBackingID id() const { return m_id; }
 
+    // Whether the image is uploaded from its YCbCr planes. Such an image must not be asked for
+    // its native image to tell whether it changed, as that decodes it to RGB; being complete and
+    // single framed, it can't change anyway.
+    static bool shouldUploadAsYUV(Image&);
+
     void addHost(Host*);
     void removeHost(Host*);
 
@@ -70,6 +75,7 @@ public:
 private:
     CoordinatedImageBacking(Client*, PassRefPtr<Image>);
 
+    PassRefPtr<CoordinatedSurface> createYUVSurfaceIfPossible();
     void releaseSurfaceIfNeeded();
     void updateVisibilityIfNeeded(bool& changedToVisible);
     void clearContentsTimerFired();
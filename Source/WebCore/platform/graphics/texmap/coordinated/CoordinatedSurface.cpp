@@ -28,9 +28,12 @@
 
 #if USE(COORDINATED_GRAPHICS)
 
+#include "YUVImage.h"
+
 namespace WebCore {
 
 CoordinatedSurface::Factory* CoordinatedSurface::s_factory = 0;
+CoordinatedSurface::YUVFactory* CoordinatedSurface::s_yuvFactory = 0;
 
 void CoordinatedSurface::setFactory(CoordinatedSurface::Factory factory)
 {
@@ -43,6 +46,18 @@ PassRefPtr<CoordinatedSurface> CoordinatedSurface::create(const IntSize& size, F
     return s_factory(size, flags);
 }
 
+void CoordinatedSurface::setYUVFactory(CoordinatedSurface::YUVFactory factory)
+{
+    s_yuvFactory = factory;
+}
+
+PassRefPtr<CoordinatedSurface> CoordinatedSurface::create(PassRefPtr<YUVImage> image)
+{
+    if (!s_yuvFactory)
+        return nullptr;
+    return s_yuvFactory(image);
+}
+
 CoordinatedSurface::CoordinatedSurface(const IntSize& size, Flags flags)
     : m_size(size)
     , m_flags(flags)
@@ -29,6 +29,7 @@
 namespace WebCore {
 class BitmapTexture;
 class GraphicsContext;
+class YUVImage;
 
 class CoordinatedSurface : public ThreadSafeRefCounted<CoordinatedSurface> {
 public:
@@ -48,6 +49,13 @@ public:
     static void setFactory(Factory);
     static PassRefPtr<CoordinatedSurface> create(const IntSize&, Flags);
 
+    // Surfaces holding undecoded YCbCr planes, converted to RGB when copied to a texture.
+    // Only available where the surface never has to be sent to another process.
+    typedef PassRefPtr<CoordinatedSurface> YUVFactory(PassRefPtr<YUVImage>);
+    static void setYUVFactory(YUVFactory);
+    static bool supportsYUVImages() { return s_yuvFactory; }
+    static PassRefPtr<CoordinatedSurface> create(PassRefPtr<YUVImage>);
+
     virtual ~CoordinatedSurface() { }
 
     bool supportsAlpha() const { return flags() & SupportsAlpha; }
@@ -68,6 +76,7 @@ protected:
 
 private:
     static CoordinatedSurface::Factory* s_factory;
+    static CoordinatedSurface::YUVFactory* s_yuvFactory;
 };
 
 } // namespace WebCore
@@ -27,10 +27,15 @@
 #include "Tile.h"
 
 #if USE(COORDINATED_GRAPHICS)
+#include "DisplayList.h"
+#include "DisplayListRecorder.h"
+#include "DisplayListReplayer.h"
 #include "GraphicsContext.h"
+#include "ImageBuffer.h"
 #include "SurfaceUpdateInfo.h"
 #include "TiledBackingStore.h"
 #include "TiledBackingStoreClient.h"
+#include <wtf/MainThread.h>
 
 namespace WebCore {
 
@@ -93,7 +98,69 @@ bool Tile::updateBackBuffer()
     return true;
 }
 
+bool Tile::recordBackBuffer()
+{
+    ASSERT(isMainThread());
+    if (!isDirty())
+        return false;
+
+    m_displayList = std::make_unique<DisplayList::DisplayList>();
+    {
+        GraphicsContext recordingContext(static_cast<PlatformGraphicsContext*>(nullptr));
+        DisplayList::Recorder recorder(recordingContext, *m_displayList, FloatRect(FloatPoint(), m_dirtyRect.size()));
+        paintDirtyRect(recordingContext);
+    }
+
+    // Native theme parts can't be recorded, so the tile is painted directly when it is committed.
+    if (!m_displayList->isReplayable()) {
+        m_displayList = nullptr;
+        return false;
+    }
+
+    if (!m_displayList->canReplayOnWorkerThread())
+        return false;
+
+    // The scratch buffer is allocated here so that worker threads only rasterize.
+    m_rasterBuffer = ImageBuffer::create(m_dirtyRect.size(), Unaccelerated);
+    return !!m_rasterBuffer;
+}
+
+void Tile::rasterizeBackBuffer()
+{
+    ASSERT(m_displayList);
+    ASSERT(m_rasterBuffer);
+
+    DisplayList::Replayer replayer(m_rasterBuffer->context(), *m_displayList);
+    replayer.replay();
+}
+
+bool Tile::commitBackBuffer()
+{
+    ASSERT(isMainThread());
+    bool updated = updateBackBuffer();
+
+    m_displayList = nullptr;
+    m_rasterBuffer = nullptr;
+    return updated;
+}
+
 void Tile::paintToSurfaceContext(GraphicsContext& context)
+{
+    if (m_rasterBuffer) {
+        context.drawImageBuffer(*m_rasterBuffer, FloatPoint());
+        return;
+    }
+
+    if (m_displayList) {
+        DisplayList::Replayer replayer(context, *m_displayList);
+        replayer.replay();
+        return;
+    }
+
+    paintDirtyRect(context);
+}
+
+void Tile::paintDirtyRect(GraphicsContext& context)
 {
     context.translate(-m_dirtyRect.x(), -m_dirtyRect.y());
     context.scale(FloatSize(m_tiledBackingStore.contentsScale(), m_tiledBackingStore.contentsScale()));
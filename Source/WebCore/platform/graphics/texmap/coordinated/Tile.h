@@ -36,8 +36,13 @@
 namespace WebCore {
 
 class GraphicsContext;
+class ImageBuffer;
 class TiledBackingStore;
 
+namespace DisplayList {
+class DisplayList;
+}
+
 class Tile : public CoordinatedSurface::Client {
 public:
     typedef IntPoint Coordinate;
@@ -50,6 +55,14 @@ public:
     bool updateBackBuffer();
     bool isReadyToPaint() const;
 
+    // Split version of updateBackBuffer() for threaded rasterization. recordBackBuffer() records
+    // the dirty contents on the main thread and returns true if they can be rasterized by
+    // rasterizeBackBuffer() on a worker thread. commitBackBuffer() then copies the result to the
+    // update atlas on the main thread, replaying the recording there if it was not rasterized.
+    bool recordBackBuffer();
+    void rasterizeBackBuffer();
+    bool commitBackBuffer();
+
     const Coordinate& coordinate() const { return m_coordinate; }
     const IntRect& rect() const { return m_rect; }
     void resize(const IntSize&);
@@ -57,12 +70,17 @@ public:
     virtual void paintToSurfaceContext(GraphicsContext&) override;
 
 private:
+    void paintDirtyRect(GraphicsContext&);
+
     TiledBackingStore& m_tiledBackingStore;
     Coordinate m_coordinate;
     IntRect m_rect;
 
     uint32_t m_ID;
     IntRect m_dirtyRect;
+
+    std::unique_ptr<DisplayList::DisplayList> m_displayList;
+    std::unique_ptr<ImageBuffer> m_rasterBuffer;
 };
 
 } // namespace WebCore
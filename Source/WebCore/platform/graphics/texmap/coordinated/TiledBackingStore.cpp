@@ -24,6 +24,7 @@
 #include "GraphicsContext.h"
 #include "TiledBackingStoreClient.h"
 #include <wtf/CheckedArithmetic.h>
+#include <wtf/TaskScheduler.h>
 
 namespace WebCore {
 
@@ -90,15 +91,31 @@ void TiledBackingStore::invalidate(const IntRect& contentsDirtyRect)
 
 void TiledBackingStore::updateTileBuffers()
 {
-    // FIXME: In single threaded case, tile back buffers could be updated asynchronously 
-    // one by one and then swapped to front in one go. This would minimize the time spent
-    // blocking on tile updates.
-    bool updated = false;
+    Vector<Tile*> dirtyTiles;
     for (auto& tile : m_tiles.values()) {
-        if (!tile->isDirty())
-            continue;
+        if (tile->isDirty())
+            dirtyTiles.append(tile.get());
+    }
+
+    if (dirtyTiles.isEmpty())
+        return;
+
+    bool updated = false;
+    if (dirtyTiles.size() == 1 || !TaskScheduler::singleton().numberOfWorkers()) {
+        for (auto* tile : dirtyTiles)
+            updated |= tile->updateBackBuffer();
+    } else {
+        // Record every dirty tile first, so that the raster workers can start while the
+        // main thread keeps recording, then commit the results in tile order.
+        TaskGroup rasterTasks(TaskScheduler::Priority::High);
+        for (auto* tile : dirtyTiles) {
+            if (tile->recordBackBuffer())
+                rasterTasks.dispatch([tile] { tile->rasterizeBackBuffer(); });
+        }
+        rasterTasks.wait();
 
-        updated |= tile->updateBackBuffer();
+        for (auto* tile : dirtyTiles)
+            updated |= tile->commitBackBuffer();
     }
 
     if (updated)
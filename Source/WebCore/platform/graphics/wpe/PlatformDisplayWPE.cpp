@@ -70,18 +70,33 @@ std::unique_ptr<GLContextEGL> PlatformDisplayWPE::createOffscreenContext(GLConte
 }
 
 PlatformDisplayWPE::Surface::Surface(const PlatformDisplayWPE& display, const IntSize& size, uint32_t targetHandle, Client& client)
+    : m_size(size)
 {
     m_backend = display.m_backend->createSurface(std::max(0, size.width()), std::max(0, size.height()), targetHandle, client);
 }
 
 void PlatformDisplayWPE::Surface::resize(const IntSize& size)
 {
+    m_size = size;
     m_backend->resize(std::max(0, size.width()), std::max(0, size.height()));
 }
 
 std::unique_ptr<GLContextEGL> PlatformDisplayWPE::Surface::createGLContext() const
 {
-    return GLContextEGL::createWindowContext(m_backend->nativeWindow(), GLContext::sharingContext());
+    // Backends without native windows, like the headless one, render into a pbuffer of the surface size.
+    if (EGLNativeWindowType window = m_backend->nativeWindow())
+        return GLContextEGL::createWindowContext(window, GLContext::sharingContext());
+    return GLContextEGL::createPbufferContext(m_size, GLContext::sharingContext());
+}
+
+void PlatformDisplayWPE::Surface::beginFrame()
+{
+    m_backend->beginFrame();
+}
+
+void PlatformDisplayWPE::Surface::reportPaintTime(double paintTime)
+{
+    m_backend->reportPaintTime(static_cast<uint32_t>(paintTime * 1000000));
 }
 
 PlatformDisplayWPE::BufferExport PlatformDisplayWPE::Surface::lockFrontBuffer()
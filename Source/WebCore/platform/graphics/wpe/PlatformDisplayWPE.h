@@ -33,13 +33,13 @@
 #endif
 
 #include <WPE/Graphics/RenderingBackend.h>
+#include "IntSize.h"
 #include "PlatformDisplay.h"
 
 namespace WebCore {
 
 class GLContext;
 class GLContextEGL;
-class IntSize;
 
 class PlatformDisplayWPE final : public PlatformDisplay {
 public:
@@ -57,11 +57,14 @@ public:
         void resize(const IntSize&);
         std::unique_ptr<GLContextEGL> createGLContext() const;
 
+        void beginFrame();
+        void reportPaintTime(double);
         BufferExport lockFrontBuffer();
         void releaseBuffer(uint32_t);
 
     private:
         std::unique_ptr<WPE::Graphics::RenderingBackend::Surface> m_backend;
+        IntSize m_size;
     };
 
     std::unique_ptr<Surface> createSurface(const IntSize&, uint32_t, Surface::Client&);
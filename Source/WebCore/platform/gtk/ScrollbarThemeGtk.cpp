@@ -400,6 +400,12 @@ bool ScrollbarThemeGtk::paint(Scrollbar& scrollbar, GraphicsContext& graphicsCon
     if (graphicsContext.paintingDisabled())
         return false;
 
+    // GTK+ renders into the Cairo context directly, which a recording context doesn't have.
+    if (graphicsContext.isRecording()) {
+        graphicsContext.markRecordingAsNotReplayable();
+        return true;
+    }
+
     // Create the ScrollbarControlPartMask based on the damageRect
     ScrollbarControlPartMask scrollMask = NoPart;
 
@@ -127,7 +127,8 @@ ImageDecoder* ImageDecoder::create(const SharedBuffer& data, ImageSource::AlphaO
 }
 
 ImageFrame::ImageFrame()
-    : m_hasAlpha(false)
+    : m_bytes(0)
+    , m_hasAlpha(false)
     , m_status(FrameEmpty)
     , m_duration(0)
     , m_disposalMethod(DisposeNotSpecified)
@@ -197,7 +198,8 @@ bool ImageFrame::copyBitmapData(const ImageFrame& other)
 
 bool ImageFrame::setSize(int newWidth, int newHeight)
 {
-    ASSERT(!width() && !height());
+    // clearPixelData() keeps the size, which the frame is decoded again at.
+    ASSERT(!m_bytes);
     size_t backingStoreSize = newWidth * newHeight;
     if (!m_backingStore.tryReserveCapacity(backingStoreSize))
         return false;
@@ -284,23 +286,30 @@ unsigned ImageDecoder::frameBytesAtIndex(size_t index) const
     if (m_frameBufferCache.size() <= index)
         return 0;
     // FIXME: Use the dimension of the requested frame.
-    return m_size.area() * sizeof(ImageFrame::PixelData);
+    return scaledSize().area() * sizeof(ImageFrame::PixelData);
 }
 
 void ImageDecoder::prepareScaleDataIfNecessary()
+{
+    prepareScaleDataIfNecessary(size(), m_subsamplingLevel);
+}
+
+void ImageDecoder::prepareScaleDataIfNecessary(const IntSize& sourceSize, SubsamplingLevel level)
 {
     m_scaled = false;
     m_scaledColumns.clear();
     m_scaledRows.clear();
 
-    int width = size().width();
-    int height = size().height();
+    int width = sourceSize.width();
+    int height = sourceSize.height();
     int numPixels = height * width;
-    if (m_maxNumPixels <= 0 || numPixels <= m_maxNumPixels)
+    double scale = 1. / (1 << level);
+    if (m_maxNumPixels > 0 && numPixels * scale * scale > m_maxNumPixels)
+        scale = sqrt(m_maxNumPixels / (double)numPixels);
+    if (scale >= 1)
         return;
 
     m_scaled = true;
-    double scale = sqrt(m_maxNumPixels / (double)numPixels);
     fillScaledValues(m_scaledColumns, scale, width);
     fillScaledValues(m_scaledRows, scale, height);
 }
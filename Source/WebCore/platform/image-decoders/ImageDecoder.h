@@ -33,6 +33,7 @@
 #include "ImageSource.h"
 #include "PlatformScreen.h"
 #include "SharedBuffer.h"
+#include "YUVImage.h"
 #include <wtf/Assertions.h>
 #include <wtf/RefPtr.h>
 #include <wtf/Vector.h>
@@ -100,8 +101,9 @@ namespace WebCore {
         }
 
         // Allocates space for the pixel data.  Must be called before any pixels
-        // are written.  Must only be called once.  Returns whether allocation
-        // succeeded.
+        // are written.  Must only be called once, or again after
+        // clearPixelData() when the frame is decoded again.  Returns whether
+        // allocation succeeded.
         bool setSize(int newWidth, int newHeight);
 
         // Returns a caller-owned pointer to the underlying native image data.
@@ -249,6 +251,7 @@ namespace WebCore {
             , m_ignoreGammaAndColorProfile(gammaAndColorProfileOption == ImageSource::GammaAndColorProfileIgnored)
             , m_sizeAvailable(false)
             , m_maxNumPixels(-1)
+            , m_subsamplingLevel(0)
             , m_isAllDataReceived(false)
             , m_failed(false) { }
 
@@ -262,6 +265,7 @@ namespace WebCore {
         virtual String filenameExtension() const = 0;
 
         bool isAllDataReceived() const { return m_isAllDataReceived; }
+        SharedBuffer* data() const { return m_data.get(); }
 
         virtual void setData(SharedBuffer* data, bool allDataReceived)
         {
@@ -283,9 +287,30 @@ namespace WebCore {
 
         IntSize scaledSize() const
         {
-            return m_scaled ? IntSize(m_scaledColumns.size(), m_scaledRows.size()) : size();
+            return m_scaled ? IntSize(m_scaledColumns.size(), m_scaledRows.size()) : subsampledSize(size(), m_subsamplingLevel);
         }
 
+        // Decoders that support subsampling produce frames that are 1 / 2^level
+        // of the image size on each axis (rounded up), without ever holding
+        // the full-size frame. The level must be set before decoding starts.
+        virtual bool supportsSubsampling() const { return false; }
+        void setSubsamplingLevel(SubsamplingLevel level) { m_subsamplingLevel = supportsSubsampling() ? level : 0; }
+        // Whether subsampled frames take much less work to decode than full-size ones, rather than
+        // being decoded at full size and then sampled.
+        virtual bool decodesSubsampledFramesCheaply() const { return false; }
+        SubsamplingLevel subsamplingLevel() const { return m_subsamplingLevel; }
+
+        static IntSize subsampledSize(const IntSize& size, SubsamplingLevel level)
+        {
+            int scale = 1 << level;
+            return IntSize((size.width() + scale - 1) / scale, (size.height() + scale - 1) / scale);
+        }
+
+        // Decodes the complete image into its planar YCbCr samples, without
+        // converting them to RGB, for decoders and images that allow it.
+        // Returns null otherwise. This does not affect the frame buffers.
+        virtual PassRefPtr<YUVImage> createYUVImage() { return nullptr; }
+
         // This will only differ from size() for ICO (where each frame is a
         // different icon) or other formats where different frames are different
         // sizes.  This does NOT differ from size() for GIF, since decoding GIFs
@@ -404,7 +429,11 @@ namespace WebCore {
         virtual bool hotSpot(IntPoint&) const { return false; }
 
     protected:
+        // Sets up m_scaledColumns and m_scaledRows so that decoders can sample
+        // rows and columns of the source: by the subsampling level, and further
+        // if the result is still larger than |m_maxNumPixels|.
         void prepareScaleDataIfNecessary();
+        void prepareScaleDataIfNecessary(const IntSize& sourceSize, SubsamplingLevel);
         int upperBoundScaledX(int origX, int searchStart = 0);
         int lowerBoundScaledX(int origX, int searchStart = 0);
         int upperBoundScaledY(int origY, int searchStart = 0);
@@ -435,6 +464,7 @@ namespace WebCore {
         IntSize m_size;
         bool m_sizeAvailable;
         int m_maxNumPixels;
+        SubsamplingLevel m_subsamplingLevel;
         bool m_isAllDataReceived;
         bool m_failed;
     };
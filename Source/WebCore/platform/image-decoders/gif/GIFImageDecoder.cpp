@@ -27,6 +27,7 @@
 #include "GIFImageDecoder.h"
 
 #include "GIFImageReader.h"
+#include "PixelRowConversion.h"
 #include <limits>
 
 namespace WebCore {
@@ -35,6 +36,7 @@ GIFImageDecoder::GIFImageDecoder(ImageSource::AlphaOption alphaOption,
                                  ImageSource::GammaAndColorProfileOption gammaAndColorProfileOption)
     : ImageDecoder(alphaOption, gammaAndColorProfileOption)
     , m_repetitionCount(cAnimationLoopOnce)
+    , m_paletteFrameIndex(notFound)
 {
 }
 
@@ -212,26 +214,32 @@ bool GIFImageDecoder::haveDecodedRow(unsigned frameIndex, const Vector<unsigned
     if (((buffer.status() == ImageFrame::FrameEmpty) && !initFrameBuffer(frameIndex)) || !buffer.hasPixelData())
         return false;
 
+    if (frameIndex != m_paletteFrameIndex)
+        updatePalette(frameIndex, colorMap, colorMapSize);
+
+    // We may or may not need to write transparent pixels to the buffer.
+    // If we're compositing against a previous image, it's wrong, and if
+    // we're writing atop a cleared, fully transparent buffer, it's
+    // unnecessary; but if we're decoding an interlaced gif and
+    // displaying it "Haeberli"-style, we must write these for passes
+    // beyond the first, or the initial passes will "show through" the
+    // later ones.
     ImageFrame::PixelData* currentAddress = buffer.getAddr(xBegin, yBegin);
-    // Write one row's worth of data into the frame.  
-    for (int x = xBegin; x < xEnd; ++x) {
-        const unsigned char sourceValue = rowBuffer[(m_scaled ? m_scaledColumns[x] : x) - frameContext->xOffset];
-        if ((!frameContext->isTransparent || (sourceValue != frameContext->tpixel)) && (sourceValue < colorMapSize)) {
-            const size_t colorIndex = static_cast<size_t>(sourceValue) * 3;
-            buffer.setRGBA(currentAddress, colorMap[colorIndex], colorMap[colorIndex + 1], colorMap[colorIndex + 2], 255);
-        } else {
+    if (!m_scaled) {
+        // Write one row's worth of data into the frame.
+        if (PixelRowConversion::expandPalette(rowBuffer.data() + xBegin - frameContext->xOffset, m_palette.data(), currentAddress, xEnd - xBegin, writeTransparentPixels))
             m_currentBufferSawAlpha = true;
-            // We may or may not need to write transparent pixels to the buffer.
-            // If we're compositing against a previous image, it's wrong, and if
-            // we're writing atop a cleared, fully transparent buffer, it's
-            // unnecessary; but if we're decoding an interlaced gif and
-            // displaying it "Haeberli"-style, we must write these for passes
-            // beyond the first, or the initial passes will "show through" the
-            // later ones.
-            if (writeTransparentPixels)
-                buffer.setRGBA(currentAddress, 0, 0, 0, 0);
+    } else {
+        for (int x = xBegin; x < xEnd; ++x) {
+            if (ImageFrame::PixelData color = m_palette[rowBuffer[m_scaledColumns[x] - frameContext->xOffset]])
+                *currentAddress = color;
+            else {
+                m_currentBufferSawAlpha = true;
+                if (writeTransparentPixels)
+                    *currentAddress = 0;
+            }
+            ++currentAddress;
         }
-        ++currentAddress;
     }
 
     // Tell the frame to copy the row data if need be.
@@ -241,6 +249,21 @@ bool GIFImageDecoder::haveDecodedRow(unsigned frameIndex, const Vector<unsigned
     return true;
 }
 
+void GIFImageDecoder::updatePalette(unsigned frameIndex, const unsigned char* colorMap, unsigned colorMapSize)
+{
+    // A frame's colormap never changes, so the palette is only rebuilt when
+    // rows of another frame come in.
+    const GIFFrameContext* frameContext = m_reader->frameContext();
+    m_palette.fill(0, 256);
+    for (unsigned index = 0; index < std::min(colorMapSize, 256u); ++index) {
+        if (frameContext->isTransparent && index == static_cast<unsigned>(frameContext->tpixel))
+            continue;
+        const unsigned char* color = colorMap + index * 3;
+        m_palette[index] = 0xFF000000U | color[0] << 16 | color[1] << 8 | color[2];
+    }
+    m_paletteFrameIndex = frameIndex;
+}
+
 bool GIFImageDecoder::frameComplete(unsigned frameIndex, unsigned frameDuration, ImageFrame::FrameDisposalMethod disposalMethod)
 {
     // Initialize the frame if necessary.  Some GIFs insert do-nothing frames,
@@ -325,6 +348,15 @@ void GIFImageDecoder::decode(unsigned haltAtFrame, GIFQuery query)
     if (query == GIFFrameCountQuery)
         return;
 
+    // The frames up to the requested one may have been decoded before and cleared since, in which
+    // case the reader has moved past them (or has been recreated, and is at the first frame).
+    size_t lastFrame = std::min<size_t>(haltAtFrame, m_frameBufferCache.size());
+    if (lastFrame && m_frameBufferCache[lastFrame - 1].status() == ImageFrame::FrameEmpty) {
+        size_t startingFrame = findStartingFrameIndex(lastFrame - 1);
+        if (startingFrame != m_reader->currentDecodingFrame() && startingFrame < m_reader->imagesCount())
+            m_reader->setCurrentDecodingFrame(startingFrame);
+    }
+
     if (!m_reader->decode(GIFFullQuery, haltAtFrame)) {
         setFailed();
         return;
@@ -336,6 +368,34 @@ void GIFImageDecoder::decode(unsigned haltAtFrame, GIFQuery query)
         setFailed();
 }
 
+size_t GIFImageDecoder::requiredPreviousFrameIndex(size_t frameIndex) const
+{
+    // This follows what initFrameBuffer() does.
+    if (!frameIndex)
+        return notFound;
+
+    size_t previousIndex = frameIndex - 1;
+    while (previousIndex && m_frameBufferCache[previousIndex].disposalMethod() == ImageFrame::DisposeOverwritePrevious)
+        --previousIndex;
+
+    const ImageFrame& previousBuffer = m_frameBufferCache[previousIndex];
+    if (previousBuffer.disposalMethod() == ImageFrame::DisposeOverwriteBgcolor || previousBuffer.disposalMethod() == ImageFrame::DisposeOverwritePrevious) {
+        if (!previousIndex || previousBuffer.originalFrameRect().contains(IntRect(IntPoint(), scaledSize())))
+            return notFound;
+    }
+    return previousIndex;
+}
+
+size_t GIFImageDecoder::findStartingFrameIndex(size_t frameIndex) const
+{
+    while (true) {
+        size_t previousIndex = requiredPreviousFrameIndex(frameIndex);
+        if (previousIndex == notFound || m_frameBufferCache[previousIndex].status() == ImageFrame::FrameComplete)
+            return frameIndex;
+        frameIndex = previousIndex;
+    }
+}
+
 bool GIFImageDecoder::initFrameBuffer(unsigned frameIndex)
 {
     // Initialize the frame rect in our buffer.
@@ -374,10 +434,12 @@ bool GIFImageDecoder::initFrameBuffer(unsigned frameIndex)
             prevBuffer = &m_frameBufferCache[--frameIndex];
             prevMethod = prevBuffer->disposalMethod();
         }
-        ASSERT(prevBuffer->status() == ImageFrame::FrameComplete);
 
+        // Only the pixels that are copied have to be decoded; after clearFrameBufferCache(), decoding
+        // may start right after a frame that is cleared entirely when disposed of.
         if ((prevMethod == ImageFrame::DisposeNotSpecified) || (prevMethod == ImageFrame::DisposeKeep)) {
             // Preserve the last frame as the starting state for this frame.
+            ASSERT(prevBuffer->status() == ImageFrame::FrameComplete);
             if (!buffer->copyBitmapData(*prevBuffer))
                 return setFailed();
         } else {
@@ -392,6 +454,7 @@ bool GIFImageDecoder::initFrameBuffer(unsigned frameIndex)
                     return setFailed();
             } else {
                 // Copy the whole previous buffer, then clear just its frame.
+                ASSERT(prevBuffer->status() == ImageFrame::FrameComplete);
                 if (!buffer->copyBitmapData(*prevBuffer))
                     return setFailed();
                 buffer->zeroFillFrameRect(prevRect);
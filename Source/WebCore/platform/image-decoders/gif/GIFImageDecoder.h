@@ -71,8 +71,24 @@ namespace WebCore {
         // failure, this will mark the image as failed.
         bool initFrameBuffer(unsigned frameIndex);
 
+        // Returns the frame whose pixels initFrameBuffer() starts |frameIndex|
+        // from, or notFound if it starts from a transparent image.
+        size_t requiredPreviousFrameIndex(size_t frameIndex) const;
+
+        // Returns the closest frame, at or before |frameIndex|, that can be
+        // decoded with what is currently in the cache: decoding from there
+        // up to |frameIndex| recreates the frames that clearFrameBufferCache()
+        // threw away.
+        size_t findStartingFrameIndex(size_t frameIndex) const;
+
+        // Fills |m_palette| with the colors of frame |frameIndex|, leaving its
+        // transparent and out of range entries at 0.
+        void updatePalette(unsigned frameIndex, const unsigned char* colorMap, unsigned colorMapSize);
+
         bool m_currentBufferSawAlpha;
         mutable int m_repetitionCount;
+        Vector<ImageFrame::PixelData, 256> m_palette;
+        size_t m_paletteFrameIndex;
         std::unique_ptr<GIFImageReader> m_reader;
     };
 
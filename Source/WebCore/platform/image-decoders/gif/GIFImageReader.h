@@ -200,6 +200,12 @@ public:
     }
 
     bool decode(const unsigned char* data, size_t length, WebCore::GIFImageDecoder* client, bool* frameDecoded);
+    // Drops the state of a partial decode, so the next decode() starts over from the first LZW block.
+    void resetDecodeState()
+    {
+        m_lzwContext = nullptr;
+        m_currentLzwBlock = 0;
+    }
 
     bool isComplete() const { return m_isComplete; }
     void setComplete() { m_isComplete = true; }
@@ -285,6 +291,18 @@ public:
         return m_currentDecodingFrame < m_frames.size() ? m_frames[m_currentDecodingFrame].get() : 0;
     }
 
+    size_t currentDecodingFrame() const { return m_currentDecodingFrame; }
+    // Makes the next decode() continue from |frame|, which must have been parsed. Used to decode
+    // frames again after their pixels were cleared.
+    void setCurrentDecodingFrame(size_t frame)
+    {
+        ASSERT(frame < imagesCount());
+        // Frames from there on may have been left partially decoded, into buffers that were cleared since.
+        for (size_t i = frame; i < m_frames.size(); ++i)
+            m_frames[i]->resetDecodeState();
+        m_currentDecodingFrame = frame;
+    }
+
 private:
     bool parse(size_t dataPosition, size_t len, bool parseSizeOnly);
     void setRemainingBytes(size_t);
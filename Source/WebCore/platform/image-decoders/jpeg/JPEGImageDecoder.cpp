@@ -39,6 +39,7 @@
 
 #include "config.h"
 #include "JPEGImageDecoder.h"
+#include "PixelRowConversion.h"
 
 extern "C" {
 #if USE(ICCJPEG)
@@ -81,6 +82,7 @@ inline bool doFancyUpsampling() { return true; }
 #endif
 
 const int exifMarker = JPEG_APP0 + 1;
+const int iccMarker = JPEG_APP0 + 2;
 
 namespace WebCore {
 
@@ -126,6 +128,17 @@ static unsigned readUint32(JOCTET* data, bool isBigEndian)
     return (GETJOCTET(data[3]) << 24) | (GETJOCTET(data[2]) << 16) | (GETJOCTET(data[1]) << 8) | GETJOCTET(data[0]);
 }
 
+// Whether the image has a color profile, valid or not. The markers must have been saved.
+static bool hasColorProfileMarker(jpeg_decompress_struct* info)
+{
+    static const char iccSignature[] = "ICC_PROFILE";
+    for (jpeg_saved_marker_ptr marker = info->marker_list; marker; marker = marker->next) {
+        if (marker->marker == iccMarker && marker->data_length >= sizeof(iccSignature) && !memcmp(marker->data, iccSignature, sizeof(iccSignature)))
+            return true;
+    }
+    return false;
+}
+
 static bool checkExifHeader(jpeg_saved_marker_ptr marker, bool& isBigEndian, unsigned& ifdOffset)
 {
     // For exif data, the APP1 block is followed by 'E', 'x', 'i', 'f', '\0',
@@ -393,6 +406,13 @@ public:
             // image is a sequential JPEG.
             m_info.buffered_image = jpeg_has_multiple_scans(&m_info);
 
+            // Let libjpeg subsample while doing the inverse DCT, which is much
+            // cheaper than decoding the whole image and throwing pixels away.
+            if (SubsamplingLevel level = m_decoder->subsamplingLevel()) {
+                m_info.scale_num = 1;
+                m_info.scale_denom = 1 << level;
+            }
+
             // Used to set up image size so arrays can be allocated.
             jpeg_calc_output_dimensions(&m_info);
 
@@ -509,6 +529,68 @@ public:
     }
 
     jpeg_decompress_struct* info() { return &m_info; }
+    // Decodes the whole image into its YCbCr planes, leaving the color
+    // conversion and chroma upsampling to the GPU. Returns null for images
+    // that cannot be decoded this way.
+    PassRefPtr<YUVImage> decodeToYUV(const SharedBuffer& data)
+    {
+        m_info.src->bytes_in_buffer = data.size();
+        m_info.src->next_input_byte = (JOCTET*)(data.data());
+        m_bufferLength = data.size();
+
+        // We need to do the setjmp here. Otherwise bad things will happen.
+        // |m_yuvImage| is a member so that it is not leaked by a longjmp.
+        if (setjmp(m_err.setjmp_buffer))
+            return nullptr;
+
+        // Keep the color profile markers, even without color management, for canDecodeToYUV().
+        jpeg_save_markers(&m_info, iccMarker, 0xFFFF);
+        if (jpeg_read_header(&m_info, TRUE) != JPEG_HEADER_OK || !canDecodeToYUV())
+            return nullptr;
+
+        m_info.raw_data_out = TRUE;
+        m_info.out_color_space = JCS_YCbCr;
+        m_info.dct_method = dctMethod();
+        m_info.do_fancy_upsampling = FALSE;
+        if (!jpeg_start_decompress(&m_info))
+            return nullptr;
+
+        // libjpeg writes whole blocks, so every plane is padded to a whole
+        // number of MCUs.
+        unsigned mcuWidth = m_info.max_h_samp_factor * DCTSIZE;
+        unsigned mcuHeight = m_info.max_v_samp_factor * DCTSIZE;
+        unsigned mcuColumns = (m_info.image_width + mcuWidth - 1) / mcuWidth;
+        unsigned mcuRows = (m_info.image_height + mcuHeight - 1) / mcuHeight;
+
+        m_yuvImage = YUVImage::create(IntSize(m_info.image_width, m_info.image_height));
+        uint8_t* planes[YUVImage::planeCount];
+        JSAMPROW rows[YUVImage::planeCount][2 * DCTSIZE];
+        JSAMPARRAY rowsPerPlane[YUVImage::planeCount];
+        for (unsigned i = 0; i < YUVImage::planeCount; ++i) {
+            const jpeg_component_info& component = m_info.comp_info[i];
+            IntSize paddedSize(mcuColumns * component.h_samp_factor * DCTSIZE, mcuRows * component.v_samp_factor * DCTSIZE);
+            planes[i] = m_yuvImage->allocatePlane(static_cast<YUVImage::Plane>(i), paddedSize);
+            rowsPerPlane[i] = rows[i];
+        }
+
+        while (m_info.output_scanline < m_info.output_height) {
+            unsigned mcuRow = m_info.output_scanline / mcuHeight;
+            for (unsigned i = 0; i < YUVImage::planeCount; ++i) {
+                const jpeg_component_info& component = m_info.comp_info[i];
+                unsigned rowCount = component.v_samp_factor * DCTSIZE;
+                unsigned rowLength = mcuColumns * component.h_samp_factor * DCTSIZE;
+                for (unsigned row = 0; row < rowCount; ++row)
+                    rows[i][row] = planes[i] + (mcuRow * rowCount + row) * rowLength;
+            }
+            if (!jpeg_read_raw_data(&m_info, rowsPerPlane, mcuHeight))
+                return nullptr;
+        }
+
+        // jpeg_finish_decompress() is not called, as it would report the
+        // completion to the decoder, whose own frame this is not.
+        return m_yuvImage.release();
+    }
+
     JSAMPARRAY samples() const { return m_samples; }
     JPEGImageDecoder* decoder() { return m_decoder; }
 #if USE(QCMSLIB)
@@ -538,6 +620,25 @@ public:
 #endif
 
 private:
+    bool canDecodeToYUV()
+    {
+        // Only sequential YCbCr images whose chroma planes are subsampled by at
+        // most 2 in each direction: 4:4:4, 4:2:2, 4:4:0 and 4:2:0.
+        if (m_info.jpeg_color_space != JCS_YCbCr || m_info.num_components != static_cast<int>(YUVImage::planeCount) || jpeg_has_multiple_scans(&m_info))
+            return false;
+
+        const jpeg_component_info* components = m_info.comp_info;
+        if (components[0].h_samp_factor > 2 || components[0].v_samp_factor > 2)
+            return false;
+        for (unsigned i = 1; i < YUVImage::planeCount; ++i) {
+            if (components[i].h_samp_factor != 1 || components[i].v_samp_factor != 1)
+                return false;
+        }
+
+        // The planes are not color managed, so images that have a profile are left to the RGB path.
+        return m_decoder->ignoresGammaAndColorProfile() || !hasColorProfileMarker(info());
+    }
+
     JPEGImageDecoder* m_decoder;
     unsigned m_bufferLength;
     int m_bytesToSkip;
@@ -548,6 +649,7 @@ private:
     jstate m_state;
 
     JSAMPARRAY m_samples;
+    RefPtr<YUVImage> m_yuvImage;
 
 #if USE(QCMSLIB)
     qcms_transform* m_transform;
@@ -596,6 +698,16 @@ JPEGImageDecoder::~JPEGImageDecoder()
 {
 }
 
+PassRefPtr<YUVImage> JPEGImageDecoder::createYUVImage()
+{
+    if (failed() || !isAllDataReceived())
+        return nullptr;
+
+    // A reader of its own leaves the state of any incremental decoding alone.
+    JPEGImageReader reader(this);
+    return reader.decodeToYUV(*m_data);
+}
+
 bool JPEGImageDecoder::isSizeAvailable()
 {
     if (!ImageDecoder::isSizeAvailable())
@@ -609,7 +721,9 @@ bool JPEGImageDecoder::setSize(unsigned width, unsigned height)
     if (!ImageDecoder::setSize(width, height))
         return false;
 
-    prepareScaleDataIfNecessary();
+    // libjpeg does the subsampling, so only the pixel limit is left for us to
+    // apply, on top of its output.
+    prepareScaleDataIfNecessary(subsampledSize(size(), subsamplingLevel()), 0);
     return true;
 }
 
@@ -685,6 +799,10 @@ bool JPEGImageDecoder::outputScanlines(ImageFrame& buffer)
 #endif
 
         ImageFrame::PixelData* currentAddress = buffer.getAddr(0, destY);
+        if (colorSpace == JCS_RGB && !isScaled) {
+            PixelRowConversion::packRGB(*samples, currentAddress, width);
+            continue;
+        }
         for (int x = 0; x < width; ++x) {
             setPixel<colorSpace>(buffer, currentAddress, samples, isScaled ? m_scaledColumns[x] : x);
             ++currentAddress;
@@ -49,6 +49,10 @@ namespace WebCore {
         virtual bool isSizeAvailable();
         virtual bool setSize(unsigned width, unsigned height);
         virtual ImageFrame* frameBufferAtIndex(size_t index);
+        virtual bool supportsSubsampling() const { return true; }
+        // Scaled DCT skips most of the inverse transform and color conversion work.
+        virtual bool decodesSubsampledFramesCheaply() const { return true; }
+        virtual PassRefPtr<YUVImage> createYUVImage();
         // CAUTION: setFailed() deletes |m_reader|.  Be careful to avoid
         // accessing deleted memory, especially when calling this from inside
         // JPEGImageReader!
@@ -41,7 +41,7 @@
 #include "config.h"
 #include "PNGImageDecoder.h"
 
-#include "Color.h"
+#include "PixelRowConversion.h"
 #include <png.h>
 #include <wtf/StdLibExtras.h>
 
@@ -501,29 +501,6 @@ void PNGImageDecoder::headerAvailable()
     }
 }
 
-static inline void setPixelRGB(ImageFrame::PixelData* dest, png_bytep pixel)
-{
-    *dest = 0xFF000000U | pixel[0] << 16 | pixel[1] << 8 | pixel[2];
-}
-
-static inline void setPixelRGBA(ImageFrame::PixelData* dest, png_bytep pixel, unsigned char& nonTrivialAlphaMask)
-{
-    unsigned char a = pixel[3];
-    *dest = a << 24 | pixel[0] << 16 | pixel[1] << 8 | pixel[2];
-    nonTrivialAlphaMask |= (255 - a);
-}
-
-static inline void setPixelPremultipliedRGBA(ImageFrame::PixelData* dest, png_bytep pixel, unsigned char& nonTrivialAlphaMask)
-{
-    unsigned char a = pixel[3];
-    unsigned char r = fastDivideBy255(pixel[0] * a);
-    unsigned char g = fastDivideBy255(pixel[1] * a);
-    unsigned char b = fastDivideBy255(pixel[2] * a);
-
-    *dest = a << 24 | r << 16 | g << 8 | b;
-    nonTrivialAlphaMask |= (255 - a);
-}
-
 void PNGImageDecoder::rowAvailable(unsigned char* rowBuffer, unsigned rowIndex, int)
 {
     if (m_frameBufferCache.isEmpty())
@@ -642,7 +619,6 @@ void PNGImageDecoder::rowAvailable(unsigned char* rowBuffer, unsigned rowIndex,
     int width = scaledSize().width();
     unsigned char nonTrivialAlphaMask = 0;
 
-#if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
     if (m_scaled) {
         for (int x = 0; x < width; ++x) {
             png_bytep pixel = row + m_scaledColumns[x] * colorChannels;
@@ -650,23 +626,11 @@ void PNGImageDecoder::rowAvailable(unsigned char* rowBuffer, unsigned rowIndex,
             buffer.setRGBA(address++, pixel[0], pixel[1], pixel[2], alpha);
             nonTrivialAlphaMask |= (255 - alpha);
         }
+    } else if (hasAlpha) {
+        if (PixelRowConversion::packRGBA(row, address, width, buffer.premultiplyAlpha()))
+            nonTrivialAlphaMask = 1;
     } else
-#endif
-    {
-        png_bytep pixel = row;
-        if (hasAlpha) {
-            if (buffer.premultiplyAlpha()) {
-                for (int x = 0; x < width; ++x, pixel += 4)
-                    setPixelPremultipliedRGBA(address++, pixel, nonTrivialAlphaMask);
-            } else {
-                for (int x = 0; x < width; ++x, pixel += 4)
-                    setPixelRGBA(address++, pixel, nonTrivialAlphaMask);
-            }
-        } else {
-            for (int x = 0; x < width; ++x, pixel += 3)
-                setPixelRGB(address++, pixel);
-        }
-    }
+        PixelRowConversion::packRGB(row, address, width);
 
 
     if (nonTrivialAlphaMask && !buffer.hasAlpha())
@@ -949,7 +913,6 @@ void PNGImageDecoder::frameComplete()
         if (m_blend && !hasAlpha)
             m_blend = 0;
 
-#if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
         for (int y = 0; y < rect.maxY() - rect.y(); ++y) {
             png_bytep row = interlaceBuffer + (m_scaled ? m_scaledRows[y] : y) * colorChannels * size().width();
 #if USE(QCMSLIB)
@@ -969,28 +932,6 @@ void PNGImageDecoder::frameComplete()
                     buffer.overRGBA(address++, pixel[0], pixel[1], pixel[2], alpha);
             }
         }
-#else
-        ASSERT(!m_scaled);
-        png_bytep row = interlaceBuffer;
-        for (int y = rect.y(); y < rect.maxY(); ++y, row += colorChannels * size().width()) {
-            png_bytep pixel = row;
-#if USE(QCMSLIB)
-            if (qcms_transform* transform = m_reader->colorTransform()) {
-                qcms_transform_data(transform, row, m_reader->rowBuffer(), size().width());
-                pixel = m_reader->rowBuffer();
-            }
-#endif
-            ImageFrame::PixelData* address = buffer.getAddr(rect.x(), y);
-            for (int x = rect.x(); x < rect.maxX(); ++x, pixel += colorChannels) {
-                unsigned alpha = hasAlpha ? pixel[3] : 255;
-                nonTrivialAlpha |= alpha < 255;
-                if (!m_blend)
-                    buffer.setRGBA(address++, pixel[0], pixel[1], pixel[2], alpha);
-                else
-                    buffer.overRGBA(address++, pixel[0], pixel[1], pixel[2], alpha);
-            }
-        }
-#endif
 
         if (!nonTrivialAlpha) {
             if (buffer.originalFrameRect().contains(IntRect(IntPoint(), scaledSize())))
@@ -50,6 +50,7 @@ namespace WebCore {
         virtual bool isSizeAvailable() override;
         virtual bool setSize(unsigned width, unsigned height) override;
         virtual ImageFrame* frameBufferAtIndex(size_t index) override;
+        virtual bool supportsSubsampling() const override { return true; }
         // CAUTION: setFailed() deletes |m_reader|.  Be careful to avoid
         // accessing deleted memory, especially when calling this from inside
         // PNGImageReader!
@@ -250,11 +250,12 @@ bool WEBPImageDecoder::decode(bool onlySize)
     ASSERT(buffer.status() != ImageFrame::FrameComplete);
 
     if (buffer.status() == ImageFrame::FrameEmpty) {
-        if (!buffer.setSize(size().width(), size().height()))
+        if (!buffer.setSize(scaledSize().width(), scaledSize().height()))
             return setFailed();
         buffer.setStatus(ImageFrame::FramePartial);
         buffer.setHasAlpha(m_hasAlpha);
-        buffer.setOriginalFrameRect(IntRect(IntPoint(), size()));
+        // The frame rect is in the coordinates of the buffer, which is allocated at the scaled size.
+        buffer.setOriginalFrameRect(IntRect(IntPoint(), scaledSize()));
     }
 
     if (!m_decoder) {
@@ -263,10 +264,26 @@ bool WEBPImageDecoder::decode(bool onlySize)
             mode = outputMode(false);
         if ((m_formatFlags & ICCP_FLAG) && !ignoresGammaAndColorProfile())
             mode = MODE_RGBA; // Decode to RGBA for input to libqcms.
-        int rowStride = size().width() * sizeof(ImageFrame::PixelData);
+        int rowStride = scaledSize().width() * sizeof(ImageFrame::PixelData);
         uint8_t* output = reinterpret_cast<uint8_t*>(buffer.getAddr(0, 0));
-        int outputSize = size().height() * rowStride;
-        m_decoder = WebPINewRGB(mode, output, outputSize, rowStride);
+        int outputSize = scaledSize().height() * rowStride;
+        if (!subsamplingLevel())
+            m_decoder = WebPINewRGB(mode, output, outputSize, rowStride);
+        else {
+            // Have libwebp scale while decoding, so that the full-size image
+            // never needs to be held in memory.
+            if (!WebPInitDecoderConfig(&m_decoderConfig))
+                return setFailed();
+            m_decoderConfig.options.use_scaling = 1;
+            m_decoderConfig.options.scaled_width = scaledSize().width();
+            m_decoderConfig.options.scaled_height = scaledSize().height();
+            m_decoderConfig.output.colorspace = mode;
+            m_decoderConfig.output.is_external_memory = 1;
+            m_decoderConfig.output.u.RGBA.rgba = output;
+            m_decoderConfig.output.u.RGBA.stride = rowStride;
+            m_decoderConfig.output.u.RGBA.size = outputSize;
+            m_decoder = WebPIDecode(0, 0, &m_decoderConfig);
+        }
         if (!m_decoder)
             return setFailed();
     }
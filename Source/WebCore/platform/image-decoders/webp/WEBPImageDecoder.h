@@ -48,11 +48,15 @@ public:
     virtual String filenameExtension() const { return "webp"; }
     virtual bool isSizeAvailable();
     virtual ImageFrame* frameBufferAtIndex(size_t index);
+    virtual bool supportsSubsampling() const { return true; }
 
 private:
     bool decode(bool onlySize);
 
     WebPIDecoder* m_decoder;
+    // Used by subsampled decodes; libwebp keeps pointers into it for the
+    // lifetime of |m_decoder|.
+    WebPDecoderConfig m_decoderConfig;
     bool m_hasAlpha;
     int m_formatFlags;
 
@@ -102,6 +102,7 @@ public:
 
     void setFilterRegion(const FloatRect& filterRegion) { m_filterRegion = filterRegion; }
     virtual FloatRect filterRegion() const override { return m_filterRegion; }
+    virtual bool keepsIntermediateResults() const override { return false; }
 
     GraphicsContext* inputContext();
     ImageBuffer* output() const { return lastEffect()->asImageBuffer(); }
@@ -1511,6 +1511,28 @@ void RenderElement::newImageAnimationFrameAvailable(CachedImage& image)
     imageChanged(&image);
 }
 
+bool RenderElement::shouldStartAsyncImageDecoding(CachedImage&)
+{
+    if (document().inPageCache())
+        return false;
+    auto& frameView = view().frameView();
+    auto visibleRect = frameView.windowToContents(frameView.windowClipRect());
+    if (!shouldRepaintForImageAnimation(*this, visibleRect)) {
+        // Like a paused animation, repaint once we are in the viewport, which requests the decode again.
+        view().addRendererWithPausedImageAnimations(*this);
+        return false;
+    }
+    return true;
+}
+
+bool RenderElement::showsImageInViewport(CachedImage&)
+{
+    if (document().inPageCache())
+        return false;
+    auto& frameView = view().frameView();
+    return shouldRepaintForImageAnimation(*this, frameView.windowToContents(frameView.windowClipRect()));
+}
+
 bool RenderElement::repaintForPausedImageAnimationsIfNeeded(const IntRect& visibleRect)
 {
     ASSERT(m_hasPausedImageAnimations);
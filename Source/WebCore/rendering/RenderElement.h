@@ -305,6 +305,8 @@ private:
     RenderStyle* cachedFirstLineStyle() const;
 
     virtual void newImageAnimationFrameAvailable(CachedImage&) final override;
+    virtual bool shouldStartAsyncImageDecoding(CachedImage&) final override;
+    virtual bool showsImageInViewport(CachedImage&) final override;
 
     bool getLeadingCorner(FloatPoint& output) const;
     bool getTrailingCorner(FloatPoint& output) const;
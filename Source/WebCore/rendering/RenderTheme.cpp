@@ -262,6 +262,14 @@ void RenderTheme::adjustStyle(StyleResolver& styleResolver, RenderStyle& style,
     }
 }
 
+bool RenderTheme::skipPaintingWhileRecording(GraphicsContext& context) const
+{
+    if (!context.isRecording() || !paintsIntoPlatformContext())
+        return false;
+    context.markRecordingAsNotReplayable();
+    return true;
+}
+
 bool RenderTheme::paint(const RenderBox& box, ControlStates& controlStates, const PaintInfo& paintInfo, const LayoutRect& rect)
 {
     // If painting is disabled, but we aren't updating control tints, then just bail.
@@ -272,7 +280,7 @@ bool RenderTheme::paint(const RenderBox& box, ControlStates& controlStates, cons
             box.repaint();
         return false;
     }
-    if (paintInfo.context().paintingDisabled())
+    if (paintInfo.context().paintingDisabled() || skipPaintingWhileRecording(paintInfo.context()))
         return false;
 
     ControlPart part = box.style().appearance();
@@ -411,7 +419,7 @@ bool RenderTheme::paint(const RenderBox& box, ControlStates& controlStates, cons
 
 bool RenderTheme::paintBorderOnly(const RenderBox& box, const PaintInfo& paintInfo, const LayoutRect& rect)
 {
-    if (paintInfo.context().paintingDisabled())
+    if (paintInfo.context().paintingDisabled() || skipPaintingWhileRecording(paintInfo.context()))
         return false;
 
 #if PLATFORM(IOS)
@@ -465,7 +473,7 @@ bool RenderTheme::paintBorderOnly(const RenderBox& box, const PaintInfo& paintIn
 
 bool RenderTheme::paintDecorations(const RenderBox& box, const PaintInfo& paintInfo, const LayoutRect& rect)
 {
-    if (paintInfo.context().paintingDisabled())
+    if (paintInfo.context().paintingDisabled() || skipPaintingWhileRecording(paintInfo.context()))
         return false;
 
     IntRect integralSnappedRect = snappedIntRect(rect);
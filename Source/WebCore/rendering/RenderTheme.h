@@ -76,6 +76,11 @@ public:
     // "border" are set, or if the appearance is not supported by the theme.
     void adjustStyle(StyleResolver&, RenderStyle&, Element*,  bool UAHasAppearance, const BorderData&, const FillLayer&, const Color& backgroundColor);
 
+    // Whether this theme draws controls straight into the platform context, which a context recording a
+    // display list doesn't have. Such themes don't paint while recording, and the list is marked as not
+    // replayable instead.
+    virtual bool paintsIntoPlatformContext() const { return false; }
+
     // This method is called to paint the widget as a background of the RenderObject.  A widget's foreground, e.g., the
     // text of a button, is always rendered by the engine itself.  The boolean return value indicates
     // whether the CSS border/background should also be painted.
@@ -394,6 +399,8 @@ public:
     bool isDefault(const RenderObject&) const;
 
 private:
+    bool skipPaintingWhileRecording(GraphicsContext&) const;
+
     mutable Color m_activeSelectionBackgroundColor;
     mutable Color m_inactiveSelectionBackgroundColor;
     mutable Color m_activeSelectionForegroundColor;
@@ -72,6 +72,9 @@ public:
     // A method asking if the theme's controls actually care about redrawing when hovered.
     virtual bool supportsHover(const RenderStyle&) const override { return true; }
 
+    // Controls are drawn into the Cairo context directly.
+    virtual bool paintsIntoPlatformContext() const override { return true; }
+
     // A method Returning whether the control is styled by css or not e.g specifying background-color.
     virtual bool isControlStyled(const RenderStyle&, const BorderData&, const FillLayer&, const Color& backgroundColor) const override;
 
@@ -54,6 +54,9 @@ public:
     // A method asking if the theme's controls actually care about redrawing when hovered.
     virtual bool supportsHover(const RenderStyle&) const override { return true; }
 
+    // Controls are drawn into the Cairo context directly.
+    virtual bool paintsIntoPlatformContext() const override { return true; }
+
     // A method asking if the theme is able to draw the focus ring.
     virtual bool supportsFocusRing(const RenderStyle&) const override;
 
@@ -53,6 +53,7 @@ list(APPEND WebKit2_SOURCES
 
     Shared/CoordinatedGraphics/threadedcompositor/ThreadedCompositor.cpp
     Shared/CoordinatedGraphics/threadedcompositor/ThreadSafeCoordinatedSurface.cpp
+    Shared/CoordinatedGraphics/threadedcompositor/YUVCoordinatedSurface.cpp
 
     Shared/Downloads/soup/DownloadSoup.cpp
 
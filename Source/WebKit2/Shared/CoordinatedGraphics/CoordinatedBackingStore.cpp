@@ -91,6 +91,16 @@ void CoordinatedBackingStore::updateTile(uint32_t id, const IntRect& sourceRect,
     it->value.setBackBuffer(tileRect, sourceRect, backBuffer, offset);
 }
 
+FloatRect CoordinatedBackingStore::layerRectForTileUpdate(uint32_t id, const IntRect& sourceRect, const IntRect& tileRect) const
+{
+    auto it = m_tiles.find(id);
+    ASSERT(it != m_tiles.end());
+    FloatRect updateRect(sourceRect);
+    updateRect.move(tileRect.x(), tileRect.y());
+    updateRect.scale(1. / it->value.scale());
+    return updateRect;
+}
+
 RefPtr<BitmapTexture> CoordinatedBackingStore::texture() const
 {
     for (auto& tile : m_tiles.values()) {
@@ -61,6 +61,8 @@ public:
     void removeTile(uint32_t tileID);
     void removeAllTiles();
     void updateTile(uint32_t tileID, const WebCore::IntRect&, const WebCore::IntRect&, PassRefPtr<WebCore::CoordinatedSurface>, const WebCore::IntPoint&);
+    // The part of the layer, in layer coordinates, that an update of the given tile repaints.
+    WebCore::FloatRect layerRectForTileUpdate(uint32_t tileID, const WebCore::IntRect& sourceRect, const WebCore::IntRect& tileRect) const;
     static Ref<CoordinatedBackingStore> create() { return adoptRef(*new CoordinatedBackingStore); }
     void commitTileOperations(WebCore::TextureMapper*);
     RefPtr<WebCore::BitmapTexture> texture() const override;
@@ -61,6 +61,7 @@ CoordinatedGraphicsScene::CoordinatedGraphicsScene(CoordinatedGraphicsSceneClien
     , m_isActive(false)
     , m_rootLayerID(InvalidCoordinatedLayerID)
     , m_viewBackgroundColor(Color::black)
+    , m_hasFullDamage(true)
     , m_clientRunLoop(RunLoop::current())
 {
 }
@@ -71,11 +72,7 @@ CoordinatedGraphicsScene::~CoordinatedGraphicsScene()
 
 void CoordinatedGraphicsScene::paintToCurrentGLContext(const TransformationMatrix& matrix, float opacity, const FloatRect& clipRect, const Color& backgroundColor, bool drawsBackground, const FloatPoint& contentPosition, TextureMapper::PaintFlags PaintFlags)
 {
-    if (!m_textureMapper) {
-        m_textureMapper = TextureMapper::create();
-        static_cast<TextureMapperGL*>(m_textureMapper.get())->setEnableEdgeDistanceAntialiasing(true);
-    }
-
+    createGLTextureMapperIfNeeded();
     syncRemoteContent();
 
     adjustPositionForFixedLayers(contentPosition);
@@ -112,8 +109,64 @@ void CoordinatedGraphicsScene::paintToCurrentGLContext(const TransformationMatri
     m_textureMapper->endClip();
     m_textureMapper->endPainting();
 
-    if (currentRootLayer->descendantsOrSelfHaveRunningAnimations() && m_client)
-        m_client->updateViewport();
+    // Animations keep changing the output until the frame after they finish.
+    if (currentRootLayer->descendantsOrSelfHaveRunningAnimations()) {
+        addFullDamage();
+        if (m_client)
+            m_client->updateViewport();
+    }
+}
+
+void CoordinatedGraphicsScene::createGLTextureMapperIfNeeded()
+{
+    if (m_textureMapper)
+        return;
+
+    m_textureMapper = TextureMapper::create();
+    static_cast<TextureMapperGL*>(m_textureMapper.get())->setEnableEdgeDistanceAntialiasing(true);
+}
+
+void CoordinatedGraphicsScene::commitPendingUpdates()
+{
+    createGLTextureMapperIfNeeded();
+    syncRemoteContent();
+}
+
+Region CoordinatedGraphicsScene::takeDamage(const IntRect& surfaceRect)
+{
+    // The FPS counter and platform layers change the output without going through the scene
+    // updates, so they need the whole surface to be repainted.
+    if (m_fpsCounter.isVisible())
+        addFullDamage();
+#if USE(COORDINATED_GRAPHICS_THREADED)
+    if (!m_platformLayerProxies.isEmpty())
+        addFullDamage();
+#endif
+
+    Region damage(surfaceRect);
+    if (!m_hasFullDamage)
+        damage.intersect(m_damage);
+
+    m_damage = Region();
+    m_hasFullDamage = false;
+    return damage;
+}
+
+void CoordinatedGraphicsScene::addDamage(TextureMapperLayer* layer, const FloatRect& rect)
+{
+    if (m_hasFullDamage)
+        return;
+
+    Optional<FloatRect> surfaceRect = layer->mapRectToSurface(rect);
+    if (!surfaceRect) {
+        addFullDamage();
+        return;
+    }
+
+    // Inflate to cover the antialiased edges of transformed layers.
+    IntRect damageRect = enclosingIntRect(surfaceRect.value());
+    damageRect.inflate(1);
+    m_damage.unite(damageRect);
 }
 
 void CoordinatedGraphicsScene::paintToGraphicsContext(PlatformGraphicsContext* platformContext, const Color& backgroundColor, bool drawsBackground)
@@ -261,6 +314,10 @@ void CoordinatedGraphicsScene::setLayerState(CoordinatedLayerID id, const Coordi
     ASSERT(m_rootLayerID != InvalidCoordinatedLayerID);
     TextureMapperLayer* layer = layerByID(id);
 
+    // Only tile content updates are tracked precisely, anything else might move pixels around.
+    if (layerState.changeMask || !layerState.tilesToCreate.isEmpty() || !layerState.tilesToRemove.isEmpty())
+        addFullDamage();
+
     if (layerState.positionChanged)
         layer->setPosition(layerState.pos);
 
@@ -483,6 +540,7 @@ void CoordinatedGraphicsScene::updateTilesIfNeeded(TextureMapperLayer* layer, co
 
         backingStore->updateTile(tile.tileID, surfaceUpdateInfo.updateRect, tile.tileRect, surfaceIt->value, surfaceUpdateInfo.surfaceOffset);
         m_backingStoresWithPendingBuffers.add(backingStore);
+        addDamage(layer, backingStore->layerRectForTileUpdate(tile.tileID, surfaceUpdateInfo.updateRect, tile.tileRect));
     }
 }
 
@@ -595,6 +653,10 @@ void CoordinatedGraphicsScene::commitPendingBackingStoreOperations()
 
 void CoordinatedGraphicsScene::commitSceneState(const CoordinatedGraphicsState& state)
 {
+    if (state.scrollPosition != m_renderedContentsScrollPosition || !state.layersToCreate.isEmpty() || !state.layersToRemove.isEmpty()
+        || state.rootCompositingLayer != m_rootLayerID || !state.imagesToUpdate.isEmpty() || !state.imagesToClear.isEmpty())
+        addFullDamage();
+
     m_renderedContentsScrollPosition = state.scrollPosition;
 
     createLayers(state.layersToCreate);
@@ -672,6 +734,7 @@ void CoordinatedGraphicsScene::purgeGLResources()
     m_textureMapper = nullptr;
     m_backingStores.clear();
     m_backingStoresWithPendingBuffers.clear();
+    addFullDamage();
 
     setActive(false);
 
@@ -28,6 +28,7 @@
 #include <WebCore/GraphicsLayer.h>
 #include <WebCore/IntRect.h>
 #include <WebCore/IntSize.h>
+#include <WebCore/Region.h>
 #include <WebCore/TextureMapper.h>
 #include <WebCore/TextureMapperBackingStore.h>
 #include <WebCore/TextureMapperFPSCounter.h>
@@ -72,6 +73,13 @@ public:
     virtual ~CoordinatedGraphicsScene();
     void paintToCurrentGLContext(const WebCore::TransformationMatrix&, float, const WebCore::FloatRect&, const WebCore::Color& backgroundColor, bool drawsBackground, const WebCore::FloatPoint&, WebCore::TextureMapper::PaintFlags = 0);
     void paintToGraphicsContext(PlatformGraphicsContext*, const WebCore::Color& backgroundColor, bool drawsBackground);
+
+    // Applies the pending scene updates ahead of paintToCurrentGLContext(), so that the damage
+    // they cause is known before painting. Requires a current GL context.
+    void commitPendingUpdates();
+    // Returns the part of surfaceRect that changed since the last call, and starts tracking anew.
+    WebCore::Region takeDamage(const WebCore::IntRect& surfaceRect);
+
     void detach();
     void appendUpdate(std::function<void()>);
 
@@ -89,7 +97,12 @@ public:
     void commitSceneState(const WebCore::CoordinatedGraphicsState&);
     void renderNextFrame();
 
-    void setViewBackgroundColor(const WebCore::Color& color) { m_viewBackgroundColor = color; }
+    void setViewBackgroundColor(const WebCore::Color& color)
+    {
+        if (color != m_viewBackgroundColor)
+            addFullDamage();
+        m_viewBackgroundColor = color;
+    }
     WebCore::Color viewBackgroundColor() const { return m_viewBackgroundColor; }
 
 private:
@@ -129,6 +142,8 @@ private:
     WebCore::TextureMapperLayer* getLayerByIDIfExists(WebCore::CoordinatedLayerID);
     WebCore::TextureMapperLayer* rootLayer() { return m_rootLayer.get(); }
 
+    void createGLTextureMapperIfNeeded();
+
     void syncRemoteContent();
     void adjustPositionForFixedLayers(const WebCore::FloatPoint& contentPosition);
 
@@ -152,6 +167,9 @@ private:
 
     void dispatchCommitScrollOffset(uint32_t layerID, const WebCore::IntSize& offset);
 
+    void addDamage(WebCore::TextureMapperLayer*, const WebCore::FloatRect&);
+    void addFullDamage() { m_hasFullDamage = true; }
+
 #if USE(COORDINATED_GRAPHICS_THREADED)
     virtual void onNewBufferAvailable() override;
 #endif
@@ -201,6 +219,10 @@ private:
 
     WebCore::TextureMapperFPSCounter m_fpsCounter;
 
+    // Surface area changed by the scene updates applied since the last takeDamage().
+    WebCore::Region m_damage;
+    bool m_hasFullDamage;
+
     RunLoop& m_clientRunLoop;
 };
 
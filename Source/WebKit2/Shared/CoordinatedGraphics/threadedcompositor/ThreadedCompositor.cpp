@@ -30,6 +30,8 @@
 
 #include <WebCore/GLContextEGL.h>
 #include <WebCore/PlatformDisplayWPE.h>
+#include <WebCore/PlatformWheelEvent.h>
+#include <WebCore/TextureMapperLayer.h>
 #include <WebCore/TransformationMatrix.h>
 #include <cstdio>
 #include <cstdlib>
@@ -206,6 +208,60 @@ void ThreadedCompositor::scrollBy(const IntSize& delta)
     });
 }
 
+void ThreadedCompositor::handleWheelEvent(const PlatformWheelEvent& event, std::function<void (bool)> completionHandler)
+{
+    RefPtr<ThreadedCompositor> protector(this);
+    callOnCompositingThread([=] {
+        completionHandler(protector->scrollForWheelEvent(event));
+    });
+}
+
+void ThreadedCompositor::setNonFastScrollableRegion(const WebCore::Region& region)
+{
+    RefPtr<ThreadedCompositor> protector(this);
+    callOnCompositingThread([=] {
+        protector->m_nonFastScrollableRegion = region;
+        protector->m_nonFastScrollableRegionIsValid = true;
+    });
+}
+
+void ThreadedCompositor::invalidateNonFastScrollableRegion()
+{
+    RefPtr<ThreadedCompositor> protector(this);
+    callOnCompositingThread([=] {
+        protector->m_nonFastScrollableRegionIsValid = false;
+    });
+}
+
+bool ThreadedCompositor::scrollForWheelEvent(const PlatformWheelEvent& event)
+{
+    ASSERT(&RunLoop::current() == &m_compositingRunLoop->runLoop());
+
+    // Zooming and page-based scrolling are handled by the main thread, and so is everything until it is
+    // known where wheel event handlers and main thread scrollable areas are.
+    if (!m_scene || !m_nonFastScrollableRegionIsValid || event.granularity() != ScrollByPixelWheelEvent || event.ctrlKey() || event.metaKey())
+        return false;
+
+    FloatRect visibleRect = viewportController()->visibleContentsRect();
+    float scale = viewportController()->pageScaleFactor();
+    FloatPoint contentsPosition = visibleRect.location() + FloatSize(event.position().x() / scale, event.position().y() / scale);
+    if (m_nonFastScrollableRegion.contains(roundedIntPoint(contentsPosition)))
+        return false;
+
+    FloatSize offset(-event.deltaX(), -event.deltaY());
+    if (TextureMapperLayer* layer = m_scene->findScrollableContentsLayerAt(event.position())) {
+        if (layer->scrollBy(offset)) {
+            m_needsFullDamage = true;
+            scheduleDisplayImmediately();
+            return true;
+        }
+    }
+
+    // Scrolling the main frame notifies the main thread through didChangeVisibleRect().
+    viewportController()->scrollBy(roundedIntSize(FloatSize(offset.width() / scale, offset.height() / scale)));
+    return true;
+}
+
 void ThreadedCompositor::purgeBackingStores()
 {
     m_client->purgeBackingStores();
@@ -247,6 +303,8 @@ bool ThreadedCompositor::ensureGLContext()
     if (m_viewportSize != contextSize) {
         glViewport(0, 0, contextSize.width(), contextSize.height());
         m_viewportSize = contextSize;
+        m_needsFullDamage = true;
+        m_damageHistory.clear();
     }
 
     return true;
@@ -298,29 +356,59 @@ void ThreadedCompositor::renderLayerTree()
     if (!ensureGLContext())
         return;
 
-    FloatRect clipRect(0, 0, m_viewportSize.width(), m_viewportSize.height());
+#if PLATFORM(WPE)
+    m_surface->beginFrame();
+#endif
+
+    IntRect viewportRect(IntPoint::zero(), m_viewportSize);
 
     TransformationMatrix viewportTransform;
     FloatPoint scrollPostion = viewportController()->visibleContentsRect().location();
     viewportTransform.scale(viewportController()->pageScaleFactor());
     viewportTransform.translate(-scrollPostion.x(), -scrollPostion.y());
 
-    m_scene->paintToCurrentGLContext(viewportTransform, 1, clipRect, Color::white, false, scrollPostion);
+    m_scene->commitPendingUpdates();
+    WebCore::Region damage = m_scene->takeDamage(viewportRect);
+    if (m_needsFullDamage || viewportTransform != m_viewportTransform) {
+        damage = WebCore::Region(viewportRect);
+        m_viewportTransform = viewportTransform;
+        m_needsFullDamage = false;
+    }
+
+    if (damage.isEmpty()) {
+        // The presented frame is still up to date, so there is nothing to paint nor to hand over, and the
+        // backend will not report the frame as complete. Complete it ourselves, but not before a frame
+        // interval has passed since the last one, or a requestAnimationFrame loop that paints nothing
+        // would run as fast as the CPU allows.
+        static const double frameInterval = 1.0 / 60;
+        double delay = m_lastFrameCompleteTime + frameInterval - monotonicallyIncreasingTime();
+        m_unchangedFrameTimer->startOneShot(std::max(0., delay));
+        return;
+    }
 
-    glContext()->swapBuffers();
+    WebCore::Region repaintRegion = m_damageHistory.repaintRegionForDamage(damage, viewportRect, glContext()->bufferAge());
+    m_scene->paintToCurrentGLContext(viewportTransform, 1, repaintRegion.bounds(), Color::white, false, scrollPostion);
+
+    // The damage is relative to the previously presented frame, which is what both EGL and the
+    // view backend compare the new buffer against; the rest of the repaint region only made up
+    // for the age of the back buffer.
+    Vector<WebCore::IntRect> damageRects = damage.rects();
+    glContext()->swapBuffersWithDamage(damageRects);
 
 #if PLATFORM(WPE)
+    m_surface->reportPaintTime(std::exchange(m_paintTimeForNextFrame, 0));
     auto bufferExport = m_surface->lockFrontBuffer();
-    m_compositingManager.commitBuffer(bufferExport);
+    m_compositingManager.commitBuffer(bufferExport, damageRects);
 #endif
 }
 
-void ThreadedCompositor::updateSceneState(const CoordinatedGraphicsState& state)
+void ThreadedCompositor::updateSceneState(const CoordinatedGraphicsState& state, double paintTime)
 {
     RefPtr<ThreadedCompositor> protector(this);
     RefPtr<CoordinatedGraphicsScene> scene = m_scene;
-    m_scene->appendUpdate([protector, scene, state] {
+    m_scene->appendUpdate([protector, scene, state, paintTime] {
         scene->commitSceneState(state);
+        protector->m_paintTimeForNextFrame += paintTime;
 
         protector->m_clientRendersNextFrame.store(true);
         bool coordinateUpdate = std::any_of(state.layersToUpdate.begin(), state.layersToUpdate.end(),
@@ -362,6 +450,7 @@ void ThreadedCompositor::runCompositingThread()
         m_compositingRunLoop = std::make_unique<CompositingRunLoop>([&] {
             renderLayerTree();
         });
+        m_unchangedFrameTimer = std::make_unique<RunLoop::Timer<ThreadedCompositor>>(RunLoop::current(), this, &ThreadedCompositor::unchangedFrameTimerFired);
         m_scene = adoptRef(new CoordinatedGraphicsScene(this));
         m_viewportController = std::make_unique<SimpleViewportController>(this);
 
@@ -371,6 +460,7 @@ void ThreadedCompositor::runCompositingThread()
     m_compositingRunLoop->runLoop().run();
 
     m_compositingRunLoop->stopUpdates();
+    m_unchangedFrameTimer = nullptr;
     m_scene->purgeGLResources();
 
     {
@@ -478,9 +568,16 @@ void ThreadedCompositor::releaseBuffer(uint32_t handle)
 #endif
 }
 
+void ThreadedCompositor::unchangedFrameTimerFired()
+{
+    frameComplete();
+}
+
 void ThreadedCompositor::frameComplete()
 {
     RELEASE_ASSERT(&RunLoop::current() == &m_compositingRunLoop->runLoop());
+    m_lastFrameCompleteTime = monotonicallyIncreasingTime();
+
     static bool reportFPS = !!std::getenv("WPE_THREADED_COMPOSITOR_FPS");
     if (reportFPS)
         debugThreadedCompositorFPS();
@@ -31,15 +31,19 @@
 #include "CompositingManager.h"
 #include "CoordinatedGraphicsScene.h"
 #include "SimpleViewportController.h"
+#include <WebCore/DamageHistory.h>
 #include <WebCore/GLContext.h>
 #include <WebCore/IntSize.h>
+#include <WebCore/Region.h>
 #include <WebCore/TransformationMatrix.h>
 #include <wtf/Atomics.h>
 #include <wtf/Condition.h>
 #include <wtf/FastMalloc.h>
 #include <wtf/Lock.h>
 #include <wtf/Noncopyable.h>
+#include <wtf/RunLoop.h>
 #include <wtf/ThreadSafeRefCounted.h>
+#include <wtf/Vector.h>
 
 #if PLATFORM(WPE)
 #include <WebCore/PlatformDisplayWPE.h>
@@ -50,6 +54,7 @@
 #endif
 
 namespace WebCore {
+class PlatformWheelEvent;
 struct CoordinatedGraphicsState;
 }
 
@@ -83,7 +88,8 @@ public:
 
     void setNativeSurfaceHandleForCompositing(uint64_t);
 
-    void updateSceneState(const WebCore::CoordinatedGraphicsState&);
+    // The paint time, in seconds, is what the main thread spent flushing the layers to produce the state.
+    void updateSceneState(const WebCore::CoordinatedGraphicsState&, double paintTime);
 
     void didChangeViewportSize(const WebCore::IntSize&);
     void didChangeViewportAttribute(const WebCore::ViewportAttributes&);
@@ -91,6 +97,13 @@ public:
     void scrollTo(const WebCore::IntPoint&);
     void scrollBy(const WebCore::IntSize&);
 
+    // Scrolls for the event on the compositing thread, where the completion handler is then called with
+    // whether it was handled. Events over the non-fast scrollable region are left to the main thread, and
+    // so are all of them while the region is not known to be up to date.
+    void handleWheelEvent(const WebCore::PlatformWheelEvent&, std::function<void (bool)> completionHandler);
+    void setNonFastScrollableRegion(const WebCore::Region&);
+    void invalidateNonFastScrollableRegion();
+
     RefPtr<WebCore::DisplayRefreshMonitor> createDisplayRefreshMonitor(PlatformDisplayID);
 
 private:
@@ -112,6 +125,8 @@ private:
     virtual void frameComplete() override;
 
     void renderLayerTree();
+    void unchangedFrameTimerFired();
+    bool scrollForWheelEvent(const WebCore::PlatformWheelEvent&);
     void scheduleDisplayImmediately();
     virtual void didChangeVisibleRect() override;
 
@@ -135,9 +150,20 @@ private:
     std::unique_ptr<WebCore::GLContext> m_context;
 
     WebCore::IntSize m_viewportSize;
+    WebCore::TransformationMatrix m_viewportTransform;
+    bool m_needsFullDamage { true };
+    WebCore::DamageHistory m_damageHistory;
     uint64_t m_nativeSurfaceHandle;
+    // Areas of the page, in contents coordinates, where scrolling depends on the main thread.
+    WebCore::Region m_nonFastScrollableRegion;
+    bool m_nonFastScrollableRegionIsValid { false };
 
     std::unique_ptr<CompositingRunLoop> m_compositingRunLoop;
+    // Completes frames that had no damage, which are never handed to the backend. Lives on the compositing thread.
+    std::unique_ptr<RunLoop::Timer<ThreadedCompositor>> m_unchangedFrameTimer;
+    double m_lastFrameCompleteTime { 0 };
+    // Main thread paint time of the scene states committed since the last presented frame. Lives on the compositing thread.
+    double m_paintTimeForNextFrame { 0 };
 
     ThreadIdentifier m_threadIdentifier;
     Condition m_initializeRunLoopCondition;
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. AND ITS CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL APPLE INC. OR ITS CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#if USE(COORDINATED_GRAPHICS)
+#include "YUVCoordinatedSurface.h"
+
+#include <WebCore/BitmapTexture.h>
+
+using namespace WebCore;
+
+namespace WebKit {
+
+PassRefPtr<CoordinatedSurface> YUVCoordinatedSurface::create(PassRefPtr<YUVImage> image)
+{
+    return adoptRef(new YUVCoordinatedSurface(image));
+}
+
+YUVCoordinatedSurface::YUVCoordinatedSurface(PassRefPtr<YUVImage> image)
+    : CoordinatedSurface(image->size(), CoordinatedSurface::NoFlags)
+    , m_image(image)
+{
+}
+
+YUVCoordinatedSurface::~YUVCoordinatedSurface()
+{
+}
+
+void YUVCoordinatedSurface::paintToSurface(const IntRect&, CoordinatedSurface::Client*)
+{
+    ASSERT_NOT_REACHED();
+}
+
+void YUVCoordinatedSurface::copyToTexture(PassRefPtr<BitmapTexture> passTexture, const IntRect& target, const IntPoint& sourceOffset)
+{
+    RefPtr<BitmapTexture> texture(passTexture);
+    texture->updateContents(*m_image, target, sourceOffset);
+}
+
+} // namespace WebKit
+
+#endif // USE(COORDINATED_GRAPHICS)
@@ -1456,3 +1456,13 @@ bool WKPreferencesGetAllowDisplayOfInsecureContent(WKPreferencesRef preferencesR
 {
     return toImpl(preferencesRef)->allowDisplayOfInsecureContent();
 }
+
+void WKPreferencesSetAsyncImageDecodingEnabled(WKPreferencesRef preferencesRef, bool enabled)
+{
+    toImpl(preferencesRef)->setAsyncImageDecodingEnabled(enabled);
+}
+
+bool WKPreferencesGetAsyncImageDecodingEnabled(WKPreferencesRef preferencesRef)
+{
+    return toImpl(preferencesRef)->asyncImageDecodingEnabled();
+}
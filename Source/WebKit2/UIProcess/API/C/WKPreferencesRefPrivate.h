@@ -395,6 +395,10 @@ WK_EXPORT bool WKPreferencesGetHTTPEquivEnabled(WKPreferencesRef preferences);
 WK_EXPORT void WKPreferencesSetResourceUsageOverlayVisible(WKPreferencesRef, bool);
 WK_EXPORT bool WKPreferencesGetResourceUsageOverlayVisible(WKPreferencesRef);
 
+// Defaults to false.
+WK_EXPORT void WKPreferencesSetAsyncImageDecodingEnabled(WKPreferencesRef, bool);
+WK_EXPORT bool WKPreferencesGetAsyncImageDecodingEnabled(WKPreferencesRef);
+
 #ifdef __cplusplus
 }
 #endif
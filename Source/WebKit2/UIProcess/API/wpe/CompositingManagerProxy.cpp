@@ -32,6 +32,7 @@
 #include "DrawingAreaMessages.h"
 #include "WPEView.h"
 #include "WebProcessProxy.h"
+#include <vector>
 
 namespace WebKit {
 
@@ -54,8 +55,13 @@ void CompositingManagerProxy::constructRenderingTarget(uint32_t width, uint32_t
     handle = m_view.viewBackend().constructRenderingTarget(width, height);
 }
 
-void CompositingManagerProxy::commitBuffer(const IPC::Attachment& fd, const IPC::DataReference& bufferData)
+void CompositingManagerProxy::commitBuffer(const IPC::Attachment& fd, const IPC::DataReference& bufferData, const Vector<WebCore::IntRect>& damageRects)
 {
+    std::vector<WPE::ViewBackend::ViewBackend::DamageRect> damage;
+    damage.reserve(damageRects.size());
+    for (auto& rect : damageRects)
+        damage.emplace_back(rect.x(), rect.y(), rect.width(), rect.height());
+    m_view.viewBackend().setDamage(damage.data(), damage.size());
     m_view.viewBackend().commitBuffer(fd.fileDescriptor(), bufferData.data(), bufferData.size());
 }
 
@@ -29,6 +29,8 @@
 #include "Connection.h"
 #include "MessageReceiver.h"
 #include <WPE/ViewBackend/ViewBackend.h>
+#include <WebCore/IntRect.h>
+#include <wtf/Vector.h>
 
 namespace IPC {
 class Attachment;
@@ -65,7 +67,7 @@ private:
     void establishConnection(IPC::Attachment);
 
     void constructRenderingTarget(uint32_t, uint32_t, uint32_t& handle);
-    void commitBuffer(const IPC::Attachment&, const IPC::DataReference&);
+    void commitBuffer(const IPC::Attachment&, const IPC::DataReference&, const Vector<WebCore::IntRect>&);
     void destroyBuffer(uint32_t);
 
     // WPE::ViewBackend::Client
@@ -76,6 +76,8 @@ CoordinatedLayerTreeHost::CoordinatedLayerTreeHost(WebPage* webPage)
     m_layerTreeContext.contextID = toCoordinatedGraphicsLayer(m_coordinator->rootLayer())->id();
 
     CoordinatedSurface::setFactory(createCoordinatedSurface);
+    // Surfaces are sent to the UI process, which only knows about RGB ones.
+    CoordinatedSurface::setYUVFactory(nullptr);
 
     scheduleLayerFlush();
 }
@@ -33,18 +33,22 @@
 
 #include "DrawingAreaProxyMessages.h"
 #include "DrawingAreaWPE.h"
+#include "EventDispatcher.h"
 #include "NotImplemented.h"
 #include "ThreadSafeCoordinatedSurface.h"
 #include "WebPage.h"
 #include "WebPageProxyMessages.h"
 #include "WebProcess.h"
+#include "YUVCoordinatedSurface.h"
 #include <WebCore/CoordinatedGraphicsLayer.h>
 #include <WebCore/CoordinatedGraphicsState.h>
+#include <WebCore/Document.h>
 #include <WebCore/Frame.h>
 #include <WebCore/FrameView.h>
 #include <WebCore/GraphicsContext.h>
 #include <WebCore/MainFrame.h>
 #include <WebCore/Page.h>
+#include <WebCore/RenderView.h>
 #include <wtf/CurrentTime.h>
 
 using namespace WebCore;
@@ -58,6 +62,7 @@ Ref<ThreadedCoordinatedLayerTreeHost> ThreadedCoordinatedLayerTreeHost::create(W
 
 ThreadedCoordinatedLayerTreeHost::~ThreadedCoordinatedLayerTreeHost()
 {
+    WebProcess::singleton().eventDispatcher().removeThreadedCompositorForPage(m_webPage->pageID());
 }
 
 ThreadedCoordinatedLayerTreeHost::ThreadedCoordinatedLayerTreeHost(WebPage* webPage)
@@ -76,8 +81,11 @@ ThreadedCoordinatedLayerTreeHost::ThreadedCoordinatedLayerTreeHost(WebPage* webP
     m_coordinator->createRootLayer(m_webPage->size());
 
     CoordinatedSurface::setFactory(createCoordinatedSurface);
+    // Surfaces stay in this process with the threaded compositor, so they can hold undecoded planes.
+    CoordinatedSurface::setYUVFactory(YUVCoordinatedSurface::create);
 
     m_compositor = ThreadedCompositor::create(this, *webPage);
+    WebProcess::singleton().eventDispatcher().addThreadedCompositorForPage(m_webPage->pageID(), *m_compositor);
     scheduleLayerFlush();
 }
 
@@ -253,14 +261,94 @@ void ThreadedCoordinatedLayerTreeHost::performScheduledLayerFlush()
         return;
 
     m_coordinator->syncDisplayState();
+    // Style, layout and animation callbacks are done by now, so only the flush and the painting it triggers are timed.
+    m_layerFlushStartTime = monotonicallyIncreasingTime();
     bool didSync = m_coordinator->flushPendingLayerChanges();
 
+    // Layout is up to date after the flush, so this is when the areas that the compositor can't scroll on its own are known.
+    updateNonFastScrollableRegion();
+
     if (m_notifyAfterScheduledLayerFlush && didSync) {
         compositorDidFlushLayers();
         m_notifyAfterScheduledLayerFlush = false;
     }
 }
 
+// There is no ScrollingCoordinator on this platform, so this mirrors ScrollingCoordinator::absoluteNonFastScrollableRegionForFrame()
+// for what the compositing thread can and cannot scroll: areas with composited scrolling have a scrollable layer of their own.
+static WebCore::Region nonFastScrollableRegionForFrame(Frame& frame)
+{
+    WebCore::Region nonFastScrollableRegion;
+    FrameView* frameView = frame.view();
+    RenderView* renderView = frame.contentRenderer();
+    if (!frameView || !renderView || renderView->documentBeingDestroyed())
+        return nonFastScrollableRegion;
+
+    if (const FrameView::ScrollableAreaSet* scrollableAreas = frameView->scrollableAreas()) {
+        for (auto& scrollableArea : *scrollableAreas) {
+            if (scrollableArea->usesCompositedScrolling())
+                continue;
+
+            bool isInsideFixed;
+            IntRect box = scrollableArea->scrollableAreaBoundingBox(&isInsideFixed);
+            if (isInsideFixed)
+                box = IntRect(frameView->fixedScrollableAreaBoundsInflatedForScrolling(LayoutRect(box)));
+            nonFastScrollableRegion.unite(box);
+        }
+    }
+
+    for (Frame* subframe = frame.tree().firstChild(); subframe; subframe = subframe->tree().nextSibling()) {
+        FrameView* subframeView = subframe->view();
+        if (!subframeView)
+            continue;
+
+        WebCore::Region subframeRegion = nonFastScrollableRegionForFrame(*subframe);
+        IntPoint offset = frameView->viewToContents(subframeView->convertToContainingView(subframeView->contentsToView(IntPoint())));
+        subframeRegion.translate(toIntSize(offset));
+        nonFastScrollableRegion.unite(subframeRegion);
+    }
+
+    Document::RegionFixedPair wheelHandlerRegion = frame.document()->absoluteRegionForEventTargets(frame.document()->wheelEventTargets());
+    if (wheelHandlerRegion.second)
+        wheelHandlerRegion.first.unite(enclosingIntRect(frameView->fixedScrollableAreaBoundsInflatedForScrolling(LayoutRect(wheelHandlerRegion.first.bounds()))));
+    nonFastScrollableRegion.unite(wheelHandlerRegion.first);
+
+    return nonFastScrollableRegion;
+}
+
+void ThreadedCoordinatedLayerTreeHost::updateNonFastScrollableRegion()
+{
+    Frame& mainFrame = m_webPage->corePage()->mainFrame();
+    if (!mainFrame.view() || mainFrame.view()->needsLayout()) {
+        invalidateNonFastScrollableRegion();
+        return;
+    }
+
+    WebCore::Region nonFastScrollableRegion = nonFastScrollableRegionForFrame(mainFrame);
+    if (m_nonFastScrollableRegionIsValid && nonFastScrollableRegion == m_lastNonFastScrollableRegion)
+        return;
+
+    m_lastNonFastScrollableRegion = nonFastScrollableRegion;
+    m_nonFastScrollableRegionIsValid = true;
+    m_compositor->setNonFastScrollableRegion(nonFastScrollableRegion);
+}
+
+void ThreadedCoordinatedLayerTreeHost::invalidateNonFastScrollableRegion()
+{
+    if (!m_nonFastScrollableRegionIsValid)
+        return;
+
+    m_nonFastScrollableRegionIsValid = false;
+    m_compositor->invalidateNonFastScrollableRegion();
+}
+
+void ThreadedCoordinatedLayerTreeHost::wheelEventHandlersChanged()
+{
+    // Wheel events go to the main thread until the next flush has found where the handlers are.
+    invalidateNonFastScrollableRegion();
+    scheduleLayerFlush();
+}
+
 void ThreadedCoordinatedLayerTreeHost::purgeBackingStores()
 {
     m_coordinator->purgeBackingStores();
@@ -291,7 +379,8 @@ void ThreadedCoordinatedLayerTreeHost::notifyFlushRequired()
 void ThreadedCoordinatedLayerTreeHost::commitSceneState(const CoordinatedGraphicsState& state)
 {
     m_isWaitingForRenderer = true;
-    m_compositor->updateSceneState(state);
+    // The state is committed at the end of the flush, once the layer contents have been painted.
+    m_compositor->updateSceneState(state, monotonicallyIncreasingTime() - m_layerFlushStartTime);
 }
 
 void ThreadedCoordinatedLayerTreeHost::paintLayerContents(const GraphicsLayer*, GraphicsContext&, const IntRect&)
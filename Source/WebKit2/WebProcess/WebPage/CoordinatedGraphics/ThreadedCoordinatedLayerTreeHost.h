@@ -99,6 +99,8 @@ public:
 
     virtual void setViewOverlayRootLayer(WebCore::GraphicsLayer*) override;
 
+    virtual void wheelEventHandlersChanged() override;
+
     static PassRefPtr<WebCore::CoordinatedSurface> createCoordinatedSurface(const WebCore::IntSize&, WebCore::CoordinatedSurface::Flags);
 
 protected:
@@ -114,6 +116,9 @@ private:
     void cancelPendingLayerFlush();
     void performScheduledLayerFlush();
 
+    void updateNonFastScrollableRegion();
+    void invalidateNonFastScrollableRegion();
+
     WebCore::GraphicsLayer* rootLayer() { return m_coordinator->rootLayer(); }
 
     // ThreadedCompositor::Client
@@ -149,6 +154,9 @@ private:
 
     float m_lastScaleFactor;
     WebCore::IntPoint m_lastScrollPosition;
+    WebCore::Region m_lastNonFastScrollableRegion;
+    bool m_nonFastScrollableRegionIsValid { false };
+    double m_layerFlushStartTime { 0 };
 
     GSourceWrap::Static m_layerFlushTimer;
     bool m_layerFlushSchedulingEnabled;
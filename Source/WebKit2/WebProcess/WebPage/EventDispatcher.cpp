@@ -43,6 +43,10 @@
 #include <WebCore/ThreadedScrollingTree.h>
 #endif
 
+#if USE(COORDINATED_GRAPHICS_THREADED)
+#include "ThreadedCompositor.h"
+#endif
+
 using namespace WebCore;
 
 namespace WebKit {
@@ -83,6 +87,21 @@ void EventDispatcher::removeScrollingTreeForPage(WebPage* webPage)
 }
 #endif
 
+#if USE(COORDINATED_GRAPHICS_THREADED)
+void EventDispatcher::addThreadedCompositorForPage(uint64_t pageID, ThreadedCompositor& compositor)
+{
+    LockHolder locker(m_threadedCompositorsMutex);
+    ASSERT(!m_threadedCompositors.contains(pageID));
+    m_threadedCompositors.set(pageID, &compositor);
+}
+
+void EventDispatcher::removeThreadedCompositorForPage(uint64_t pageID)
+{
+    LockHolder locker(m_threadedCompositorsMutex);
+    m_threadedCompositors.remove(pageID);
+}
+#endif
+
 void EventDispatcher::initializeConnection(IPC::Connection* connection)
 {
     connection->addWorkQueueMessageReceiver(Messages::EventDispatcher::messageReceiverName(), &m_queue.get(), this);
@@ -138,6 +157,28 @@ void EventDispatcher::wheelEvent(uint64_t pageID, const WebWheelEvent& wheelEven
     UNUSED_PARAM(canRubberBandAtBottom);
 #endif
 
+#if USE(COORDINATED_GRAPHICS_THREADED)
+    {
+        LockHolder locker(m_threadedCompositorsMutex);
+        if (RefPtr<ThreadedCompositor> compositor = m_threadedCompositors.get(pageID)) {
+            // Every event goes through the compositing thread so that the ones it hands over to the
+            // main thread keep their order.
+            RefPtr<EventDispatcher> eventDispatcher = this;
+            compositor->handleWheelEvent(platformWheelEvent, [eventDispatcher, pageID, wheelEvent](bool didHandleEvent) {
+                if (didHandleEvent) {
+                    eventDispatcher->sendDidReceiveEvent(pageID, wheelEvent, true);
+                    return;
+                }
+
+                RunLoop::main().dispatch([eventDispatcher, pageID, wheelEvent] {
+                    eventDispatcher->dispatchWheelEvent(pageID, wheelEvent);
+                });
+            });
+            return;
+        }
+    }
+#endif
+
     RefPtr<EventDispatcher> eventDispatcher = this;
     RunLoop::main().dispatch([eventDispatcher, pageID, wheelEvent] {
         eventDispatcher->dispatchWheelEvent(pageID, wheelEvent);
@@ -237,7 +278,7 @@ void EventDispatcher::dispatchGestureEvent(uint64_t pageID, const WebGestureEven
 }
 #endif
 
-#if ENABLE(ASYNC_SCROLLING)
+#if ENABLE(ASYNC_SCROLLING) || USE(COORDINATED_GRAPHICS_THREADED)
 void EventDispatcher::sendDidReceiveEvent(uint64_t pageID, const WebEvent& event, bool didHandleEvent)
 {
     WebProcess::singleton().parentProcessConnection()->send(Messages::WebPageProxy::DidReceiveEvent(static_cast<uint32_t>(event.type()), didHandleEvent), pageID);
@@ -47,6 +47,7 @@ class ThreadedScrollingTree;
 
 namespace WebKit {
 
+class ThreadedCompositor;
 class WebEvent;
 class WebPage;
 class WebWheelEvent;
@@ -61,6 +62,11 @@ public:
     void removeScrollingTreeForPage(WebPage*);
 #endif
 
+#if USE(COORDINATED_GRAPHICS_THREADED)
+    void addThreadedCompositorForPage(uint64_t pageID, ThreadedCompositor&);
+    void removeThreadedCompositorForPage(uint64_t pageID);
+#endif
+
 #if ENABLE(IOS_TOUCH_EVENTS)
     typedef Vector<WebTouchEvent, 1> TouchEventQueue;
 
@@ -95,7 +101,7 @@ private:
     void dispatchGestureEvent(uint64_t pageID, const WebGestureEvent&);
 #endif
 
-#if ENABLE(ASYNC_SCROLLING)
+#if ENABLE(ASYNC_SCROLLING) || USE(COORDINATED_GRAPHICS_THREADED)
     void sendDidReceiveEvent(uint64_t pageID, const WebEvent&, bool didHandleEvent);
 #endif
 
@@ -104,6 +110,10 @@ private:
 #if ENABLE(ASYNC_SCROLLING)
     Lock m_scrollingTreesMutex;
     HashMap<uint64_t, RefPtr<WebCore::ThreadedScrollingTree>> m_scrollingTrees;
+#endif
+#if USE(COORDINATED_GRAPHICS_THREADED)
+    Lock m_threadedCompositorsMutex;
+    HashMap<uint64_t, RefPtr<ThreadedCompositor>> m_threadedCompositors;
 #endif
     std::unique_ptr<WebCore::WheelEventDeltaFilter> m_recentWheelEventDeltaFilter;
 #if ENABLE(IOS_TOUCH_EVENTS)
@@ -104,6 +104,8 @@ public:
 
     virtual void setViewOverlayRootLayer(WebCore::GraphicsLayer*) = 0;
 
+    virtual void wheelEventHandlersChanged() { }
+
 protected:
     explicit LayerTreeHost(WebPage*);
 
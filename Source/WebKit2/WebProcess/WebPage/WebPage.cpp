@@ -2858,6 +2858,7 @@ void WebPage::updatePreferences(const WebPreferencesStore& store)
 #endif
 
     settings.setShouldRespectImageOrientation(store.getBoolValueForKey(WebPreferencesKey::shouldRespectImageOrientationKey()));
+    settings.setAsyncImageDecodingEnabled(store.getBoolValueForKey(WebPreferencesKey::asyncImageDecodingEnabledKey()));
     settings.setStorageBlockingPolicy(static_cast<SecurityOrigin::StorageBlockingPolicy>(store.getUInt32ValueForKey(WebPreferencesKey::storageBlockingPolicyKey())));
     settings.setCookieEnabled(store.getBoolValueForKey(WebPreferencesKey::cookieEnabledKey()));
 
@@ -4158,6 +4159,10 @@ void WebPage::confirmCompositionForTesting(const String& compositionString)
 
 void WebPage::wheelEventHandlersChanged(bool hasHandlers)
 {
+    // Handlers can be added or moved without changing whether there are any.
+    if (LayerTreeHost* layerTreeHost = m_drawingArea ? m_drawingArea->layerTreeHost() : nullptr)
+        layerTreeHost->wheelEventHandlersChanged();
+
     if (m_hasWheelEventHandlers == hasHandlers)
         return;
 
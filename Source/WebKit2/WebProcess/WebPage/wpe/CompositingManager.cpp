@@ -59,11 +59,11 @@ uint32_t CompositingManager::constructRenderingTarget(uint32_t width, uint32_t h
     return handle;
 }
 
-void CompositingManager::commitBuffer(const WebCore::PlatformDisplayWPE::BufferExport& bufferExport)
+void CompositingManager::commitBuffer(const WebCore::PlatformDisplayWPE::BufferExport& bufferExport, const Vector<WebCore::IntRect>& damageRects)
 {
     m_connection->send(Messages::CompositingManagerProxy::CommitBuffer(
         IPC::Attachment(std::get<0>(bufferExport)),
-        IPC::DataReference(std::get<1>(bufferExport), std::get<2>(bufferExport))), 0);
+        IPC::DataReference(std::get<1>(bufferExport), std::get<2>(bufferExport)), damageRects), 0);
 }
 
 void CompositingManager::destroyBuffer(uint32_t handle)
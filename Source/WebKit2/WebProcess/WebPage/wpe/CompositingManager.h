@@ -28,7 +28,9 @@
 
 #include "Connection.h"
 #include "MessageReceiver.h"
+#include <WebCore/IntRect.h>
 #include <WebCore/PlatformDisplayWPE.h>
+#include <wtf/Vector.h>
 
 namespace WebKit {
 
@@ -47,7 +49,7 @@ public:
     void establishConnection(WebPage&, WTF::RunLoop&);
 
     uint32_t constructRenderingTarget(uint32_t, uint32_t);
-    void commitBuffer(const WebCore::PlatformDisplayWPE::BufferExport&);
+    void commitBuffer(const WebCore::PlatformDisplayWPE::BufferExport&, const Vector<WebCore::IntRect>& damageRects);
     void destroyBuffer(uint32_t);
 
     CompositingManager(const CompositingManager&) = delete;
@@ -0,0 +1,75 @@
+set(TESTWEBKITAPI_RUNTIME_OUTPUT_DIRECTORY "${CMAKE_RUNTIME_OUTPUT_DIRECTORY}/TestWebKitAPI")
+set(TESTWEBKITAPI_RUNTIME_OUTPUT_DIRECTORY_WTF "${TESTWEBKITAPI_RUNTIME_OUTPUT_DIRECTORY}/WTF")
+
+add_definitions(-DBUILDING_WEBKIT2__)
+
+add_custom_target(TestWebKitAPI-forwarding-headers
+    COMMAND ${PERL_EXECUTABLE} ${WEBKIT2_DIR}/Scripts/generate-forwarding-headers.pl --include-path ${TESTWEBKITAPI_DIR} --output ${FORWARDING_HEADERS_DIR} --platform wpe --platform soup
+    DEPENDS webkit2wpe-forwarding-headers
+)
+
+set(ForwardingHeadersForTestWebKitAPI_NAME TestWebKitAPI-forwarding-headers)
+
+include_directories(
+    ${FORWARDING_HEADERS_DIR}
+    ${FORWARDING_HEADERS_DIR}/JavaScriptCore
+)
+
+include_directories(SYSTEM
+    ${GLIB_INCLUDE_DIRS}
+    ${LIBSOUP_INCLUDE_DIRS}
+)
+
+set(test_main_SOURCES
+    ${TESTWEBKITAPI_DIR}/wpe/main.cpp
+)
+
+list(APPEND test_wtf_LIBRARIES
+    ${GLIB_LIBRARIES}
+)
+
+list(APPEND test_webcore_LIBRARIES
+    ${GLIB_LIBRARIES}
+)
+
+add_executable(TestWebCore
+    ${test_main_SOURCES}
+    ${TESTWEBKITAPI_DIR}/TestsController.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/AnimatedImageFrameCache.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/BitmapTextureUploadStream.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/BoxBlur.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/CoordinatedImageBacking.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/DamageHistory.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/DisplayList.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/FilterEffect.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/GIFImageDecoder.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/HarfBuzzShapeCache.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/ImageDecodingQueue.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/JPEGImageDecoder.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/LayoutUnit.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/PixelRowConversion.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/ShadowBlur.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/TextureMapperGL.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/URL.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/SharedBuffer.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/FileSystem.cpp
+    ${TESTWEBKITAPI_DIR}/Tests/WebCore/PublicSuffix.cpp
+)
+
+target_link_libraries(TestWebCore ${test_webcore_LIBRARIES})
+add_dependencies(TestWebCore ${ForwardingHeadersForTestWebKitAPI_NAME})
+
+add_test(TestWebCore ${TESTWEBKITAPI_RUNTIME_OUTPUT_DIRECTORY}/WebCore/TestWebCore)
+set_tests_properties(TestWebCore PROPERTIES TIMEOUT 60)
+set_target_properties(TestWebCore PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${TESTWEBKITAPI_RUNTIME_OUTPUT_DIRECTORY}/WebCore)
+
+list(APPEND TestWTF_SOURCES
+    ${TESTWEBKITAPI_DIR}/Tests/WTF/glib/GUniquePtr.cpp
+)
+
+# Relies on each queue running its own GLib main context.
+if (NOT USE_EPOLL_WORK_QUEUE)
+    list(APPEND TestWTF_SOURCES
+        ${TESTWEBKITAPI_DIR}/Tests/WTF/glib/WorkQueueGLib.cpp
+    )
+endif ()
@@ -25,6 +25,7 @@
 
 #include "config.h"
 
+#include <wtf/Threading.h>
 #include <wtf/text/AtomicString.h>
 
 namespace TestWebKitAPI {
@@ -61,4 +62,43 @@ TEST(WTF, AtomicStringExistingHash)
     ASSERT_EQ(string2.existingHash(), 0u);
 }
 
+#if USE(SHARED_ATOMIC_STRING_TABLE)
+TEST(WTF, AtomicStringSharedBetweenThreads)
+{
+    AtomicString mainThreadString("content-type");
+    StringImpl* mainThreadImpl = mainThreadString.impl();
+
+    const unsigned numThreads = 4;
+    const unsigned numIterations = 10000;
+    ThreadIdentifier threads[numThreads];
+    StringImpl* threadImpls[numThreads];
+
+    for (unsigned threadIndex = numThreads; threadIndex--;) {
+        threads[threadIndex] = createThread(
+            "AtomicString test thread",
+            [threadIndex, &threadImpls, numIterations] () {
+                for (unsigned i = numIterations; i--;) {
+                    AtomicString transient(String::number(i % 64));
+                    ASSERT_TRUE(transient.impl()->isAtomic());
+                }
+                AtomicString string("content-type");
+                threadImpls[threadIndex] = string.impl();
+                // Keep a reference alive past the thread's lifetime to exercise cross-thread derefs.
+                string.impl()->ref();
+            });
+    }
+
+    for (unsigned threadIndex = numThreads; threadIndex--;)
+        waitForThreadCompletion(threads[threadIndex]);
+
+    for (unsigned threadIndex = numThreads; threadIndex--;) {
+        EXPECT_EQ(mainThreadImpl, threadImpls[threadIndex]);
+        threadImpls[threadIndex]->deref();
+    }
+
+    EXPECT_TRUE(mainThreadString.string().isSafeToSendToAnotherThread());
+    EXPECT_EQ(mainThreadImpl, mainThreadString.string().isolatedCopy().impl());
+}
+#endif
+
 } // namespace TestWebKitAPI
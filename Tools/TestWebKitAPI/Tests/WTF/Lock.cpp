@@ -24,7 +24,9 @@
  */
 
 #include "config.h"
+#include <thread>
 #include <wtf/Lock.h>
+#include <wtf/LockProfiler.h>
 #include <wtf/Threading.h>
 #include <wtf/ThreadingPrimitives.h>
 #include <wtf/WordLock.h>
@@ -186,4 +188,40 @@ TEST(WTF_Lock, SectionAddressCollision)
     runLockTest<Lock>(4, 2, 10000, 2000);
 }
 
+TEST(WTF_Lock, ContentionProfiler)
+{
+    Lock lock;
+    LockProfiler::reset();
+    LockProfiler::setEnabled(true);
+
+    // Hold the lock long enough for the other thread to give up spinning and park.
+    lock.lock();
+    ThreadIdentifier thread = createThread("Lock profiler test thread", [&] {
+        lock.lock();
+        lock.unlock();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    lock.unlock();
+    waitForThreadCompletion(thread);
+
+    LockProfiler::setEnabled(false);
+
+    // The profiler is process-wide, so other locks of the process may have been contended meanwhile.
+    Vector<LockProfiler::SiteStatistics> sitesOfLock;
+    for (auto& site : LockProfiler::statistics()) {
+        for (unsigned i = 0; i < site.numberOfLocks && i < LockProfiler::SiteStatistics::maxTrackedLocks; ++i) {
+            if (site.locks[i] == &lock)
+                sitesOfLock.append(site);
+        }
+    }
+    ASSERT_EQ(1u, sitesOfLock.size());
+    EXPECT_EQ(1u, sitesOfLock[0].contendedAcquisitions);
+    EXPECT_EQ(1u, sitesOfLock[0].numberOfLocks);
+    EXPECT_GT(sitesOfLock[0].totalWaitTime, 0.01);
+    EXPECT_EQ(sitesOfLock[0].totalWaitTime, sitesOfLock[0].maxWaitTime);
+
+    LockProfiler::reset();
+    EXPECT_TRUE(LockProfiler::statistics().isEmpty());
+}
+
 } // namespace TestWebKitAPI
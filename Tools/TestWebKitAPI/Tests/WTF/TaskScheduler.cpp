@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <wtf/TaskScheduler.h>
+#include <wtf/Vector.h>
+#include <atomic>
+#include <thread>
+
+namespace TestWebKitAPI {
+
+TEST(WTF_TaskScheduler, TaskGroup)
+{
+    std::atomic<unsigned> counter { 0 };
+    TaskGroup group;
+    for (unsigned i = 0; i < 1000; ++i)
+        group.dispatch([&counter] { counter++; });
+    group.wait();
+    EXPECT_EQ(1000u, counter.load());
+}
+
+TEST(WTF_TaskScheduler, NestedTaskGroups)
+{
+    std::atomic<unsigned> counter { 0 };
+    TaskGroup outerGroup;
+    for (unsigned i = 0; i < 16; ++i) {
+        outerGroup.dispatch([&counter] {
+            TaskGroup innerGroup(TaskScheduler::Priority::High);
+            for (unsigned j = 0; j < 16; ++j)
+                innerGroup.dispatch([&counter] { counter++; });
+            innerGroup.wait();
+        });
+    }
+    outerGroup.wait();
+    EXPECT_EQ(256u, counter.load());
+}
+
+TEST(WTF_TaskScheduler, WaitOnlyRunsTasksOfItsGroup)
+{
+    if (!TaskScheduler::singleton().numberOfWorkers())
+        return;
+
+    ThreadIdentifier waitingThread = currentThread();
+    const unsigned numberOfUnrelatedTasks = 64;
+    std::atomic<unsigned> unrelatedTasksRun { 0 };
+    std::atomic<unsigned> unrelatedTasksRunByWaitingThread { 0 };
+    for (unsigned i = 0; i < numberOfUnrelatedTasks; ++i) {
+        TaskScheduler::singleton().dispatch([&] {
+            if (currentThread() == waitingThread)
+                unrelatedTasksRunByWaitingThread++;
+            unrelatedTasksRun++;
+        }, TaskScheduler::Priority::Low);
+    }
+
+    std::atomic<unsigned> counter { 0 };
+    TaskGroup group(TaskScheduler::Priority::Low);
+    for (unsigned i = 0; i < 1000; ++i)
+        group.dispatch([&counter] { counter++; });
+    group.wait();
+    EXPECT_EQ(1000u, counter.load());
+
+    while (unrelatedTasksRun.load() < numberOfUnrelatedTasks)
+        std::this_thread::yield();
+    EXPECT_EQ(0u, unrelatedTasksRunByWaitingThread.load());
+}
+
+TEST(WTF_TaskScheduler, ParallelFor)
+{
+    const size_t size = 10000;
+    Vector<unsigned> values(size, 0);
+    parallelFor(0, size, [&values] (size_t index) {
+        values[index] += index;
+    }, 16);
+
+    for (size_t i = 0; i < size; ++i)
+        EXPECT_EQ(i, values[i]);
+}
+
+TEST(WTF_TaskScheduler, ParallelForEmptyRange)
+{
+    bool called = false;
+    parallelFor(5, 5, [&called] (size_t) { called = true; });
+    EXPECT_FALSE(called);
+}
+
+} // namespace TestWebKitAPI
@@ -32,6 +32,13 @@
 #include <wtf/WorkQueue.h>
 #include <string>
 #include <thread>
+#include <wtf/CurrentTime.h>
+#include <wtf/DataLog.h>
+
+#if USE(EPOLL_WORK_QUEUE)
+#include <unistd.h>
+#include <wtf/NumberOfCores.h>
+#endif
 
 namespace TestWebKitAPI {
 
@@ -200,4 +207,149 @@ TEST(WTF_WorkQueue, DispatchAfter)
     EXPECT_STREQ(dispatchAfterLabel, m_functionCallOrder[1].c_str());
 }
 
+TEST(WTF_WorkQueue, ConcurrentApply)
+{
+    static const size_t iterations = 1000;
+    Vector<std::atomic<unsigned>> counts(iterations);
+    for (auto& count : counts)
+        count = 0;
+
+    WorkQueue::concurrentApply(iterations, [&](size_t index) {
+        counts[index]++;
+    });
+
+    for (auto& count : counts)
+        EXPECT_EQ(1u, count.load());
+}
+
+// The GLib backend wraps the descriptor in a GSocket, which does not accept pipes.
+#if USE(EPOLL_WORK_QUEUE)
+TEST(WTF_WorkQueue, SocketEventHandler)
+{
+    Lock lock;
+    Condition condition;
+    Vector<char> received;
+    bool closed = false;
+
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+
+    auto queue = WorkQueue::create("com.apple.WebKit.Test.socketEventHandler");
+    queue->registerSocketEventHandler(fds[0], [&] {
+        char c;
+        if (read(fds[0], &c, 1) != 1)
+            return;
+        LockHolder locker(lock);
+        received.append(c);
+        condition.notifyOne();
+    }, [&] {
+        LockHolder locker(lock);
+        closed = true;
+        condition.notifyOne();
+    });
+
+    LockHolder locker(lock);
+    for (char c = 'a'; c <= 'c'; ++c) {
+        EXPECT_EQ(1, write(fds[1], &c, 1));
+        condition.wait(lock, [&] { return received.size() == static_cast<size_t>(c - 'a' + 1); });
+    }
+    EXPECT_EQ('a', received[0]);
+    EXPECT_EQ('b', received[1]);
+    EXPECT_EQ('c', received[2]);
+
+    close(fds[1]);
+    condition.wait(lock, [&] { return closed; });
+    EXPECT_TRUE(closed);
+
+    queue->unregisterSocketEventHandler(fds[0]);
+    close(fds[0]);
+}
+
+// The shared pool normally keeps at most max(4, 2 * cores) threads. Block more functions than that
+// on a function dispatched last to yet another queue: the pool has to grow past its normal size for
+// that function to run at all.
+TEST(WTF_WorkQueue, FunctionsWaitingOnOtherQueues)
+{
+    const unsigned numberOfWaitingQueues = 2 * std::max(4, 2 * WTF::numberOfProcessorCores());
+
+    Lock lock;
+    Condition condition;
+    bool released = false;
+    unsigned finishedQueues = 0;
+
+    Vector<Ref<WorkQueue>> queues;
+    for (unsigned i = 0; i < numberOfWaitingQueues; ++i) {
+        queues.append(WorkQueue::create("com.apple.WebKit.Test.waitingQueue"));
+        queues.last()->dispatch([&] {
+            LockHolder locker(lock);
+            condition.wait(lock, [&] { return released; });
+            finishedQueues++;
+            condition.notifyAll();
+        });
+    }
+
+    auto releasingQueue = WorkQueue::create("com.apple.WebKit.Test.releasingQueue");
+    releasingQueue->dispatch([&] {
+        LockHolder locker(lock);
+        released = true;
+        condition.notifyAll();
+    });
+
+    LockHolder locker(lock);
+    condition.wait(lock, [&] { return finishedQueues == numberOfWaitingQueues; });
+    EXPECT_TRUE(released);
+}
+#endif
+
+// Not a correctness test so much as a benchmark: many serial queues each receive a stream of small
+// functions, which must still run in order per queue. Reports the overall dispatch throughput.
+TEST(WTF_WorkQueue, SerialQueueThroughput)
+{
+    static const unsigned numberOfQueues = 16;
+    static const unsigned functionsPerQueue = 20000;
+
+    Lock lock;
+    Condition condition;
+    unsigned finishedQueues = 0;
+    Vector<Ref<WorkQueue>> queues;
+    Vector<unsigned> lastSeen(numberOfQueues);
+    Vector<bool> inOrder(numberOfQueues);
+
+    for (unsigned i = 0; i < numberOfQueues; ++i) {
+        queues.append(WorkQueue::create("com.apple.WebKit.Test.throughput"));
+        lastSeen[i] = 0;
+        inOrder[i] = true;
+    }
+
+    double start = monotonicallyIncreasingTime();
+    for (unsigned n = 1; n <= functionsPerQueue; ++n) {
+        for (unsigned i = 0; i < numberOfQueues; ++i) {
+            queues[i]->dispatch([&, i, n] {
+                if (lastSeen[i] + 1 != n)
+                    inOrder[i] = false;
+                lastSeen[i] = n;
+                if (n == functionsPerQueue) {
+                    LockHolder locker(lock);
+                    finishedQueues++;
+                    condition.notifyOne();
+                }
+            });
+        }
+    }
+
+    {
+        LockHolder locker(lock);
+        condition.wait(lock, [&] { return finishedQueues == numberOfQueues; });
+    }
+    double elapsed = monotonicallyIncreasingTime() - start;
+
+    for (unsigned i = 0; i < numberOfQueues; ++i) {
+        EXPECT_TRUE(inOrder[i]);
+        EXPECT_EQ(functionsPerQueue, lastSeen[i]);
+    }
+
+    dataLogF("WorkQueue throughput: %u functions on %u queues in %.1f ms (%.0f functions/s)\n",
+        numberOfQueues * functionsPerQueue, numberOfQueues, elapsed * 1000, numberOfQueues * functionsPerQueue / elapsed);
+}
+
 } // namespace TestWebKitAPI
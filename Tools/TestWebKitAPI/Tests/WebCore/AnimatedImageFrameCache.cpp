@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <WebCore/AnimatedImageFrameCache.h>
+#include <wtf/MainThread.h>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+static const size_t frameBytes = 1000;
+
+// Stands for an animated image with |frameCount| decoded frames of frameBytes each.
+class TestImage : public AnimatedImageFrameCache::Client {
+public:
+    explicit TestImage(bool isAnimatingOrVisible = false)
+        : m_isAnimatingOrVisible(isAnimatingOrVisible)
+    {
+    }
+
+    ~TestImage()
+    {
+        AnimatedImageFrameCache::singleton().remove(*this);
+    }
+
+    void setFrameCount(unsigned frameCount)
+    {
+        m_frameCount = frameCount;
+        AnimatedImageFrameCache::singleton().decodedSizeChanged(*this, m_frameCount * frameBytes);
+    }
+
+    void requestFrame()
+    {
+        AnimatedImageFrameCache::singleton().didRequestFrame(*this, true);
+    }
+
+    unsigned frameCount() const { return m_frameCount; }
+
+private:
+    virtual void evictNonCurrentFrames() override
+    {
+        setFrameCount(std::min(m_frameCount, 1u));
+    }
+
+    virtual void evictAllFrames() override
+    {
+        setFrameCount(0);
+    }
+
+    virtual bool isAnimatingOrVisible() override { return m_isAnimatingOrVisible; }
+
+    unsigned m_frameCount { 0 };
+    bool m_isAnimatingOrVisible;
+};
+
+class AnimatedImageFrameCacheTest : public testing::Test {
+public:
+    void SetUp() override
+    {
+        WTF::initializeMainThread();
+        m_initialStats = AnimatedImageFrameCache::singleton().stats();
+    }
+
+    void TearDown() override
+    {
+        AnimatedImageFrameCache::singleton().setMemoryBudget(m_initialStats.memoryBudget);
+    }
+
+protected:
+    AnimatedImageFrameCache::Stats m_initialStats;
+};
+
+TEST_F(AnimatedImageFrameCacheTest, AccountsForDecodedBytes)
+{
+    AnimatedImageFrameCache& cache = AnimatedImageFrameCache::singleton();
+    cache.setMemoryBudget(100 * frameBytes);
+
+    TestImage first;
+    TestImage second;
+    first.setFrameCount(3);
+    second.setFrameCount(5);
+    EXPECT_EQ(2u, cache.stats().imageCount);
+    EXPECT_EQ(8 * frameBytes, cache.stats().bytes);
+
+    // Sizes are replaced, not added up.
+    first.setFrameCount(4);
+    EXPECT_EQ(9 * frameBytes, cache.stats().bytes);
+    second.setFrameCount(1);
+    EXPECT_EQ(5 * frameBytes, cache.stats().bytes);
+
+    // Images without decoded frames leave the cache.
+    second.setFrameCount(0);
+    EXPECT_EQ(1u, cache.stats().imageCount);
+    EXPECT_EQ(4 * frameBytes, cache.stats().bytes);
+
+    cache.remove(first);
+    EXPECT_EQ(0u, cache.stats().imageCount);
+    EXPECT_EQ(0u, cache.stats().bytes);
+}
+
+TEST_F(AnimatedImageFrameCacheTest, CountsHitsAndMisses)
+{
+    AnimatedImageFrameCache& cache = AnimatedImageFrameCache::singleton();
+    TestImage image;
+    image.setFrameCount(1);
+
+    cache.didRequestFrame(image, true);
+    cache.didRequestFrame(image, true);
+    cache.didRequestFrame(image, false);
+    EXPECT_EQ(m_initialStats.hits + 2, cache.stats().hits);
+    EXPECT_EQ(m_initialStats.misses + 1, cache.stats().misses);
+}
+
+TEST_F(AnimatedImageFrameCacheTest, NonCurrentFramesGoFirst)
+{
+    AnimatedImageFrameCache& cache = AnimatedImageFrameCache::singleton();
+    cache.setMemoryBudget(10 * frameBytes);
+
+    TestImage first;
+    TestImage second;
+    TestImage third;
+    first.setFrameCount(4);
+    second.setFrameCount(4);
+
+    // 12 frames are over the budget; dropping 3 frames of the least recently used image is enough.
+    third.setFrameCount(4);
+    EXPECT_EQ(1u, first.frameCount());
+    EXPECT_EQ(4u, second.frameCount());
+    EXPECT_EQ(4u, third.frameCount());
+    EXPECT_EQ(3u, cache.stats().imageCount);
+    EXPECT_EQ(9 * frameBytes, cache.stats().bytes);
+    EXPECT_EQ(m_initialStats.trimmedImages + 1, cache.stats().trimmedImages);
+    EXPECT_EQ(m_initialStats.evictedImages, cache.stats().evictedImages);
+}
+
+TEST_F(AnimatedImageFrameCacheTest, LeastRecentlyUsedImagesGoFirst)
+{
+    AnimatedImageFrameCache& cache = AnimatedImageFrameCache::singleton();
+    cache.setMemoryBudget(10 * frameBytes);
+
+    TestImage first;
+    TestImage second;
+    TestImage third;
+    first.setFrameCount(4);
+    second.setFrameCount(4);
+
+    // Asking for a frame makes the first image the most recently used one.
+    first.requestFrame();
+    third.setFrameCount(4);
+    EXPECT_EQ(4u, first.frameCount());
+    EXPECT_EQ(1u, second.frameCount());
+    EXPECT_EQ(4u, third.frameCount());
+
+    // Losing frames doesn't count as a use: the second image is still the least recently used one,
+    // so it is the first to go when dropping non-current frames isn't enough.
+    third.setFrameCount(9);
+    EXPECT_EQ(1u, first.frameCount());
+    EXPECT_EQ(0u, second.frameCount());
+    EXPECT_EQ(9u, third.frameCount());
+    EXPECT_EQ(10 * frameBytes, cache.stats().bytes);
+}
+
+TEST_F(AnimatedImageFrameCacheTest, ImagesInUseKeepTheirCurrentFrame)
+{
+    AnimatedImageFrameCache& cache = AnimatedImageFrameCache::singleton();
+    cache.setMemoryBudget(10 * frameBytes);
+
+    TestImage visible(true);
+    TestImage hidden;
+    TestImage growing;
+    visible.setFrameCount(3);
+    hidden.setFrameCount(3);
+
+    // Dropping all the non-current frames is not enough; only the hidden image goes away entirely.
+    growing.setFrameCount(9);
+    EXPECT_EQ(1u, visible.frameCount());
+    EXPECT_EQ(0u, hidden.frameCount());
+    EXPECT_EQ(9u, growing.frameCount());
+    EXPECT_EQ(2u, cache.stats().imageCount);
+    EXPECT_EQ(10 * frameBytes, cache.stats().bytes);
+    EXPECT_EQ(m_initialStats.trimmedImages + 2, cache.stats().trimmedImages);
+    EXPECT_EQ(m_initialStats.evictedImages + 1, cache.stats().evictedImages);
+
+    // Over the budget with nothing left to drop, the images in use keep their current frame.
+    growing.setFrameCount(10);
+    EXPECT_EQ(1u, visible.frameCount());
+    EXPECT_EQ(11 * frameBytes, cache.stats().bytes);
+}
+
+TEST_F(AnimatedImageFrameCacheTest, LoweringTheBudgetEvicts)
+{
+    AnimatedImageFrameCache& cache = AnimatedImageFrameCache::singleton();
+    cache.setMemoryBudget(10 * frameBytes);
+
+    TestImage first;
+    TestImage second;
+    first.setFrameCount(4);
+    second.setFrameCount(4);
+
+    cache.setMemoryBudget(2 * frameBytes);
+    EXPECT_EQ(1u, first.frameCount());
+    EXPECT_EQ(1u, second.frameCount());
+    EXPECT_EQ(2 * frameBytes, cache.stats().bytes);
+
+    cache.setMemoryBudget(frameBytes);
+    EXPECT_EQ(0u, first.frameCount());
+    EXPECT_EQ(1u, second.frameCount());
+}
+
+TEST_F(AnimatedImageFrameCacheTest, MemoryPressureEvictsEverything)
+{
+    AnimatedImageFrameCache& cache = AnimatedImageFrameCache::singleton();
+    cache.setMemoryBudget(10 * frameBytes);
+
+    TestImage visible(true);
+    TestImage hidden;
+    visible.setFrameCount(3);
+    hidden.setFrameCount(3);
+
+    cache.evictAllImages();
+    EXPECT_EQ(0u, visible.frameCount());
+    EXPECT_EQ(0u, hidden.frameCount());
+    EXPECT_EQ(0u, cache.stats().imageCount);
+    EXPECT_EQ(0u, cache.stats().bytes);
+    EXPECT_EQ(m_initialStats.evictedImages + 2, cache.stats().evictedImages);
+}
+
+} // namespace TestWebKitAPI
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#if USE(TEXTURE_MAPPER_GL) && USE(EGL)
+
+#include <WebCore/BitmapTextureUploadStream.h>
+#include <WebCore/GLContextEGL.h>
+#include <WebCore/GraphicsContext3D.h>
+#include <cstdlib>
+#include <wtf/MainThread.h>
+#include <wtf/Vector.h>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+class BitmapTextureUploadStreamTest : public testing::Test {
+public:
+    void SetUp() override
+    {
+        WTF::initializeMainThread();
+
+        // Renders on a surfaceless display, through Mesa's software rasterizer when there is no GPU.
+        setenv("WPE_BACKEND", "headless", 0);
+        m_glContext = GLContextEGL::createPbufferContext(IntSize(1, 1), nullptr);
+        ASSERT_TRUE(m_glContext.get());
+        m_glContext->makeContextCurrent();
+
+        m_context = GraphicsContext3D::createForCurrentGLContext();
+        ASSERT_TRUE(m_context);
+        m_stream = BitmapTextureUploadStream::forContext(*m_context);
+        ASSERT_TRUE(m_stream);
+    }
+
+    void TearDown() override
+    {
+        if (m_texture)
+            m_context->deleteTexture(m_texture);
+        m_stream = nullptr;
+        m_context = nullptr;
+        m_glContext = nullptr;
+    }
+
+    void createTexture(const IntSize& size)
+    {
+        m_textureSize = size;
+        m_texture = m_context->createTexture();
+        m_context->bindTexture(GraphicsContext3D::TEXTURE_2D, m_texture);
+        Vector<uint32_t> zeros(size.area(), 0);
+        m_context->texImage2DDirect(GraphicsContext3D::TEXTURE_2D, 0, GraphicsContext3D::RGBA, size.width(), size.height(), 0, GraphicsContext3D::RGBA, GraphicsContext3D::UNSIGNED_BYTE, zeros.data());
+    }
+
+    bool upload(const Vector<uint32_t>& pixels, const IntRect& targetRect, int bytesPerLine)
+    {
+        m_context->bindTexture(GraphicsContext3D::TEXTURE_2D, m_texture);
+        return m_stream->upload(pixels.data(), targetRect, bytesPerLine, 4, GraphicsContext3D::RGBA, GraphicsContext3D::UNSIGNED_BYTE);
+    }
+
+    Vector<uint32_t> readTexture()
+    {
+        Platform3DObject framebuffer = m_context->createFramebuffer();
+        m_context->bindFramebuffer(GraphicsContext3D::FRAMEBUFFER, framebuffer);
+        m_context->framebufferTexture2D(GraphicsContext3D::FRAMEBUFFER, GraphicsContext3D::COLOR_ATTACHMENT0, GraphicsContext3D::TEXTURE_2D, m_texture, 0);
+
+        Vector<uint32_t> pixels(m_textureSize.area(), 0);
+        m_context->readPixels(0, 0, m_textureSize.width(), m_textureSize.height(), GraphicsContext3D::RGBA, GraphicsContext3D::UNSIGNED_BYTE, pixels.data());
+
+        m_context->bindFramebuffer(GraphicsContext3D::FRAMEBUFFER, 0);
+        m_context->deleteFramebuffer(framebuffer);
+        return pixels;
+    }
+
+protected:
+    std::unique_ptr<GLContextEGL> m_glContext;
+    RefPtr<GraphicsContext3D> m_context;
+    RefPtr<BitmapTextureUploadStream> m_stream;
+    Platform3DObject m_texture { 0 };
+    IntSize m_textureSize;
+};
+
+static uint32_t tileColor(unsigned index)
+{
+    return 0xff000000 | (index * 0x0a0b0c);
+}
+
+TEST_F(BitmapTextureUploadStreamTest, UploadsOutliveTheirBuffers)
+{
+    // More uploads than the ring can have buffers, all in one frame. Buffers are reused as soon as
+    // their fences signal, which software rasterizers do right away, or else the ring fills up and
+    // the stream has to wait for the oldest one. An upload overwritten too early shows up as a tile
+    // with the color of a later one.
+    static const unsigned tileSize = 32;
+    static const unsigned tileCount = 20;
+    createTexture(IntSize(tileSize * tileCount, tileSize));
+
+    // The source rows are padded, which the stream has to pack.
+    static const unsigned padding = 8;
+    int bytesPerLine = (tileSize + padding) * 4;
+    for (unsigned i = 0; i < tileCount; ++i) {
+        Vector<uint32_t> pixels((tileSize + padding) * tileSize, tileColor(i));
+        for (unsigned y = 0; y < tileSize; ++y) {
+            for (unsigned x = tileSize; x < tileSize + padding; ++x)
+                pixels[y * (tileSize + padding) + x] = 0xffffffff;
+        }
+        EXPECT_TRUE(upload(pixels, IntRect(i * tileSize, 0, tileSize, tileSize), bytesPerLine));
+    }
+    m_stream->didFinishFrame();
+
+    Vector<uint32_t> contents = readTexture();
+    for (unsigned y = 0; y < tileSize; ++y) {
+        for (unsigned x = 0; x < tileSize * tileCount; ++x)
+            ASSERT_EQ(tileColor(x / tileSize), contents[y * tileSize * tileCount + x]) << "at " << x << ", " << y;
+    }
+}
+
+TEST_F(BitmapTextureUploadStreamTest, UploadsOverTheFrameBudgetAreRefused)
+{
+    // 2304x2048 pixels are 18MB, over the 16MB the stream takes per frame.
+    static const IntSize largeSize(2304, 2048);
+    createTexture(largeSize);
+
+    IntRect tile(0, 0, 256, 256);
+    EXPECT_TRUE(upload(Vector<uint32_t>(tile.size().area(), tileColor(1)), tile, tile.width() * 4));
+
+    EXPECT_FALSE(m_stream->hasBudgetFor(largeSize));
+    EXPECT_FALSE(upload(Vector<uint32_t>(largeSize.area(), tileColor(2)), IntRect(IntPoint(), largeSize), largeSize.width() * 4));
+
+    // The refused upload left the texture untouched.
+    Vector<uint32_t> contents = readTexture();
+    EXPECT_EQ(tileColor(1), contents[0]);
+    EXPECT_EQ(tileColor(1), contents[255 * largeSize.width() + 255]);
+    EXPECT_EQ(0u, contents[256]);
+    EXPECT_EQ(0u, contents[largeSize.area() - 1]);
+
+    // The budget is per frame, but even a new one can't take the whole texture at once.
+    m_stream->didFinishFrame();
+    EXPECT_TRUE(m_stream->hasBudgetFor(IntSize(2048, 2048)));
+    EXPECT_FALSE(m_stream->hasBudgetFor(largeSize));
+
+    // Up to the budget, the frame's uploads all go through.
+    IntRect firstHalf(0, 0, 2048, 1024);
+    IntRect secondHalf(0, 1024, 2048, 1024);
+    EXPECT_TRUE(upload(Vector<uint32_t>(firstHalf.size().area(), tileColor(3)), firstHalf, firstHalf.width() * 4));
+    EXPECT_TRUE(upload(Vector<uint32_t>(secondHalf.size().area(), tileColor(4)), secondHalf, secondHalf.width() * 4));
+    EXPECT_FALSE(m_stream->hasBudgetFor(IntSize(1, 1)));
+    m_stream->didFinishFrame();
+
+    contents = readTexture();
+    EXPECT_EQ(tileColor(3), contents[0]);
+    EXPECT_EQ(tileColor(3), contents[1023 * largeSize.width() + 2047]);
+    EXPECT_EQ(tileColor(4), contents[1024 * largeSize.width()]);
+    EXPECT_EQ(tileColor(4), contents[2047 * largeSize.width() + 2047]);
+    EXPECT_EQ(0u, contents[2048]);
+}
+
+TEST_F(BitmapTextureUploadStreamTest, StreamIsSharedByTheContext)
+{
+    EXPECT_EQ(m_stream.get(), BitmapTextureUploadStream::forContext(*m_context).get());
+}
+
+} // namespace TestWebKitAPI
+
+#endif // USE(TEXTURE_MAPPER_GL) && USE(EGL)
@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <WebCore/BoxBlur.h>
+#include <wtf/Vector.h>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+static Vector<uint8_t> randomPixels(int width, int height, unsigned seed)
+{
+    Vector<uint8_t> pixels(width * height * 4);
+    for (auto& channel : pixels) {
+        seed = seed * 1103515245 + 12345;
+        channel = seed >> 16;
+    }
+    // Runs of transparent and opaque pixels, like the edges of a shape.
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width / 4; ++x)
+            pixels[(y * width + x) * 4 + 3] = 0;
+        for (int x = width / 2; x < width * 3 / 4; ++x)
+            pixels[(y * width + x) * 4 + 3] = 255;
+    }
+    return pixels;
+}
+
+// The kernel positions of the three passes of FEGaussianBlur.
+static void kernelPosition(int blurIteration, unsigned& radius, int& deltaLeft, int& deltaRight)
+{
+    switch (blurIteration) {
+    case 0:
+        if (!(radius % 2)) {
+            deltaLeft = radius / 2 - 1;
+            deltaRight = radius - deltaLeft;
+        } else {
+            deltaLeft = radius / 2;
+            deltaRight = radius - deltaLeft;
+        }
+        break;
+    case 1:
+        if (!(radius % 2)) {
+            deltaLeft++;
+            deltaRight--;
+        }
+        break;
+    case 2:
+        if (!(radius % 2)) {
+            deltaRight++;
+            radius++;
+        }
+        break;
+    }
+}
+
+// The scalar RGBA box blur FEGaussianBlur used before boxBlurPixelLines().
+static void oldFEGaussianBlurBoxBlur(const uint8_t* srcData, uint8_t* dstData, unsigned dx, int dxLeft, int dxRight, int stride, int strideLine, int effectWidth, int effectHeight, BoxBlurEdgeMode edgeMode)
+{
+    const int maxKernelSize = std::min(dxRight, effectWidth);
+    for (int y = 0; y < effectHeight; ++y) {
+        int line = y * strideLine;
+        int sum[4] = { 0, 0, 0, 0 };
+
+        if (edgeMode == BoxBlurEdgeMode::Transparent) {
+            for (int i = 0; i < maxKernelSize; ++i) {
+                for (int c = 0; c < 4; ++c)
+                    sum[c] += srcData[line + i * stride + c];
+            }
+
+            for (int x = 0; x < effectWidth; ++x) {
+                int pixelByteOffset = line + x * stride;
+                for (int c = 0; c < 4; ++c)
+                    dstData[pixelByteOffset + c] = sum[c] / dx;
+                if (x >= dxLeft) {
+                    for (int c = 0; c < 4; ++c)
+                        sum[c] -= srcData[pixelByteOffset - dxLeft * stride + c];
+                }
+                if (x + dxRight < effectWidth) {
+                    for (int c = 0; c < 4; ++c)
+                        sum[c] += srcData[pixelByteOffset + dxRight * stride + c];
+                }
+            }
+        } else {
+            const uint8_t* edgeValueLeft = srcData + line;
+            const uint8_t* edgeValueRight = srcData + line + (effectWidth - 1) * stride;
+
+            for (int i = -dxLeft; i < dxRight; ++i) {
+                const uint8_t* pixel = i < 0 ? edgeValueLeft : i >= effectWidth ? edgeValueRight : srcData + line + i * stride;
+                for (int c = 0; c < 4; ++c)
+                    sum[c] += pixel[c];
+            }
+
+            for (int x = 0; x < effectWidth; ++x) {
+                int pixelByteOffset = line + x * stride;
+                for (int c = 0; c < 4; ++c)
+                    dstData[pixelByteOffset + c] = sum[c] / dx;
+                const uint8_t* leaving = x < dxLeft ? edgeValueLeft : srcData + pixelByteOffset - dxLeft * stride;
+                const uint8_t* entering = x + dxRight >= effectWidth ? edgeValueRight : srcData + pixelByteOffset + dxRight * stride;
+                for (int c = 0; c < 4; ++c)
+                    sum[c] += entering[c] - leaving[c];
+            }
+        }
+    }
+}
+
+// Blurs the image with the three passes per axis of FEGaussianBlur, with either box blur.
+static Vector<uint8_t> gaussianBlur(const Vector<uint8_t>& image, int width, int height, unsigned kernelSizeX, unsigned kernelSizeY, BoxBlurEdgeMode edgeMode, bool useOldBoxBlur)
+{
+    Vector<uint8_t> source = image;
+    Vector<uint8_t> destination(image.size());
+    int stride = width * 4;
+    int dxLeft = 0, dxRight = 0, dyLeft = 0, dyRight = 0;
+    for (int i = 0; i < 3; ++i) {
+        if (kernelSizeX) {
+            kernelPosition(i, kernelSizeX, dxLeft, dxRight);
+            if (useOldBoxBlur)
+                oldFEGaussianBlurBoxBlur(source.data(), destination.data(), kernelSizeX, dxLeft, dxRight, 4, stride, width, height, edgeMode);
+            else
+                boxBlurPixelLines(source.data(), destination.data(), 4, stride, width, height, dxLeft, dxRight - 1, edgeMode);
+            source.swap(destination);
+        }
+        if (kernelSizeY) {
+            kernelPosition(i, kernelSizeY, dyLeft, dyRight);
+            if (useOldBoxBlur)
+                oldFEGaussianBlurBoxBlur(source.data(), destination.data(), kernelSizeY, dyLeft, dyRight, stride, 4, height, width, edgeMode);
+            else
+                boxBlurPixelLines(source.data(), destination.data(), stride, 4, height, width, dyLeft, dyRight - 1, edgeMode);
+            source.swap(destination);
+        }
+    }
+    return source;
+}
+
+// The alpha-only blur ShadowBlur used before boxBlurChannelLines(), with exact divisions instead
+// of 17.15 fixed point ones.
+static void oldShadowBlur(uint8_t* imageData, int width, int height, int lobes[3][2])
+{
+    const int channels[4] = { 3, 0, 1, 3 };
+    int stride = 4;
+    int delta = width * 4;
+    int final = height;
+    int dim = width;
+
+    for (int pass = 0; pass < 2; ++pass) {
+        uint8_t* pixels = imageData;
+        for (int j = 0; j < final; ++j, pixels += delta) {
+            for (int step = 0; step < 3; ++step) {
+                int side1 = lobes[step][0];
+                int side2 = lobes[step][1];
+                int pixelCount = side1 + 1 + side2;
+                int ofs = 1 + side2;
+                int alpha1 = pixels[channels[step]];
+                int alpha2 = pixels[(dim - 1) * stride + channels[step]];
+
+                uint8_t* ptr = pixels + channels[step + 1];
+                uint8_t* prev = pixels + stride + channels[step];
+                uint8_t* next = pixels + ofs * stride + channels[step];
+
+                int i;
+                int sum = side1 * alpha1 + alpha1;
+                int limit = (dim < side2 + 1) ? dim : side2 + 1;
+
+                for (i = 1; i < limit; ++i, prev += stride)
+                    sum += *prev;
+
+                if (limit <= side2)
+                    sum += (side2 - limit + 1) * alpha2;
+
+                limit = (side1 < dim) ? side1 : dim;
+                for (i = 0; i < limit; ptr += stride, next += stride, ++i, ++ofs) {
+                    *ptr = sum / pixelCount;
+                    sum += ((ofs < dim) ? *next : alpha2) - alpha1;
+                }
+
+                prev = pixels + channels[step];
+                for (; ofs < dim; ptr += stride, prev += stride, next += stride, ++i, ++ofs) {
+                    *ptr = sum / pixelCount;
+                    sum += (*next) - (*prev);
+                }
+
+                for (; i < dim; ptr += stride, prev += stride, ++i) {
+                    *ptr = sum / pixelCount;
+                    sum += alpha2 - (*prev);
+                }
+            }
+        }
+
+        stride = width * 4;
+        delta = 4;
+        final = width;
+        dim = height;
+    }
+}
+
+static void newShadowBlur(uint8_t* imageData, int width, int height, int lobes[3][2])
+{
+    const int channels[4] = { 3, 0, 1, 3 };
+    for (int step = 0; step < 3; ++step)
+        boxBlurChannelLines(imageData + channels[step], imageData + channels[step + 1], 4, width * 4, width, height, lobes[step][0], lobes[step][1], BoxBlurEdgeMode::Duplicate);
+    for (int step = 0; step < 3; ++step)
+        boxBlurChannelLines(imageData + channels[step], imageData + channels[step + 1], width * 4, 4, height, width, lobes[step][0], lobes[step][1], BoxBlurEdgeMode::Duplicate);
+}
+
+static const int imageSizes[][2] = { { 1, 1 }, { 1, 7 }, { 3, 2 }, { 13, 5 }, { 37, 23 }, { 64, 64 }, { 101, 9 } };
+
+TEST(BoxBlur, PixelLinesMatchFEGaussianBlur)
+{
+    for (auto& size : imageSizes) {
+        Vector<uint8_t> image = randomPixels(size[0], size[1], size[0] * 31 + size[1]);
+        for (unsigned kernelSize : { 1, 2, 3, 4, 7, 10, 25, 60, 150 }) {
+            for (BoxBlurEdgeMode edgeMode : { BoxBlurEdgeMode::Transparent, BoxBlurEdgeMode::Duplicate }) {
+                Vector<uint8_t> expected = gaussianBlur(image, size[0], size[1], kernelSize, kernelSize / 2, edgeMode, true);
+                Vector<uint8_t> actual = gaussianBlur(image, size[0], size[1], kernelSize, kernelSize / 2, edgeMode, false);
+                EXPECT_TRUE(expected == actual) << size[0] << "x" << size[1] << ", kernel " << kernelSize << (edgeMode == BoxBlurEdgeMode::Duplicate ? ", duplicate" : ", none");
+            }
+        }
+    }
+}
+
+TEST(BoxBlur, WindowsOfOnePixelAreCopied)
+{
+    Vector<uint8_t> image = randomPixels(17, 3, 5);
+    Vector<uint8_t> blurred(image.size());
+    boxBlurPixelLines(image.data(), blurred.data(), 4, 17 * 4, 17, 3, 0, 0, BoxBlurEdgeMode::Transparent);
+    EXPECT_TRUE(image == blurred);
+}
+
+TEST(BoxBlur, ChannelLinesMatchShadowBlur)
+{
+    for (auto& size : imageSizes) {
+        Vector<uint8_t> image = randomPixels(size[0], size[1], size[0] * 17 + size[1]);
+        for (int radius : { 1, 2, 5, 16, 40 }) {
+            // Lobes like the ones ShadowBlur gives an even and an odd diameter.
+            int lobes[3][2] = { { radius / 2, radius / 2 }, { radius / 2, radius / 2 - 1 }, { radius / 2 - 1 + (radius == 1), radius / 2 } };
+            for (auto& lobe : lobes) {
+                lobe[0] = std::max(lobe[0], 0);
+                lobe[1] = std::max(lobe[1], 0);
+            }
+
+            Vector<uint8_t> expected = image;
+            oldShadowBlur(expected.data(), size[0], size[1], lobes);
+            Vector<uint8_t> actual = image;
+            newShadowBlur(actual.data(), size[0], size[1], lobes);
+
+            bool alphaMatches = true;
+            for (size_t i = 3; i < image.size(); i += 4)
+                alphaMatches &= expected[i] == actual[i];
+            EXPECT_TRUE(alphaMatches) << size[0] << "x" << size[1] << ", radius " << radius;
+        }
+    }
+}
+
+TEST(BoxBlur, ChannelLinesOnlyWriteTheirChannel)
+{
+    const int width = 9;
+    const int height = 6;
+    Vector<uint8_t> image = randomPixels(width, height, 3);
+    Vector<uint8_t> blurred = image;
+    // Columns, with a last group of two lines.
+    boxBlurChannelLines(blurred.data() + 3, blurred.data() + 1, width * 4, 4, height, width, 2, 2, BoxBlurEdgeMode::Transparent);
+    for (size_t i = 0; i < image.size(); ++i) {
+        if (i % 4 != 1)
+            EXPECT_EQ(image[i], blurred[i]) << i;
+    }
+
+    Vector<uint8_t> expected(image.size());
+    boxBlurPixelLines(image.data(), expected.data(), width * 4, 4, height, width, 2, 2, BoxBlurEdgeMode::Transparent);
+    for (size_t i = 1; i < image.size(); i += 4)
+        EXPECT_EQ(expected[i + 2], blurred[i]) << i;
+}
+
+} // namespace TestWebKitAPI
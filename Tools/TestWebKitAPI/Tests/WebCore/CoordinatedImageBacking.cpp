@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#if USE(COORDINATED_GRAPHICS)
+
+#include <WebCore/BitmapImage.h>
+#include <WebCore/CoordinatedImageBacking.h>
+#include <WebCore/CoordinatedSurface.h>
+#include <WebCore/SharedBuffer.h>
+#include <WebCore/YUVImage.h>
+#include <wtf/MainThread.h>
+#include <wtf/Vector.h>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+// Builds a mid grey baseline JPEG with 4:2:0 subsampling. All of its coefficients are zero, and
+// its Huffman tables only hold a one bit code for zero, so every block is coded as two zero bits.
+static Vector<uint8_t> createGreyJPEG(const IntSize& size)
+{
+    static const uint8_t quantizationTable[] = { 0xff, 0xdb, 0x00, 0x43, 0x00 };
+    static const uint8_t startOfFrame[] = { 0xff, 0xc0, 0x00, 0x11, 0x08 };
+    static const uint8_t components[] = { 0x03, 0x01, 0x22, 0x00, 0x02, 0x11, 0x00, 0x03, 0x11, 0x00 };
+    static const uint8_t huffmanTables[] = {
+        0xff, 0xc4, 0x00, 0x14, 0x00, 0x01, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x00,
+        0xff, 0xc4, 0x00, 0x14, 0x10, 0x01, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x00
+    };
+    static const uint8_t startOfScan[] = { 0xff, 0xda, 0x00, 0x0c, 0x03, 0x01, 0x00, 0x02, 0x00, 0x03, 0x00, 0x00, 0x3f, 0x00 };
+
+    Vector<uint8_t> data;
+    data.append(0xff);
+    data.append(0xd8);
+    data.append(quantizationTable, sizeof(quantizationTable));
+    for (unsigned i = 0; i < 64; ++i)
+        data.append(1);
+    data.append(startOfFrame, sizeof(startOfFrame));
+    data.append(size.height() >> 8);
+    data.append(size.height() & 0xff);
+    data.append(size.width() >> 8);
+    data.append(size.width() & 0xff);
+    data.append(components, sizeof(components));
+    data.append(huffmanTables, sizeof(huffmanTables));
+    data.append(startOfScan, sizeof(startOfScan));
+
+    // Six blocks per 16x16 MCU, padded to whole bytes with one bits.
+    unsigned mcuCount = ((size.width() + 15) / 16) * ((size.height() + 15) / 16);
+    unsigned bitCount = mcuCount * 6 * 2;
+    for (unsigned i = 0; i < bitCount / 8; ++i)
+        data.append(0);
+    if (bitCount % 8)
+        data.append(0xff >> (bitCount % 8));
+
+    data.append(0xff);
+    data.append(0xd9);
+    return data;
+}
+
+static Ref<BitmapImage> createGreyJPEGImage(const IntSize& size)
+{
+    Vector<uint8_t> data = createGreyJPEG(size);
+    Ref<BitmapImage> image = BitmapImage::create();
+    image->setData(SharedBuffer::create(data.data(), data.size()), true);
+    return image;
+}
+
+class TestSurface : public CoordinatedSurface {
+public:
+    static unsigned rgbSurfaceCount;
+    static unsigned yuvSurfaceCount;
+
+    static PassRefPtr<CoordinatedSurface> create(const IntSize& size, Flags flags)
+    {
+        ++rgbSurfaceCount;
+        return adoptRef(new TestSurface(size, flags));
+    }
+
+    static PassRefPtr<CoordinatedSurface> create(PassRefPtr<YUVImage> image)
+    {
+        ++yuvSurfaceCount;
+        return adoptRef(new TestSurface(image->size(), NoFlags));
+    }
+
+    virtual void paintToSurface(const IntRect&, Client*) override { }
+#if USE(TEXTURE_MAPPER)
+    virtual void copyToTexture(PassRefPtr<BitmapTexture>, const IntRect&, const IntPoint&) override { }
+#endif
+
+private:
+    TestSurface(const IntSize& size, Flags flags)
+        : CoordinatedSurface(size, flags)
+    {
+    }
+};
+
+unsigned TestSurface::rgbSurfaceCount;
+unsigned TestSurface::yuvSurfaceCount;
+
+class TestImageBackingClient : public CoordinatedImageBacking::Client, public CoordinatedImageBacking::Host {
+public:
+    virtual void createImageBacking(CoordinatedImageBackingID) override { }
+    virtual void updateImageBacking(CoordinatedImageBackingID, PassRefPtr<CoordinatedSurface>) override { ++updateCount; }
+    virtual void clearImageBackingContents(CoordinatedImageBackingID) override { }
+    virtual void removeImageBacking(CoordinatedImageBackingID) override { }
+
+    virtual bool imageBackingVisible() override { return true; }
+
+    unsigned updateCount { 0 };
+};
+
+class CoordinatedImageBackingTest : public testing::Test {
+public:
+    virtual void SetUp() override
+    {
+        WTF::initializeMainThread();
+
+        TestSurface::rgbSurfaceCount = 0;
+        TestSurface::yuvSurfaceCount = 0;
+        CoordinatedSurface::setFactory(TestSurface::create);
+        CoordinatedSurface::setYUVFactory(TestSurface::create);
+    }
+
+    virtual void TearDown() override
+    {
+        CoordinatedSurface::setFactory(nullptr);
+        CoordinatedSurface::setYUVFactory(nullptr);
+    }
+
+    static unsigned update(BitmapImage& image)
+    {
+        TestImageBackingClient client;
+        RefPtr<CoordinatedImageBacking> backing = CoordinatedImageBacking::create(&client, &image);
+        backing->addHost(&client);
+        backing->update();
+
+        // Nothing changed, so marking the backing dirty must neither upload nor decode the image again.
+        backing->markDirty();
+        backing->update();
+
+        backing->removeHost(&client);
+        return client.updateCount;
+    }
+};
+
+TEST_F(CoordinatedImageBackingTest, LargeJPEGIsUploadedFromYUVPlanes)
+{
+    Ref<BitmapImage> image = createGreyJPEGImage(IntSize(512, 384));
+    EXPECT_TRUE(CoordinatedImageBacking::shouldUploadAsYUV(image.get()));
+
+    EXPECT_EQ(1u, update(image.get()));
+    EXPECT_EQ(1u, TestSurface::yuvSurfaceCount);
+    EXPECT_EQ(0u, TestSurface::rgbSurfaceCount);
+
+    // The RGB frame was never decoded.
+    EXPECT_EQ(0u, image->decodedSize());
+}
+
+TEST_F(CoordinatedImageBackingTest, SmallJPEGIsUploadedAsRGB)
+{
+    Ref<BitmapImage> image = createGreyJPEGImage(IntSize(64, 64));
+    EXPECT_FALSE(CoordinatedImageBacking::shouldUploadAsYUV(image.get()));
+
+    EXPECT_EQ(1u, update(image.get()));
+    EXPECT_EQ(0u, TestSurface::yuvSurfaceCount);
+    EXPECT_EQ(1u, TestSurface::rgbSurfaceCount);
+}
+
+TEST_F(CoordinatedImageBackingTest, DecodedJPEGIsUploadedAsRGB)
+{
+    Ref<BitmapImage> image = createGreyJPEGImage(IntSize(512, 384));
+    EXPECT_TRUE(image->nativeImageForCurrentFrame());
+    EXPECT_FALSE(CoordinatedImageBacking::shouldUploadAsYUV(image.get()));
+
+    EXPECT_EQ(1u, update(image.get()));
+    EXPECT_EQ(0u, TestSurface::yuvSurfaceCount);
+    EXPECT_EQ(1u, TestSurface::rgbSurfaceCount);
+}
+
+TEST_F(CoordinatedImageBackingTest, IncompleteJPEGIsNotUploadedAsYUV)
+{
+    Vector<uint8_t> data = createGreyJPEG(IntSize(512, 384));
+    Ref<BitmapImage> image = BitmapImage::create();
+    image->setData(SharedBuffer::create(data.data(), data.size() / 2), false);
+    EXPECT_FALSE(CoordinatedImageBacking::shouldUploadAsYUV(image.get()));
+}
+
+} // namespace TestWebKitAPI
+
+#endif // USE(COORDINATED_GRAPHICS)
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <WebCore/DamageHistory.h>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+static const IntRect viewport(0, 0, 800, 600);
+
+static bool regionsAreEqual(const Region& a, const Region& b)
+{
+    Region difference = a;
+    difference.subtract(b);
+    if (!difference.isEmpty())
+        return false;
+    difference = b;
+    difference.subtract(a);
+    return difference.isEmpty();
+}
+
+TEST(DamageHistory, UndefinedBufferContentsRepaintTheViewport)
+{
+    DamageHistory history;
+    Region damage(IntRect(10, 10, 20, 20));
+
+    EXPECT_TRUE(regionsAreEqual(Region(viewport), history.repaintRegionForDamage(damage, viewport, 0)));
+    EXPECT_TRUE(regionsAreEqual(Region(viewport), history.repaintRegionForDamage(damage, viewport, 0)));
+    EXPECT_EQ(2u, history.size());
+}
+
+TEST(DamageHistory, FirstFrameOfABufferOfAgeOne)
+{
+    DamageHistory history;
+    Region damage(IntRect(10, 10, 20, 20));
+
+    // A buffer of age 1 holds the previous frame, whether the history knows about it or not.
+    EXPECT_TRUE(regionsAreEqual(damage, history.repaintRegionForDamage(damage, viewport, 1)));
+}
+
+TEST(DamageHistory, AccumulatesDamageOfNewerFrames)
+{
+    DamageHistory history;
+    IntRect first(0, 0, 10, 10);
+    IntRect second(100, 100, 10, 10);
+    IntRect third(200, 200, 10, 10);
+    IntRect fourth(300, 300, 10, 10);
+
+    history.repaintRegionForDamage(Region(first), viewport, 0);
+    history.repaintRegionForDamage(Region(second), viewport, 0);
+    history.repaintRegionForDamage(Region(third), viewport, 0);
+
+    // A buffer of age 3 was last presented two frames before the previous one, so it is missing
+    // the damage of the last two frames, not that of the one it showed.
+    Region expected(fourth);
+    expected.unite(Region(third));
+    expected.unite(Region(second));
+    EXPECT_TRUE(regionsAreEqual(expected, history.repaintRegionForDamage(Region(fourth), viewport, 3)));
+}
+
+TEST(DamageHistory, DoubleBuffering)
+{
+    DamageHistory history;
+    IntRect rects[] = { IntRect(0, 0, 10, 10), IntRect(50, 0, 10, 10), IntRect(100, 0, 10, 10), IntRect(150, 0, 10, 10) };
+
+    history.repaintRegionForDamage(Region(rects[0]), viewport, 0);
+    history.repaintRegionForDamage(Region(rects[1]), viewport, 0);
+    for (unsigned i = 2; i < 4; ++i) {
+        Region expected(rects[i]);
+        expected.unite(Region(rects[i - 1]));
+        EXPECT_TRUE(regionsAreEqual(expected, history.repaintRegionForDamage(Region(rects[i]), viewport, 2)));
+    }
+}
+
+TEST(DamageHistory, KeepsTheLastFourFrames)
+{
+    DamageHistory history;
+    for (unsigned i = 0; i < 6; ++i)
+        history.repaintRegionForDamage(Region(IntRect(i * 20, 0, 10, 10)), viewport, 0);
+    EXPECT_EQ(4u, history.size());
+
+    IntRect damage(0, 100, 10, 10);
+
+    // Age 5 needs the four most recent frames, which are all still known.
+    Region expected(damage);
+    for (unsigned i = 2; i < 6; ++i)
+        expected.unite(Region(IntRect(i * 20, 0, 10, 10)));
+    EXPECT_TRUE(regionsAreEqual(expected, history.repaintRegionForDamage(Region(damage), viewport, 5)));
+
+    // Age 6 would need a fifth one, which was dropped.
+    EXPECT_TRUE(regionsAreEqual(Region(viewport), history.repaintRegionForDamage(Region(damage), viewport, 6)));
+    EXPECT_EQ(4u, history.size());
+}
+
+TEST(DamageHistory, ClearForgetsPreviousFrames)
+{
+    DamageHistory history;
+    history.repaintRegionForDamage(Region(IntRect(0, 0, 10, 10)), viewport, 0);
+    history.repaintRegionForDamage(Region(IntRect(20, 0, 10, 10)), viewport, 0);
+    history.clear();
+    EXPECT_EQ(0u, history.size());
+
+    EXPECT_TRUE(regionsAreEqual(Region(viewport), history.repaintRegionForDamage(Region(IntRect(40, 0, 10, 10)), viewport, 2)));
+}
+
+} // namespace TestWebKitAPI
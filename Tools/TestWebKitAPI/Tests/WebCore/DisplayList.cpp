@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include "Test.h"
+#include <WebCore/DisplayList.h>
+#include <WebCore/DisplayListRecorder.h>
+#include <WebCore/DisplayListReplayer.h>
+#include <WebCore/FloatRoundedRect.h>
+#include <WebCore/Gradient.h>
+#include <WebCore/GraphicsContext.h>
+#include <WebCore/Image.h>
+#include <WebCore/ImageBuffer.h>
+#include <WebCore/Path.h>
+#include <runtime/Uint8ClampedArray.h>
+#include <wtf/MainThread.h>
+#include <wtf/Threading.h>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+static const IntSize sceneSize(64, 48);
+
+class DisplayListTest : public testing::Test {
+public:
+    virtual void SetUp() override
+    {
+        WTF::initializeMainThread();
+    }
+
+    // Records into a context without a platform context, the way Tile does.
+    template<typename Painter>
+    static void record(DisplayList::DisplayList& list, const Painter& paint)
+    {
+        GraphicsContext recordingContext(static_cast<PlatformGraphicsContext*>(nullptr));
+        DisplayList::Recorder recorder(recordingContext, list, FloatRect(FloatPoint(), sceneSize));
+        paint(recordingContext);
+    }
+
+    static void paintScene(GraphicsContext& context)
+    {
+        context.fillRect(FloatRect(0, 0, 64, 48), Color(255, 255, 255));
+        context.fillRect(FloatRect(4, 4, 20, 12), Color(200, 30, 40));
+
+        context.save();
+        context.translate(32, 24);
+        context.rotate(0.3);
+        context.clip(FloatRect(-16, -16, 32, 32));
+        context.setFillColor(Color(20, 120, 200, 180));
+        Path ellipse;
+        ellipse.addEllipse(FloatRect(-20, -10, 40, 20));
+        context.fillPath(ellipse);
+        context.restore();
+
+        context.setStrokeColor(Color(10, 160, 60));
+        context.setStrokeThickness(3);
+        context.setLineDash({ 4, 2 }, 1);
+        Path line;
+        line.moveTo(FloatPoint(2, 40));
+        line.addLineTo(FloatPoint(60, 30));
+        context.strokePath(line);
+
+        context.beginTransparencyLayer(0.5);
+        context.fillRoundedRect(FloatRoundedRect(FloatRect(36, 4, 24, 16), FloatRoundedRect::Radii(FloatSize(5, 5), FloatSize(5, 5), FloatSize(5, 5), FloatSize(5, 5))), Color(250, 200, 0));
+        context.endTransparencyLayer();
+
+        context.clearRect(FloatRect(10, 30, 6, 6));
+    }
+
+    static RefPtr<Uint8ClampedArray> pixels(const ImageBuffer& buffer)
+    {
+        return buffer.getPremultipliedImageData(IntRect(IntPoint(), sceneSize));
+    }
+};
+
+TEST_F(DisplayListTest, WorkerThreadReplayMatchesMainThreadReplay)
+{
+    DisplayList::DisplayList list;
+    record(list, paintScene);
+    ASSERT_FALSE(list.isEmpty());
+    EXPECT_TRUE(list.canReplayOnWorkerThread());
+
+    auto mainThreadBuffer = ImageBuffer::create(sceneSize, Unaccelerated);
+    {
+        DisplayList::Replayer replayer(mainThreadBuffer->context(), list);
+        replayer.replay();
+    }
+
+    // As for tiles, the buffer is created on the main thread and only rasterized into on the worker.
+    auto workerThreadBuffer = ImageBuffer::create(sceneSize, Unaccelerated);
+    ThreadIdentifier thread = createThread("DisplayList replay", [&] {
+        DisplayList::Replayer replayer(workerThreadBuffer->context(), list);
+        replayer.replay();
+    });
+    waitForThreadCompletion(thread);
+
+    auto expected = pixels(*mainThreadBuffer);
+    auto actual = pixels(*workerThreadBuffer);
+    ASSERT_EQ(expected->length(), actual->length());
+    EXPECT_EQ(0, memcmp(expected->data(), actual->data(), expected->length()));
+
+    // The list must also have produced something, or the comparison proves nothing.
+    auto blank = ImageBuffer::create(sceneSize, Unaccelerated);
+    EXPECT_NE(0, memcmp(expected->data(), pixels(*blank)->data(), expected->length()));
+}
+
+TEST_F(DisplayListTest, ItemsWithSharedCachesAreNotReplayedOnWorkerThread)
+{
+    auto gradient = Gradient::create(FloatPoint(), FloatPoint(64, 0));
+    gradient->addColorStop(0, Color(255, 0, 0));
+    gradient->addColorStop(1, Color(0, 0, 255));
+
+    DisplayList::DisplayList gradientFill;
+    record(gradientFill, [&] (GraphicsContext& context) {
+        context.fillRect(FloatRect(0, 0, 64, 48), gradient.get());
+    });
+    EXPECT_FALSE(gradientFill.canReplayOnWorkerThread());
+
+    DisplayList::DisplayList gradientState;
+    record(gradientState, [&] (GraphicsContext& context) {
+        context.setFillGradient(gradient.copyRef());
+        context.fillRect(FloatRect(0, 0, 64, 48));
+    });
+    EXPECT_FALSE(gradientState.canReplayOnWorkerThread());
+
+    DisplayList::DisplayList shadow;
+    record(shadow, [] (GraphicsContext& context) {
+        context.setShadow(FloatSize(2, 2), 3, Color(0, 0, 0, 128));
+        context.fillRect(FloatRect(4, 4, 20, 20), Color(255, 0, 0));
+    });
+    EXPECT_FALSE(shadow.canReplayOnWorkerThread());
+
+    auto source = ImageBuffer::create(IntSize(8, 8), Unaccelerated);
+    source->context().fillRect(FloatRect(0, 0, 8, 8), Color(0, 255, 0));
+    RefPtr<Image> image = source->copyImage(CopyBackingStore);
+    ASSERT_TRUE(image);
+
+    DisplayList::DisplayList imageDraw;
+    record(imageDraw, [&] (GraphicsContext& context) {
+        context.drawImage(*image, FloatRect(0, 0, 16, 16));
+    });
+    EXPECT_FALSE(imageDraw.canReplayOnWorkerThread());
+
+    // A transparent shadow color draws no shadow, so it does not prevent worker replay.
+    DisplayList::DisplayList transparentShadow;
+    record(transparentShadow, [] (GraphicsContext& context) {
+        context.setShadow(FloatSize(2, 2), 3, Color(0, 0, 0, 0));
+        context.fillRect(FloatRect(4, 4, 20, 20), Color(255, 0, 0));
+    });
+    EXPECT_TRUE(transparentShadow.canReplayOnWorkerThread());
+}
+
+TEST_F(DisplayListTest, PlatformContextPaintingMakesTheListNotReplayable)
+{
+    DisplayList::DisplayList list;
+    record(list, [] (GraphicsContext& context) {
+        context.fillRect(FloatRect(0, 0, 64, 48), Color(255, 255, 255));
+        // What native theme painters do instead of drawing into the missing platform context.
+        context.markRecordingAsNotReplayable();
+        context.fillRect(FloatRect(4, 4, 20, 12), Color(200, 30, 40));
+    });
+    EXPECT_FALSE(list.isReplayable());
+    EXPECT_FALSE(list.canReplayOnWorkerThread());
+
+    list.clear();
+    EXPECT_TRUE(list.isReplayable());
+
+    DisplayList::DisplayList scene;
+    record(scene, paintScene);
+    EXPECT_TRUE(scene.isReplayable());
+}
+
+} // namespace TestWebKitAPI
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <WebCore/FEColorMatrix.h>
+#include <WebCore/FEComponentTransfer.h>
+#include <WebCore/Filter.h>
+#include <WebCore/FilterEffect.h>
+#include <wtf/MainThread.h>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+class TestFilter : public Filter {
+public:
+    static Ref<TestFilter> create(bool keepsIntermediateResults) { return adoptRef(*new TestFilter(keepsIntermediateResults)); }
+
+    virtual FloatRect sourceImageRect() const override { return FloatRect(0, 0, 1024, 1024); }
+    virtual FloatRect filterRegion() const override { return sourceImageRect(); }
+    virtual bool keepsIntermediateResults() const override { return m_keepsIntermediateResults; }
+
+private:
+    explicit TestFilter(bool keepsIntermediateResults)
+        : Filter(AffineTransform())
+        , m_keepsIntermediateResults(keepsIntermediateResults)
+    {
+    }
+
+    bool m_keepsIntermediateResults;
+};
+
+static void prepareEffect(FilterEffect& effect, Filter& filter)
+{
+    effect.setOperatingColorSpace(ColorSpaceSRGB);
+    effect.setMaxEffectRect(filter.filterRegion());
+}
+
+// Fills its paint rect with pixels that only depend on their absolute position, so that any part
+// of an image can be produced on its own.
+class TestSourceEffect : public FilterEffect {
+public:
+    static Ref<TestSourceEffect> create(Filter& filter, const IntRect& paintRect) { return adoptRef(*new TestSourceEffect(filter, paintRect)); }
+
+    Uint8ClampedArray* resultArray() const { return m_resultArray; }
+
+private:
+    TestSourceEffect(Filter& filter, const IntRect& paintRect)
+        : FilterEffect(filter)
+        , m_paintRect(paintRect)
+    {
+        prepareEffect(*this, filter);
+    }
+
+    virtual void determineAbsolutePaintRect() override { setAbsolutePaintRect(m_paintRect); }
+
+    virtual void platformApplySoftware() override
+    {
+        m_resultArray = createUnmultipliedImageResult();
+        uint8_t* pixel = m_resultArray->data();
+        for (int y = m_paintRect.y(); y < m_paintRect.maxY(); ++y) {
+            for (int x = m_paintRect.x(); x < m_paintRect.maxX(); ++x) {
+                unsigned hash = (x * 2654435761u) ^ (y * 40503u);
+                pixel[0] = hash;
+                pixel[1] = hash >> 8;
+                pixel[2] = hash >> 16;
+                pixel[3] = std::max<uint8_t>(hash >> 24, 1);
+                pixel += 4;
+            }
+        }
+    }
+
+    virtual void dump() override { }
+
+    IntRect m_paintRect;
+    Uint8ClampedArray* m_resultArray { nullptr };
+};
+
+// Inverts the colors of its input.
+class TestInvertEffect : public FilterEffect {
+public:
+    static Ref<TestInvertEffect> create(Filter& filter, FilterEffect& input)
+    {
+        Ref<TestInvertEffect> effect = adoptRef(*new TestInvertEffect(filter));
+        effect->inputEffects().append(&input);
+        return effect;
+    }
+
+    Uint8ClampedArray* resultArray() const { return m_resultArray; }
+
+private:
+    explicit TestInvertEffect(Filter& filter)
+        : FilterEffect(filter)
+    {
+        prepareEffect(*this, filter);
+    }
+
+    virtual void platformApplySoftware() override
+    {
+        FilterEffect* in = inputEffect(0);
+        m_resultArray = createUnmultipliedImageResult();
+        in->copyUnmultipliedImage(m_resultArray, requestedRegionOfInputImageData(in->absolutePaintRect()));
+        uint8_t* data = m_resultArray->data();
+        for (unsigned i = 0; i < m_resultArray->length(); i += 4) {
+            for (unsigned channel = 0; channel < 3; ++channel)
+                data[i + channel] = 255 - data[i + channel];
+        }
+    }
+
+    virtual void dump() override { }
+
+    Uint8ClampedArray* m_resultArray { nullptr };
+};
+
+class FilterEffectTest : public testing::Test {
+public:
+    virtual void SetUp() override
+    {
+        WTF::initializeMainThread();
+    }
+};
+
+static RefPtr<Uint8ClampedArray> applyEffect(FilterEffect& effect)
+{
+    effect.apply();
+    return effect.asUnmultipliedImage(IntRect(IntPoint(), effect.absolutePaintRect().size()));
+}
+
+// Applies the effect created by createEffect() to a large image, which is processed in several
+// bands, and to each strip of rows of it on its own, which fits in a single band.
+template<typename CreateEffect>
+static void expectBandedOutputMatchesSinglePass(CreateEffect createEffect)
+{
+    static const int width = 512;
+    static const int height = 512;
+    static const int stripHeight = 16;
+    Ref<TestFilter> filter = TestFilter::create(false);
+
+    Ref<TestSourceEffect> source = TestSourceEffect::create(filter.get(), IntRect(0, 0, width, height));
+    Ref<FilterEffect> effect = createEffect(filter.get(), source.get());
+    RefPtr<Uint8ClampedArray> banded = applyEffect(effect.get());
+    ASSERT_TRUE(banded);
+    ASSERT_EQ(static_cast<unsigned>(width * height * 4), banded->length());
+
+    for (int y = 0; y < height; y += stripHeight) {
+        Ref<TestSourceEffect> stripSource = TestSourceEffect::create(filter.get(), IntRect(0, y, width, stripHeight));
+        Ref<FilterEffect> stripEffect = createEffect(filter.get(), stripSource.get());
+        RefPtr<Uint8ClampedArray> strip = applyEffect(stripEffect.get());
+        ASSERT_TRUE(strip);
+        EXPECT_EQ(0, memcmp(banded->data() + y * width * 4, strip->data(), strip->length())) << "rows " << y << " to " << y + stripHeight;
+    }
+}
+
+TEST_F(FilterEffectTest, BandedColorMatrixMatchesSinglePass)
+{
+    expectBandedOutputMatchesSinglePass([](Filter& filter, FilterEffect& input) -> Ref<FilterEffect> {
+        Vector<float> values;
+        values.append(0.25);
+        Ref<FEColorMatrix> effect = FEColorMatrix::create(filter, FECOLORMATRIX_TYPE_SATURATE, values);
+        prepareEffect(effect.get(), filter);
+        effect->inputEffects().append(&input);
+        return WTF::move(effect);
+    });
+}
+
+TEST_F(FilterEffectTest, BandedComponentTransferMatchesSinglePass)
+{
+    expectBandedOutputMatchesSinglePass([](Filter& filter, FilterEffect& input) -> Ref<FilterEffect> {
+        ComponentTransferFunction gamma;
+        gamma.type = FECOMPONENTTRANSFER_TYPE_GAMMA;
+        gamma.amplitude = 1;
+        gamma.exponent = 0.5;
+        ComponentTransferFunction linear;
+        linear.type = FECOMPONENTTRANSFER_TYPE_LINEAR;
+        linear.slope = 0.5;
+        linear.intercept = 0.25;
+        Ref<FEComponentTransfer> effect = FEComponentTransfer::create(filter, gamma, linear, gamma, ComponentTransferFunction());
+        prepareEffect(effect.get(), filter);
+        effect->inputEffects().append(&input);
+        return WTF::move(effect);
+    });
+}
+
+TEST_F(FilterEffectTest, IntermediateResultsAreReleasedAndRecycled)
+{
+    Ref<TestFilter> filter = TestFilter::create(false);
+    Ref<TestSourceEffect> source = TestSourceEffect::create(filter.get(), IntRect(0, 0, 64, 32));
+    Ref<TestInvertEffect> first = TestInvertEffect::create(filter.get(), source.get());
+    Ref<TestInvertEffect> second = TestInvertEffect::create(filter.get(), first.get());
+    Ref<TestInvertEffect> last = TestInvertEffect::create(filter.get(), second.get());
+
+    last->apply();
+
+    // Each result is released once the effect reading it is done, and backs the next result.
+    EXPECT_FALSE(source->hasResult());
+    EXPECT_FALSE(first->hasResult());
+    EXPECT_FALSE(second->hasResult());
+    EXPECT_TRUE(last->hasResult());
+    EXPECT_EQ(source->resultArray(), second->resultArray());
+    EXPECT_EQ(first->resultArray(), last->resultArray());
+
+    // Inverted three times.
+    RefPtr<Uint8ClampedArray> result = last->asUnmultipliedImage(IntRect(0, 0, 64, 32));
+    Ref<TestSourceEffect> expectedSource = TestSourceEffect::create(filter.get(), IntRect(0, 0, 64, 32));
+    Ref<TestInvertEffect> expected = TestInvertEffect::create(filter.get(), expectedSource.get());
+    RefPtr<Uint8ClampedArray> expectedResult = applyEffect(expected.get());
+    EXPECT_EQ(0, memcmp(expectedResult->data(), result->data(), result->length()));
+}
+
+TEST_F(FilterEffectTest, ResultsReadTwiceAreReleasedAfterTheLastRead)
+{
+    Ref<TestFilter> filter = TestFilter::create(false);
+    Ref<TestSourceEffect> source = TestSourceEffect::create(filter.get(), IntRect(0, 0, 16, 16));
+    Ref<TestInvertEffect> first = TestInvertEffect::create(filter.get(), source.get());
+    Ref<TestInvertEffect> last = TestInvertEffect::create(filter.get(), first.get());
+    last->inputEffects().append(source.ptr());
+
+    last->apply();
+
+    EXPECT_FALSE(source->hasResult());
+    EXPECT_FALSE(first->hasResult());
+    EXPECT_TRUE(last->hasResult());
+}
+
+TEST_F(FilterEffectTest, IntermediateResultsAreKeptWhenTheFilterKeepsThem)
+{
+    Ref<TestFilter> filter = TestFilter::create(true);
+    Ref<TestSourceEffect> source = TestSourceEffect::create(filter.get(), IntRect(0, 0, 64, 32));
+    Ref<TestInvertEffect> first = TestInvertEffect::create(filter.get(), source.get());
+    Ref<TestInvertEffect> last = TestInvertEffect::create(filter.get(), first.get());
+
+    last->apply();
+
+    EXPECT_TRUE(source->hasResult());
+    EXPECT_TRUE(first->hasResult());
+    EXPECT_TRUE(last->hasResult());
+    EXPECT_NE(source->resultArray(), last->resultArray());
+}
+
+} // namespace TestWebKitAPI
@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <WebCore/GIFImageDecoder.h>
+#include <WebCore/SharedBuffer.h>
+#include <wtf/Vector.h>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+static const IntSize imageSize(8, 8);
+
+// Writes animated GIFs whose frames each fill a rectangle with one of four colors.
+class GIFBuilder {
+public:
+    GIFBuilder()
+    {
+        append("GIF89a", 6);
+        appendShort(imageSize.width());
+        appendShort(imageSize.height());
+        // A global color table of 4 entries, background color 0.
+        appendBytes({ 0x81, 0, 0 });
+        appendBytes({ 0xff, 0, 0, 0, 0xff, 0, 0, 0, 0xff, 0xff, 0xff, 0xff });
+        // Loop forever.
+        appendBytes({ 0x21, 0xff, 11 });
+        append("NETSCAPE2.0", 11);
+        appendBytes({ 3, 1, 0, 0, 0 });
+    }
+
+    void addFrame(const IntRect& rect, unsigned char colorIndex, ImageFrame::FrameDisposalMethod disposalMethod)
+    {
+        // Graphic control extension: disposal method and a 100ms delay.
+        appendBytes({ 0x21, 0xf9, 4, static_cast<unsigned char>(disposalMethod << 2), 10, 0, 0, 0 });
+
+        m_data.append(0x2c);
+        appendShort(rect.x());
+        appendShort(rect.y());
+        appendShort(rect.width());
+        appendShort(rect.height());
+        m_data.append(0);
+
+        // Starting the LZW table over every two pixels keeps codes 3 bits wide, so that every pixel
+        // is a plain color index.
+        static const unsigned clearCode = 4;
+        static const unsigned endCode = 5;
+        Vector<unsigned> codes;
+        for (int i = 0; i < rect.width() * rect.height(); ++i) {
+            if (!(i % 2))
+                codes.append(clearCode);
+            codes.append(colorIndex);
+        }
+        codes.append(endCode);
+
+        Vector<unsigned char> lzwData;
+        unsigned bits = 0;
+        unsigned bitCount = 0;
+        for (unsigned code : codes) {
+            bits |= code << bitCount;
+            bitCount += 3;
+            while (bitCount >= 8) {
+                lzwData.append(bits & 0xff);
+                bits >>= 8;
+                bitCount -= 8;
+            }
+        }
+        if (bitCount)
+            lzwData.append(bits);
+
+        // Minimum code size, then the data in blocks of up to 255 bytes.
+        m_data.append(2);
+        for (size_t offset = 0; offset < lzwData.size(); offset += 255) {
+            size_t blockSize = std::min<size_t>(255, lzwData.size() - offset);
+            m_data.append(blockSize);
+            m_data.append(lzwData.data() + offset, blockSize);
+        }
+        m_data.append(0);
+    }
+
+    RefPtr<SharedBuffer> finish()
+    {
+        m_data.append(0x3b);
+        return SharedBuffer::create(m_data.data(), m_data.size());
+    }
+
+private:
+    void append(const char* data, size_t size) { m_data.append(reinterpret_cast<const unsigned char*>(data), size); }
+    void appendBytes(std::initializer_list<unsigned char> bytes) { m_data.append(bytes.begin(), bytes.size()); }
+    void appendShort(unsigned value)
+    {
+        m_data.append(value & 0xff);
+        m_data.append(value >> 8);
+    }
+
+    Vector<unsigned char> m_data;
+};
+
+// Tells which frames are decoded without decoding them, which frameBufferAtIndex() does.
+class TestGIFImageDecoder : public GIFImageDecoder {
+public:
+    TestGIFImageDecoder()
+        : GIFImageDecoder(ImageSource::AlphaPremultiplied, ImageSource::GammaAndColorProfileIgnored)
+    {
+    }
+
+    Vector<ImageFrame::FrameStatus> frameStatuses()
+    {
+        Vector<ImageFrame::FrameStatus> statuses;
+        for (size_t i = 0; i < frameCount(); ++i)
+            statuses.append(m_frameBufferCache[i].status());
+        return statuses;
+    }
+};
+
+static std::unique_ptr<TestGIFImageDecoder> createDecoder(SharedBuffer& data)
+{
+    auto decoder = std::make_unique<TestGIFImageDecoder>();
+    decoder->setData(&data, true);
+    return decoder;
+}
+
+static Vector<ImageFrame::PixelData> framePixels(GIFImageDecoder& decoder, size_t index)
+{
+    ImageFrame* frame = decoder.frameBufferAtIndex(index);
+    EXPECT_EQ(ImageFrame::FrameComplete, frame->status());
+
+    Vector<ImageFrame::PixelData> pixels;
+    for (int y = 0; y < imageSize.height(); ++y) {
+        for (int x = 0; x < imageSize.width(); ++x)
+            pixels.append(*frame->getAddr(x, y));
+    }
+    return pixels;
+}
+
+// Decodes every frame once, in order, as the reference to compare decoding them again with.
+static Vector<Vector<ImageFrame::PixelData>> decodeAllFrames(SharedBuffer& data)
+{
+    auto decoder = createDecoder(data);
+    Vector<Vector<ImageFrame::PixelData>> frames;
+    for (size_t i = 0; i < decoder->frameCount(); ++i)
+        frames.append(framePixels(*decoder, i));
+    return frames;
+}
+
+TEST(GIFImageDecoder, DecodesFramesInOrder)
+{
+    GIFBuilder builder;
+    builder.addFrame(IntRect(IntPoint(), imageSize), 0, ImageFrame::DisposeKeep);
+    builder.addFrame(IntRect(0, 0, 4, 4), 1, ImageFrame::DisposeKeep);
+    builder.addFrame(IntRect(4, 4, 4, 4), 2, ImageFrame::DisposeKeep);
+    RefPtr<SharedBuffer> data = builder.finish();
+
+    auto frames = decodeAllFrames(*data);
+    ASSERT_EQ(3u, frames.size());
+
+    // The frames build on each other.
+    EXPECT_EQ(frames[0][7 * 8 + 7], frames[1][7 * 8 + 7]);
+    EXPECT_NE(frames[0][0], frames[1][0]);
+    EXPECT_EQ(frames[1][0], frames[2][0]);
+    EXPECT_NE(frames[1][7 * 8 + 7], frames[2][7 * 8 + 7]);
+}
+
+TEST(GIFImageDecoder, RedecodesFromTheFirstFrameOfAChain)
+{
+    GIFBuilder builder;
+    builder.addFrame(IntRect(IntPoint(), imageSize), 0, ImageFrame::DisposeKeep);
+    builder.addFrame(IntRect(0, 0, 4, 4), 1, ImageFrame::DisposeKeep);
+    builder.addFrame(IntRect(4, 4, 4, 4), 2, ImageFrame::DisposeKeep);
+    builder.addFrame(IntRect(0, 4, 2, 2), 3, ImageFrame::DisposeKeep);
+    RefPtr<SharedBuffer> data = builder.finish();
+    auto reference = decodeAllFrames(*data);
+
+    auto decoder = createDecoder(*data);
+    for (size_t i = 0; i < 4; ++i)
+        framePixels(*decoder, i);
+
+    // Each frame needs the one before it, so only the last one is left.
+    decoder->clearFrameBufferCache(3);
+    Vector<ImageFrame::FrameStatus> expected = { ImageFrame::FrameEmpty, ImageFrame::FrameEmpty, ImageFrame::FrameEmpty, ImageFrame::FrameComplete };
+    EXPECT_TRUE(expected == decoder->frameStatuses());
+
+    // Frame 1 has to be decoded again from frame 0.
+    EXPECT_TRUE(reference[1] == framePixels(*decoder, 1));
+    expected = { ImageFrame::FrameComplete, ImageFrame::FrameComplete, ImageFrame::FrameEmpty, ImageFrame::FrameComplete };
+    EXPECT_TRUE(expected == decoder->frameStatuses());
+
+    // Frame 2 only needs frame 1, which is back.
+    EXPECT_TRUE(reference[2] == framePixels(*decoder, 2));
+    EXPECT_TRUE(reference[3] == framePixels(*decoder, 3));
+}
+
+TEST(GIFImageDecoder, RedecodingStartsAfterAFullBackgroundDisposal)
+{
+    GIFBuilder builder;
+    builder.addFrame(IntRect(IntPoint(), imageSize), 0, ImageFrame::DisposeKeep);
+    builder.addFrame(IntRect(IntPoint(), imageSize), 1, ImageFrame::DisposeOverwriteBgcolor);
+    builder.addFrame(IntRect(2, 2, 4, 4), 2, ImageFrame::DisposeKeep);
+    builder.addFrame(IntRect(0, 0, 2, 2), 3, ImageFrame::DisposeKeep);
+    RefPtr<SharedBuffer> data = builder.finish();
+    auto reference = decodeAllFrames(*data);
+
+    auto decoder = createDecoder(*data);
+    for (size_t i = 0; i < 4; ++i)
+        framePixels(*decoder, i);
+    decoder->clearFrameBufferCache(3);
+
+    // Frame 1 clears the whole image when it is done, so frame 2 starts from a blank one and
+    // doesn't need the frames before it.
+    EXPECT_TRUE(reference[2] == framePixels(*decoder, 2));
+    Vector<ImageFrame::FrameStatus> expected = { ImageFrame::FrameEmpty, ImageFrame::FrameEmpty, ImageFrame::FrameComplete, ImageFrame::FrameComplete };
+    EXPECT_TRUE(expected == decoder->frameStatuses());
+
+    // Going back to the start of the animation works too.
+    EXPECT_TRUE(reference[0] == framePixels(*decoder, 0));
+    EXPECT_TRUE(reference[1] == framePixels(*decoder, 1));
+}
+
+TEST(GIFImageDecoder, RedecodingSkipsFramesDisposedToThePreviousOne)
+{
+    GIFBuilder builder;
+    builder.addFrame(IntRect(IntPoint(), imageSize), 0, ImageFrame::DisposeKeep);
+    builder.addFrame(IntRect(0, 0, 4, 4), 1, ImageFrame::DisposeOverwritePrevious);
+    builder.addFrame(IntRect(4, 0, 4, 4), 2, ImageFrame::DisposeOverwritePrevious);
+    builder.addFrame(IntRect(0, 4, 4, 4), 3, ImageFrame::DisposeKeep);
+    builder.addFrame(IntRect(4, 4, 4, 4), 1, ImageFrame::DisposeKeep);
+    RefPtr<SharedBuffer> data = builder.finish();
+    auto reference = decodeAllFrames(*data);
+
+    auto decoder = createDecoder(*data);
+    for (size_t i = 0; i < 5; ++i)
+        framePixels(*decoder, i);
+    decoder->clearFrameBufferCache(4);
+    Vector<ImageFrame::FrameStatus> expected = { ImageFrame::FrameEmpty, ImageFrame::FrameEmpty, ImageFrame::FrameEmpty, ImageFrame::FrameEmpty, ImageFrame::FrameComplete };
+    EXPECT_TRUE(expected == decoder->frameStatuses());
+
+    EXPECT_TRUE(reference[0] == framePixels(*decoder, 0));
+
+    // Frames 1 and 2 are undone when they are replaced, so frame 2 starts from frame 0, and frame 1
+    // is not decoded again on the way.
+    EXPECT_TRUE(reference[2] == framePixels(*decoder, 2));
+    expected = { ImageFrame::FrameComplete, ImageFrame::FrameEmpty, ImageFrame::FrameComplete, ImageFrame::FrameEmpty, ImageFrame::FrameComplete };
+    EXPECT_TRUE(expected == decoder->frameStatuses());
+
+    EXPECT_TRUE(reference[1] == framePixels(*decoder, 1));
+    EXPECT_TRUE(reference[3] == framePixels(*decoder, 3));
+}
+
+TEST(GIFImageDecoder, RedecodesTheWholeAnimationAfterClearingEverything)
+{
+    GIFBuilder builder;
+    builder.addFrame(IntRect(IntPoint(), imageSize), 0, ImageFrame::DisposeKeep);
+    builder.addFrame(IntRect(0, 0, 4, 4), 1, ImageFrame::DisposeOverwritePrevious);
+    builder.addFrame(IntRect(2, 2, 4, 4), 2, ImageFrame::DisposeOverwriteBgcolor);
+    builder.addFrame(IntRect(4, 4, 4, 4), 3, ImageFrame::DisposeKeep);
+    RefPtr<SharedBuffer> data = builder.finish();
+    auto reference = decodeAllFrames(*data);
+
+    auto decoder = createDecoder(*data);
+    for (unsigned loop = 0; loop < 3; ++loop) {
+        for (size_t i = 0; i < 4; ++i)
+            EXPECT_TRUE(reference[i] == framePixels(*decoder, i)) << "frame " << i << " of loop " << loop;
+        decoder->clearFrameBufferCache(4);
+    }
+}
+
+} // namespace TestWebKitAPI
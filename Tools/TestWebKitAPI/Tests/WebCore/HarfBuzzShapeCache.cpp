@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#if USE(HARFBUZZ)
+
+#include <WebCore/Font.h>
+#include <WebCore/FontCache.h>
+#include <WebCore/FontDescription.h>
+#include <WebCore/HarfBuzzShapeCache.h>
+#include <wtf/MainThread.h>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+static const UChar webKit[] = { 'W', 'e', 'b', 'K', 'i', 't' };
+static const UChar webCore[] = { 'W', 'e', 'b', 'C', 'o', 'r', 'e' };
+static const hb_feature_t ligatures[] = { { HB_TAG('l', 'i', 'g', 'a'), 1, 0, static_cast<unsigned>(-1) } };
+static const hb_feature_t noLigatures[] = { { HB_TAG('l', 'i', 'g', 'a'), 0, 0, static_cast<unsigned>(-1) } };
+
+class HarfBuzzShapeCacheTest : public testing::Test {
+public:
+    virtual void SetUp() override
+    {
+        WTF::initializeMainThread();
+        HarfBuzzShapeCache::singleton().clear();
+        m_memoryBudget = HarfBuzzShapeCache::singleton().stats().memoryBudget;
+    }
+
+    virtual void TearDown() override
+    {
+        HarfBuzzShapeCache::singleton().clear();
+        HarfBuzzShapeCache::singleton().setMemoryBudget(m_memoryBudget);
+    }
+
+    static HarfBuzzShapeCache::Key key(const FontPlatformData& platformData, hb_script_t script = HB_SCRIPT_LATIN, hb_direction_t direction = HB_DIRECTION_LTR, const hb_feature_t* features = ligatures, unsigned featureCount = WTF_ARRAY_LENGTH(ligatures), const UChar* text = webKit, unsigned length = WTF_ARRAY_LENGTH(webKit))
+    {
+        return HarfBuzzShapeCache::Key(text, length, platformData, script, direction, features, featureCount);
+    }
+
+    // A result whose glyphs are numbered from firstGlyph on.
+    static HarfBuzzShapeCache::ShapeResult shapeResult(unsigned firstGlyph, unsigned numGlyphs = WTF_ARRAY_LENGTH(webKit))
+    {
+        HarfBuzzShapeCache::ShapeResult result;
+        for (unsigned i = 0; i < numGlyphs; ++i) {
+            hb_glyph_info_t info = { };
+            info.codepoint = firstGlyph + i;
+            info.cluster = i;
+            result.glyphInfos.append(info);
+
+            hb_glyph_position_t position = { };
+            position.x_advance = 64 * (i + 1);
+            result.glyphPositions.append(position);
+        }
+        return result;
+    }
+
+private:
+    size_t m_memoryBudget { 0 };
+};
+
+TEST_F(HarfBuzzShapeCacheTest, HitForSameRun)
+{
+    HarfBuzzShapeCache& cache = HarfBuzzShapeCache::singleton();
+    FontPlatformData platformData(16, false, false);
+    cache.add(key(platformData), shapeResult(10));
+    HarfBuzzShapeCache::Stats initialStats = cache.stats();
+
+    // An equal key built from copies of everything.
+    FontPlatformData samePlatformData(platformData);
+    hb_feature_t sameLigatures[] = { ligatures[0] };
+    Vector<UChar> sameText;
+    sameText.append(webKit, WTF_ARRAY_LENGTH(webKit));
+    const HarfBuzzShapeCache::ShapeResult* result = cache.find(key(samePlatformData, HB_SCRIPT_LATIN, HB_DIRECTION_LTR, sameLigatures, 1, sameText.data(), sameText.size()));
+    ASSERT_TRUE(result);
+    ASSERT_EQ(WTF_ARRAY_LENGTH(webKit), result->numGlyphs());
+    for (unsigned i = 0; i < result->numGlyphs(); ++i) {
+        EXPECT_EQ(10 + i, result->glyphInfos[i].codepoint);
+        EXPECT_EQ(static_cast<hb_position_t>(64 * (i + 1)), result->glyphPositions[i].x_advance);
+    }
+
+    HarfBuzzShapeCache::Stats stats = cache.stats();
+    EXPECT_EQ(1u, stats.entryCount);
+    EXPECT_EQ(initialStats.hits + 1, stats.hits);
+    EXPECT_EQ(initialStats.misses, stats.misses);
+}
+
+TEST_F(HarfBuzzShapeCacheTest, MissWhenAnyPartOfTheRunChanges)
+{
+    HarfBuzzShapeCache& cache = HarfBuzzShapeCache::singleton();
+    FontPlatformData platformData(16, false, false);
+    cache.add(key(platformData), shapeResult(10));
+    HarfBuzzShapeCache::Stats initialStats = cache.stats();
+
+    FontPlatformData biggerPlatformData(17, false, false);
+    FontPlatformData boldPlatformData(16, true, false);
+    EXPECT_FALSE(cache.find(key(biggerPlatformData)));
+    EXPECT_FALSE(cache.find(key(boldPlatformData)));
+    EXPECT_FALSE(cache.find(key(platformData, HB_SCRIPT_GREEK)));
+    EXPECT_FALSE(cache.find(key(platformData, HB_SCRIPT_LATIN, HB_DIRECTION_RTL)));
+    EXPECT_FALSE(cache.find(key(platformData, HB_SCRIPT_LATIN, HB_DIRECTION_LTR, nullptr, 0)));
+    EXPECT_FALSE(cache.find(key(platformData, HB_SCRIPT_LATIN, HB_DIRECTION_LTR, noLigatures, WTF_ARRAY_LENGTH(noLigatures))));
+    EXPECT_FALSE(cache.find(key(platformData, HB_SCRIPT_LATIN, HB_DIRECTION_LTR, ligatures, WTF_ARRAY_LENGTH(ligatures), webCore, WTF_ARRAY_LENGTH(webCore))));
+    EXPECT_FALSE(cache.find(key(platformData, HB_SCRIPT_LATIN, HB_DIRECTION_LTR, ligatures, WTF_ARRAY_LENGTH(ligatures), webKit, 3)));
+
+    HarfBuzzShapeCache::Stats stats = cache.stats();
+    EXPECT_EQ(initialStats.hits, stats.hits);
+    EXPECT_EQ(initialStats.misses + 8, stats.misses);
+
+    EXPECT_TRUE(cache.find(key(platformData)));
+}
+
+TEST_F(HarfBuzzShapeCacheTest, RemoveEntriesForFont)
+{
+    HarfBuzzShapeCache& cache = HarfBuzzShapeCache::singleton();
+    FontPlatformData platformData(16, false, false);
+    FontPlatformData otherPlatformData(12, false, false);
+    cache.add(key(platformData), shapeResult(10));
+    cache.add(key(platformData, HB_SCRIPT_LATIN, HB_DIRECTION_RTL), shapeResult(20));
+    cache.add(key(otherPlatformData), shapeResult(30));
+    size_t otherEntryBytes = key(otherPlatformData).sizeInBytes() + shapeResult(30).sizeInBytes();
+
+    cache.removeEntriesForFont(platformData);
+
+    EXPECT_FALSE(cache.find(key(platformData)));
+    EXPECT_FALSE(cache.find(key(platformData, HB_SCRIPT_LATIN, HB_DIRECTION_RTL)));
+    EXPECT_TRUE(cache.find(key(otherPlatformData)));
+
+    HarfBuzzShapeCache::Stats stats = cache.stats();
+    EXPECT_EQ(1u, stats.entryCount);
+    EXPECT_EQ(otherEntryBytes, stats.bytes);
+}
+
+TEST_F(HarfBuzzShapeCacheTest, RemoveEntriesForFontAfterEviction)
+{
+    HarfBuzzShapeCache& cache = HarfBuzzShapeCache::singleton();
+    FontPlatformData platformData(16, false, false);
+    FontPlatformData otherPlatformData(12, false, false);
+    size_t entryBytes = key(platformData).sizeInBytes() + shapeResult(10).sizeInBytes();
+    cache.setMemoryBudget(2 * entryBytes);
+    unsigned evictedEntries = cache.stats().evictedEntries;
+
+    // The first entry of the font is evicted, which the font's index has to forget too.
+    cache.add(key(platformData), shapeResult(10));
+    cache.add(key(platformData, HB_SCRIPT_LATIN, HB_DIRECTION_RTL), shapeResult(20));
+    cache.add(key(otherPlatformData), shapeResult(30));
+    EXPECT_EQ(2u, cache.stats().entryCount);
+    EXPECT_EQ(evictedEntries + 1, cache.stats().evictedEntries);
+
+    cache.removeEntriesForFont(platformData);
+    EXPECT_FALSE(cache.find(key(platformData, HB_SCRIPT_LATIN, HB_DIRECTION_RTL)));
+    EXPECT_TRUE(cache.find(key(otherPlatformData)));
+    EXPECT_EQ(1u, cache.stats().entryCount);
+    EXPECT_EQ(entryBytes, cache.stats().bytes);
+
+    // Nothing is left of the font, so adding it again starts over.
+    cache.add(key(platformData), shapeResult(10));
+    cache.removeEntriesForFont(otherPlatformData);
+    EXPECT_TRUE(cache.find(key(platformData)));
+    EXPECT_EQ(1u, cache.stats().entryCount);
+    EXPECT_EQ(entryBytes, cache.stats().bytes);
+}
+
+TEST_F(HarfBuzzShapeCacheTest, EntriesAreDroppedWhenTheFontGoesAway)
+{
+    FontDescription description;
+    description.setComputedSize(16);
+    RefPtr<Font> font = Font::create(FontCache::singleton().lastResortFallbackFont(description)->platformData());
+
+    HarfBuzzShapeCache& cache = HarfBuzzShapeCache::singleton();
+    FontPlatformData otherPlatformData(12, false, false);
+    cache.add(key(font->platformData()), shapeResult(10));
+    cache.add(key(otherPlatformData), shapeResult(30));
+    EXPECT_EQ(2u, cache.stats().entryCount);
+
+    FontPlatformData platformData(font->platformData());
+    font = nullptr;
+
+    EXPECT_FALSE(cache.find(key(platformData)));
+    EXPECT_TRUE(cache.find(key(otherPlatformData)));
+    EXPECT_EQ(1u, cache.stats().entryCount);
+}
+
+} // namespace TestWebKitAPI
+
+#endif // USE(HARFBUZZ)
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <WebCore/ImageDecodingQueue.h>
+#include <wtf/Condition.h>
+#include <wtf/Lock.h>
+#include <wtf/MainThread.h>
+#include <wtf/RunLoop.h>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+class TestClient : public ImageDecodingQueue::Client {
+public:
+    explicit TestClient(bool allowsDecoding = true)
+        : m_allowsDecoding(allowsDecoding)
+    {
+    }
+
+    unsigned numberOfStartQueries() const { return m_numberOfStartQueries; }
+
+private:
+    virtual bool shouldStartDecoding() override
+    {
+        ++m_numberOfStartQueries;
+        return m_allowsDecoding;
+    }
+
+    bool m_allowsDecoding;
+    unsigned m_numberOfStartQueries { 0 };
+};
+
+// Counts decodes as they run on the worker threads.
+class DecodeCounter {
+public:
+    std::function<void ()> decodeFunction()
+    {
+        return [this] {
+            LockHolder locker(m_lock);
+            ++m_count;
+            m_condition.notifyAll();
+        };
+    }
+
+    unsigned count()
+    {
+        LockHolder locker(m_lock);
+        return m_count;
+    }
+
+    void waitForCount(unsigned count)
+    {
+        LockHolder locker(m_lock);
+        while (m_count < count)
+            m_condition.wait(m_lock);
+    }
+
+private:
+    Lock m_lock;
+    Condition m_condition;
+    unsigned m_count { 0 };
+};
+
+class ImageDecodingQueueTest : public testing::Test {
+public:
+    void SetUp() override
+    {
+        WTF::initializeMainThread();
+        RunLoop::initializeMainRunLoop();
+    }
+
+    void TearDown() override
+    {
+        ImageDecodingQueue::singleton().setMaximumDecodesPerGroup(ImageDecodingQueue::defaultMaximumDecodesPerGroup);
+    }
+
+    // Completion handlers run on the main thread, which waits in RunLoop::run() until the expected number of them did.
+    static std::function<void ()> completionHandler(unsigned& completions, unsigned expectedCompletions = 0)
+    {
+        return [&completions, expectedCompletions] {
+            if (++completions == expectedCompletions)
+                RunLoop::main().stop();
+        };
+    }
+};
+
+TEST_F(ImageDecodingQueueTest, DecodesPerGroupAreLimited)
+{
+    ImageDecodingQueue& queue = ImageDecodingQueue::singleton();
+    queue.setMaximumDecodesPerGroup(2);
+
+    int firstGroup;
+    int secondGroup;
+    TestClient client;
+    DecodeCounter firstGroupDecodes;
+    DecodeCounter secondGroupDecodes;
+    unsigned completions = 0;
+
+    for (unsigned i = 0; i < 4; ++i)
+        queue.enqueue(client, &firstGroup, firstGroupDecodes.decodeFunction(), completionHandler(completions, 6));
+    queue.enqueue(client, &secondGroup, secondGroupDecodes.decodeFunction(), completionHandler(completions, 6));
+
+    // Waiting requests only start once the main thread hears that a running one finished. Until then,
+    // the first group has its two decodes, and the full group doesn't hold up the other one.
+    firstGroupDecodes.waitForCount(2);
+    secondGroupDecodes.waitForCount(1);
+    EXPECT_EQ(2u, firstGroupDecodes.count());
+    EXPECT_EQ(0u, completions);
+    EXPECT_EQ(0u, client.numberOfStartQueries());
+
+    queue.enqueue(client, &firstGroup, firstGroupDecodes.decodeFunction(), completionHandler(completions, 6));
+    RunLoop::run();
+
+    EXPECT_EQ(5u, firstGroupDecodes.count());
+    EXPECT_EQ(1u, secondGroupDecodes.count());
+    EXPECT_EQ(6u, completions);
+    EXPECT_EQ(3u, client.numberOfStartQueries());
+}
+
+TEST_F(ImageDecodingQueueTest, CancelDropsTheRequestsOfAClient)
+{
+    ImageDecodingQueue& queue = ImageDecodingQueue::singleton();
+    queue.setMaximumDecodesPerGroup(1);
+
+    int group;
+    TestClient runningClient;
+    TestClient cancelledClient;
+    TestClient otherClient;
+    DecodeCounter runningDecodes;
+    DecodeCounter cancelledDecodes;
+    DecodeCounter otherDecodes;
+    unsigned runningCompletions = 0;
+    unsigned cancelledCompletions = 0;
+    unsigned otherCompletions = 0;
+
+    queue.enqueue(runningClient, &group, runningDecodes.decodeFunction(), completionHandler(runningCompletions));
+    queue.enqueue(cancelledClient, &group, cancelledDecodes.decodeFunction(), completionHandler(cancelledCompletions));
+    queue.enqueue(cancelledClient, &group, cancelledDecodes.decodeFunction(), completionHandler(cancelledCompletions));
+    queue.enqueue(otherClient, &group, otherDecodes.decodeFunction(), completionHandler(otherCompletions, 1));
+
+    // The first request is already running; it finishes, but nobody hears about it.
+    queue.cancel(runningClient);
+    queue.cancel(cancelledClient);
+    RunLoop::run();
+
+    EXPECT_EQ(1u, runningDecodes.count());
+    EXPECT_EQ(0u, runningCompletions);
+    EXPECT_EQ(0u, cancelledDecodes.count());
+    EXPECT_EQ(0u, cancelledCompletions);
+    EXPECT_EQ(0u, cancelledClient.numberOfStartQueries());
+    EXPECT_EQ(1u, otherDecodes.count());
+    EXPECT_EQ(1u, otherCompletions);
+}
+
+TEST_F(ImageDecodingQueueTest, RefusedRequestsAreDropped)
+{
+    ImageDecodingQueue& queue = ImageDecodingQueue::singleton();
+    queue.setMaximumDecodesPerGroup(1);
+
+    int group;
+    TestClient client;
+    TestClient refusingClient(false);
+    DecodeCounter decodes;
+    DecodeCounter refusedDecodes;
+    unsigned completions = 0;
+    unsigned refusedCompletions = 0;
+
+    queue.enqueue(client, &group, decodes.decodeFunction(), completionHandler(completions, 2));
+    queue.enqueue(refusingClient, &group, refusedDecodes.decodeFunction(), completionHandler(refusedCompletions));
+    queue.enqueue(client, &group, decodes.decodeFunction(), completionHandler(completions, 2));
+    RunLoop::run();
+
+    // Only the requests that had to wait are asked, once, when their turn comes.
+    EXPECT_EQ(1u, client.numberOfStartQueries());
+    EXPECT_EQ(1u, refusingClient.numberOfStartQueries());
+    EXPECT_EQ(0u, refusedDecodes.count());
+    EXPECT_EQ(0u, refusedCompletions);
+    EXPECT_EQ(2u, decodes.count());
+    EXPECT_EQ(2u, completions);
+}
+
+} // namespace TestWebKitAPI
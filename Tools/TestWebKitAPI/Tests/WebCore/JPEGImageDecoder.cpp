@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <WebCore/JPEGImageDecoder.h>
+#include <WebCore/SharedBuffer.h>
+#include <WebCore/YUVImage.h>
+#include <cstdlib>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+// Not a multiple of any MCU size, so that every plane is padded.
+static const IntSize imageSize(37, 21);
+
+struct JPEGEncodingOptions {
+    int lumaHorizontalSampling { 2 };
+    int lumaVerticalSampling { 2 };
+    bool progressive { false };
+    bool colorProfile { false };
+};
+
+// Encodes a mid-grey image, whose samples are all 128 in every plane.
+static RefPtr<SharedBuffer> encodeGreyJPEG(const JPEGEncodingOptions& options)
+{
+    jpeg_compress_struct info;
+    jpeg_error_mgr errorManager;
+    info.err = jpeg_std_error(&errorManager);
+    jpeg_create_compress(&info);
+
+    unsigned char* buffer = nullptr;
+    unsigned long bufferSize = 0;
+    jpeg_mem_dest(&info, &buffer, &bufferSize);
+
+    info.image_width = imageSize.width();
+    info.image_height = imageSize.height();
+    info.input_components = 3;
+    info.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&info);
+    jpeg_set_quality(&info, 100, TRUE);
+    info.comp_info[0].h_samp_factor = options.lumaHorizontalSampling;
+    info.comp_info[0].v_samp_factor = options.lumaVerticalSampling;
+    if (options.progressive)
+        jpeg_simple_progression(&info);
+
+    jpeg_start_compress(&info, TRUE);
+    if (options.colorProfile) {
+        // The signature, the chunk number and count, then the profile, which is never parsed.
+        Vector<JOCTET> marker;
+        marker.append(reinterpret_cast<const JOCTET*>("ICC_PROFILE"), 12);
+        marker.append(1);
+        marker.append(1);
+        marker.grow(marker.size() + 128);
+        jpeg_write_marker(&info, JPEG_APP0 + 2, marker.data(), marker.size());
+    }
+
+    Vector<JSAMPLE> row(imageSize.width() * 3, 128);
+    while (info.next_scanline < info.image_height) {
+        JSAMPROW rows[] = { row.data() };
+        jpeg_write_scanlines(&info, rows, 1);
+    }
+    jpeg_finish_compress(&info);
+    jpeg_destroy_compress(&info);
+
+    RefPtr<SharedBuffer> data = SharedBuffer::create(buffer, bufferSize);
+    free(buffer);
+    return data;
+}
+
+static RefPtr<YUVImage> decodeToYUV(SharedBuffer& data, ImageSource::GammaAndColorProfileOption colorProfileOption = ImageSource::GammaAndColorProfileApplied)
+{
+    JPEGImageDecoder decoder(ImageSource::AlphaPremultiplied, colorProfileOption);
+    decoder.setData(&data, true);
+    return decoder.createYUVImage();
+}
+
+// Only the samples covering the image are checked, libjpeg doesn't write the padding blocks past it.
+static void expectMidGreyPlane(const YUVImage& image, YUVImage::Plane plane, const IntSize& visibleSize)
+{
+    int rowLength = image.paddedPlaneSize(plane).width();
+    const uint8_t* samples = image.planeData(plane);
+    for (int y = 0; y < visibleSize.height(); ++y) {
+        for (int x = 0; x < visibleSize.width(); ++x)
+            ASSERT_NEAR(128, samples[y * rowLength + x], 1) << "plane " << plane << ", at " << x << ", " << y;
+    }
+}
+
+TEST(JPEGImageDecoder, DecodesToYUV420)
+{
+    RefPtr<YUVImage> image = decodeToYUV(*encodeGreyJPEG(JPEGEncodingOptions()));
+    ASSERT_TRUE(image.get());
+    EXPECT_TRUE(imageSize == image->size());
+
+    // 16x16 MCUs: 3 columns and 2 rows of them, with chroma at half the resolution both ways.
+    EXPECT_TRUE(IntSize(48, 32) == image->paddedPlaneSize(YUVImage::YPlane));
+    EXPECT_TRUE(IntSize(24, 16) == image->paddedPlaneSize(YUVImage::CbPlane));
+    EXPECT_TRUE(IntSize(24, 16) == image->paddedPlaneSize(YUVImage::CrPlane));
+    EXPECT_EQ(48u * 32 + 2 * 24 * 16, image->sizeInBytes());
+
+    expectMidGreyPlane(*image, YUVImage::YPlane, imageSize);
+    expectMidGreyPlane(*image, YUVImage::CbPlane, IntSize(19, 11));
+    expectMidGreyPlane(*image, YUVImage::CrPlane, IntSize(19, 11));
+}
+
+TEST(JPEGImageDecoder, DecodesToYUV422)
+{
+    JPEGEncodingOptions options;
+    options.lumaVerticalSampling = 1;
+    RefPtr<YUVImage> image = decodeToYUV(*encodeGreyJPEG(options));
+    ASSERT_TRUE(image.get());
+
+    // 16x8 MCUs: 3 columns and 3 rows of them, with chroma at half the horizontal resolution.
+    EXPECT_TRUE(IntSize(48, 24) == image->paddedPlaneSize(YUVImage::YPlane));
+    EXPECT_TRUE(IntSize(24, 24) == image->paddedPlaneSize(YUVImage::CbPlane));
+    EXPECT_TRUE(IntSize(24, 24) == image->paddedPlaneSize(YUVImage::CrPlane));
+
+    expectMidGreyPlane(*image, YUVImage::YPlane, imageSize);
+    expectMidGreyPlane(*image, YUVImage::CbPlane, IntSize(19, 21));
+    expectMidGreyPlane(*image, YUVImage::CrPlane, IntSize(19, 21));
+}
+
+TEST(JPEGImageDecoder, DecodesToYUV444)
+{
+    JPEGEncodingOptions options;
+    options.lumaHorizontalSampling = 1;
+    options.lumaVerticalSampling = 1;
+    RefPtr<YUVImage> image = decodeToYUV(*encodeGreyJPEG(options));
+    ASSERT_TRUE(image.get());
+
+    // 8x8 MCUs: 5 columns and 3 rows of them, with chroma at full resolution.
+    EXPECT_TRUE(IntSize(40, 24) == image->paddedPlaneSize(YUVImage::YPlane));
+    EXPECT_TRUE(IntSize(40, 24) == image->paddedPlaneSize(YUVImage::CbPlane));
+    EXPECT_TRUE(IntSize(40, 24) == image->paddedPlaneSize(YUVImage::CrPlane));
+
+    expectMidGreyPlane(*image, YUVImage::YPlane, imageSize);
+    expectMidGreyPlane(*image, YUVImage::CbPlane, imageSize);
+    expectMidGreyPlane(*image, YUVImage::CrPlane, imageSize);
+}
+
+TEST(JPEGImageDecoder, DoesNotDecodeYUV411)
+{
+    JPEGEncodingOptions options;
+    options.lumaHorizontalSampling = 4;
+    options.lumaVerticalSampling = 1;
+    EXPECT_FALSE(decodeToYUV(*encodeGreyJPEG(options)).get());
+}
+
+TEST(JPEGImageDecoder, DoesNotDecodeProgressiveImagesToYUV)
+{
+    JPEGEncodingOptions options;
+    options.progressive = true;
+    EXPECT_FALSE(decodeToYUV(*encodeGreyJPEG(options)).get());
+}
+
+TEST(JPEGImageDecoder, DoesNotDecodeImagesWithAColorProfileToYUV)
+{
+    JPEGEncodingOptions options;
+    options.colorProfile = true;
+    RefPtr<SharedBuffer> data = encodeGreyJPEG(options);
+    EXPECT_FALSE(decodeToYUV(*data).get());
+
+    // Unless color profiles are ignored anyway.
+    EXPECT_TRUE(decodeToYUV(*data, ImageSource::GammaAndColorProfileIgnored).get());
+}
+
+} // namespace TestWebKitAPI
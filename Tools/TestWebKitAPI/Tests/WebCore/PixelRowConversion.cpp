@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <WebCore/PixelRowConversion.h>
+#include <wtf/Vector.h>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+// Row lengths that exercise the vectorized loops together with every possible scalar tail.
+static const size_t rowLengths[] = { 1, 2, 3, 5, 7, 9, 15, 17, 19, 31, 33, 63, 65, 255, 257, 1023 };
+
+// The source rows start at every offset up to this one so that unaligned loads are covered.
+static const size_t maximumSourceOffset = 3;
+
+static uint32_t referencePixel(unsigned r, unsigned g, unsigned b, unsigned a, bool premultiplyAlpha)
+{
+    if (premultiplyAlpha && a != 255) {
+        r = r * a / 255;
+        g = g * a / 255;
+        b = b * a / 255;
+    }
+    return a << 24 | r << 16 | g << 8 | b;
+}
+
+// Every alpha value paired with every channel value, with distinct values in each channel.
+static Vector<uint8_t> allValueAndAlphaPairs()
+{
+    Vector<uint8_t> source;
+    source.reserveInitialCapacity(256 * 256 * 4);
+    for (unsigned alpha = 0; alpha < 256; ++alpha) {
+        for (unsigned value = 0; value < 256; ++value) {
+            source.uncheckedAppend(value);
+            source.uncheckedAppend(255 - value);
+            source.uncheckedAppend(value ^ 0x5a);
+            source.uncheckedAppend(alpha);
+        }
+    }
+    return source;
+}
+
+static void testPackRGBA(bool premultiplyAlpha)
+{
+    Vector<uint8_t> source = allValueAndAlphaPairs();
+    size_t pixelCount = source.size() / 4;
+
+    Vector<uint32_t> expected(pixelCount);
+    for (size_t i = 0; i < pixelCount; ++i) {
+        const uint8_t* pixel = source.data() + i * 4;
+        expected[i] = referencePixel(pixel[0], pixel[1], pixel[2], pixel[3], premultiplyAlpha);
+    }
+
+    // A single call converts most of the pixels with the vectorized loop...
+    Vector<uint32_t> destination(pixelCount);
+    EXPECT_TRUE(PixelRowConversion::packRGBA(source.data(), destination.data(), pixelCount, premultiplyAlpha));
+    for (size_t i = 0; i < pixelCount; ++i)
+        ASSERT_EQ(expected[i], destination[i]) << "value " << i % 256 << ", alpha " << i / 256;
+
+    // ...while converting one pixel at a time only ever takes the scalar path.
+    for (size_t i = 0; i < pixelCount; ++i) {
+        uint32_t pixel;
+        EXPECT_EQ(source[i * 4 + 3] != 255, PixelRowConversion::packRGBA(source.data() + i * 4, &pixel, 1, premultiplyAlpha));
+        ASSERT_EQ(expected[i], pixel) << "value " << i % 256 << ", alpha " << i / 256;
+    }
+
+    for (size_t length : rowLengths) {
+        for (size_t offset = 0; offset <= maximumSourceOffset; ++offset) {
+            // Rows taken from the opaque end of the source only report transparency if they reach into it.
+            size_t start = pixelCount - length - offset;
+            Vector<uint32_t> row(length);
+            bool hasAlpha = PixelRowConversion::packRGBA(source.data() + start * 4, row.data(), length, premultiplyAlpha);
+            EXPECT_EQ(start < 255 * 256, hasAlpha) << "length " << length << ", offset " << offset;
+            for (size_t i = 0; i < length; ++i)
+                ASSERT_EQ(expected[start + i], row[i]) << "length " << length << ", offset " << offset << ", pixel " << i;
+        }
+    }
+}
+
+TEST(PixelRowConversion, PackRGBAPremultiplied)
+{
+    testPackRGBA(true);
+}
+
+TEST(PixelRowConversion, PackRGBAUnpremultiplied)
+{
+    testPackRGBA(false);
+}
+
+TEST(PixelRowConversion, PackRGBAReportsSingleTransparentPixel)
+{
+    for (size_t length : rowLengths) {
+        Vector<uint8_t> source(length * 4, 255);
+        Vector<uint32_t> destination(length);
+        EXPECT_FALSE(PixelRowConversion::packRGBA(source.data(), destination.data(), length, true));
+        for (size_t i = 0; i < length; ++i) {
+            source[i * 4 + 3] = 254;
+            EXPECT_TRUE(PixelRowConversion::packRGBA(source.data(), destination.data(), length, true)) << "length " << length << ", pixel " << i;
+            source[i * 4 + 3] = 255;
+        }
+    }
+}
+
+TEST(PixelRowConversion, PackRGB)
+{
+    Vector<uint8_t> source;
+    for (unsigned i = 0; i < 1024 * 3 + maximumSourceOffset * 3; ++i)
+        source.append(i * 7 + (i >> 8));
+
+    for (size_t length : rowLengths) {
+        for (size_t offset = 0; offset <= maximumSourceOffset; ++offset) {
+            const uint8_t* row = source.data() + offset * 3;
+            Vector<uint32_t> destination(length);
+            PixelRowConversion::packRGB(row, destination.data(), length);
+            for (size_t i = 0; i < length; ++i) {
+                const uint8_t* pixel = row + i * 3;
+                ASSERT_EQ(referencePixel(pixel[0], pixel[1], pixel[2], 255, false), destination[i]) << "length " << length << ", offset " << offset << ", pixel " << i;
+            }
+        }
+    }
+}
+
+TEST(PixelRowConversion, SwapRedAndBlue)
+{
+    Vector<uint32_t> source;
+    for (unsigned i = 0; i < 1024 + maximumSourceOffset; ++i)
+        source.append(i * 0x01030507u ^ 0x9e3779b9u);
+
+    for (size_t length : rowLengths) {
+        for (size_t offset = 0; offset <= maximumSourceOffset; ++offset) {
+            const uint32_t* row = source.data() + offset;
+            Vector<uint32_t> expected(length);
+            for (size_t i = 0; i < length; ++i)
+                expected[i] = (row[i] & 0xff00ff00) | (row[i] & 0xff0000) >> 16 | (row[i] & 0xff) << 16;
+
+            Vector<uint32_t> destination(length);
+            PixelRowConversion::swapRedAndBlue(row, destination.data(), length);
+            for (size_t i = 0; i < length; ++i)
+                ASSERT_EQ(expected[i], destination[i]) << "length " << length << ", offset " << offset << ", pixel " << i;
+
+            // In place.
+            Vector<uint32_t> inPlace(length);
+            memcpy(inPlace.data(), row, length * sizeof(uint32_t));
+            PixelRowConversion::swapRedAndBlue(inPlace.data(), inPlace.data(), length);
+            for (size_t i = 0; i < length; ++i)
+                ASSERT_EQ(expected[i], inPlace[i]) << "length " << length << ", offset " << offset << ", pixel " << i;
+        }
+    }
+}
+
+TEST(PixelRowConversion, ExpandPalette)
+{
+    uint32_t palette[256];
+    for (unsigned i = 0; i < 256; ++i)
+        palette[i] = i % 3 ? (0xff000000 | i * 0x010101) : 0;
+
+    Vector<uint8_t> indices;
+    for (unsigned i = 0; i < 1024 + maximumSourceOffset; ++i)
+        indices.append(i * 13 + 1);
+
+    const uint32_t untouched = 0x12345678;
+    for (size_t length : rowLengths) {
+        for (size_t offset = 0; offset <= maximumSourceOffset; ++offset) {
+            const uint8_t* row = indices.data() + offset;
+            bool expectedTransparency = false;
+            for (size_t i = 0; i < length; ++i)
+                expectedTransparency |= !palette[row[i]];
+
+            for (bool writeTransparentPixels : { false, true }) {
+                Vector<uint32_t> destination(length, untouched);
+                EXPECT_EQ(expectedTransparency, PixelRowConversion::expandPalette(row, palette, destination.data(), length, writeTransparentPixels));
+                for (size_t i = 0; i < length; ++i) {
+                    uint32_t expected = palette[row[i]] || writeTransparentPixels ? palette[row[i]] : untouched;
+                    ASSERT_EQ(expected, destination[i]) << "length " << length << ", offset " << offset << ", pixel " << i;
+                }
+            }
+        }
+    }
+}
+
+} // namespace TestWebKitAPI
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <WebCore/FloatRoundedRect.h>
+#include <WebCore/GraphicsContext.h>
+#include <WebCore/ImageBuffer.h>
+#include <WebCore/ShadowBlur.h>
+#include <runtime/Uint8ClampedArray.h>
+#include <wtf/MainThread.h>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+class ShadowBlurTest : public testing::Test {
+public:
+    virtual void SetUp() override
+    {
+        WTF::initializeMainThread();
+        ShadowBlur::purgeTemplateCache();
+        m_initialStats = ShadowBlur::templateCacheStats();
+    }
+
+    virtual void TearDown() override
+    {
+        ShadowBlur::purgeTemplateCache();
+    }
+
+    // Large enough for the tiled shadow of a rect with the largest blur radius, 128 pixels.
+    static std::unique_ptr<ImageBuffer> createBuffer()
+    {
+        return ImageBuffer::create(FloatSize(1200, 1200), Unaccelerated);
+    }
+
+    static void drawShadow(ImageBuffer& buffer, float blurRadius, const Color& color, const FloatRect& rect, const FloatRoundedRect::Radii& radii = FloatRoundedRect::Radii())
+    {
+        ShadowBlur shadow(FloatSize(blurRadius, blurRadius), FloatSize(), color);
+        shadow.drawRectShadow(buffer.context(), FloatRoundedRect(rect, radii));
+    }
+
+    static int alphaAt(ImageBuffer& buffer, const IntPoint& point)
+    {
+        RefPtr<Uint8ClampedArray> pixel = buffer.getPremultipliedImageData(IntRect(point, IntSize(1, 1)));
+        return pixel->data()[3];
+    }
+
+    // A template is 1 pixel plus, on each side, twice the blur radius and the corner radius.
+    static size_t templateBytes(int blurRadius, int cornerRadius = 0)
+    {
+        int side = 1 + 2 * (2 * blurRadius + cornerRadius);
+        return side * side * 4;
+    }
+
+protected:
+    ShadowBlur::TemplateCacheStats m_initialStats;
+};
+
+TEST_F(ShadowBlurTest, RectsOfDifferentSizesShareATemplate)
+{
+    auto buffer = createBuffer();
+    drawShadow(*buffer, 8, Color(0, 0, 0, 128), FloatRect(100, 100, 100, 50));
+    drawShadow(*buffer, 8, Color(0, 0, 0, 128), FloatRect(300, 100, 400, 300));
+    drawShadow(*buffer, 8, Color(0, 0, 0, 128), FloatRect(100, 500, 40, 600));
+
+    ShadowBlur::TemplateCacheStats stats = ShadowBlur::templateCacheStats();
+    EXPECT_EQ(1u, stats.templateCount);
+    EXPECT_EQ(templateBytes(8), stats.bytes);
+    EXPECT_EQ(1u, stats.misses - m_initialStats.misses);
+    EXPECT_EQ(2u, stats.hits - m_initialStats.hits);
+
+    // Rounded corners and other colors are different templates, whatever the size of the rect.
+    FloatRoundedRect::Radii radii(FloatSize(10, 10), FloatSize(10, 10), FloatSize(10, 10), FloatSize(10, 10));
+    drawShadow(*buffer, 8, Color(0, 0, 0, 128), FloatRect(100, 100, 100, 60), radii);
+    drawShadow(*buffer, 8, Color(0, 0, 0, 128), FloatRect(300, 100, 400, 300), radii);
+    drawShadow(*buffer, 8, Color(255, 0, 0, 128), FloatRect(300, 100, 400, 300));
+
+    stats = ShadowBlur::templateCacheStats();
+    EXPECT_EQ(3u, stats.templateCount);
+    EXPECT_EQ(templateBytes(8) * 2 + templateBytes(8, 10), stats.bytes);
+    EXPECT_EQ(3u, stats.misses - m_initialStats.misses);
+    EXPECT_EQ(3u, stats.hits - m_initialStats.hits);
+}
+
+TEST_F(ShadowBlurTest, LeastRecentlyUsedTemplatesAreEvictedPastTheMaximumCount)
+{
+    auto buffer = createBuffer();
+    unsigned maximumTemplateCount = m_initialStats.maximumTemplateCount;
+    for (unsigned i = 0; i < maximumTemplateCount; ++i)
+        drawShadow(*buffer, 4, Color(i, 0, 0, 255), FloatRect(100, 100, 50, 50));
+
+    // Using the first template makes the second one the least recently used.
+    drawShadow(*buffer, 4, Color(0, 0, 0, 255), FloatRect(200, 200, 80, 50));
+    EXPECT_EQ(1u, ShadowBlur::templateCacheStats().hits - m_initialStats.hits);
+    EXPECT_EQ(0u, ShadowBlur::templateCacheStats().evictedTemplates - m_initialStats.evictedTemplates);
+
+    drawShadow(*buffer, 4, Color(0, 0, 255, 255), FloatRect(100, 100, 50, 50));
+    ShadowBlur::TemplateCacheStats stats = ShadowBlur::templateCacheStats();
+    EXPECT_EQ(maximumTemplateCount, stats.templateCount);
+    EXPECT_EQ(templateBytes(4) * maximumTemplateCount, stats.bytes);
+    EXPECT_EQ(1u, stats.evictedTemplates - m_initialStats.evictedTemplates);
+
+    drawShadow(*buffer, 4, Color(0, 0, 0, 255), FloatRect(100, 100, 50, 50));
+    EXPECT_EQ(2u, ShadowBlur::templateCacheStats().hits - m_initialStats.hits);
+    drawShadow(*buffer, 4, Color(1, 0, 0, 255), FloatRect(100, 100, 50, 50));
+    EXPECT_EQ(2u, ShadowBlur::templateCacheStats().hits - m_initialStats.hits);
+}
+
+TEST_F(ShadowBlurTest, LeastRecentlyUsedTemplatesAreEvictedPastTheMaximumBytes)
+{
+    // Templates of the largest blur radius take 1MB, so only one of them fits with smaller ones.
+    ASSERT_LT(templateBytes(128) + templateBytes(16), m_initialStats.maximumBytes);
+    ASSERT_GT(templateBytes(128) * 2, m_initialStats.maximumBytes);
+
+    auto buffer = createBuffer();
+    drawShadow(*buffer, 128, Color(255, 0, 0, 255), FloatRect(100, 100, 600, 600));
+    drawShadow(*buffer, 16, Color(0, 0, 0, 255), FloatRect(100, 100, 600, 600));
+    EXPECT_EQ(2u, ShadowBlur::templateCacheStats().templateCount);
+
+    drawShadow(*buffer, 128, Color(0, 0, 255, 255), FloatRect(100, 100, 600, 600));
+    ShadowBlur::TemplateCacheStats stats = ShadowBlur::templateCacheStats();
+    EXPECT_EQ(2u, stats.templateCount);
+    EXPECT_EQ(templateBytes(16) + templateBytes(128), stats.bytes);
+    EXPECT_LE(stats.bytes, stats.maximumBytes);
+    EXPECT_EQ(1u, stats.evictedTemplates - m_initialStats.evictedTemplates);
+
+    // Only the red template, the least recently used, was evicted.
+    drawShadow(*buffer, 16, Color(0, 0, 0, 255), FloatRect(100, 100, 600, 600));
+    EXPECT_EQ(1u, ShadowBlur::templateCacheStats().hits - m_initialStats.hits);
+    drawShadow(*buffer, 128, Color(255, 0, 0, 255), FloatRect(100, 100, 600, 600));
+    EXPECT_EQ(1u, ShadowBlur::templateCacheStats().hits - m_initialStats.hits);
+}
+
+TEST_F(ShadowBlurTest, TemplatesLargerThanTheMaximumBytesAreNotCached)
+{
+    // Corners of 110 pixels make the template of the largest blur radius 733 pixels wide.
+    FloatRoundedRect::Radii radii(FloatSize(110, 110), FloatSize(110, 110), FloatSize(110, 110), FloatSize(110, 110));
+    ASSERT_GT(templateBytes(128, 110), m_initialStats.maximumBytes);
+
+    auto buffer = createBuffer();
+    drawShadow(*buffer, 4, Color(0, 0, 0, 255), FloatRect(100, 100, 50, 50));
+    drawShadow(*buffer, 128, Color(0, 0, 0, 255), FloatRect(200, 200, 800, 800), radii);
+
+    // The template wasn't kept, and didn't evict the others to make room.
+    ShadowBlur::TemplateCacheStats stats = ShadowBlur::templateCacheStats();
+    EXPECT_EQ(1u, stats.templateCount);
+    EXPECT_EQ(templateBytes(4), stats.bytes);
+    EXPECT_EQ(0u, stats.evictedTemplates - m_initialStats.evictedTemplates);
+
+    // But the shadow was drawn with it, around and under the rect.
+    EXPECT_GT(alphaAt(*buffer, IntPoint(150, 600)), 0);
+    EXPECT_EQ(255, alphaAt(*buffer, IntPoint(600, 600)));
+    EXPECT_EQ(0, alphaAt(*buffer, IntPoint(600, 30)));
+
+    drawShadow(*buffer, 128, Color(0, 0, 0, 255), FloatRect(200, 200, 800, 800), radii);
+    stats = ShadowBlur::templateCacheStats();
+    EXPECT_EQ(3u, stats.misses - m_initialStats.misses);
+    EXPECT_EQ(0u, stats.hits - m_initialStats.hits);
+}
+
+} // namespace TestWebKitAPI
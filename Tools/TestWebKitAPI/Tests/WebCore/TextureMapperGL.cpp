@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#if USE(TEXTURE_MAPPER_GL) && USE(EGL)
+
+#include <WebCore/BitmapTextureGL.h>
+#include <WebCore/FilterOperations.h>
+#include <WebCore/GLContextEGL.h>
+#include <WebCore/GraphicsContext3D.h>
+#include <WebCore/TextureMapperGL.h>
+#include <cstdlib>
+#include <wtf/MainThread.h>
+#include <wtf/Vector.h>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+static const IntSize textureSize(256, 256);
+
+class TextureMapperGLTest : public testing::Test {
+public:
+    void SetUp() override
+    {
+        WTF::initializeMainThread();
+
+        // Renders on a surfaceless display, through Mesa's software rasterizer when there is no GPU.
+        setenv("WPE_BACKEND", "headless", 0);
+        m_glContext = GLContextEGL::createPbufferContext(IntSize(1, 1), nullptr);
+        ASSERT_TRUE(m_glContext.get());
+        m_glContext->makeContextCurrent();
+
+        m_textureMapper = std::make_unique<TextureMapperGL>();
+        m_textureMapper->beginPainting();
+    }
+
+    void TearDown() override
+    {
+        if (m_textureMapper)
+            m_textureMapper->endPainting();
+        m_textureMapper = nullptr;
+        m_glContext = nullptr;
+    }
+
+    // Two opaque rectangles of different colors on a transparent background, placed so that
+    // flipped or shifted results don't match.
+    PassRefPtr<BitmapTexture> createSourceTexture()
+    {
+        Vector<uint32_t> pixels(textureSize.area(), 0);
+        fillRect(pixels, IntRect(48, 32, 96, 48), 0xffff0000);
+        fillRect(pixels, IntRect(160, 150, 40, 80), 0xff0000ff);
+
+        RefPtr<BitmapTexture> texture = m_textureMapper->acquireTextureFromPool(textureSize, true);
+        texture->updateContents(pixels.data(), IntRect(IntPoint(), textureSize), IntPoint(), textureSize.width() * 4, BitmapTexture::UpdateCanModifyOriginalImageData);
+        return texture.release();
+    }
+
+    Vector<uint32_t> drawFiltered(BitmapTexture& source, const FilterOperations& filters)
+    {
+        RefPtr<BitmapTexture> filtered = source.applyFilters(m_textureMapper.get(), filters);
+
+        // Filters whose last pass is left for when the texture is drawn are completed here.
+        RefPtr<BitmapTexture> target = m_textureMapper->acquireTextureFromPool(textureSize, true);
+        m_textureMapper->bindSurface(target.get());
+        m_textureMapper->drawTexture(*filtered, FloatRect(IntPoint(), textureSize), TransformationMatrix(), 1, TextureMapper::AllEdges);
+        m_textureMapper->bindSurface(nullptr);
+        return readTexture(static_cast<BitmapTextureGL&>(*target));
+    }
+
+protected:
+    static void fillRect(Vector<uint32_t>& pixels, const IntRect& rect, uint32_t color)
+    {
+        for (int y = rect.y(); y < rect.maxY(); ++y) {
+            for (int x = rect.x(); x < rect.maxX(); ++x)
+                pixels[y * textureSize.width() + x] = color;
+        }
+    }
+
+    Vector<uint32_t> readTexture(const BitmapTextureGL& texture)
+    {
+        GraphicsContext3D* context = m_textureMapper->graphicsContext3D();
+        Platform3DObject framebuffer = context->createFramebuffer();
+        context->bindFramebuffer(GraphicsContext3D::FRAMEBUFFER, framebuffer);
+        context->framebufferTexture2D(GraphicsContext3D::FRAMEBUFFER, GraphicsContext3D::COLOR_ATTACHMENT0, GraphicsContext3D::TEXTURE_2D, texture.id(), 0);
+
+        Vector<uint32_t> pixels(textureSize.area(), 0);
+        context->readPixels(0, 0, textureSize.width(), textureSize.height(), GraphicsContext3D::RGBA, GraphicsContext3D::UNSIGNED_BYTE, pixels.data());
+
+        context->deleteFramebuffer(framebuffer);
+        m_textureMapper->bindSurface(nullptr);
+        return pixels;
+    }
+
+    std::unique_ptr<GLContextEGL> m_glContext;
+    std::unique_ptr<TextureMapperGL> m_textureMapper;
+};
+
+static int channel(uint32_t pixel, int i)
+{
+    return (pixel >> (i * 8)) & 0xff;
+}
+
+TEST_F(TextureMapperGLTest, DownsampledBlurMatchesFullSizeBlur)
+{
+    RefPtr<BitmapTexture> source = createSourceTexture();
+    FilterOperations filters;
+    filters.operations().append(BlurFilterOperation::create(Length(24, Fixed)));
+
+    // A standard deviation of 24 pixels is blurred at a quarter of the size, 6 texels.
+    EXPECT_EQ(4u, m_textureMapper->filterDownsamplingFactor(*filters.at(0), textureSize));
+    Vector<uint32_t> downsampled = drawFiltered(*source, filters);
+
+    m_textureMapper->setMaximumBlurDownsamplingFactor(1);
+    EXPECT_EQ(1u, m_textureMapper->filterDownsamplingFactor(*filters.at(0), textureSize));
+    Vector<uint32_t> fullSize = drawFiltered(*source, filters);
+
+    // The full size blur spreads the 21 samples of its kernel 4.8 pixels apart, which shows as
+    // steps along edges that the downsampled one smooths out. Everywhere else they are close.
+    int maximumDifference = 0;
+    int64_t totalDifference = 0;
+    int64_t totalAlpha = 0;
+    for (size_t i = 0; i < fullSize.size(); ++i) {
+        for (int c = 0; c < 4; ++c) {
+            int difference = std::abs(channel(downsampled[i], c) - channel(fullSize[i], c));
+            maximumDifference = std::max(maximumDifference, difference);
+            totalDifference += difference;
+        }
+        totalAlpha += channel(fullSize[i], 3);
+    }
+    EXPECT_LE(maximumDifference, 16);
+    EXPECT_LT(static_cast<double>(totalDifference) / (fullSize.size() * 4), 1);
+
+    // Both spread the same amount of color.
+    int64_t downsampledAlpha = 0;
+    for (auto pixel : downsampled)
+        downsampledAlpha += channel(pixel, 3);
+    EXPECT_NEAR(1, static_cast<double>(downsampledAlpha) / totalAlpha, 0.02);
+
+    // And both blurred the rectangles: the middle of the red one is no longer opaque, and its
+    // color reached the transparent pixels around it.
+    uint32_t center = downsampled[56 * textureSize.width() + 96];
+    EXPECT_LT(channel(center, 3), 255);
+    EXPECT_GT(channel(center, 0), channel(center, 2));
+    uint32_t outside = downsampled[20 * textureSize.width() + 96];
+    EXPECT_GT(channel(outside, 3), 0);
+}
+
+TEST_F(TextureMapperGLTest, SmallBlursAreNotDownsampled)
+{
+    FilterOperations filters;
+    filters.operations().append(BlurFilterOperation::create(Length(7, Fixed)));
+    EXPECT_EQ(1u, m_textureMapper->filterDownsamplingFactor(*filters.at(0), textureSize));
+
+    filters.operations().clear();
+    filters.operations().append(BlurFilterOperation::create(Length(8, Fixed)));
+    EXPECT_EQ(2u, m_textureMapper->filterDownsamplingFactor(*filters.at(0), textureSize));
+
+    // Never more than 8 times, nor down to nothing.
+    filters.operations().clear();
+    filters.operations().append(BlurFilterOperation::create(Length(200, Fixed)));
+    EXPECT_EQ(8u, m_textureMapper->filterDownsamplingFactor(*filters.at(0), textureSize));
+    EXPECT_EQ(4u, m_textureMapper->filterDownsamplingFactor(*filters.at(0), IntSize(1024, 5)));
+}
+
+} // namespace TestWebKitAPI
+
+#endif // USE(TEXTURE_MAPPER_GL) && USE(EGL)
@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2016 Igalia S.L.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+// Loads a page on the headless WPE backend, keeps it scrolling and animating for a while,
+// and reports the per-frame timings the backend logged in the meantime: the interval between
+// frames, the compositor render time and, separately, the main thread layer paint time.
+
+#include <WebKit/WKContext.h>
+#include <WebKit/WKFrame.h>
+#include <WebKit/WKPage.h>
+#include <WebKit/WKPageConfigurationRef.h>
+#include <WebKit/WKPageGroup.h>
+#include <WebKit/WKRetainPtr.h>
+#include <WebKit/WKString.h>
+#include <WebKit/WKURL.h>
+#include <WebKit/WKView.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <unistd.h>
+#include <vector>
+
+static int durationInSeconds = 10;
+static char* viewSize;
+static char* dumpDirectory;
+static char** uriArguments;
+
+static const GOptionEntry commandLineOptions[] = {
+    { "duration", 'd', 0, G_OPTION_ARG_INT, &durationInSeconds, "Seconds to scroll and animate the page for", "SECONDS" },
+    { "size", 's', 0, G_OPTION_ARG_STRING, &viewSize, "Size of the view", "WIDTHxHEIGHT" },
+    { "dump-frames", 0, 0, G_OPTION_ARG_FILENAME, &dumpDirectory, "Directory to dump every rendered frame into, as PPM files", "DIRECTORY" },
+    { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_STRING_ARRAY, &uriArguments, nullptr, "URL" },
+    { nullptr, 0, 0, G_OPTION_ARG_NONE, nullptr, nullptr, nullptr }
+};
+
+// Scrolls the document up and down by a fixed step on every animation frame, while a
+// composited box moves across the viewport.
+static const char* workloadScript =
+    "(function() {"
+    "    var box = document.createElement('div');"
+    "    box.style.cssText = 'position: fixed; top: 0; left: 0; width: 100px; height: 100px; background: rgba(255, 0, 0, 0.5);"
+    "        will-change: transform; pointer-events: none; z-index: 2147483647';"
+    "    (document.body || document.documentElement).appendChild(box);"
+    "    var step = 8;"
+    "    var start = performance.now();"
+    "    function tick(now) {"
+    "        var maxScroll = document.documentElement.scrollHeight - window.innerHeight;"
+    "        if (maxScroll > 0) {"
+    "            if (window.scrollY + step > maxScroll || window.scrollY + step < 0)"
+    "                step = -step;"
+    "            window.scrollBy(0, step);"
+    "        }"
+    "        var t = (now - start) / 1000;"
+    "        box.style.transform = 'translate(' + (100 + 80 * Math.cos(t * 4)) + 'px, ' + (100 + 80 * Math.sin(t * 4)) + 'px) rotate(' + (t * 180) + 'deg)';"
+    "        requestAnimationFrame(tick);"
+    "    }"
+    "    requestAnimationFrame(tick);"
+    "})();";
+
+struct Benchmark {
+    GMainLoop* loop;
+    char* frameLogPath;
+    long frameLogOffset;
+    bool started;
+};
+
+struct FrameTiming {
+    unsigned interval;
+    unsigned renderTime;
+    unsigned paintTime;
+    unsigned damagedPercentage;
+};
+
+static long fileSize(const char* path)
+{
+    GStatBuf statBuffer;
+    if (g_stat(path, &statBuffer))
+        return 0;
+    return statBuffer.st_size;
+}
+
+static void didFinishLoadForFrame(WKPageRef page, WKFrameRef frame, WKTypeRef, const void* clientInfo)
+{
+    auto& benchmark = *static_cast<Benchmark*>(const_cast<void*>(clientInfo));
+    if (!WKFrameIsMainFrame(frame) || benchmark.started)
+        return;
+
+    // Frames rendered while loading are not part of the measurement.
+    benchmark.started = true;
+    benchmark.frameLogOffset = fileSize(benchmark.frameLogPath);
+
+    auto script = adoptWK(WKStringCreateWithUTF8CString(workloadScript));
+    WKPageRunJavaScriptInMainFrame(page, script.get(), nullptr, [](WKSerializedScriptValueRef, WKErrorRef, void*) { });
+
+    g_timeout_add_seconds(durationInSeconds, [](gpointer userData) -> gboolean {
+        g_main_loop_quit(static_cast<GMainLoop*>(userData));
+        return G_SOURCE_REMOVE;
+    }, benchmark.loop);
+}
+
+static std::vector<FrameTiming> readFrameTimings(const char* path, long offset)
+{
+    std::vector<FrameTiming> timings;
+    FILE* file = fopen(path, "r");
+    if (!file)
+        return timings;
+
+    fseek(file, offset, SEEK_SET);
+    unsigned frameNumber;
+    unsigned long long interval;
+    unsigned renderTime;
+    unsigned paintTime;
+    unsigned damagedPercentage;
+    while (fscanf(file, "%u %llu %u %u %u", &frameNumber, &interval, &renderTime, &paintTime, &damagedPercentage) == 5) {
+        if (interval)
+            timings.push_back({ static_cast<unsigned>(interval), renderTime, paintTime, damagedPercentage });
+    }
+    fclose(file);
+    return timings;
+}
+
+static void printStatistics(const char* name, std::vector<unsigned> values)
+{
+    std::sort(values.begin(), values.end());
+    unsigned long long sum = 0;
+    for (auto value : values)
+        sum += value;
+
+    auto percentile = [&values](unsigned p) {
+        return values[std::min<size_t>(values.size() - 1, values.size() * p / 100)] / 1000.;
+    };
+    printf("%-18s mean %7.2f ms  median %7.2f ms  90th %7.2f ms  99th %7.2f ms  max %7.2f ms\n", name,
+        sum / 1000. / values.size(), percentile(50), percentile(90), percentile(99), values.back() / 1000.);
+}
+
+int main(int argc, char* argv[])
+{
+    GOptionContext* context = g_option_context_new(nullptr);
+    g_option_context_add_main_entries(context, commandLineOptions, nullptr);
+    GError* error = nullptr;
+    if (!g_option_context_parse(context, &argc, &argv, &error)) {
+        fprintf(stderr, "Cannot parse arguments: %s\n", error->message);
+        g_error_free(error);
+        g_option_context_free(context);
+        return 1;
+    }
+    g_option_context_free(context);
+
+    if (!uriArguments || !uriArguments[0] || durationInSeconds <= 0) {
+        fprintf(stderr, "Usage: %s [--duration=SECONDS] [--size=WIDTHxHEIGHT] [--dump-frames=DIRECTORY] URL\n", g_get_prgname());
+        return 1;
+    }
+
+    // The backends are picked in the UI and web processes from the environment, so it
+    // has to be set up before any of them is created.
+    g_setenv("WPE_BACKEND", "headless", TRUE);
+    if (viewSize)
+        g_setenv("WPE_HEADLESS_SIZE", viewSize, TRUE);
+    if (dumpDirectory)
+        g_setenv("WPE_HEADLESS_DUMP_DIRECTORY", dumpDirectory, TRUE);
+
+    Benchmark benchmark { nullptr, nullptr, 0, false };
+    bool ownsFrameLog = false;
+    if (const char* frameLogPath = g_getenv("WPE_HEADLESS_FRAME_LOG"))
+        benchmark.frameLogPath = g_strdup(frameLogPath);
+    else {
+        int fd = g_file_open_tmp("WPEFrameTimeBenchmark-XXXXXX.log", &benchmark.frameLogPath, &error);
+        if (fd == -1) {
+            fprintf(stderr, "Cannot create the frame log: %s\n", error->message);
+            g_error_free(error);
+            return 1;
+        }
+        close(fd);
+        g_setenv("WPE_HEADLESS_FRAME_LOG", benchmark.frameLogPath, TRUE);
+        ownsFrameLog = true;
+    }
+
+    benchmark.loop = g_main_loop_new(nullptr, FALSE);
+
+    auto webContext = adoptWK(WKContextCreate());
+    auto pageGroupIdentifier = adoptWK(WKStringCreateWithUTF8CString("WPEFrameTimeBenchmark"));
+    auto pageGroup = adoptWK(WKPageGroupCreateWithIdentifier(pageGroupIdentifier.get()));
+    auto pageConfiguration = adoptWK(WKPageConfigurationCreate());
+    WKPageConfigurationSetContext(pageConfiguration.get(), webContext.get());
+    WKPageConfigurationSetPageGroup(pageConfiguration.get(), pageGroup.get());
+
+    auto view = adoptWK(WKViewCreate(pageConfiguration.get()));
+    WKPageRef page = WKViewGetPage(view.get());
+
+    WKPageLoaderClientV0 loaderClient;
+    memset(&loaderClient, 0, sizeof(loaderClient));
+    loaderClient.base.version = 0;
+    loaderClient.base.clientInfo = &benchmark;
+    loaderClient.didFinishLoadForFrame = didFinishLoadForFrame;
+    WKPageSetPageLoaderClient(page, &loaderClient.base);
+
+    auto url = adoptWK(WKURLCreateWithUTF8CString(uriArguments[0]));
+    WKPageLoadURL(page, url.get());
+
+    g_main_loop_run(benchmark.loop);
+    g_main_loop_unref(benchmark.loop);
+
+    auto timings = readFrameTimings(benchmark.frameLogPath, benchmark.frameLogOffset);
+    if (ownsFrameLog)
+        g_unlink(benchmark.frameLogPath);
+    g_free(benchmark.frameLogPath);
+
+    if (timings.empty()) {
+        fprintf(stderr, "No frames were rendered, is the headless backend enabled?\n");
+        return 1;
+    }
+
+    std::vector<unsigned> intervals, renderTimes, paintTimes;
+    unsigned long long totalTime = 0;
+    unsigned droppedFrames = 0;
+    unsigned long long totalDamagedPercentage = 0;
+    for (const auto& timing : timings) {
+        intervals.push_back(timing.interval);
+        renderTimes.push_back(timing.renderTime);
+        // Frames that only moved already painted content have nothing to report.
+        if (timing.paintTime)
+            paintTimes.push_back(timing.paintTime);
+        totalTime += timing.interval;
+        totalDamagedPercentage += timing.damagedPercentage;
+        if (timing.interval > 16667)
+            ++droppedFrames;
+    }
+
+    printf("%zu frames in %.2f s, %.1f frames per second\n", timings.size(), totalTime / 1000000., timings.size() * 1000000. / totalTime);
+    printStatistics("Frame interval:", intervals);
+    printStatistics("Compositor time:", renderTimes);
+    if (!paintTimes.empty())
+        printStatistics("Paint time:", paintTimes);
+    printf("Frames with main thread paint: %zu\n", paintTimes.size());
+    printf("Damaged area: %.1f%% of the view per frame on average\n", static_cast<double>(totalDamagedPercentage) / timings.size());
+    printf("Frames over 16.7 ms: %u (%.1f%%)\n", droppedFrames, droppedFrames * 100. / timings.size());
+    return 0;
+}
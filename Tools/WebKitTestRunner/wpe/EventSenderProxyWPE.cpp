@@ -26,8 +26,16 @@
 #include "config.h"
 #include "EventSenderProxy.h"
 
+#include <WPE/Input/Handling.h>
+
 namespace WTR {
 
+// Synthesized events go through the input server, so they only reach the view with backends that take their input from it, like the headless one.
+static uint32_t eventTime(double time)
+{
+    return static_cast<uint32_t>(time * 1000);
+}
+
 EventSenderProxy::EventSenderProxy(TestController* testController)
     : m_testController(testController)
     , m_time(0)
@@ -50,12 +58,20 @@ void EventSenderProxy::mouseUp(unsigned, WKEventModifiers)
 {
 }
 
-void EventSenderProxy::mouseMoveTo(double, double)
+void EventSenderProxy::mouseMoveTo(double x, double y)
 {
+    m_position.x = x;
+    m_position.y = y;
+    WPE::Input::Server::singleton().servePointerEvent({ WPE::Input::PointerEvent::Motion, eventTime(m_time), static_cast<int>(x), static_cast<int>(y), 0, 0 });
 }
 
-void EventSenderProxy::mouseScrollBy(int, int)
+void EventSenderProxy::mouseScrollBy(int horizontal, int vertical)
 {
+    // Axis 0 is the vertical one and 1 the horizontal one, see WebEventFactory::createWebWheelEvent().
+    if (vertical)
+        WPE::Input::Server::singleton().serveAxisEvent({ WPE::Input::AxisEvent::Motion, eventTime(m_time), 0, vertical });
+    if (horizontal)
+        WPE::Input::Server::singleton().serveAxisEvent({ WPE::Input::AxisEvent::Motion, eventTime(m_time), 1, horizontal });
 }
 
 void EventSenderProxy::mouseScrollByWithWheelAndMomentumPhases(int, int, int, int)